@@ -8,33 +8,22 @@
 #include "Script/ScriptExecutor.h"
 
 #include <boost/filesystem.hpp>
+
+#include <algorithm>
 using namespace Leviathan;
 // ------------------------------------ //
 DLLEXPORT GameModule::GameModule(const std::string& filepath, const std::string& ownername,
     GameModuleLoader* loadedthrough) :
+    GameModule(filepath, *_ParseModuleFile(filepath), ownername, loadedthrough)
+{}
+
+DLLEXPORT GameModule::GameModule(const std::string& filepath, ObjectFile& file,
+    const std::string& ownername, GameModuleLoader* loadedthrough) :
     EventableScriptObject(nullptr),
-    OwnerName(ownername), Loader(loadedthrough)
+    OwnerName(ownername), LoadedFromFile(filepath), Loader(loadedthrough)
 {
-    std::string file = filepath;
-
-    if(!boost::filesystem::is_regular_file(file)) {
-
-        // Couldn't find file //
-        throw InvalidArgument("File doesn't exist '" + filepath + "'");
-    }
-
-    LoadedFromFile = file;
-
-    // Load the file //
-    auto ofile = ObjectFileProcessor::ProcessObjectFile(file, Logger::Get());
-
-    if(!ofile) {
-
-        throw InvalidArgument("File is invalid");
-    }
-
     // Process the objects //
-    if(ofile->GetTotalObjectCount() != 1) {
+    if(file.GetTotalObjectCount() != 1) {
 
         throw InvalidArgument("File contains invalid number of objects, single GameModule "
                               "expected");
@@ -42,9 +31,9 @@ DLLEXPORT GameModule::GameModule(const std::string& filepath, const std::string&
 
     // Get various data from the header //
     ObjectFileProcessor::LoadValueFromNamedVars<std::string>(
-        ofile->GetVariables(), "Version", Name, "-1", Logger::Get(), "GameModule:");
+        file.GetVariables(), "Version", Name, "-1", Logger::Get(), "GameModule:");
 
-    auto gmobject = ofile->GetObjectFromIndex(0);
+    auto gmobject = file.GetObjectFromIndex(0);
 
     Name = gmobject->GetName();
 
@@ -151,6 +140,25 @@ DLLEXPORT GameModule::GameModule(const std::string& filepath, const std::string&
     LEVIATHAN_ASSERT(!SourceFiles.empty(), "GameModule: empty source files");
 }
 
+std::unique_ptr<ObjectFile> GameModule::_ParseModuleFile(const std::string& filepath)
+{
+    if(!boost::filesystem::is_regular_file(filepath)) {
+
+        // Couldn't find file //
+        throw InvalidArgument("File doesn't exist '" + filepath + "'");
+    }
+
+    // Load the file //
+    auto ofile = ObjectFileProcessor::ProcessObjectFile(filepath, Logger::Get());
+
+    if(!ofile) {
+
+        throw InvalidArgument("File is invalid");
+    }
+
+    return ofile;
+}
+
 DLLEXPORT GameModule::~GameModule()
 {
     LoadedImportedModules.clear();
@@ -168,6 +176,43 @@ DLLEXPORT GameModule::~GameModule()
     // }
 }
 // ------------------------------------ //
+DLLEXPORT void GameModule::ReadSourceFiles()
+{
+    const auto read = [this](const std::string& file) {
+        // Same as ScriptModule::AddScriptSegmentFromFile, failures are left for Init
+        boost::system::error_code error;
+        const auto expanded = boost::filesystem::canonical(file, error).generic_string();
+
+        if(error)
+            return;
+
+        std::string scriptdata;
+        if(!FileSystem::ReadFileEntirely(expanded, scriptdata))
+            return;
+
+        ReadSources[file] = std::make_shared<ScriptSourceFileData>(expanded, 1, scriptdata);
+    };
+
+    for(const auto& file : SourceFiles)
+        read(file);
+
+    for(const auto& file : ExportFiles)
+        read(file);
+}
+
+void GameModule::_AddSourceFile(ScriptModule& mod, const std::string& file) const
+{
+    const auto found = ReadSources.find(file);
+
+    if(found != ReadSources.end()) {
+
+        mod.AddScriptSegment(found->second);
+    } else {
+
+        mod.AddScriptSegmentFromFile(file);
+    }
+}
+// ------------------------------------ //
 DLLEXPORT bool GameModule::Init()
 {
     IsCurrentlyInitializing = true;
@@ -177,21 +222,17 @@ DLLEXPORT bool GameModule::Init()
 
         const auto desc = GetDescription(true);
 
-        for(const auto& import : ImportModules) {
-
-            // Load the dependency module. We give our full description to make debugging the
-            // chain easier
-            try {
-                auto imported = Loader->Load(import, desc.c_str());
-
-                LoadedImportedModules.push_back(imported);
-            } catch(const NotFound& e) {
+        // Load the whole import graph at once so that the script files of all of the
+        // modules are read in parallel. We give our full description to make debugging the
+        // chain easier
+        try {
+            LoadedImportedModules = Loader->LoadMultiple(ImportModules, desc.c_str());
+        } catch(const NotFound& e) {
 
-                LOG_ERROR("GameModule: Init: module \"" + import +
-                          "\" could not be loaded by: " + desc + ", exception:");
-                e.PrintToLog();
-                return false;
-            }
+            LOG_ERROR("GameModule: Init: imported modules could not be loaded by: " + desc +
+                      ", exception:");
+            e.PrintToLog();
+            return false;
         }
     }
 
@@ -208,7 +249,7 @@ DLLEXPORT bool GameModule::Init()
     mod = Scripting->GetModule();
 
     for(const auto& file : SourceFiles) {
-        mod->AddScriptSegmentFromFile(file);
+        _AddSourceFile(*mod, file);
     }
 
     // Also add imported files
@@ -223,7 +264,7 @@ DLLEXPORT bool GameModule::Init()
         }
 
         for(const auto& file : import->GetExportFiles()) {
-            mod->AddScriptSegmentFromFile(file);
+            import->_AddSourceFile(*mod, file);
         }
     }
 
@@ -270,6 +311,16 @@ DLLEXPORT bool GameModule::Init()
                                ", did you intent to use Generic type?");
     }
 
+    // Only the exports are needed by modules importing this //
+    for(auto iter = ReadSources.begin(); iter != ReadSources.end();) {
+
+        if(std::find(ExportFiles.begin(), ExportFiles.end(), iter->first) == ExportFiles.end()) {
+            iter = ReadSources.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
     // Call init callbacks //
 
     // fire an event //
@@ -292,6 +343,12 @@ DLLEXPORT void GameModule::ReleaseScript()
         // Release our initial reference
         releaseEvent->Release();
 
+        {
+            Lock lock(PreparedListenersMutex);
+            PreparedEventListeners.clear();
+            PreparedGenericListeners.clear();
+        }
+
         // Remove our reference //
         int tmpid = Scripting->GetModule()->GetID();
         Scripting.reset();
@@ -310,10 +367,19 @@ DLLEXPORT std::string GameModule::GetDescription(bool full /*= false*/)
 ScriptRunResult<int> GameModule::_DoCallWithParams(
     ScriptRunningSetup& sargs, Event* event, GenericEvent* event2)
 {
-    if(event)
+    if(event) {
+
+        if(auto* call = _GetPreparedListener(PreparedEventListeners, sargs); call)
+            return call->Call(this, event);
+
         return ScriptExecutor::Get()->RunScript<int>(
             Scripting->GetModuleSafe(), sargs, this, event);
-    else
+    } else {
+
+        if(auto* call = _GetPreparedListener(PreparedGenericListeners, sargs); call)
+            return call->Call(this, event2);
+
         return ScriptExecutor::Get()->RunScript<int>(
             Scripting->GetModuleSafe(), sargs, this, event2);
+    }
 }
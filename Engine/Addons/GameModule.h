@@ -5,6 +5,7 @@
 // ------------------------------------ //
 #include "Common/ThreadSafe.h"
 #include "Events/EventableScriptObject.h"
+#include "Script/PreparedScriptCall.h"
 #include "Script/ScriptModule.h"
 // Required for template based script running
 #include "Script/ScriptExecutor.h"
@@ -24,6 +25,16 @@ protected:
     DLLEXPORT GameModule(const std::string& filepath, const std::string& ownername,
         GameModuleLoader* loadedthrough);
 
+    //! \brief Creates from an already parsed module file
+    DLLEXPORT GameModule(const std::string& filepath, ObjectFile& file,
+        const std::string& ownername, GameModuleLoader* loadedthrough);
+
+    //! \brief Reads the source and export files into memory
+    //!
+    //! This doesn't touch the script engine so GameModuleLoader runs this for multiple modules
+    //! at once. Init uses the read files instead of opening them again
+    DLLEXPORT void ReadSourceFiles();
+
     //! \brief Makes the scripts usable
     DLLEXPORT bool Init();
 
@@ -92,6 +103,47 @@ protected:
     virtual ScriptRunResult<int> _DoCallWithParams(
         ScriptRunningSetup& sargs, Event* event, GenericEvent* event2) override;
 
+    //! \exception InvalidArgument if the file doesn't exist or can't be parsed
+    static std::unique_ptr<ObjectFile> _ParseModuleFile(const std::string& filepath);
+
+    //! \brief Adds file to mod, using the data read by ReadSourceFiles if possible
+    void _AddSourceFile(ScriptModule& mod, const std::string& file) const;
+
+    //! \brief A listener function that has been looked up and prepared
+    template<class EventT>
+    struct PreparedListener {
+
+        //! The module the function was found in, used to detect reloading
+        asIScriptModule* FromModule = nullptr;
+
+        //! Not valid if the listener takes different parameters in which case RunScript is
+        //! used as it can do conversions
+        PreparedScriptCall<int, GameModule*, EventT*> Call;
+    };
+
+    //! \brief Finds the prepared listener for sargs.Entryfunction, preparing it if needed
+    //! \returns Null if the listener can't be prepared
+    template<class EventT>
+    PreparedScriptCall<int, GameModule*, EventT*>* _GetPreparedListener(
+        std::map<std::string, PreparedListener<EventT>>& listeners, ScriptRunningSetup& sargs)
+    {
+        ScriptModule* module = Scripting->GetModule();
+        asIScriptModule* asModule = module->GetModule();
+
+        Lock lock(PreparedListenersMutex);
+
+        auto& listener = listeners[sargs.Entryfunction];
+
+        if(listener.FromModule != asModule) {
+
+            listener.FromModule = asModule;
+            listener.Call.SetFunction(
+                ScriptExecutor::Get()->GetFunctionFromModule(module, sargs), false);
+        }
+
+        return listener.Call.IsValid() ? &listener.Call : nullptr;
+    }
+
 private:
     AccessFlags ExtraAccess = 0;
 
@@ -107,6 +159,9 @@ private:
     std::vector<std::string> ImportModules;
     std::vector<std::string> ExportFiles;
 
+    //! Files read by ReadSourceFiles. Only the export files are kept after Init for the
+    //! modules that import this
+    std::map<std::string, std::shared_ptr<ScriptSourceFileData>> ReadSources;
 
     //! This is used to work with GameModuleLoader without it holding a reference, in order to
     //! work like a weak reference (this is uses boost::intrusive_ptr so weak_ptr isn't
@@ -116,6 +171,14 @@ private:
     //! This is used to detect circular loading of modules
     bool IsCurrentlyInitializing = false;
 
+    //! Event listeners by function name. These are called often so they are kept prepared
+    std::map<std::string, PreparedListener<Event>> PreparedEventListeners;
+    std::map<std::string, PreparedListener<GenericEvent>> PreparedGenericListeners;
+
+    //! Events can be sent from multiple threads. This only protects finding the listeners,
+    //! PreparedScriptCall handles concurrent calls by itself
+    Mutex PreparedListenersMutex;
+
     //! Loaded modules that this depends on. The list is defined in ImportModules
     std::vector<GameModule::pointer> LoadedImportedModules;
 };
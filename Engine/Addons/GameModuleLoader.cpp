@@ -4,9 +4,12 @@
 #include "FileSystem.h"
 #include "Logger.h"
 #include "ObjectFiles/ObjectFileProcessor.h"
+#include "Threading/ThreadingManager.h"
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+
 using namespace Leviathan;
 // ------------------------------------ //
 DLLEXPORT GameModuleLoader::GameModuleLoader() {}
@@ -41,15 +44,57 @@ DLLEXPORT void GameModuleLoader::Init()
     const auto modules =
         FileSystem::Get()->FindAllMatchingFiles(FILEGROUP_SCRIPT, ".*", "levgm", false);
 
-    LOG_INFO("GameModuleLoader: detected following module files: ");
+    struct ParseResult {
+        bool Valid = false;
+        std::string ModuleName;
+        std::string Error;
+        ParsedModuleFile Parsed;
+    };
+
+    std::vector<ParseResult> results(modules.size());
+
+    const auto parse = [&](size_t index) {
+        const auto start = Time::GetThreadSafeSteadyTimePoint();
+        auto& result = results[index];
+        const auto& path = modules[index]->RelativePath;
+
+        boost::system::error_code error;
+        result.Parsed.WriteTime = boost::filesystem::last_write_time(path, error);
+
+        result.Valid = _LoadInfoFromModuleFile(
+            path, result.Parsed.File, result.ModuleName, result.Error);
+
+        result.Parsed.ParseTime = std::chrono::duration_cast<MicrosecondDuration>(
+            Time::GetThreadSafeSteadyTimePoint() - start);
+    };
+
+    const auto start = Time::GetThreadSafeSteadyTimePoint();
 
-    for(const auto& file : modules) {
+    if(auto threads = ThreadingManager::Get(); threads) {
+        threads->RunInParallel(modules.size(), parse);
+    } else {
+        for(size_t i = 0; i < modules.size(); ++i)
+            parse(i);
+    }
+
+    LOG_INFO("GameModuleLoader: parsed " + std::to_string(modules.size()) +
+             " module files in " +
+             std::to_string(std::chrono::duration_cast<MillisecondDuration>(
+                 Time::GetThreadSafeSteadyTimePoint() - start)
+                                .count()) +
+             " ms, detected following module files: ");
+
+    ParsedModuleFiles.clear();
+
+    for(size_t i = 0; i < modules.size(); ++i) {
 
-        std::string error;
-        std::string moduleName;
+        const auto& file = modules[i];
+        auto& result = results[i];
 
-        if(!_LoadInfoFromModuleFile(file->RelativePath, moduleName, error)) {
-            LOG_INFO("\t" + file->RelativePath + " which is invalid: " + error);
+        const auto& moduleName = result.ModuleName;
+
+        if(!result.Valid) {
+            LOG_INFO("\t" + file->RelativePath + " which is invalid: " + result.Error);
             continue;
         } else {
             LOG_INFO(
@@ -66,6 +111,9 @@ DLLEXPORT void GameModuleLoader::Init()
         }
 
         ModuleNameToPath[moduleName] = file->RelativePath;
+
+        if(result.Parsed.File)
+            ParsedModuleFiles[file->RelativePath] = std::move(result.Parsed);
     }
 }
 
@@ -150,6 +198,166 @@ DLLEXPORT GameModule::pointer GameModuleLoader::Load(
                        " from path: " + pathIter->second + ", inner exception: " + e.what());
     }
 }
+
+DLLEXPORT std::vector<GameModule::pointer> GameModuleLoader::LoadMultiple(
+    const std::vector<std::string>& modulenames, const char* requiredby)
+{
+    GUARD_LOCK();
+
+    const auto start = Time::GetThreadSafeSteadyTimePoint();
+
+    // Create all the modules that need loading. This also keeps them alive until all are
+    // initialized
+    std::map<std::string, GameModule::pointer> created;
+    std::vector<std::string> toprocess = modulenames;
+
+    while(!toprocess.empty()) {
+
+        const auto name = toprocess.back();
+        toprocess.pop_back();
+
+        if(created.find(name) != created.end())
+            continue;
+
+        // Already loaded modules are handled by Load //
+        const auto loaded = LoadedModules.find(name);
+
+        if(loaded != LoadedModules.end() && loaded->second)
+            continue;
+
+        const auto pathIter = ModuleNameToPath.find(name);
+
+        if(pathIter == ModuleNameToPath.end()) {
+
+            LOG_ERROR("GameModuleLoader: module with name doesn't exist: " + name);
+            throw NotFound("no module found with name (hint: remove extension): " + name);
+        }
+
+        GameModule::pointer module;
+
+        try {
+            module = _CreateModule(pathIter->second, requiredby);
+        } catch(const Exception& e) {
+
+            throw NotFound("module failed initial loading: " + name + " from path: " +
+                           pathIter->second + ", inner exception: " + e.what());
+        }
+
+        for(const auto& import : module->ImportModules)
+            toprocess.push_back(import);
+
+        created[name] = module;
+    }
+
+    // Sort into dependency order. Only the imports that are being loaded now matter
+    std::map<GameModule*, size_t> remainingImports;
+    std::map<std::string, std::vector<GameModule*>> importedBy;
+    std::vector<GameModule*> ready;
+
+    for(const auto& [name, module] : created) {
+
+        size_t count = 0;
+
+        for(const auto& import : module->ImportModules) {
+
+            if(created.find(import) == created.end())
+                continue;
+
+            ++count;
+            importedBy[import].push_back(module.get());
+        }
+
+        remainingImports[module.get()] = count;
+
+        if(count == 0)
+            ready.push_back(module.get());
+    }
+
+    std::vector<GameModule*> order;
+    order.reserve(created.size());
+
+    while(!ready.empty()) {
+
+        auto* module = ready.back();
+        ready.pop_back();
+        order.push_back(module);
+
+        for(auto* dependent : importedBy[module->GetName()]) {
+            if(--remainingImports[dependent] == 0)
+                ready.push_back(dependent);
+        }
+    }
+
+    if(order.size() != created.size()) {
+
+        std::string cycle;
+
+        for(const auto& [module, count] : remainingImports) {
+            if(count > 0)
+                cycle += (cycle.empty() ? "" : ", ") + module->GetName();
+        }
+
+        LOG_ERROR("GameModuleLoader: LoadMultiple: circular dependency detected between "
+                  "modules: " +
+                  cycle + ", required by: " + std::string(requiredby));
+        throw NotFound("circular loading detected");
+    }
+
+    // Script files don't depend on anything so they can all be read at once //
+    std::vector<MicrosecondDuration> readTimes(order.size());
+
+    const auto read = [&](size_t index) {
+        const auto readStart = Time::GetThreadSafeSteadyTimePoint();
+
+        order[index]->ReadSourceFiles();
+
+        readTimes[index] = std::chrono::duration_cast<MicrosecondDuration>(
+            Time::GetThreadSafeSteadyTimePoint() - readStart);
+    };
+
+    if(auto threads = ThreadingManager::Get(); threads) {
+        threads->RunInParallel(order.size(), read);
+    } else {
+        for(size_t i = 0; i < order.size(); ++i)
+            read(i);
+    }
+
+    for(size_t i = 0; i < order.size(); ++i)
+        LoadTimes[order[i]->GetName()].ReadSources = readTimes[i];
+
+    for(auto* module : order) {
+
+        const auto buildStart = Time::GetThreadSafeSteadyTimePoint();
+
+        if(!module->Init()) {
+
+            throw NotFound("module failed initial loading: " + module->GetName() +
+                           " from path: " + module->LoadedFromFile +
+                           ", inner exception: module Init failed");
+        }
+
+        LoadTimes[module->GetName()].Build = std::chrono::duration_cast<MicrosecondDuration>(
+            Time::GetThreadSafeSteadyTimePoint() - buildStart);
+    }
+
+    if(!order.empty()) {
+
+        LOG_INFO("GameModuleLoader: loaded " + std::to_string(order.size()) + " modules in " +
+                 std::to_string(std::chrono::duration_cast<MillisecondDuration>(
+                     Time::GetThreadSafeSteadyTimePoint() - start)
+                                    .count()) +
+                 " ms");
+        _ReportLoadTimes(order);
+    }
+
+    std::vector<GameModule::pointer> result;
+    result.reserve(modulenames.size());
+
+    for(const auto& name : modulenames)
+        result.push_back(Load(name, requiredby));
+
+    return result;
+}
 // ------------------------------------ //
 void GameModuleLoader::GameModuleReportDestruction(GameModule& module)
 {
@@ -175,10 +383,11 @@ void GameModuleLoader::GameModuleReportDestruction(GameModule& module)
     iter->second = nullptr;
 }
 // ------------------------------------ //
-bool GameModuleLoader::_LoadInfoFromModuleFile(
-    const std::string& file, std::string& modulename, std::string& errorstring)
+bool GameModuleLoader::_LoadInfoFromModuleFile(const std::string& file,
+    std::unique_ptr<ObjectFile>& parsed, std::string& modulename, std::string& errorstring)
 {
-    auto ofile = ObjectFileProcessor::ProcessObjectFile(file, Logger::Get());
+    auto& ofile = parsed;
+    ofile = ObjectFileProcessor::ProcessObjectFile(file, Logger::Get());
 
     if(!ofile) {
         errorstring = "file has invalid syntax";
@@ -212,15 +421,16 @@ GameModule::pointer GameModuleLoader::_LoadModuleFromFile(
 
     try {
 
-        auto module = GameModule::MakeShared<GameModule>(filename, requiredby, this);
+        auto module = _CreateModule(filename, requiredby);
 
-        // At this point the module will report destruction so we must register it before Init,
-        // which can fail quite easily due to syntax errors
-        LoadedModules[module->GetName()] = module.get();
+        const auto buildStart = Time::GetThreadSafeSteadyTimePoint();
 
         if(!module->Init())
             throw Exception("module Init failed");
 
+        LoadTimes[module->GetName()].Build = std::chrono::duration_cast<MicrosecondDuration>(
+            Time::GetThreadSafeSteadyTimePoint() - buildStart);
+
         // We don't need to keep a reference alive because the module reports to us before it
         // destructs and we want to act like a weak reference
         return module;
@@ -230,3 +440,61 @@ GameModule::pointer GameModuleLoader::_LoadModuleFromFile(
         throw NotFound("Module failed to load due to exception: " + std::string(e.what()));
     }
 }
+
+GameModule::pointer GameModuleLoader::_CreateModule(
+    const std::string& filename, const char* requiredby)
+{
+    GameModule::pointer module;
+    GameModuleLoadTimes times;
+
+    const auto parsed = ParsedModuleFiles.find(filename);
+
+    if(parsed != ParsedModuleFiles.end()) {
+
+        // The parsed data is only used once as the file may change after this
+        ParsedModuleFile data = std::move(parsed->second);
+        ParsedModuleFiles.erase(parsed);
+
+        boost::system::error_code error;
+        const auto writeTime = boost::filesystem::last_write_time(filename, error);
+
+        if(!error && writeTime == data.WriteTime && data.File) {
+
+            module = GameModule::MakeShared<GameModule>(filename, *data.File, requiredby, this);
+            times.Parse = data.ParseTime;
+        }
+    }
+
+    if(!module) {
+
+        const auto parseStart = Time::GetThreadSafeSteadyTimePoint();
+
+        module = GameModule::MakeShared<GameModule>(filename, requiredby, this);
+
+        times.Parse = std::chrono::duration_cast<MicrosecondDuration>(
+            Time::GetThreadSafeSteadyTimePoint() - parseStart);
+    }
+
+    // At this point the module will report destruction so we must register it before Init,
+    // which can fail quite easily due to syntax errors
+    LoadedModules[module->GetName()] = module.get();
+    LoadTimes[module->GetName()] = times;
+
+    return module;
+}
+// ------------------------------------ //
+void GameModuleLoader::_ReportLoadTimes(const std::vector<GameModule*>& modules)
+{
+    const auto toMs = [](MicrosecondDuration duration) {
+        return std::to_string(duration.count() / 1000.f);
+    };
+
+    for(auto* module : modules) {
+
+        const auto& times = LoadTimes[module->GetName()];
+
+        LOG_INFO("\t" + module->GetName() + ": parse " + toMs(times.Parse) +
+                 " ms, read sources " + toMs(times.ReadSources) + " ms, build " +
+                 toMs(times.Build) + " ms");
+    }
+}
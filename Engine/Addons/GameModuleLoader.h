@@ -6,9 +6,25 @@
 #include "GameModule.h"
 
 #include "Common/ThreadSafe.h"
+#include "TimeIncludes.h"
+
+#include <ctime>
 
 namespace Leviathan {
 
+//! \brief How long the steps of loading a GameModule took
+struct GameModuleLoadTimes {
+
+    //! Reading and parsing the module file
+    MicrosecondDuration Parse{0};
+
+    //! Reading the script source files
+    MicrosecondDuration ReadSources{0};
+
+    //! Building the script module and running the init callbacks
+    MicrosecondDuration Build{0};
+};
+
 //! \brief Manages loading GameModule objects to make sure that each is loaded only once
 //! \note This is ThreadSafeRecursive to allow the loaded modules to load their required
 //! modules without deadlocking
@@ -22,6 +38,9 @@ public:
 
     //! \brief Finds the names of all modules and which files they are in. This is safe to call
     //! again if changes to module files are detected
+    //!
+    //! The module files are parsed in parallel with ThreadingManager::RunInParallel and the
+    //! results are kept for when the modules are loaded
 	DLLEXPORT void Init();
 
     //! \brief Returns a module by name
@@ -33,21 +52,65 @@ public:
     //! \todo Allow loading by relative path (right now must just have the exact module name)
     DLLEXPORT GameModule::pointer Load(const std::string& modulename, const char* requiredby);
 
+    //! \brief Loads multiple modules and everything they import at once
+    //!
+    //! The imports are resolved into a dependency graph before anything is built. The script
+    //! files of all the modules are then read in parallel and the modules are built in
+    //! dependency order. The building itself can't be done in parallel as AngelScript doesn't
+    //! support building multiple modules at once
+    //! \note GameModule::Init uses this to load its imports, so loading a module with Load
+    //! also loads its whole import graph this way
+    //! \returns The modules in the same order as modulenames
+    //! \exception NotFound if any of the modules fails to load or there is a circular
+    //! dependency
+    DLLEXPORT std::vector<GameModule::pointer> LoadMultiple(
+        const std::vector<std::string>& modulenames, const char* requiredby);
+
+    //! \returns Load times of the modules by name
+    DLLEXPORT const auto& GetLoadTimes() const
+    {
+        return LoadTimes;
+    }
+
 protected:
     //! \brief Used by GameModule to report that it is going to be deleted
     void GameModuleReportDestruction(GameModule& module);
 
 private:
-    bool _LoadInfoFromModuleFile(
-        const std::string& file, std::string& modulename, std::string& errorstring);
+    bool _LoadInfoFromModuleFile(const std::string& file, std::unique_ptr<ObjectFile>& parsed,
+        std::string& modulename, std::string& errorstring);
 
     //! \exception NotFound on error
     GameModule::pointer _LoadModuleFromFile(
         const std::string& filename, const char* requiredby);
 
+    //! \brief Creates a module without initializing it, using the file parsed by Init if it
+    //! is still up to date
+    //! \exception Exception from the GameModule constructor
+    GameModule::pointer _CreateModule(const std::string& filename, const char* requiredby);
+
+    //! \brief Logs load times of modules
+    void _ReportLoadTimes(const std::vector<GameModule*>& modules);
+
 private:
+    //! \brief A module file parsed by Init
+    struct ParsedModuleFile {
+
+        std::unique_ptr<ObjectFile> File;
+
+        //! Used to detect changes after Init
+        std::time_t WriteTime = 0;
+
+        MicrosecondDuration ParseTime{0};
+    };
+
     std::map<std::string, std::string> ModuleNameToPath;
 
+    //! Module files parsed by Init by path, removed once the module is created
+    std::map<std::string, ParsedModuleFile> ParsedModuleFiles;
+
+    std::map<std::string, GameModuleLoadTimes> LoadTimes;
+
     // This is a plain pointer to allow GameModules to be deleted when only us have a reference
     // to it
     std::map<std::string, GameModule*> LoadedModules;
@@ -155,7 +155,16 @@ DLLEXPORT int LeviathanApplication::RunMessageLoop()
         //! TODO: make this wait happen only if tick wasn't actually and no frame was
         //! rendered
         try {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            if(_Engine->GetNoGui()) {
+
+                // Nothing is rendered so there is nothing to do until the next tick, a
+                // packet or an invoke //
+                _Engine->WaitForWork();
+
+            } else {
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
         } catch(...) {
             FailCount++;
         }
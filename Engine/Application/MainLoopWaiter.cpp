@@ -0,0 +1,80 @@
+// ------------------------------------ //
+#include "MainLoopWaiter.h"
+
+#include "SFML/Network/IpAddress.hpp"
+
+using namespace Leviathan;
+// ------------------------------------ //
+DLLEXPORT MainLoopWaiter::MainLoopWaiter() {}
+
+DLLEXPORT MainLoopWaiter::~MainLoopWaiter()
+{
+    Selector.clear();
+    WakeReceiver.unbind();
+    WakeSender.unbind();
+}
+// ------------------------------------ //
+DLLEXPORT bool MainLoopWaiter::Init()
+{
+    if(WakeReceiver.bind(sf::Socket::AnyPort, sf::IpAddress::LocalHost) != sf::Socket::Done) {
+
+        LOG_ERROR("MainLoopWaiter: Init: failed to bind the wake up socket");
+        return false;
+    }
+
+    WakePort = WakeReceiver.getLocalPort();
+    WakeReceiver.setBlocking(false);
+
+    if(WakeSender.bind(sf::Socket::AnyPort, sf::IpAddress::LocalHost) != sf::Socket::Done) {
+
+        LOG_ERROR("MainLoopWaiter: Init: failed to bind the wake up sending socket");
+        return false;
+    }
+
+    return true;
+}
+// ------------------------------------ //
+DLLEXPORT bool MainLoopWaiter::Wait(int64_t timeout, sf::UdpSocket* socket)
+{
+    if(timeout <= 0)
+        return false;
+
+    // The network socket may be different each time so this is rebuilt for each wait
+    Selector.clear();
+    Selector.add(WakeReceiver);
+
+    if(socket)
+        Selector.add(*socket);
+
+    if(!Selector.wait(sf::milliseconds(static_cast<sf::Int32>(timeout))))
+        return false;
+
+    if(Selector.isReady(WakeReceiver)) {
+
+        // Cleared before draining so that a Wake that happens after this always sends a
+        // new datagram
+        WakePending = false;
+
+        char buffer[16];
+        std::size_t received;
+        sf::IpAddress sender;
+        unsigned short port;
+
+        while(WakeReceiver.receive(buffer, sizeof(buffer), received, sender, port) ==
+              sf::Socket::Done) {
+        }
+    }
+
+    return true;
+}
+
+DLLEXPORT void MainLoopWaiter::Wake()
+{
+    if(WakePort == 0 || WakePending.exchange(true))
+        return;
+
+    const char data = 1;
+
+    Lock lock(WakeSenderMutex);
+    WakeSender.send(&data, sizeof(data), sf::IpAddress::LocalHost, WakePort);
+}
@@ -0,0 +1,57 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2018 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Common/ThreadSafe.h"
+
+#include "SFML/Network/SocketSelector.hpp"
+#include "SFML/Network/UdpSocket.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace Leviathan {
+
+//! \brief Blocks the main thread of a headless application until there is something to do
+//!
+//! All the wake up sources are waited on with a single sf::SocketSelector wait: the
+//! timeout (the next tick), the network socket becoming readable and Wake calls. Wake
+//! sends a datagram to a loopback socket that is part of the wait so that other threads
+//! (invokes, console input) can interrupt the wait without polling.
+class MainLoopWaiter {
+public:
+    DLLEXPORT MainLoopWaiter();
+    DLLEXPORT ~MainLoopWaiter();
+
+    //! \brief Binds the loopback sockets used by Wake
+    //! \returns False if the sockets couldn't be bound. Wait can't be used then
+    DLLEXPORT bool Init();
+
+    //! \brief Waits for timeout milliseconds or until something wakes this
+    //! \param socket Socket that ends the wait when it has data, can be null
+    //! \returns False if the whole timeout passed
+    DLLEXPORT bool Wait(int64_t timeout, sf::UdpSocket* socket);
+
+    //! \brief Makes the current or next Wait call return immediately
+    //! \note This is thread safe
+    DLLEXPORT void Wake();
+
+private:
+    //! Part of the wait, receives the wake up datagrams
+    sf::UdpSocket WakeReceiver;
+    unsigned short WakePort = 0;
+
+    //! Sends the wake up datagrams. Separate from WakeReceiver to not need to lock the
+    //! receiving socket while the main thread is waiting
+    sf::UdpSocket WakeSender;
+    Mutex WakeSenderMutex;
+
+    //! Set when a datagram has been sent and the main thread hasn't yet woken up. Avoids
+    //! flooding the loopback socket when many invokes are queued at once
+    std::atomic<bool> WakePending{false};
+
+    sf::SocketSelector Selector;
+};
+
+} // namespace Leviathan
@@ -0,0 +1,126 @@
+// ------------------------------------ //
+#include "BitStream.h"
+
+#include "SFML/Network/Packet.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Leviathan;
+// ------------------------------------ //
+DLLEXPORT void BitWriter::Write(uint32_t value, int bits)
+{
+    LEVIATHAN_ASSERT(bits >= 0 && bits <= 32, "BitWriter: invalid bit count");
+
+    while(bits > 0) {
+
+        const int used = static_cast<int>(BitCount % 8);
+
+        if(used == 0)
+            Bytes.push_back(0);
+
+        const int count = std::min(8 - used, bits);
+        const uint32_t mask = (1u << count) - 1;
+
+        Bytes.back() |= static_cast<uint8_t>((value & mask) << used);
+
+        value = count < 32 ? value >> count : 0;
+        bits -= count;
+        BitCount += count;
+    }
+}
+
+DLLEXPORT void BitWriter::WriteFloat(float value)
+{
+    uint32_t raw;
+    std::memcpy(&raw, &value, sizeof(raw));
+    Write(raw, 32);
+}
+
+DLLEXPORT void BitWriter::WriteSigned(int32_t value, int bits)
+{
+    Write(static_cast<uint32_t>(value), bits);
+}
+
+DLLEXPORT void BitWriter::AppendToPacket(sf::Packet& packet) const
+{
+    if(!Bytes.empty())
+        packet.append(Bytes.data(), Bytes.size());
+}
+// ------------------------------------ //
+DLLEXPORT BitReader::BitReader(const uint8_t* data, size_t size) : Data(data), Size(size) {}
+
+DLLEXPORT BitReader::BitReader(sf::Packet& packet) : Packet(&packet) {}
+// ------------------------------------ //
+DLLEXPORT uint32_t BitReader::Read(int bits)
+{
+    LEVIATHAN_ASSERT(bits >= 0 && bits <= 32, "BitReader: invalid bit count");
+
+    uint32_t value = 0;
+    int filled = 0;
+
+    while(filled < bits) {
+
+        if(BitsLeft == 0 && !_NextByte())
+            return 0;
+
+        const int count = std::min(BitsLeft, bits - filled);
+        const uint32_t mask = (1u << count) - 1;
+        const int used = 8 - BitsLeft;
+
+        value |= ((static_cast<uint32_t>(CurrentByte) >> used) & mask) << filled;
+
+        BitsLeft -= count;
+        filled += count;
+    }
+
+    return value;
+}
+
+DLLEXPORT float BitReader::ReadFloat()
+{
+    const uint32_t raw = Read(32);
+    float value;
+    std::memcpy(&value, &raw, sizeof(value));
+    return value;
+}
+
+DLLEXPORT int32_t BitReader::ReadSigned(int bits)
+{
+    uint32_t value = Read(bits);
+
+    // Sign extend
+    if(bits > 0 && bits < 32 && (value & (1u << (bits - 1))))
+        value |= ~((1u << bits) - 1);
+
+    return static_cast<int32_t>(value);
+}
+// ------------------------------------ //
+bool BitReader::_NextByte()
+{
+    if(Failed)
+        return false;
+
+    if(Packet) {
+
+        *Packet >> CurrentByte;
+
+        if(!*Packet) {
+            Failed = true;
+            return false;
+        }
+
+    } else {
+
+        if(ReadBytes >= Size) {
+            Failed = true;
+            return false;
+        }
+
+        CurrentByte = Data[ReadBytes];
+    }
+
+    ++ReadBytes;
+    BitsLeft = 8;
+    return true;
+}
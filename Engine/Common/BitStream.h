@@ -0,0 +1,108 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include <cstdint>
+#include <vector>
+
+namespace sf {
+class Packet;
+}
+
+namespace Leviathan {
+
+//! \brief Writes values with an arbitrary amount of bits into a byte buffer
+//!
+//! Bits are filled starting from the lowest bit of each byte. The last byte is padded with
+//! zero bits
+class BitWriter {
+public:
+    //! \brief Writes the lowest bits of value
+    //! \param bits How many bits to write, at most 32
+    DLLEXPORT void Write(uint32_t value, int bits);
+
+    inline void WriteBool(bool value)
+    {
+        Write(value ? 1 : 0, 1);
+    }
+
+    //! \brief Writes all 32 bits of a float
+    DLLEXPORT void WriteFloat(float value);
+
+    //! \brief Writes a signed value that must fit into bits with two's complement
+    DLLEXPORT void WriteSigned(int32_t value, int bits);
+
+    //! \brief Appends the written bytes to packet without a length
+    //!
+    //! The reader must know how many bits to read, which is the case when the same code
+    //! decides what is written and what is read
+    DLLEXPORT void AppendToPacket(sf::Packet& packet) const;
+
+    inline size_t GetBitCount() const
+    {
+        return BitCount;
+    }
+
+    inline size_t GetByteCount() const
+    {
+        return Bytes.size();
+    }
+
+    inline const std::vector<uint8_t>& GetBytes() const
+    {
+        return Bytes;
+    }
+
+protected:
+    std::vector<uint8_t> Bytes;
+    size_t BitCount = 0;
+};
+
+//! \brief Reads values written with BitWriter
+//!
+//! Can read either from a buffer or from a packet. When reading from a packet only as many
+//! bytes as are needed for the read bits are taken from it. Reading past the end returns zero
+//! bits and sets the reader as failed, and also fails the packet
+class BitReader {
+public:
+    DLLEXPORT BitReader(const uint8_t* data, size_t size);
+    DLLEXPORT BitReader(sf::Packet& packet);
+
+    DLLEXPORT uint32_t Read(int bits);
+
+    inline bool ReadBool()
+    {
+        return Read(1) != 0;
+    }
+
+    DLLEXPORT float ReadFloat();
+
+    DLLEXPORT int32_t ReadSigned(int bits);
+
+    //! \returns False if there weren't enough bits to read
+    inline bool IsValid() const
+    {
+        return !Failed;
+    }
+
+protected:
+    //! \returns False if there are no more bytes
+    bool _NextByte();
+
+protected:
+    const uint8_t* Data = nullptr;
+    size_t Size = 0;
+    size_t ReadBytes = 0;
+
+    sf::Packet* Packet = nullptr;
+
+    uint8_t CurrentByte = 0;
+
+    //! Unread bits left in CurrentByte
+    int BitsLeft = 0;
+
+    bool Failed = false;
+};
+
+} // namespace Leviathan
@@ -0,0 +1,282 @@
+// ------------------------------------ //
+#include "BulkMath.h"
+
+#include "BulkMathKernelsImpl.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LEVIATHAN_BULKMATH_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace Leviathan;
+// ------------------------------------ //
+namespace {
+
+#ifdef LEVIATHAN_BULKMATH_SSE2
+struct SSE2Ops {
+
+    using Vector = __m128;
+    static constexpr size_t WIDTH = 4;
+
+    static inline Vector Load(const float* values)
+    {
+        return _mm_loadu_ps(values);
+    }
+    static inline void Store(float* values, Vector vector)
+    {
+        _mm_storeu_ps(values, vector);
+    }
+    static inline Vector Set(float value)
+    {
+        return _mm_set1_ps(value);
+    }
+    static inline Vector Add(Vector first, Vector second)
+    {
+        return _mm_add_ps(first, second);
+    }
+    static inline Vector Subtract(Vector first, Vector second)
+    {
+        return _mm_sub_ps(first, second);
+    }
+    static inline Vector Multiply(Vector first, Vector second)
+    {
+        return _mm_mul_ps(first, second);
+    }
+    static inline Vector Divide(Vector first, Vector second)
+    {
+        return _mm_div_ps(first, second);
+    }
+    static inline Vector Sqrt(Vector value)
+    {
+        return _mm_sqrt_ps(value);
+    }
+    static inline Vector And(Vector first, Vector second)
+    {
+        return _mm_and_ps(first, second);
+    }
+    static inline Vector Xor(Vector first, Vector second)
+    {
+        return _mm_xor_ps(first, second);
+    }
+    static inline Vector Less(Vector first, Vector second)
+    {
+        return _mm_cmplt_ps(first, second);
+    }
+    static inline Vector LessOrEqual(Vector first, Vector second)
+    {
+        return _mm_cmple_ps(first, second);
+    }
+    static inline Vector Equal(Vector first, Vector second)
+    {
+        return _mm_cmpeq_ps(first, second);
+    }
+    static inline Vector Select(Vector mask, Vector first, Vector second)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, first), _mm_andnot_ps(mask, second));
+    }
+    static inline int GetLaneMask(Vector mask)
+    {
+        return _mm_movemask_ps(mask);
+    }
+};
+#endif // LEVIATHAN_BULKMATH_SSE2
+
+const BulkMathKernels* GetKernelsFor(BULK_MATH_IMPLEMENTATION implementation)
+{
+    switch(implementation) {
+    case BULK_MATH_IMPLEMENTATION::Scalar: return GetScalarBulkMathKernels();
+    case BULK_MATH_IMPLEMENTATION::SSE2: return GetSSE2BulkMathKernels();
+    }
+
+    return nullptr;
+}
+
+BULK_MATH_IMPLEMENTATION DetectBestImplementation()
+{
+    if(GetKernelsFor(BULK_MATH_IMPLEMENTATION::SSE2))
+        return BULK_MATH_IMPLEMENTATION::SSE2;
+
+    return BULK_MATH_IMPLEMENTATION::Scalar;
+}
+
+struct UsedKernels {
+
+    BULK_MATH_IMPLEMENTATION Implementation;
+    const BulkMathKernels* Kernels;
+};
+
+//! \brief The kernels that are currently used, picked on first use
+UsedKernels& GetUsed()
+{
+    static UsedKernels used = []() {
+        const auto best = DetectBestImplementation();
+        return UsedKernels{best, GetKernelsFor(best)};
+    }();
+
+    return used;
+}
+
+inline const BulkMathKernels& Kernels()
+{
+    return *GetUsed().Kernels;
+}
+
+} // namespace
+// ------------------------------------ //
+const BulkMathKernels* Leviathan::GetScalarBulkMathKernels()
+{
+    return MakeBulkMathKernels<ScalarOps>();
+}
+
+const BulkMathKernels* Leviathan::GetSSE2BulkMathKernels()
+{
+#ifdef LEVIATHAN_BULKMATH_SSE2
+    return MakeBulkMathKernels<SSE2Ops>();
+#else
+    return nullptr;
+#endif // LEVIATHAN_BULKMATH_SSE2
+}
+// ------------------------------------ //
+DLLEXPORT void BulkMath::Lerp(const float* start, const float* end, const float* progress,
+    float* result, size_t count)
+{
+    Kernels().Lerp(start, end, progress, result, count);
+}
+
+DLLEXPORT void BulkMath::Lerp(const Float3Array& start, const Float3Array& end,
+    const float* progress, Float3Array& result)
+{
+    LEVIATHAN_ASSERT(start.GetSize() == end.GetSize(), "BulkMath::Lerp size mismatch");
+
+    const size_t count = start.GetSize();
+    result.Resize(count);
+
+    Kernels().Lerp(start.X.data(), end.X.data(), progress, result.X.data(), count);
+    Kernels().Lerp(start.Y.data(), end.Y.data(), progress, result.Y.data(), count);
+    Kernels().Lerp(start.Z.data(), end.Z.data(), progress, result.Z.data(), count);
+}
+
+DLLEXPORT void BulkMath::Slerp(const Float4Array& start, const Float4Array& end,
+    const float* progress, Float4Array& result)
+{
+    LEVIATHAN_ASSERT(start.GetSize() == end.GetSize(), "BulkMath::Slerp size mismatch");
+
+    const size_t count = start.GetSize();
+    result.Resize(count);
+
+    const float* const starts[] = {start.X.data(), start.Y.data(), start.Z.data(),
+        start.W.data()};
+    const float* const ends[] = {end.X.data(), end.Y.data(), end.Z.data(), end.W.data()};
+    float* const results[] = {result.X.data(), result.Y.data(), result.Z.data(),
+        result.W.data()};
+
+    Kernels().Slerp(starts, ends, progress, results, count);
+}
+// ------------------------------------ //
+DLLEXPORT void BulkMath::Normalize(Float3Array& values)
+{
+    float* const components[] = {values.X.data(), values.Y.data(), values.Z.data()};
+
+    Kernels().Normalize3(components, values.GetSize());
+}
+
+DLLEXPORT void BulkMath::Normalize(Float4Array& values)
+{
+    float* const components[] = {
+        values.X.data(), values.Y.data(), values.Z.data(), values.W.data()};
+
+    Kernels().Normalize4(components, values.GetSize());
+}
+// ------------------------------------ //
+DLLEXPORT void BulkMath::Transform(const Float3Array& points, const Float4& orientation,
+    const Float3& translation, Float3Array& result)
+{
+    const size_t count = points.GetSize();
+    result.Resize(count);
+
+    const float* const components[] = {points.X.data(), points.Y.data(), points.Z.data()};
+    float* const results[] = {result.X.data(), result.Y.data(), result.Z.data()};
+
+    const float rotation[] = {orientation.X, orientation.Y, orientation.Z, orientation.W};
+    const float move[] = {translation.X, translation.Y, translation.Z};
+
+    Kernels().Transform(components, rotation, move, results, count);
+}
+// ------------------------------------ //
+DLLEXPORT void BulkMath::DistanceSquared(
+    const Float3Array& points, const Float3& target, float* result)
+{
+    const float* const components[] = {points.X.data(), points.Y.data(), points.Z.data()};
+    const float position[] = {target.X, target.Y, target.Z};
+
+    Kernels().DistanceSquared(components, position, result, points.GetSize());
+}
+
+DLLEXPORT size_t BulkMath::FindInsideRadius(const Float3Array& points, const Float3& center,
+    float radius, std::vector<size_t>& found)
+{
+    const size_t count = points.GetSize();
+    const size_t oldSize = found.size();
+
+    // Space for the worst case so that the kernels don't need to grow the vector
+    found.resize(oldSize + count);
+
+    const float* const components[] = {points.X.data(), points.Y.data(), points.Z.data()};
+    const float position[] = {center.X, center.Y, center.Z};
+
+    const size_t foundCount = Kernels().FindInsideRadius(
+        components, position, radius * radius, found.data() + oldSize, count);
+
+    found.resize(oldSize + foundCount);
+    return foundCount;
+}
+
+DLLEXPORT size_t BulkMath::FindInsideBox(const Float3Array& points, const Float3& min,
+    const Float3& max, std::vector<size_t>& found)
+{
+    const size_t count = points.GetSize();
+    const size_t oldSize = found.size();
+
+    found.resize(oldSize + count);
+
+    const float* const components[] = {points.X.data(), points.Y.data(), points.Z.data()};
+    const float low[] = {min.X, min.Y, min.Z};
+    const float high[] = {max.X, max.Y, max.Z};
+
+    const size_t foundCount =
+        Kernels().FindInsideBox(components, low, high, found.data() + oldSize, count);
+
+    found.resize(oldSize + foundCount);
+    return foundCount;
+}
+// ------------------------------------ //
+DLLEXPORT BULK_MATH_IMPLEMENTATION BulkMath::GetImplementation()
+{
+    return GetUsed().Implementation;
+}
+
+DLLEXPORT const char* BulkMath::GetImplementationName()
+{
+    switch(GetUsed().Implementation) {
+    case BULK_MATH_IMPLEMENTATION::Scalar: return "scalar";
+    case BULK_MATH_IMPLEMENTATION::SSE2: return "SSE2";
+    }
+
+    return "unknown";
+}
+
+DLLEXPORT bool BulkMath::IsSupported(BULK_MATH_IMPLEMENTATION implementation)
+{
+    return GetKernelsFor(implementation) != nullptr;
+}
+
+DLLEXPORT bool BulkMath::SetImplementation(BULK_MATH_IMPLEMENTATION implementation)
+{
+    const BulkMathKernels* kernels = GetKernelsFor(implementation);
+
+    if(!kernels)
+        return false;
+
+    GetUsed() = UsedKernels{implementation, kernels};
+    return true;
+}
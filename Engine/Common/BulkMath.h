@@ -0,0 +1,245 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Types.h"
+
+#include <new>
+#include <vector>
+
+namespace Leviathan {
+
+//! \brief Allocator that aligns memory for SIMD loads
+template<class T, size_t Alignment>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template<class U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template<class U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+    {}
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(
+            ::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* pointer, size_t)
+    {
+        ::operator delete(pointer, std::align_val_t(Alignment));
+    }
+
+    template<class U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const
+    {
+        return true;
+    }
+
+    template<class U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const
+    {
+        return false;
+    }
+};
+
+//! Alignment of AlignedVector, enough for the widest vectors that BulkMath uses
+constexpr size_t BULK_MATH_ALIGNMENT = 16;
+
+template<class T>
+using AlignedVector = std::vector<T, AlignedAllocator<T, BULK_MATH_ALIGNMENT>>;
+
+//! \brief Many Float3 values stored as separate X, Y and Z arrays for BulkMath
+class Float3Array {
+public:
+    inline size_t GetSize() const
+    {
+        return X.size();
+    }
+
+    inline void Resize(size_t size)
+    {
+        X.resize(size);
+        Y.resize(size);
+        Z.resize(size);
+    }
+
+    inline void Reserve(size_t size)
+    {
+        X.reserve(size);
+        Y.reserve(size);
+        Z.reserve(size);
+    }
+
+    //! \brief Removes all values but keeps the memory
+    inline void Clear()
+    {
+        X.clear();
+        Y.clear();
+        Z.clear();
+    }
+
+    inline void PushBack(const Float3& value)
+    {
+        X.push_back(value.X);
+        Y.push_back(value.Y);
+        Z.push_back(value.Z);
+    }
+
+    inline Float3 Get(size_t index) const
+    {
+        return Float3(X[index], Y[index], Z[index]);
+    }
+
+    inline void Set(size_t index, const Float3& value)
+    {
+        X[index] = value.X;
+        Y[index] = value.Y;
+        Z[index] = value.Z;
+    }
+
+    AlignedVector<float> X;
+    AlignedVector<float> Y;
+    AlignedVector<float> Z;
+};
+
+//! \brief Many Float4 values (usually quaternions) stored as separate X, Y, Z and W arrays
+class Float4Array {
+public:
+    inline size_t GetSize() const
+    {
+        return X.size();
+    }
+
+    inline void Resize(size_t size)
+    {
+        X.resize(size);
+        Y.resize(size);
+        Z.resize(size);
+        W.resize(size);
+    }
+
+    inline void Reserve(size_t size)
+    {
+        X.reserve(size);
+        Y.reserve(size);
+        Z.reserve(size);
+        W.reserve(size);
+    }
+
+    //! \brief Removes all values but keeps the memory
+    inline void Clear()
+    {
+        X.clear();
+        Y.clear();
+        Z.clear();
+        W.clear();
+    }
+
+    inline void PushBack(const Float4& value)
+    {
+        X.push_back(value.X);
+        Y.push_back(value.Y);
+        Z.push_back(value.Z);
+        W.push_back(value.W);
+    }
+
+    inline Float4 Get(size_t index) const
+    {
+        return Float4(X[index], Y[index], Z[index], W[index]);
+    }
+
+    inline void Set(size_t index, const Float4& value)
+    {
+        X[index] = value.X;
+        Y[index] = value.Y;
+        Z[index] = value.Z;
+        W[index] = value.W;
+    }
+
+    AlignedVector<float> X;
+    AlignedVector<float> Y;
+    AlignedVector<float> Z;
+    AlignedVector<float> W;
+};
+
+//! \brief Instruction sets that BulkMath can use
+enum class BULK_MATH_IMPLEMENTATION { Scalar, SSE2 };
+
+//! \brief Operations on many Float3 and Float4 values at once
+//!
+//! The fastest instruction set that the processor supports is picked when first used. All
+//! of the operations give the same results as the matching Float3 and Float4 methods. The
+//! output arrays are resized to match the inputs and may be the same as an input array
+class BulkMath {
+public:
+    BulkMath() = delete;
+
+    //! \brief Linear interpolation of count values, same as Float3::Lerp for each value
+    DLLEXPORT static void Lerp(const float* start, const float* end, const float* progress,
+        float* result, size_t count);
+
+    //! \brief Float3::Lerp for each value
+    //! \param progress Must have as many values as start
+    DLLEXPORT static void Lerp(const Float3Array& start, const Float3Array& end,
+        const float* progress, Float3Array& result);
+
+    //! \brief Float4::Slerp for each value
+    DLLEXPORT static void Slerp(const Float4Array& start, const Float4Array& end,
+        const float* progress, Float4Array& result);
+
+    //! \brief Float3::Normalize for each value
+    DLLEXPORT static void Normalize(Float3Array& values);
+
+    //! \brief Float4::Normalize for each value
+    DLLEXPORT static void Normalize(Float4Array& values);
+
+    //! \brief Rotates points with orientation and then moves them by translation
+    //!
+    //! Same as orientation.RotateVector(point) + translation
+    DLLEXPORT static void Transform(const Float3Array& points, const Float4& orientation,
+        const Float3& translation, Float3Array& result);
+
+    //! \brief Calculates the squared distances of points from target
+    //! \param result Must have space for all of the points
+    DLLEXPORT static void DistanceSquared(
+        const Float3Array& points, const Float3& target, float* result);
+
+    //! \brief Finds the points that are at most radius away from center
+    //! \param found The indexes of the found points are added here
+    //! \returns The number of found points
+    DLLEXPORT static size_t FindInsideRadius(const Float3Array& points, const Float3& center,
+        float radius, std::vector<size_t>& found);
+
+    //! \brief Finds the points that are inside the axis aligned box from min to max
+    //!
+    //! Points on the box faces are inside
+    //! \param found The indexes of the found points are added here
+    //! \returns The number of found points
+    DLLEXPORT static size_t FindInsideBox(const Float3Array& points, const Float3& min,
+        const Float3& max, std::vector<size_t>& found);
+
+    //! \returns The currently used instruction set
+    DLLEXPORT static BULK_MATH_IMPLEMENTATION GetImplementation();
+
+    //! \returns "SSE2" or "scalar" depending on the currently used instruction set
+    DLLEXPORT static const char* GetImplementationName();
+
+    //! \returns True if the processor and the build support implementation
+    DLLEXPORT static bool IsSupported(BULK_MATH_IMPLEMENTATION implementation);
+
+    //! \brief Forces an instruction set to be used, for testing and benchmarking
+    //! \note This isn't thread safe and must not be called while other threads use BulkMath
+    //! \returns False if implementation isn't supported and nothing was changed
+    DLLEXPORT static bool SetImplementation(BULK_MATH_IMPLEMENTATION implementation);
+};
+
+} // namespace Leviathan
@@ -0,0 +1,50 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+
+namespace Leviathan {
+
+//! \brief The functions implementing BulkMath with one instruction set
+//!
+//! The components of Float3Array and Float4Array are passed as arrays of 3 or 4 pointers
+//! \see BulkMathKernelsImpl.h
+struct BulkMathKernels {
+
+    void (*Lerp)(const float* start, const float* end, const float* progress, float* result,
+        size_t count);
+
+    void (*Slerp)(const float* const* start, const float* const* end, const float* progress,
+        float* const* result, size_t count);
+
+    void (*Normalize3)(float* const* values, size_t count);
+
+    void (*Normalize4)(float* const* values, size_t count);
+
+    //! \param rotation Quaternion X, Y, Z and W
+    //! \param translation X, Y and Z
+    void (*Transform)(const float* const* points, const float* rotation,
+        const float* translation, float* const* result, size_t count);
+
+    void (*DistanceSquared)(
+        const float* const* points, const float* target, float* result, size_t count);
+
+    //! \param found Must have space for count indexes
+    //! \returns The number of indexes written to found
+    size_t (*FindInsideRadius)(const float* const* points, const float* center,
+        float radiussquared, size_t* found, size_t count);
+
+    //! \param found Must have space for count indexes
+    //! \returns The number of indexes written to found
+    size_t (*FindInsideBox)(const float* const* points, const float* min, const float* max,
+        size_t* found, size_t count);
+};
+
+//! \returns The plain C++ kernels, these are always available
+const BulkMathKernels* GetScalarBulkMathKernels();
+
+//! \returns The SSE2 kernels or null if the build doesn't target x86
+const BulkMathKernels* GetSSE2BulkMathKernels();
+
+} // namespace Leviathan
@@ -0,0 +1,518 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+//! \file The BulkMath operations written once for all instruction sets
+//!
+//! Each instruction set has a struct with the vector operations, which is given to
+//! MakeBulkMathKernels to instantiate these with it. Only BulkMath.cpp includes this
+// ------------------------------------ //
+#include "BulkMathKernels.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace Leviathan {
+namespace {
+
+//! Quaternions closer than this are linearly interpolated, same as in Float4::Slerp
+constexpr float SLERP_LINEAR_THRESHOLD = 0.95f;
+
+//! \brief Vector operations on one float at a time
+//!
+//! Used for the values left over after the last full vector. Masks are floats with all bits
+//! set or cleared like the SIMD compare results
+struct ScalarOps {
+
+    using Vector = float;
+    static constexpr size_t WIDTH = 1;
+
+    static inline float Load(const float* values)
+    {
+        return *values;
+    }
+    static inline void Store(float* values, float value)
+    {
+        *values = value;
+    }
+    static inline float Set(float value)
+    {
+        return value;
+    }
+    static inline float Add(float first, float second)
+    {
+        return first + second;
+    }
+    static inline float Subtract(float first, float second)
+    {
+        return first - second;
+    }
+    static inline float Multiply(float first, float second)
+    {
+        return first * second;
+    }
+    static inline float Divide(float first, float second)
+    {
+        return first / second;
+    }
+    static inline float Sqrt(float value)
+    {
+        return sqrtf(value);
+    }
+    static inline float And(float first, float second)
+    {
+        return FromBits(ToBits(first) & ToBits(second));
+    }
+    static inline float Xor(float first, float second)
+    {
+        return FromBits(ToBits(first) ^ ToBits(second));
+    }
+    static inline float Less(float first, float second)
+    {
+        return FromBits(first < second ? 0xFFFFFFFF : 0);
+    }
+    static inline float LessOrEqual(float first, float second)
+    {
+        return FromBits(first <= second ? 0xFFFFFFFF : 0);
+    }
+    static inline float Equal(float first, float second)
+    {
+        return FromBits(first == second ? 0xFFFFFFFF : 0);
+    }
+    //! \returns first where mask is set and second elsewhere
+    static inline float Select(float mask, float first, float second)
+    {
+        return ToBits(mask) != 0 ? first : second;
+    }
+    //! \returns Bit for each lane that has its mask set
+    static inline int GetLaneMask(float mask)
+    {
+        return static_cast<int>(ToBits(mask) >> 31);
+    }
+
+private:
+    static inline uint32_t ToBits(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static inline float FromBits(uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+// ------------------------------------ //
+// Each loop processes values from index while a full vector fits and returns where it
+// stopped. The operations are done in the same order as in Types.h for identical results
+
+template<class Ops>
+size_t LerpLoop(const float* start, const float* end, const float* progress, float* result,
+    size_t index, size_t count)
+{
+    for(; index + Ops::WIDTH <= count; index += Ops::WIDTH) {
+
+        const auto from = Ops::Load(start + index);
+        const auto difference = Ops::Subtract(Ops::Load(end + index), from);
+
+        Ops::Store(result + index,
+            Ops::Add(Ops::Multiply(difference, Ops::Load(progress + index)), from));
+    }
+
+    return index;
+}
+
+template<class Ops>
+size_t SlerpLoop(const float* const* start, const float* const* end, const float* progress,
+    float* const* result, size_t index, size_t count)
+{
+    using Vector = typename Ops::Vector;
+
+    const Vector zero = Ops::Set(0.f);
+    const Vector signBit = Ops::Set(-0.f);
+    const Vector threshold = Ops::Set(SLERP_LINEAR_THRESHOLD);
+
+    for(; index + Ops::WIDTH <= count; index += Ops::WIDTH) {
+
+        Vector from[4];
+        Vector to[4];
+
+        for(size_t c = 0; c < 4; ++c) {
+            from[c] = Ops::Load(start[c] + index);
+            to[c] = Ops::Load(end[c] + index);
+        }
+
+        const Vector factor = Ops::Load(progress + index);
+
+        Vector dot = Ops::Multiply(from[0], to[0]);
+
+        for(size_t c = 1; c < 4; ++c)
+            dot = Ops::Add(dot, Ops::Multiply(from[c], to[c]));
+
+        // Take the shorter path by negating the end where the dot product is negative
+        const Vector flip = Ops::And(Ops::Less(dot, zero), signBit);
+        dot = Ops::Xor(dot, flip);
+
+        for(size_t c = 0; c < 4; ++c)
+            to[c] = Ops::Xor(to[c], flip);
+
+        Vector interpolated[4];
+
+        for(size_t c = 0; c < 4; ++c) {
+            interpolated[c] =
+                Ops::Add(Ops::Multiply(Ops::Subtract(to[c], from[c]), factor), from[c]);
+        }
+
+        const Vector spherical = Ops::Less(dot, threshold);
+        const int sphericalLanes = Ops::GetLaneMask(spherical);
+
+        // Usually the rotation between the values is small enough to not need this
+        if(sphericalLanes != 0) {
+
+            alignas(16) float dots[Ops::WIDTH];
+            alignas(16) float factors[Ops::WIDTH];
+            alignas(16) float fromWeights[Ops::WIDTH];
+            alignas(16) float toWeights[Ops::WIDTH];
+            alignas(16) float divisors[Ops::WIDTH];
+
+            Ops::Store(dots, dot);
+            Ops::Store(factors, factor);
+
+            for(size_t lane = 0; lane < Ops::WIDTH; ++lane) {
+
+                if(sphericalLanes & (1 << lane)) {
+
+                    const float angle = acosf(dots[lane]);
+                    fromWeights[lane] = sinf(angle * (1 - factors[lane]));
+                    toWeights[lane] = sinf(angle * factors[lane]);
+                    divisors[lane] = sinf(angle);
+                } else {
+
+                    fromWeights[lane] = 0.f;
+                    toWeights[lane] = 0.f;
+                    divisors[lane] = 1.f;
+                }
+            }
+
+            const Vector fromWeight = Ops::Load(fromWeights);
+            const Vector toWeight = Ops::Load(toWeights);
+            const Vector divisor = Ops::Load(divisors);
+
+            for(size_t c = 0; c < 4; ++c) {
+
+                const Vector weighted = Ops::Add(
+                    Ops::Multiply(from[c], fromWeight), Ops::Multiply(to[c], toWeight));
+
+                interpolated[c] = Ops::Select(
+                    spherical, Ops::Divide(weighted, divisor), interpolated[c]);
+            }
+        }
+
+        for(size_t c = 0; c < 4; ++c)
+            Ops::Store(result[c] + index, interpolated[c]);
+    }
+
+    return index;
+}
+
+template<class Ops>
+size_t Normalize3Loop(float* const* values, size_t index, size_t count)
+{
+    using Vector = typename Ops::Vector;
+
+    const Vector zero = Ops::Set(0.f);
+
+    for(; index + Ops::WIDTH <= count; index += Ops::WIDTH) {
+
+        Vector components[3];
+
+        for(size_t c = 0; c < 3; ++c)
+            components[c] = Ops::Load(values[c] + index);
+
+        Vector lengthSquared = Ops::Multiply(components[0], components[0]);
+
+        for(size_t c = 1; c < 3; ++c) {
+            lengthSquared =
+                Ops::Add(lengthSquared, Ops::Multiply(components[c], components[c]));
+        }
+
+        const Vector length = Ops::Sqrt(lengthSquared);
+        const Vector isZero = Ops::Equal(length, zero);
+
+        // Zero length vectors become all zeros
+        for(size_t c = 0; c < 3; ++c) {
+            Ops::Store(values[c] + index,
+                Ops::Select(isZero, zero, Ops::Divide(components[c], length)));
+        }
+    }
+
+    return index;
+}
+
+template<class Ops>
+size_t Normalize4Loop(float* const* values, size_t index, size_t count)
+{
+    using Vector = typename Ops::Vector;
+
+    const Vector zero = Ops::Set(0.f);
+
+    // Zero length quaternions become identity quaternions
+    const Vector identity[4] = {zero, zero, zero, Ops::Set(1.f)};
+
+    for(; index + Ops::WIDTH <= count; index += Ops::WIDTH) {
+
+        Vector components[4];
+
+        for(size_t c = 0; c < 4; ++c)
+            components[c] = Ops::Load(values[c] + index);
+
+        Vector lengthSquared = Ops::Multiply(components[0], components[0]);
+
+        for(size_t c = 1; c < 4; ++c) {
+            lengthSquared =
+                Ops::Add(lengthSquared, Ops::Multiply(components[c], components[c]));
+        }
+
+        const Vector length = Ops::Sqrt(lengthSquared);
+        const Vector isZero = Ops::Equal(length, zero);
+
+        for(size_t c = 0; c < 4; ++c) {
+            Ops::Store(values[c] + index,
+                Ops::Select(isZero, identity[c], Ops::Divide(components[c], length)));
+        }
+    }
+
+    return index;
+}
+
+template<class Ops>
+size_t TransformLoop(const float* const* points, const float* rotation,
+    const float* translation, float* const* result, size_t index, size_t count)
+{
+    using Vector = typename Ops::Vector;
+
+    const Vector qx = Ops::Set(rotation[0]);
+    const Vector qy = Ops::Set(rotation[1]);
+    const Vector qz = Ops::Set(rotation[2]);
+    const Vector doubleW = Ops::Set(2.0f * rotation[3]);
+    const Vector two = Ops::Set(2.0f);
+
+    const Vector move[3] = {
+        Ops::Set(translation[0]), Ops::Set(translation[1]), Ops::Set(translation[2])};
+
+    for(; index + Ops::WIDTH <= count; index += Ops::WIDTH) {
+
+        const Vector vx = Ops::Load(points[0] + index);
+        const Vector vy = Ops::Load(points[1] + index);
+        const Vector vz = Ops::Load(points[2] + index);
+
+        // Same as Float4::RotateVector
+        const Vector uv[3] = {Ops::Subtract(Ops::Multiply(qy, vz), Ops::Multiply(vy, qz)),
+            Ops::Subtract(Ops::Multiply(qz, vx), Ops::Multiply(vz, qx)),
+            Ops::Subtract(Ops::Multiply(qx, vy), Ops::Multiply(vx, qy))};
+
+        const Vector uuv[3] = {
+            Ops::Subtract(Ops::Multiply(qy, uv[2]), Ops::Multiply(uv[1], qz)),
+            Ops::Subtract(Ops::Multiply(qz, uv[0]), Ops::Multiply(uv[2], qx)),
+            Ops::Subtract(Ops::Multiply(qx, uv[1]), Ops::Multiply(uv[0], qy))};
+
+        const Vector vector[3] = {vx, vy, vz};
+
+        for(size_t c = 0; c < 3; ++c) {
+
+            const Vector rotated = Ops::Add(Ops::Add(vector[c], Ops::Multiply(uv[c], doubleW)),
+                Ops::Multiply(uuv[c], two));
+
+            Ops::Store(result[c] + index, Ops::Add(rotated, move[c]));
+        }
+    }
+
+    return index;
+}
+
+template<class Ops>
+inline typename Ops::Vector DistanceSquaredAt(
+    const float* const* points, const typename Ops::Vector* target, size_t index)
+{
+    using Vector = typename Ops::Vector;
+
+    Vector difference[3];
+
+    for(size_t c = 0; c < 3; ++c)
+        difference[c] = Ops::Subtract(Ops::Load(points[c] + index), target[c]);
+
+    // Same as Float3::LengthSquared of the difference
+    Vector result = Ops::Multiply(difference[0], difference[0]);
+
+    for(size_t c = 1; c < 3; ++c)
+        result = Ops::Add(result, Ops::Multiply(difference[c], difference[c]));
+
+    return result;
+}
+
+template<class Ops>
+size_t DistanceSquaredLoop(const float* const* points, const float* target, float* result,
+    size_t index, size_t count)
+{
+    using Vector = typename Ops::Vector;
+
+    const Vector to[3] = {Ops::Set(target[0]), Ops::Set(target[1]), Ops::Set(target[2])};
+
+    for(; index + Ops::WIDTH <= count; index += Ops::WIDTH)
+        Ops::Store(result + index, DistanceSquaredAt<Ops>(points, to, index));
+
+    return index;
+}
+
+//! \brief Adds the indexes of the set lanes to found
+inline size_t StoreFoundLanes(int lanes, size_t index, size_t* found)
+{
+    size_t added = 0;
+
+    for(size_t lane = 0; lanes != 0; ++lane, lanes >>= 1) {
+
+        if(lanes & 1)
+            found[added++] = index + lane;
+    }
+
+    return added;
+}
+
+template<class Ops>
+size_t FindInsideRadiusLoop(const float* const* points, const float* center,
+    float radiussquared, size_t* found, size_t& foundcount, size_t index, size_t count)
+{
+    using Vector = typename Ops::Vector;
+
+    const Vector to[3] = {Ops::Set(center[0]), Ops::Set(center[1]), Ops::Set(center[2])};
+    const Vector limit = Ops::Set(radiussquared);
+
+    for(; index + Ops::WIDTH <= count; index += Ops::WIDTH) {
+
+        const int lanes = Ops::GetLaneMask(
+            Ops::LessOrEqual(DistanceSquaredAt<Ops>(points, to, index), limit));
+
+        foundcount += StoreFoundLanes(lanes, index, found + foundcount);
+    }
+
+    return index;
+}
+
+template<class Ops>
+size_t FindInsideBoxLoop(const float* const* points, const float* min, const float* max,
+    size_t* found, size_t& foundcount, size_t index, size_t count)
+{
+    using Vector = typename Ops::Vector;
+
+    const Vector low[3] = {Ops::Set(min[0]), Ops::Set(min[1]), Ops::Set(min[2])};
+    const Vector high[3] = {Ops::Set(max[0]), Ops::Set(max[1]), Ops::Set(max[2])};
+
+    for(; index + Ops::WIDTH <= count; index += Ops::WIDTH) {
+
+        Vector inside[3];
+
+        for(size_t c = 0; c < 3; ++c) {
+
+            const Vector value = Ops::Load(points[c] + index);
+            inside[c] =
+                Ops::And(Ops::LessOrEqual(low[c], value), Ops::LessOrEqual(value, high[c]));
+        }
+
+        const int lanes = Ops::GetLaneMask(Ops::And(Ops::And(inside[0], inside[1]), inside[2]));
+
+        foundcount += StoreFoundLanes(lanes, index, found + foundcount);
+    }
+
+    return index;
+}
+
+// ------------------------------------ //
+// The kernels run the loops with Ops and finish the rest one value at a time
+
+template<class Ops>
+void LerpKernel(const float* start, const float* end, const float* progress, float* result,
+    size_t count)
+{
+    const size_t index = LerpLoop<Ops>(start, end, progress, result, 0, count);
+    LerpLoop<ScalarOps>(start, end, progress, result, index, count);
+}
+
+template<class Ops>
+void SlerpKernel(const float* const* start, const float* const* end, const float* progress,
+    float* const* result, size_t count)
+{
+    const size_t index = SlerpLoop<Ops>(start, end, progress, result, 0, count);
+    SlerpLoop<ScalarOps>(start, end, progress, result, index, count);
+}
+
+template<class Ops>
+void Normalize3Kernel(float* const* values, size_t count)
+{
+    Normalize3Loop<ScalarOps>(values, Normalize3Loop<Ops>(values, 0, count), count);
+}
+
+template<class Ops>
+void Normalize4Kernel(float* const* values, size_t count)
+{
+    Normalize4Loop<ScalarOps>(values, Normalize4Loop<Ops>(values, 0, count), count);
+}
+
+template<class Ops>
+void TransformKernel(const float* const* points, const float* rotation,
+    const float* translation, float* const* result, size_t count)
+{
+    const size_t index = TransformLoop<Ops>(points, rotation, translation, result, 0, count);
+    TransformLoop<ScalarOps>(points, rotation, translation, result, index, count);
+}
+
+template<class Ops>
+void DistanceSquaredKernel(
+    const float* const* points, const float* target, float* result, size_t count)
+{
+    const size_t index = DistanceSquaredLoop<Ops>(points, target, result, 0, count);
+    DistanceSquaredLoop<ScalarOps>(points, target, result, index, count);
+}
+
+template<class Ops>
+size_t FindInsideRadiusKernel(const float* const* points, const float* center,
+    float radiussquared, size_t* found, size_t count)
+{
+    size_t foundCount = 0;
+
+    const size_t index =
+        FindInsideRadiusLoop<Ops>(points, center, radiussquared, found, foundCount, 0, count);
+    FindInsideRadiusLoop<ScalarOps>(
+        points, center, radiussquared, found, foundCount, index, count);
+
+    return foundCount;
+}
+
+template<class Ops>
+size_t FindInsideBoxKernel(const float* const* points, const float* min, const float* max,
+    size_t* found, size_t count)
+{
+    size_t foundCount = 0;
+
+    const size_t index = FindInsideBoxLoop<Ops>(points, min, max, found, foundCount, 0, count);
+    FindInsideBoxLoop<ScalarOps>(points, min, max, found, foundCount, index, count);
+
+    return foundCount;
+}
+
+//! \returns The kernels using the vector operations in Ops
+template<class Ops>
+const BulkMathKernels* MakeBulkMathKernels()
+{
+    static const BulkMathKernels kernels = {&LerpKernel<Ops>, &SlerpKernel<Ops>,
+        &Normalize3Kernel<Ops>, &Normalize4Kernel<Ops>, &TransformKernel<Ops>,
+        &DistanceSquaredKernel<Ops>, &FindInsideRadiusKernel<Ops>, &FindInsideBoxKernel<Ops>};
+
+    return &kernels;
+}
+
+} // namespace
+} // namespace Leviathan
@@ -0,0 +1,62 @@
+// ------------------------------------ //
+#include "FixedTimestep.h"
+
+#include <algorithm>
+
+using namespace Leviathan;
+// ------------------------------------ //
+DLLEXPORT FixedTimestep::FixedTimestep(int interval, int maxcatchup, int64_t now /*= 0*/) :
+    Interval(std::max(interval, 1)), MaxCatchUp(std::max(maxcatchup, 1)), LastStepTime(now)
+{
+}
+// ------------------------------------ //
+DLLEXPORT void FixedTimestep::Reset(int64_t now)
+{
+    LastStepTime = now;
+}
+
+DLLEXPORT int FixedTimestep::Advance(int64_t now, int* dropped /*= nullptr*/)
+{
+    if(dropped)
+        *dropped = 0;
+
+    const int64_t passed = now - LastStepTime;
+
+    if(passed < Interval)
+        return 0;
+
+    int64_t steps = passed / Interval;
+
+    if(steps > MaxCatchUp) {
+
+        // Too far behind to catch up, skip the time the extra steps would have taken
+        const int64_t skipped = steps - MaxCatchUp;
+
+        DroppedSteps += skipped;
+        LastStepTime += skipped * Interval;
+        steps = MaxCatchUp;
+
+        if(dropped)
+            *dropped = static_cast<int>(skipped);
+    }
+
+    CatchUpSteps += steps - 1;
+    LastStepTime += steps * Interval;
+
+    return static_cast<int>(steps);
+}
+
+DLLEXPORT int64_t FixedTimestep::GetTimeUntilNextStep(int64_t now) const
+{
+    return std::max<int64_t>(LastStepTime + Interval - now, 0);
+}
+// ------------------------------------ //
+DLLEXPORT void FixedTimestep::SetInterval(int interval)
+{
+    Interval = std::max(interval, 1);
+}
+
+DLLEXPORT void FixedTimestep::SetMaxCatchUp(int maxcatchup)
+{
+    MaxCatchUp = std::max(maxcatchup, 1);
+}
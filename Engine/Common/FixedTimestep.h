@@ -0,0 +1,86 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2018 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include <cstdint>
+
+namespace Leviathan {
+
+//! \brief Decides how many fixed length steps should be ran to catch up to the current time
+//!
+//! Used to run ticks at a fixed rate. When the caller falls behind more than MaxCatchUp
+//! steps the extra steps are dropped and the clock jumps forward, this prevents the case
+//! where running the catch up steps takes so long that even more steps need to be ran.
+//! Times are in milliseconds
+class FixedTimestep {
+public:
+    DLLEXPORT FixedTimestep(int interval, int maxcatchup, int64_t now = 0);
+
+    //! \brief Moves the clock to now without running any steps
+    DLLEXPORT void Reset(int64_t now);
+
+    //! \brief Advances the clock to now
+    //! \param dropped If not null receives the number of steps that were skipped by this
+    //! call. Users that number their steps should skip this many numbers before running the
+    //! returned steps to stay aligned with the time
+    //! \returns The number of steps that should be ran now. At most MaxCatchUp
+    DLLEXPORT int Advance(int64_t now, int* dropped = nullptr);
+
+    //! \returns How long until the next step should run, 0 if already late
+    DLLEXPORT int64_t GetTimeUntilNextStep(int64_t now) const;
+
+    //! \returns The time since the last step started. Can be more than the interval if
+    //! Advance hasn't been called recently
+    inline int64_t GetTimeSinceLastStep(int64_t now) const
+    {
+        return now - LastStepTime;
+    }
+
+    //! \brief Moves the start of the last step by amount milliseconds
+    inline void AdjustLastStepTime(int64_t amount)
+    {
+        LastStepTime += amount;
+    }
+
+    //! \note The current step keeps its start time
+    DLLEXPORT void SetInterval(int interval);
+
+    inline int GetInterval() const
+    {
+        return Interval;
+    }
+
+    //! \param maxcatchup The number of steps Advance returns at most. Values less than 1
+    //! are treated as 1
+    DLLEXPORT void SetMaxCatchUp(int maxcatchup);
+
+    inline int GetMaxCatchUp() const
+    {
+        return MaxCatchUp;
+    }
+
+    //! \returns The number of steps that have been ran late, ie. all except the first step
+    //! returned by an Advance call
+    inline uint64_t GetCatchUpSteps() const
+    {
+        return CatchUpSteps;
+    }
+
+    //! \returns The number of steps that have been skipped because of the catch up limit
+    inline uint64_t GetDroppedSteps() const
+    {
+        return DroppedSteps;
+    }
+
+private:
+    int Interval;
+    int MaxCatchUp;
+
+    int64_t LastStepTime;
+
+    uint64_t CatchUpSteps = 0;
+    uint64_t DroppedSteps = 0;
+};
+
+} // namespace Leviathan
@@ -17,9 +17,12 @@
 
 namespace Leviathan{
 
-//! Number of milliseconds between engine and world ticks
+//! Number of milliseconds between engine ticks and the default for world ticks
 constexpr auto TICKSPEED = 50;
 
+//! Default number of late ticks that are ran at once before the rest are skipped
+constexpr auto DEFAULT_MAX_CATCHUP_TICKS = 5;
+
 //! \todo Allow this to not be a multiple of TICKSPEED or smaller than it
 constexpr auto INTERPOLATION_TIME = 100;
 
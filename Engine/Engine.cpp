@@ -5,6 +5,7 @@
 #include "Application/AppDefine.h"
 #include "Application/Application.h"
 #include "Application/ConsoleInput.h"
+#include "Application/MainLoopWaiter.h"
 #include "Common/DataStoring/DataStore.h"
 #include "Common/StringOperations.h"
 #include "Common/Types.h"
@@ -21,12 +22,13 @@
 #include "Iterators/StringIterator.h"
 #include "Networking/NetworkHandler.h"
 #include "Networking/RemoteConsole.h"
+#include "ObjectFiles/ObjectFileCache.h"
 #include "ObjectFiles/ObjectFileProcessor.h"
 #include "Rendering/Graphics.h"
 #include "Script/Console.h"
 #include "Sound/SoundDevice.h"
 #include "Statistics/RenderingStatistics.h"
-#include "Statistics/TimingMonitor.h"
+#include "Statistics/Profiler.h"
 #include "Threading/QueuedTask.h"
 #include "Threading/ThreadingManager.h"
 #include "TimeIncludes.h"
@@ -61,7 +63,7 @@ static std::atomic<int> WindowNameCounter = {1};
 DLLEXPORT Engine::Engine(LeviathanApplication* owner) : Owner(owner)
 {
     // This makes sure that uninitialized engine will have at least some last frame time //
-    LastTickTime = Time::GetTimeMs64();
+    TickClock.Reset(Time::GetTimeMs64());
 
     instance = this;
 }
@@ -72,6 +74,7 @@ DLLEXPORT Engine::~Engine()
     instance = nullptr;
 
     _ConsoleInput.reset();
+    LoopWaiter.reset();
 }
 
 DLLEXPORT Engine* Engine::instance = nullptr;
@@ -124,6 +127,20 @@ DLLEXPORT bool Engine::Init(
     MainRandom = new Random((int)InitStartTime);
     MainRandom->SetAsMain();
 
+    // Headless applications wait for work instead of polling so the waiter needs to exist
+    // before anything that can invoke
+    if(NoGui) {
+
+        LoopWaiter = std::make_unique<MainLoopWaiter>();
+
+        if(!LoopWaiter->Init()) {
+
+            LOG_WARNING("Engine: Init: main loop waiter failed, falling back to sleeping "
+                        "until ticks");
+            LoopWaiter.reset();
+        }
+    }
+
     // Console might be the first thing we want //
     if(!NoSTDInput) {
 
@@ -192,6 +209,7 @@ DLLEXPORT bool Engine::Init(
 
     // File parsing //
     ObjectFileProcessor::Initialize();
+    ObjectFileCache::SetCacheFolder("Data/Cache/ObjectFiles");
 
     // Main program wide event dispatcher //
     MainEvents = new EventHandler();
@@ -435,7 +453,7 @@ void Engine::PostLoad()
     ClearTimers();
 
     // get time //
-    LastTickTime = Time::GetTimeMs64();
+    TickClock.Reset(Time::GetTimeMs64());
 
     ExecuteCommandLine();
 
@@ -592,8 +610,8 @@ void Engine::Release(bool forced)
     ObjectFileProcessor::Release();
     SAFE_DELETE(MainFileHandler);
 
-    // clears all running timers that might have accidentally been left running //
-    TimingMonitor::ClearTimers();
+    // Stop a possibly running profiler capture //
+    Profiler::SetEnabled(false);
 
     // safe to delete this here //
     SAFE_DELETE(OutOMemory);
@@ -814,8 +832,15 @@ void Engine::Tick()
     {
         Lock lock(NetworkHandlerLock);
 
-        if(_NetworkHandler)
+        if(_NetworkHandler) {
+
+            const auto networkStart = Time::GetTimeMicro64();
+
             _NetworkHandler->UpdateAllConnections();
+
+            const auto networkEnd = Time::GetTimeMicro64();
+            NetworkUpdateDurations.Record(networkEnd - networkStart, networkEnd);
+        }
     }
 
     // And handle invokes //
@@ -837,20 +862,37 @@ void Engine::Tick()
         return;
     }
 
-    // Get the passed time since the last update //
-    auto CurTime = Time::GetTimeMs64();
-    TimePassed = (int)(CurTime - LastTickTime);
+    const auto now = Time::GetTimeMs64();
 
+    // Run all the ticks that should have happened since the last call, the clock limits
+    // this so that a long stall doesn't cause even more stalling
+    int dropped;
+    const int ticks = TickClock.Advance(now, &dropped);
 
-    if((TimePassed < TICKSPEED)) {
-        // It's not tick time yet //
-        return;
-    }
+    // New worlds start from the engine tick so it needs to stay aligned with the time
+    TickCount += dropped;
+
+    for(int i = 0; i < ticks; ++i)
+        _RunEngineTick();
 
+    // Worlds have their own tick rates //
+    _TickWorlds(now);
+}
+
+void Engine::_RunEngineTick()
+{
+    const auto CurTime = Time::GetTimeMs64();
+    TimePassed = TickClock.GetInterval();
 
-    LastTickTime += TICKSPEED;
     TickCount++;
 
+    // This needs to be before the zone to not end a capture in the middle of it
+    Profiler::OnNewTick();
+
+    LEVIATHAN_PROFILE_ZONE("Engine::Tick");
+
+    const auto tickStart = Time::GetTimeMicro64();
+
     // Update input //
 #ifdef LEVIATHAN_USES_LEAP
     if(LeapData)
@@ -873,25 +915,37 @@ void Engine::Tick()
     }
 
 
-    // Update worlds //
-    {
-        Lock lock(GameWorldsLock);
-
-        // This will also update physics //
-        auto end = GameWorlds.end();
-        for(auto iter = GameWorlds.begin(); iter != end; ++iter) {
-
-            (*iter)->Tick(TickCount);
-        }
-    }
-
-
     // Some dark magic here //
     if(TickCount % 25 == 0) {
         // update values
         Mainstore->SetTickCount(TickCount);
         Mainstore->SetTickTime(TickTime);
 
+        TickDurations.ReportStats(Mainstore, "TickTime");
+        NetworkUpdateDurations.ReportStats(Mainstore, "NetworkUpdateTime");
+
+        Mainstore->SetValue(
+            "CatchUpTicks", VariableBlock(static_cast<int>(TickClock.GetCatchUpSteps())));
+        Mainstore->SetValue(
+            "DroppedTicks", VariableBlock(static_cast<int>(TickClock.GetDroppedSteps())));
+
+        {
+            Lock lock(GameWorldsLock);
+
+            for(const auto& world : GameWorlds) {
+
+                const auto prefix = "World" + std::to_string(world->GetID());
+
+                world->GetTickDurations().ReportStats(Mainstore, prefix + "TickTime");
+                Mainstore->SetValue(prefix + "CPUTime",
+                    VariableBlock(static_cast<int>(world->GetTickCPUTime() / 1000)));
+                Mainstore->SetValue(prefix + "CatchUpTicks",
+                    VariableBlock(static_cast<int>(world->GetCatchUpTickCount())));
+                Mainstore->SetValue(prefix + "DroppedTicks",
+                    VariableBlock(static_cast<int>(world->GetDroppedTickCount())));
+            }
+        }
+
         if(!NoGui) {
             // send updated rendering statistics //
             RenderTimer->ReportStats(Mainstore);
@@ -910,6 +964,50 @@ void Engine::Tick()
     Owner->Tick(TimePassed);
 
     TickTime = (int)(Time::GetTimeMs64() - CurTime);
+
+    const auto tickEnd = Time::GetTimeMicro64();
+    TickDurations.Record(tickEnd - tickStart, tickEnd);
+}
+
+void Engine::_TickWorlds(int64_t now)
+{
+    LEVIATHAN_PROFILE_ZONE("Engine::TickWorlds");
+
+    // The list is copied so that the lock isn't held while the worlds tick. The copies keep
+    // the worlds alive if they are destroyed during the tick
+    std::vector<std::shared_ptr<GameWorld>> worlds;
+    {
+        Lock lock(GameWorldsLock);
+        worlds = GameWorlds;
+    }
+
+    // Independent worlds are ticked on the workers after the others //
+    std::vector<GameWorld*> concurrentWorlds;
+
+    // This will also update physics //
+    for(const auto& world : worlds) {
+
+        if(world->GetTickConcurrently()) {
+
+            concurrentWorlds.push_back(world.get());
+        } else {
+
+            world->RunPendingTicks(now);
+        }
+    }
+
+    if(concurrentWorlds.size() == 1) {
+
+        concurrentWorlds.front()->RunPendingTicks(now);
+
+    } else if(!concurrentWorlds.empty()) {
+
+        // Each world is one item so a world stays on one thread for the whole tick. This
+        // blocks so networking (which is handled on this thread) can't touch the worlds
+        // while they are ticking
+        _ThreadingManager->RunInParallel(concurrentWorlds.size(),
+            [&](size_t index) { concurrentWorlds[index]->RunPendingTicks(now); });
+    }
 }
 
 DLLEXPORT void Engine::PreFirstTick()
@@ -953,12 +1051,12 @@ void Engine::RenderFrame()
         new Event(EVENT_TYPE_FRAME_BEGIN, new IntegerEventData(SinceLastFrame)));
 
     // Calculate parameters for GameWorld frame rendering systems //
-    int64_t timeintick = Time::GetTimeMs64() - LastTickTime;
+    int64_t timeintick = TickClock.GetTimeSinceLastStep(Time::GetTimeMs64());
     int moreticks = 0;
 
-    while(timeintick > TICKSPEED) {
+    while(timeintick > TickClock.GetInterval()) {
 
-        timeintick -= TICKSPEED;
+        timeintick -= TickClock.GetInterval();
         moreticks++;
     }
 
@@ -1138,8 +1236,18 @@ DLLEXPORT void Engine::MarkQuit()
 DLLEXPORT void Engine::Invoke(const std::function<void()>& function)
 {
 
-    RecursiveLock lock(InvokeLock);
-    InvokeQueue.push_back(function);
+    {
+        RecursiveLock lock(InvokeLock);
+        InvokeQueue.push_back(function);
+    }
+
+    WakeMainLoop();
+}
+
+DLLEXPORT void Engine::WakeMainLoop()
+{
+    if(LoopWaiter)
+        LoopWaiter->Wake();
 }
 
 DLLEXPORT void Engine::ProcessInvokes()
@@ -1158,6 +1266,39 @@ DLLEXPORT void Engine::ProcessInvokes()
     }
 }
 
+DLLEXPORT void Engine::WaitForWork()
+{
+    const auto untilTick = GetTimeUntilNextTick();
+
+    if(untilTick <= 0)
+        return;
+
+    {
+        RecursiveLock lock(InvokeLock);
+
+        if(!InvokeQueue.empty())
+            return;
+    }
+
+    if(!LoopWaiter) {
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(untilTick));
+        return;
+    }
+
+    sf::UdpSocket* socket = nullptr;
+    {
+        Lock lock(NetworkHandlerLock);
+
+        // In blocking mode this is null and the listening thread wakes this instead
+        if(_NetworkHandler)
+            socket = _NetworkHandler->GetSocketForWaiting();
+    }
+
+    // The socket is only released on the main thread so it stays valid during the wait
+    LoopWaiter->Wait(untilTick, socket);
+}
+
 DLLEXPORT void Engine::RunOnMainThread(const std::function<void()>& function)
 {
     if(!IsOnMainThread()) {
@@ -1244,7 +1385,7 @@ void Engine::_NotifyThreadsRegisterOgre()
 DLLEXPORT int64_t Leviathan::Engine::GetTimeSinceLastTick() const
 {
 
-    return Time::GetTimeMs64() - LastTickTime;
+    return TickClock.GetTimeSinceLastStep(Time::GetTimeMs64());
 }
 
 DLLEXPORT int Engine::GetCurrentTick() const
@@ -1252,6 +1393,60 @@ DLLEXPORT int Engine::GetCurrentTick() const
 
     return TickCount;
 }
+
+DLLEXPORT Random* Engine::GetRandom()
+{
+    return Random::Get();
+}
+
+DLLEXPORT int64_t Engine::GetTimeUntilNextTick()
+{
+    const auto now = Time::GetTimeMs64();
+
+    int64_t result;
+    {
+        GUARD_LOCK();
+        result = TickClock.GetTimeUntilNextStep(now);
+    }
+
+    Lock lock(GameWorldsLock);
+
+    for(const auto& world : GameWorlds)
+        result = std::min(result, world->GetTimeUntilNextTick(now));
+
+    return result;
+}
+
+DLLEXPORT void Engine::SetMaxCatchUpTicks(int maxticks)
+{
+    GUARD_LOCK();
+    TickClock.SetMaxCatchUp(maxticks);
+}
+
+DLLEXPORT std::string Engine::GetTimingReport()
+{
+    std::string report = "Durations of the last minute in microseconds:\n";
+
+    report += "Tick " + TickDurations.GetSummary().ToString() + "\n";
+    report += "Network update " + NetworkUpdateDurations.GetSummary().ToString() + "\n";
+    report += "Late ticks caught up: " + std::to_string(TickClock.GetCatchUpSteps()) +
+              " dropped: " + std::to_string(TickClock.GetDroppedSteps()) + "\n";
+
+    if(RenderTimer)
+        report += "Frame " + RenderTimer->GetFrameTimes().GetSummary().ToString() + "\n";
+
+    Lock lock(GameWorldsLock);
+
+    for(const auto& world : GameWorlds) {
+        report += "World " + std::to_string(world->GetID()) + " tick " +
+                  world->GetTickDurations().GetSummary().ToString() +
+                  " late ticks caught up: " + std::to_string(world->GetCatchUpTickCount()) +
+                  " dropped: " + std::to_string(world->GetDroppedTickCount()) +
+                  " CPU time: " + std::to_string(world->GetTickCPUTime() / 1000) + "ms\n";
+    }
+
+    return report;
+}
 // ------------------------------------ //
 void Engine::_AdjustTickClock(int amount, bool absolute /*= true*/)
 {
@@ -1262,28 +1457,21 @@ void Engine::_AdjustTickClock(int amount, bool absolute /*= true*/)
 
         Logger::Get()->Info("Engine: adjusted tick timer by " + Convert::ToString(amount));
 
-        LastTickTime += amount;
+        TickClock.AdjustLastStepTime(amount);
         return;
     }
 
     // Calculate the time in the current last tick //
-    int64_t templasttick = LastTickTime;
-
-    int64_t curtime = Time::GetTimeMs64();
-
-    while(curtime - templasttick >= TICKSPEED) {
-
-        templasttick += TICKSPEED;
-    }
+    int64_t intolasttick =
+        TickClock.GetTimeSinceLastStep(Time::GetTimeMs64()) % TickClock.GetInterval();
 
     // Check how far off we are from the target //
-    int64_t intolasttick = curtime - templasttick;
 
     int changeamount = amount - static_cast<int>(intolasttick);
 
     Logger::Get()->Info("Engine: changing tick counter by " + Convert::ToString(changeamount));
 
-    LastTickTime += changeamount;
+    TickClock.AdjustLastStepTime(changeamount);
 }
 
 void Engine::_AdjustTickNumber(int tickamount, bool absolute)
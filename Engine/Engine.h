@@ -3,9 +3,11 @@
 #pragma once
 #include "Define.h"
 // ------------------------------------ //
+#include "Common/FixedTimestep.h"
 #include "Common/ThreadSafe.h"
 #include "Entities/WorldNetworkSettings.h"
 #include "Networking/CommonNetwork.h"
+#include "Statistics/LatencyHistogram.h"
 
 #include <functional>
 #include <inttypes.h>
@@ -65,6 +67,48 @@ public:
     //! \brief Returns the number of tick that was last simulated
     DLLEXPORT int GetCurrentTick() const;
 
+    //! \brief Calculates how long until the engine or any world needs to tick
+    //! \return The time in milliseconds, 0 if a tick is late
+    DLLEXPORT int64_t GetTimeUntilNextTick();
+
+    //! \brief Sets how many late engine ticks are ran at once before dropping the rest
+    //!
+    //! If a tick (or a frame) takes so long that more than this many ticks should have
+    //! happened the extra ticks are skipped. This prevents the engine from falling further
+    //! behind by trying to run the missed ticks. Worlds have their own limits
+    DLLEXPORT void SetMaxCatchUpTicks(int maxticks);
+
+    //! \returns The number of engine ticks that have been ran late to catch up
+    inline uint64_t GetCatchUpTickCount() const
+    {
+        return TickClock.GetCatchUpSteps();
+    }
+
+    //! \returns The number of engine ticks that have been skipped due to falling too far
+    //! behind
+    inline uint64_t GetDroppedTickCount() const
+    {
+        return TickClock.GetDroppedSteps();
+    }
+
+    //! \brief Returns the durations of the ticks of the last minute in microseconds
+    inline RollingLatencyHistogram& GetTickDurations()
+    {
+        return TickDurations;
+    }
+
+    //! \brief Returns the durations of NetworkHandler::UpdateAllConnections calls of the last
+    //! minute in microseconds
+    inline RollingLatencyHistogram& GetNetworkUpdateDurations()
+    {
+        return NetworkUpdateDurations;
+    }
+
+    //! \brief Formats the percentiles of the tick, world tick, frame and network update
+    //! durations
+    //! \returns One line per duration type
+    DLLEXPORT std::string GetTimingReport();
+
     //! \brief Processes queued messages from Ogre, SDL and input
     DLLEXPORT void MessagePump();
 
@@ -97,6 +141,19 @@ public:
     //! \brief Runs the function now if on the main thread otherwise calls Invoke
     DLLEXPORT void RunOnMainThread(const std::function<void()>& function);
 
+    //! \brief Blocks until the next tick, a network packet arrives or something is invoked
+    //!
+    //! Used by headless applications instead of polling Tick. Console input is also
+    //! handled through Invoke so it wakes this as well
+    //! \note Must be called on the main thread
+    DLLEXPORT void WaitForWork();
+
+    //! \brief Makes the current or next WaitForWork call return right away
+    //!
+    //! For threads that produce work for the main thread without going through Invoke
+    //! \note This is thread safe
+    DLLEXPORT void WakeMainLoop();
+
     //! \brief Returns true if called on the main thread
     DLLEXPORT bool IsOnMainThread() const;
 
@@ -223,10 +280,9 @@ public:
     {
         return _RemoteConsole;
     }
-    inline Random* GetRandom()
-    {
-        return MainRandom;
-    }
+    //! \returns The generator for the calling thread, see Random::Get
+    //! \note During a GameWorld tick this is the generator of the world
+    DLLEXPORT Random* GetRandom();
     inline GameModuleLoader* GetGameModuleLoader()
     {
         return _GameModuleLoader.get();
@@ -273,6 +329,12 @@ protected:
     //! when registering threads to work with Ogre
     void _NotifyThreadsRegisterOgre();
 
+    //! \brief Runs a single engine tick. Called by Tick with the lock held
+    void _RunEngineTick();
+
+    //! \brief Runs the ticks of the worlds that their tick rates require
+    void _TickWorlds(int64_t now);
+
     //! \brief Sets the tick clock to a certain value
     //! \note Should only be used to match the server's clock
     //! \param amount The amount of time in milliseconds to set or change
@@ -321,6 +383,9 @@ protected:
     ResourceRefreshHandler* _ResourceRefreshHandler = nullptr;
 
     std::unique_ptr<ConsoleInput> _ConsoleInput;
+
+    //! Only created in NoGui mode, wakes up WaitForWork when an invoke is queued
+    std::unique_ptr<MainLoopWaiter> LoopWaiter;
     std::unique_ptr<GameModuleLoader> _GameModuleLoader;
     std::vector<std::unique_ptr<Editor::Editor>> OpenedEditors;
 
@@ -342,7 +407,8 @@ protected:
     std::mutex NetworkHandlerLock;
 
     // data //
-    int64_t LastTickTime;
+    //! Decides when engine ticks happen, TimePassed is always the interval of this
+    FixedTimestep TickClock{TICKSPEED, DEFAULT_MAX_CATCHUP_TICKS};
 
     int TimePassed = 0;
     int FrameLimit = 0;
@@ -350,6 +416,10 @@ protected:
     int TickTime = 0;
     int FrameCount = 0;
 
+    //! Durations of the last minute, used for finding the spikes that the averages hide
+    RollingLatencyHistogram TickDurations;
+    RollingLatencyHistogram NetworkUpdateDurations;
+
     //! Set when PreRelease is called and Tick has happened
     bool PreReleaseDone = false;
 
@@ -4,6 +4,7 @@
 #include "Define.h"
 // ------------------------------------ //
 #include "Component.h"
+#include "StateQuantization.h"
 
 namespace Leviathan {
 
@@ -22,10 +23,12 @@ public:
     // Data for currently interpolating state
     // Some child classes might not use this if interpolating is not done
     // maybe some of these could be moved to a new class
+    //! The states are referred to by their tick numbers as StateHolder may move them. -1
+    //! when not set
     float InterpolatingStartTime = 0.f;
     int InterpolatingRemoteStartTick;
-    StateT* InterpolatingStartState = nullptr;
-    StateT* InterpolatingEndState = nullptr;
+    int32_t InterpolatingStartTick = -1;
+    int32_t InterpolatingEndTick = -1;
 
     // Current time can be calculated from the game world tick and engine clock
     // once the time - InterpolatingStartTime is >= TICKSPEED
@@ -132,6 +132,17 @@ public:
             SentPackets.emplace_back(tick, state, packet);
         }
 
+        //! \brief Makes the next update a full state
+        //!
+        //! Used when the receiver couldn't decode a delta. The packets still on the way may
+        //! fail the same way so their acknowledgements are ignored
+        inline void ResetReference()
+        {
+            LastConfirmedData.reset();
+            LastConfirmedTickNumber = -1;
+            SentPackets.clear();
+        }
+
         std::shared_ptr<Connection> CorrespondingConnection;
 
         //! Data used to build a delta update packet
@@ -0,0 +1,227 @@
+// ------------------------------------ //
+#include "EntityJitterBuffer.h"
+
+#include "Networking/NetworkResponse.h"
+#include "StateHolder.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Leviathan;
+// ------------------ PlayoutDelayEstimator ------------------ //
+DLLEXPORT PlayoutDelayEstimator::PlayoutDelayEstimator(int mindelay, int maxdelay)
+{
+    SetDelayLimits(mindelay, maxdelay);
+}
+// ------------------------------------ //
+DLLEXPORT void PlayoutDelayEstimator::AddSample(int32_t tick, int64_t now)
+{
+    if(tick <= NewestTick)
+        return;
+
+    const int64_t offset = now - static_cast<int64_t>(tick) * TICKSPEED;
+
+    // Difference in transit time compared to the previous packet, as in RFC 3550
+    if(OffsetCount > 0) {
+
+        const int64_t previous = Offsets[(NextOffset + OFFSET_WINDOW - 1) % OFFSET_WINDOW];
+        const float difference = static_cast<float>(std::abs(offset - previous));
+
+        Jitter += (difference - Jitter) / 16.f;
+    }
+
+    NewestTick = tick;
+
+    Offsets[NextOffset] = offset;
+    NextOffset = (NextOffset + 1) % OFFSET_WINDOW;
+    OffsetCount = std::min(OffsetCount + 1, OFFSET_WINDOW);
+
+    BaseOffset = *std::min_element(Offsets.begin(), Offsets.begin() + OffsetCount);
+}
+// ------------------------------------ //
+DLLEXPORT int64_t PlayoutDelayEstimator::GetPlayoutTime(int32_t tick) const
+{
+    if(OffsetCount == 0)
+        return 0;
+
+    return BaseOffset + static_cast<int64_t>(tick) * TICKSPEED + GetTargetDelay();
+}
+
+DLLEXPORT int PlayoutDelayEstimator::GetTargetDelay() const
+{
+    // Three times the jitter covers almost all of the late packets
+    return std::clamp(MinDelay + static_cast<int>(std::ceil(3.f * Jitter)), MinDelay, MaxDelay);
+}
+// ------------------------------------ //
+DLLEXPORT void PlayoutDelayEstimator::SetDelayLimits(int mindelay, int maxdelay)
+{
+    MinDelay = std::max(mindelay, 0);
+    MaxDelay = std::max(maxdelay, MinDelay);
+}
+
+DLLEXPORT void PlayoutDelayEstimator::Reset()
+{
+    OffsetCount = 0;
+    NextOffset = 0;
+    BaseOffset = 0;
+    NewestTick = -1;
+    Jitter = 0.f;
+}
+// ------------------ EntityJitterBuffer ------------------ //
+DLLEXPORT EntityJitterBuffer::EntityJitterBuffer(
+    int mindelay /*= TICKSPEED*/, int maxdelay /*= 500*/, int orphantimeout /*= 2000*/) :
+    Estimator(mindelay, maxdelay),
+    OrphanTimeout(orphantimeout)
+{}
+
+DLLEXPORT EntityJitterBuffer::~EntityJitterBuffer() {}
+// ------------------------------------ //
+DLLEXPORT void EntityJitterBuffer::Add(
+    ObjectID entity, int32_t tick, std::unique_ptr<NetworkResponse>&& message, int64_t now)
+{
+    if(entity != NULL_OBJECT && Destroyed.find(entity) != Destroyed.end())
+        return;
+
+    Estimator.AddSample(tick, now);
+
+    _Push(Entry{tick, false, NextSequence++, entity, now, std::move(message)});
+}
+
+DLLEXPORT void EntityJitterBuffer::AddDestruction(
+    ObjectID entity, std::unique_ptr<NetworkResponse>&& message, int64_t now)
+{
+    // Destruction messages have no tick so the destruction happens after all the states that
+    // have been received before it
+    _Push(Entry{std::max(Estimator.GetNewestTick(), 0), true, NextSequence++, entity, now,
+        std::move(message)});
+}
+
+DLLEXPORT void EntityJitterBuffer::OnEntityCreated(ObjectID entity)
+{
+    for(auto iter = Orphans.begin(); iter != Orphans.end();) {
+
+        if(iter->Entity == entity) {
+
+            _Push(std::move(*iter));
+            iter = Orphans.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+// ------------------------------------ //
+DLLEXPORT size_t EntityJitterBuffer::PlayOut(int64_t now, const Applier& applier)
+{
+    _RemoveExpired(now);
+
+    size_t applied = 0;
+
+    while(!Queue.empty()) {
+
+        if(Estimator.GetPlayoutTime(Queue.front().Tick) > now)
+            break;
+
+        std::pop_heap(Queue.begin(), Queue.end(), &EntityJitterBuffer::_IsLater);
+        Entry entry = std::move(Queue.back());
+        Queue.pop_back();
+
+        if(entry.Entity != NULL_OBJECT) {
+
+            if(Destroyed.find(entry.Entity) != Destroyed.end())
+                continue;
+
+            if(!entry.IsDestruction && IsObsolete(entry.Entity, entry.Tick))
+                continue;
+        }
+
+        // The applier may queue more packets so nothing in Queue may be referenced here
+        if(applier(*entry.Message) == JITTER_BUFFER_APPLY::MissingEntity) {
+
+            Orphans.push_back(std::move(entry));
+            continue;
+        }
+
+        ++applied;
+
+        if(entry.Entity == NULL_OBJECT)
+            continue;
+
+        if(entry.IsDestruction) {
+
+            PlayedTicks.erase(entry.Entity);
+            Destroyed[entry.Entity] = now;
+
+            const auto destroyed = entry.Entity;
+
+            Orphans.erase(std::remove_if(Orphans.begin(), Orphans.end(),
+                              [=](const Entry& orphan) { return orphan.Entity == destroyed; }),
+                Orphans.end());
+        } else {
+
+            MarkPlayed(entry.Entity, entry.Tick);
+        }
+    }
+
+    return applied;
+}
+// ------------------------------------ //
+DLLEXPORT bool EntityJitterBuffer::IsObsolete(ObjectID entity, int32_t tick) const
+{
+    const auto found = PlayedTicks.find(entity);
+
+    if(found == PlayedTicks.end())
+        return false;
+
+    // Slightly older states are still stored as newer deltas may reference them
+    return tick <= found->second - static_cast<int32_t>(KEPT_STATES_COUNT);
+}
+
+DLLEXPORT void EntityJitterBuffer::MarkPlayed(ObjectID entity, int32_t tick)
+{
+    auto& played = PlayedTicks[entity];
+    played = std::max(played, tick);
+}
+// ------------------------------------ //
+DLLEXPORT void EntityJitterBuffer::Clear()
+{
+    Queue.clear();
+    Orphans.clear();
+    PlayedTicks.clear();
+    Destroyed.clear();
+    Estimator.Reset();
+}
+// ------------------------------------ //
+bool EntityJitterBuffer::_IsLater(const Entry& first, const Entry& second)
+{
+    if(first.Tick != second.Tick)
+        return first.Tick > second.Tick;
+
+    if(first.IsDestruction != second.IsDestruction)
+        return first.IsDestruction;
+
+    return first.Sequence > second.Sequence;
+}
+
+void EntityJitterBuffer::_Push(Entry&& entry)
+{
+    Queue.push_back(std::move(entry));
+    std::push_heap(Queue.begin(), Queue.end(), &EntityJitterBuffer::_IsLater);
+}
+
+void EntityJitterBuffer::_RemoveExpired(int64_t now)
+{
+    const auto timeout = OrphanTimeout;
+
+    Orphans.erase(std::remove_if(Orphans.begin(), Orphans.end(),
+                      [=](const Entry& orphan) { return now - orphan.Arrival > timeout; }),
+        Orphans.end());
+
+    for(auto iter = Destroyed.begin(); iter != Destroyed.end();) {
+
+        if(now - iter->second > OrphanTimeout) {
+            iter = Destroyed.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
@@ -0,0 +1,192 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "EntityCommon.h"
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Leviathan {
+
+class NetworkResponse;
+
+//! \brief Estimates when the packets a server sent on a tick should be applied on a client
+//!
+//! The transit time of the fastest recent packet is used as the base and the measured jitter
+//! decides how much extra delay is added on top so that late packets still arrive in time
+class PlayoutDelayEstimator {
+public:
+    //! \param mindelay Smallest delay in milliseconds added on top of the fastest transit time
+    DLLEXPORT PlayoutDelayEstimator(int mindelay, int maxdelay);
+
+    //! \brief Records that a packet sent on remote tick arrived at now
+    //!
+    //! Only the first packet of each new tick is used as the later ones were sent at the same
+    //! time
+    DLLEXPORT void AddSample(int32_t tick, int64_t now);
+
+    //! \returns The local time in milliseconds at which packets for tick should be applied
+    DLLEXPORT int64_t GetPlayoutTime(int32_t tick) const;
+
+    //! \returns The extra delay in milliseconds that is added after the fastest transit time
+    DLLEXPORT int GetTargetDelay() const;
+
+    DLLEXPORT void SetDelayLimits(int mindelay, int maxdelay);
+
+    DLLEXPORT void Reset();
+
+    inline bool HasSamples() const
+    {
+        return OffsetCount > 0;
+    }
+
+    //! \returns The smoothed jitter in milliseconds
+    inline float GetJitter() const
+    {
+        return Jitter;
+    }
+
+    //! \returns The newest remote tick that has been seen
+    inline int32_t GetNewestTick() const
+    {
+        return NewestTick;
+    }
+
+    //! How many of the latest transit times the base is picked from
+    static constexpr size_t OFFSET_WINDOW = 64;
+
+protected:
+    int MinDelay;
+    int MaxDelay;
+
+    //! Arrival times minus the remote tick times
+    std::array<int64_t, OFFSET_WINDOW> Offsets;
+    size_t OffsetCount = 0;
+    size_t NextOffset = 0;
+
+    //! The smallest value in Offsets
+    int64_t BaseOffset = 0;
+
+    int32_t NewestTick = -1;
+    float Jitter = 0.f;
+};
+
+//! \brief Result of applying a packet from EntityJitterBuffer
+enum class JITTER_BUFFER_APPLY {
+
+    Applied,
+
+    //! The entity hasn't been created yet so the packet is kept until it is
+    MissingEntity
+};
+
+//! \brief Holds received entity packets on a client until their tick should be played out
+//!
+//! Packets are applied in tick order at a delay adapted to the measured jitter. Updates for
+//! entities that haven't been created yet are kept until the creation message arrives and
+//! packets that are too old to be useful are thrown away
+class EntityJitterBuffer {
+public:
+    using Applier = std::function<JITTER_BUFFER_APPLY(NetworkResponse& message)>;
+
+    //! \param orphantimeout How long in milliseconds to keep packets for missing entities
+    DLLEXPORT EntityJitterBuffer(
+        int mindelay = TICKSPEED, int maxdelay = 500, int orphantimeout = 2000);
+    DLLEXPORT ~EntityJitterBuffer();
+
+    //! \brief Queues a packet that was sent on remote tick
+    //! \param entity The entity the packet is about or NULL_OBJECT if it has many
+    DLLEXPORT void Add(ObjectID entity, int32_t tick,
+        std::unique_ptr<NetworkResponse>&& message, int64_t now);
+
+    //! \brief Queues a destruction to happen after the packets that were received before it
+    DLLEXPORT void AddDestruction(
+        ObjectID entity, std::unique_ptr<NetworkResponse>&& message, int64_t now);
+
+    //! \brief Queues again the packets that were waiting for entity to be created
+    DLLEXPORT void OnEntityCreated(ObjectID entity);
+
+    //! \brief Calls applier for all the packets that should be played out by now in tick order
+    //! \returns The number of applied packets
+    DLLEXPORT size_t PlayOut(int64_t now, const Applier& applier);
+
+    //! \returns True if a state for entity on tick can't be stored anymore as a newer one has
+    //! been applied more than KEPT_STATES_COUNT ticks after it
+    DLLEXPORT bool IsObsolete(ObjectID entity, int32_t tick) const;
+
+    //! \brief Records that a state has been applied for entity
+    DLLEXPORT void MarkPlayed(ObjectID entity, int32_t tick);
+
+    DLLEXPORT void Clear();
+
+    inline PlayoutDelayEstimator& GetEstimator()
+    {
+        return Estimator;
+    }
+
+    inline size_t GetQueuedCount() const
+    {
+        return Queue.size();
+    }
+
+    inline size_t GetOrphanCount() const
+    {
+        return Orphans.size();
+    }
+
+    //! \returns True if PlayOut has nothing to do, not even old orphans to throw out
+    inline bool IsEmpty() const
+    {
+        return Queue.empty() && Orphans.empty() && Destroyed.empty();
+    }
+
+protected:
+    struct Entry {
+
+        int32_t Tick;
+
+        //! Destructions are played after updates of the same tick
+        bool IsDestruction;
+
+        //! Keeps the arrival order for packets of the same tick
+        uint64_t Sequence;
+
+        ObjectID Entity;
+        int64_t Arrival;
+        std::unique_ptr<NetworkResponse> Message;
+    };
+
+    //! Comparator for keeping the earliest entry at the front of the heap
+    static bool _IsLater(const Entry& first, const Entry& second);
+
+    void _Push(Entry&& entry);
+
+    //! \brief Drops orphans and destroyed entity records that are older than OrphanTimeout
+    void _RemoveExpired(int64_t now);
+
+protected:
+    PlayoutDelayEstimator Estimator;
+
+    const int OrphanTimeout;
+
+    //! Heap ordered by _IsLater
+    std::vector<Entry> Queue;
+
+    //! Packets for entities that don't exist yet
+    std::vector<Entry> Orphans;
+
+    //! Newest applied state tick for each entity
+    std::unordered_map<ObjectID, int32_t> PlayedTicks;
+
+    //! Entities that have been destroyed and when, to throw out late packets for them
+    std::unordered_map<ObjectID, int64_t> Destroyed;
+
+    uint64_t NextSequence = 0;
+};
+
+} // namespace Leviathan
@@ -2,9 +2,12 @@
 #include "GameWorld.h"
 
 #include "Common/DataStoring/NamedVars.h"
+#include "Common/FixedTimestep.h"
 #include "Components.h"
 #include "Engine.h"
+#include "EntityJitterBuffer.h"
 #include "Handlers/IDFactory.h"
+#include "LocalControlPrediction.h"
 #include "Networking/Connection.h"
 #include "Networking/NetworkHandler.h"
 #include "Networking/NetworkRequest.h"
@@ -17,12 +20,17 @@
 #include "ScriptComponentHolder.h"
 #include "ScriptSystemWrapper.h"
 #include "Sound/SoundDevice.h"
+#include "Statistics/LatencyHistogram.h"
 #include "Threading/ThreadingManager.h"
+#include "TimeIncludes.h"
+#include "Utility/Random.h"
 #include "Window.h"
+#include "WorldRecording.h"
 
 // Camera interpolation
 #include "Generated/ComponentStates.h"
 #include "StateInterpolator.h"
+#include "WorldSnapshot.h"
 
 #include "Exceptions.h"
 
@@ -37,6 +45,13 @@
 
 using namespace Leviathan;
 // ------------------------------------ //
+namespace {
+
+//! How long to wait before asking again for full states of an entity, in milliseconds
+constexpr int64_t FULL_STATE_REQUEST_INTERVAL = 500;
+
+} // namespace
+// ------------------------------------ //
 
 // // Ray callbacks //
 // static dFloat RayCallbackDataCallbackClosest(const NewtonBody* const body,
@@ -64,9 +79,42 @@ public:
     std::map<std::string, ScriptComponentHolder::pointer> RegisteredScriptComponents;
     std::map<std::string, std::unique_ptr<ScriptSystemWrapper>> RegisteredScriptSystems;
 
-    //! Queued entity updates. Contains the time it was received in order to throw out old ones
-    std::vector<std::tuple<WantedClockType::time_point, ResponseEntityUpdate>>
-        QueuedEntityUpdates;
+    //! Received entity packets waiting for their tick to be played out on a client
+    EntityJitterBuffer EntityPackets;
+
+    RollingLatencyHistogram TickDurations;
+
+    FixedTimestep TickClock{TICKSPEED, DEFAULT_MAX_CATCHUP_TICKS};
+
+    //! Held while ticking so that RunOnWorld knows when it needs to queue
+    RecursiveMutex TickMutex;
+
+    Mutex QueuedTasksMutex;
+    std::vector<std::function<void()>> QueuedTasks;
+
+    std::atomic<int64_t> TickCPUTime{0};
+
+    bool TrackMovedEntities = false;
+
+    //! Cleared after the tick systems have ran
+    std::vector<ObjectID> MovedEntities;
+
+    //! Client side inputs and results of our locally controlled entities
+    LocalControlPrediction Prediction;
+
+    //! Server side checks for the states clients send about their locally controlled entities
+    LocalControlValidator LocalControlChecks;
+
+    std::shared_ptr<WorldRecorder> Recorder;
+
+    //! Returned by Random::Get while this world is ticking
+    Random WorldRandom;
+
+    //! Connections that asked for full states and the entities, handled by SendableSystem
+    std::vector<std::tuple<Connection*, ObjectID>> FullStateRequests;
+
+    //! When we last asked for full states of entities
+    std::unordered_map<ObjectID, int64_t> SentFullStateRequests;
 };
 
 // ------------------------------------ //
@@ -75,7 +123,13 @@ DLLEXPORT GameWorld::GameWorld(int32_t worldtype,
     pimpl(std::make_unique<Implementation>()),
     PhysicsMaterials(physicsMaterials), ID(worldid >= 0 ? worldid : IDFactory::GetID()),
     WorldType(worldtype)
-{}
+{
+    // Derived from the main generator so that seeding that is enough for repeatable worlds
+    Random* main = Random::Get();
+
+    if(main)
+        pimpl->WorldRandom.SetSeed(main->GetNumber());
+}
 
 DLLEXPORT GameWorld::~GameWorld()
 {
@@ -92,6 +146,9 @@ DLLEXPORT bool GameWorld::Init(const WorldNetworkSettings& network, Ogre::Root*
 {
     NetworkSettings = network;
 
+    pimpl->EntityPackets.GetEstimator().SetDelayLimits(
+        NetworkSettings.MinPlayoutDelay, NetworkSettings.MaxPlayoutDelay);
+
     // Detecting non-GUI mode //
     if(ogre) {
 
@@ -108,7 +165,21 @@ DLLEXPORT bool GameWorld::Init(const WorldNetworkSettings& network, Ogre::Root*
     // that physics is wanted
     if(PhysicsMaterials) {
 
-        _PhysicalWorld = std::make_shared<PhysicalWorld>(this, PhysicsMaterials.get());
+        _PhysicalWorld = std::make_shared<PhysicalWorld>(
+            this, PhysicsMaterials.get(), MultithreadedPhysics);
+    }
+
+    // Start ticking in step with the engine //
+    const auto now = Time::GetTimeMs64();
+    Engine* engine = Engine::Get();
+
+    if(engine) {
+
+        TickNumber = engine->GetCurrentTick();
+        pimpl->TickClock.Reset(now - engine->GetTimeSinceLastTick());
+    } else {
+
+        pimpl->TickClock.Reset(now);
     }
 
     _DoSystemsInit();
@@ -435,69 +506,10 @@ DLLEXPORT void GameWorld::SetPlayerReceiveWorld(std::shared_ptr<ConnectedPlayer>
     // Update the position data //
     UpdatePlayersPositionData(*ply);
 
-    // Start sending initial update //
-    Logger::Get()->Info(
-        "Starting to send " + Convert::ToString(Entities.size()) + " to player");
-
-    // Now we can queue all objects for sending //
-    // TODO: make sure that all objects are sent
-    // TODO: redo this inside the world tick
-    // ThreadingManager::Get()->QueueTask(
-    //     new RepeatCountedTask(std::bind<void>([](
-    //                 std::shared_ptr<Connection> connection,
-    //                 std::shared_ptr<ConnectedPlayer> processingobject, GameWorld* world,
-    //                 std::shared_ptr<bool> WorldInvalid)
-    //             -> void
-    //     {
-    //         // Get the next object //
-    //         RepeatCountedTask* task =
-    //             dynamic_cast<RepeatCountedTask*>(TaskThread::GetThreadSpecificThreadObject()->
-    //             QuickTaskAccess.get());
-
-    //         LEVIATHAN_ASSERT(task, "wrong type passed to our task");
-
-    //         size_t num = task->GetRepeatCount();
-
-    //         if(*WorldInvalid){
-
-    //         taskstopprocessingobjectsforinitialsynclabel:
-
-    //             // Stop processing //
-    //             task->StopRepeating();
-    //             return;
-    //         }
-
-    //         // Stop if out of bounds //
-    //         if(num >= world->Entities.size()){
-
-    //             goto taskstopprocessingobjectsforinitialsynclabel;
-    //         }
-
-    //         // Get the object //
-    //         auto tosend = world->Entities[num];
-
-    //         // Skip if shouldn't send //
-    //         try{
-
-    //             auto& position = world->GetComponent<Position>(tosend);
-
-    //             if(!world->ShouldPlayerReceiveObject(position, *connection)){
-
-    //                 return;
-    //             }
-
-    //         } catch(const NotFound&){
-
-    //             // No position, should probably always send //
-    //         }
-
-
-    //         // Send it //
-    //         world->SendObjectToConnection(guard, tosend, connection);
-
-    //         return;
-
-    //     }, ply->GetConnection(), ply, this, WorldDestroyed), Entities.size()));
+    // The existing entities are sent over the next ticks by SendableSystem, nearest first
+    // (see WorldJoinStreamer)
+    LOG_INFO("GameWorld: " + Convert::ToString(Entities.size()) +
+             " entities will be streamed to player(\"" + ply->GetNickname() + "\")");
 }
 
 DLLEXPORT void GameWorld::SendToAllPlayers(
@@ -554,16 +566,40 @@ DLLEXPORT void GameWorld::Tick(int currenttick)
     if(InBackground && !TickWhileInBackground && GraphicalMode)
         return;
 
+    LEVIATHAN_PROFILE_ZONE("GameWorld::Tick");
+
+    const auto tickStart = Time::GetTimeMicro64();
+    const auto cpuStart = Time::GetThreadCPUTimeMicro64();
+
+    RandomThreadOverride random(pimpl->WorldRandom);
+
     TickNumber = currenttick;
 
+    if(pimpl->Recorder)
+        pimpl->Recorder->RecordTick(currenttick, pimpl->WorldRandom);
+
     // Apply queued packets //
     ApplyQueuedPackets();
 
     _HandleDelayedDelete();
 
     // All required nodes for entities are created //
-    HandleAddedAndDeleted();
-    ClearAddedAndRemoved();
+    {
+        LEVIATHAN_PROFILE_ZONE("GameWorld::HandleAddedAndDeleted");
+
+        if(pimpl->TrackMovedEntities) {
+
+            // New positions need to be seen once like they had moved
+            std::vector<std::tuple<void*, ObjectID, ComponentTypeInfo>> added;
+            GetAddedFor(Position::TYPE, added);
+
+            for(const auto& component : added)
+                NotifyEntityMoved(std::get<1>(component));
+        }
+
+        HandleAddedAndDeleted();
+        ClearAddedAndRemoved();
+    }
 
     // Remove closed player connections //
 
@@ -591,8 +627,17 @@ DLLEXPORT void GameWorld::Tick(int currenttick)
         // if(IsOnServer) {
 
         // _ApplyEntityUpdatePackets();
-        if(_PhysicalWorld)
-            _PhysicalWorld->SimulateWorld(TICKSPEED / 1000.f);
+        if(_PhysicalWorld) {
+
+            _PhysicalWorld->SimulateWorld(pimpl->TickClock.GetInterval() / 1000.f);
+
+            if(pimpl->TrackMovedEntities) {
+
+                const auto& moved = _PhysicalWorld->GetMovedEntities();
+                pimpl->MovedEntities.insert(
+                    pimpl->MovedEntities.end(), moved.begin(), moved.end());
+            }
+        }
 
         // } else {
 
@@ -600,7 +645,15 @@ DLLEXPORT void GameWorld::Tick(int currenttick)
         // }
     }
 
-    _RunTickSystems();
+    {
+        LEVIATHAN_PROFILE_ZONE("GameWorld::RunTickSystems");
+        _RunTickSystems();
+    }
+
+    if(!NetworkSettings.IsAuthoritative)
+        _RecordLocalControlResults();
+
+    pimpl->MovedEntities.clear();
 
     TickInProgress = false;
 
@@ -622,6 +675,10 @@ DLLEXPORT void GameWorld::Tick(int currenttick)
         // TODO: direct control objects
         // _ReceivedSystem.Run(ComponentReceived.GetIndex(), *this);
     }
+
+    const auto tickEnd = Time::GetTimeMicro64();
+    pimpl->TickDurations.Record(tickEnd - tickStart, tickEnd);
+    pimpl->TickCPUTime += Time::GetThreadCPUTimeMicro64() - cpuStart;
 }
 // ------------------------------------ //
 DLLEXPORT void GameWorld::HandleAddedAndDeleted()
@@ -692,28 +749,158 @@ DLLEXPORT void GameWorld::_RunTickSystems()
     }
 }
 // ------------------------------------ //
+DLLEXPORT RollingLatencyHistogram& GameWorld::GetTickDurations()
+{
+    return pimpl->TickDurations;
+}
+
+DLLEXPORT int GameWorld::RunPendingTicks(int64_t now)
+{
+    RecursiveLock lock(pimpl->TickMutex);
+
+    RandomThreadOverride random(pimpl->WorldRandom);
+
+    // Tasks handed off while the previous tick was running //
+    std::vector<std::function<void()>> tasks;
+    {
+        Lock tasksLock(pimpl->QueuedTasksMutex);
+        tasks.swap(pimpl->QueuedTasks);
+    }
+
+    for(const auto& task : tasks)
+        task();
+
+    int dropped;
+    const int ticks = pimpl->TickClock.Advance(now, &dropped);
+
+    // The tick numbers of dropped ticks are skipped so that the tick number stays aligned
+    // with the time. Networked worlds compare tick numbers with other instances
+    TickNumber += dropped;
+
+    for(int i = 0; i < ticks; ++i)
+        Tick(TickNumber + 1);
+
+    return ticks;
+}
+
+DLLEXPORT void GameWorld::RunOnWorld(std::function<void()> task)
+{
+    std::unique_lock<RecursiveMutex> lock(pimpl->TickMutex, std::try_to_lock);
+
+    if(lock.owns_lock()) {
+
+        // Same as the queued tasks that run while ticking
+        RandomThreadOverride random(pimpl->WorldRandom);
+
+        task();
+        return;
+    }
+
+    Lock tasksLock(pimpl->QueuedTasksMutex);
+    pimpl->QueuedTasks.push_back(std::move(task));
+}
+
+DLLEXPORT Random& GameWorld::GetRandom()
+{
+    return pimpl->WorldRandom;
+}
+
+DLLEXPORT int64_t GameWorld::GetTickCPUTime() const
+{
+    return pimpl->TickCPUTime.load();
+}
+
+DLLEXPORT void GameWorld::SetTrackMovedEntities(bool track)
+{
+    pimpl->TrackMovedEntities = track;
+    pimpl->MovedEntities.clear();
+}
+
+DLLEXPORT const std::vector<ObjectID>* GameWorld::GetMovedEntities() const
+{
+    if(!pimpl->TrackMovedEntities)
+        return nullptr;
+
+    return &pimpl->MovedEntities;
+}
+
+DLLEXPORT void GameWorld::NotifyEntityMoved(ObjectID id)
+{
+    if(pimpl->TrackMovedEntities)
+        pimpl->MovedEntities.push_back(id);
+}
+
+DLLEXPORT void GameWorld::SetTickInterval(int interval)
+{
+    pimpl->TickClock.SetInterval(interval);
+}
+
+DLLEXPORT int GameWorld::GetTickInterval() const
+{
+    return pimpl->TickClock.GetInterval();
+}
+
+DLLEXPORT void GameWorld::SetMaxCatchUpTicks(int maxticks)
+{
+    pimpl->TickClock.SetMaxCatchUp(maxticks);
+}
+
+DLLEXPORT int64_t GameWorld::GetTimeUntilNextTick(int64_t now) const
+{
+    return pimpl->TickClock.GetTimeUntilNextStep(now);
+}
+
+DLLEXPORT uint64_t GameWorld::GetCatchUpTickCount() const
+{
+    return pimpl->TickClock.GetCatchUpSteps();
+}
+
+DLLEXPORT uint64_t GameWorld::GetDroppedTickCount() const
+{
+    return pimpl->TickClock.GetDroppedSteps();
+}
+
 DLLEXPORT float GameWorld::GetTickProgress() const
 {
-    float progress = Engine::Get()->GetTimeSinceLastTick() / (float)TICKSPEED;
+    float progress = pimpl->TickClock.GetTimeSinceLastStep(Time::GetTimeMs64()) /
+                     static_cast<float>(pimpl->TickClock.GetInterval());
 
     if(progress < 0.f)
         return 0.f;
 
     return progress < 1.f ? progress : 1.f;
 }
+// ------------------------------------ //
+DLLEXPORT void GameWorld::SetRecorder(const std::shared_ptr<WorldRecorder>& recorder)
+{
+    if(recorder)
+        recorder->RecordHeader(*this);
 
-DLLEXPORT std::tuple<int, int> GameWorld::GetTickAndTime() const
+    pimpl->Recorder = recorder;
+}
+
+DLLEXPORT const std::shared_ptr<WorldRecorder>& GameWorld::GetRecorder() const
 {
-    int tick = TickNumber;
-    int timeSince = static_cast<int>(Engine::Get()->GetTimeSinceLastTick());
+    return pimpl->Recorder;
+}
 
-    while(timeSince >= TICKSPEED) {
+DLLEXPORT void GameWorld::RecordCommand(uint32_t type, const sf::Packet& data)
+{
+    if(pimpl->Recorder)
+        pimpl->Recorder->RecordCommand(type, data);
+}
+// ------------------------------------ //
+DLLEXPORT std::tuple<int, int> GameWorld::GetTickAndTime() const
+{
+    const int interval = pimpl->TickClock.GetInterval();
+    const int64_t timeSince = pimpl->TickClock.GetTimeSinceLastStep(Time::GetTimeMs64());
 
-        ++tick;
-        timeSince -= TICKSPEED;
-    }
+    // The clock is behind if ticks haven't been ran recently or some were dropped
+    if(timeSince < 0)
+        return std::make_tuple(TickNumber, 0);
 
-    return std::make_tuple(tick, timeSince);
+    return std::make_tuple(TickNumber + static_cast<int>(timeSince / interval),
+        static_cast<int>(timeSince % interval));
 }
 
 // ------------------ Object managing ------------------ //
@@ -752,6 +939,10 @@ DLLEXPORT void GameWorld::ClearEntities()
     // This shouldn't be used all that much so release the memory
     Parents.shrink_to_fit();
 
+    pimpl->Prediction.Clear();
+    pimpl->LocalControlChecks.Clear();
+    pimpl->EntityPackets.Clear();
+
     // Clear all nodes //
     _ResetSystems();
 
@@ -909,6 +1100,9 @@ void GameWorld::_DoDestroy(ObjectID id)
     if(NetworkSettings.IsAuthoritative)
         _ReportEntityDestruction(id);
 
+    pimpl->Prediction.Remove(id);
+    pimpl->LocalControlChecks.Remove(id);
+
     // TODO: find a better way to do this
     DestroyAllIn(id);
 
@@ -1192,8 +1386,66 @@ DLLEXPORT void GameWorld::HandleEntityPacket(
                 return;
             }
 
-            _ApplyLocalControlUpdateMessage(message.EntityID, message.TickNumber,
-                message.UpdateData, message.ReferenceTick, -1);
+            // Older, duplicate or out of order states are ignored
+            if(!pimpl->LocalControlChecks.CheckTick(message.EntityID, message.TickNumber))
+                return;
+
+            // The whole state, rotation included, is restored if the client's state is
+            // rejected
+            Position* position = GetComponentPtr<Position>(message.EntityID);
+            LocalControlRollback oldState;
+
+            if(position) {
+                oldState.Position = position->Members._Position;
+                oldState.Orientation = position->Members._Orientation;
+
+                Physics* physics = GetComponentPtr<Physics>(message.EntityID);
+
+                if(physics && physics->GetBody()) {
+                    oldState.HasBody = true;
+                    oldState.Velocity = physics->GetBody()->GetVelocity();
+                    oldState.AngularVelocity = physics->GetBody()->GetAngularVelocity();
+                }
+            }
+
+            try {
+                _ApplyLocalControlUpdateMessage(message.EntityID, message.TickNumber,
+                    message.UpdateData, message.ReferenceTick, -1);
+            } catch(const InvalidState& e) {
+                LOG_WARNING("GameWorld: can't decode local control state, entity: " +
+                            std::to_string(message.EntityID) + ", requesting full states");
+                e.PrintToLog();
+                _RequestFullEntityState(message.EntityID, connection);
+                return;
+            }
+
+            if(position) {
+
+                const auto check = pimpl->LocalControlChecks.CheckState(message.EntityID,
+                    message.TickNumber, TickNumber, position->Members._Position,
+                    NetworkSettings.MaxLocalControlSpeed, NetworkSettings.LocalControlTickSlack,
+                    NetworkSettings.LocalControlCorrectionResendTicks);
+
+                if(check != LOCAL_CONTROL_CHECK::Accepted) {
+
+                    // Ignored states were sent before the client got our correction
+                    const bool rejected = check == LOCAL_CONTROL_CHECK::Rejected;
+
+                    if(rejected) {
+                        LOG_WARNING("GameWorld: rejected too fast local control movement, "
+                                    "entity: " +
+                                    std::to_string(message.EntityID));
+                    }
+
+                    _RejectLocalControlUpdate(message.EntityID, message.TickNumber, connection,
+                        *position, oldState, rejected);
+                    return;
+                }
+
+                pimpl->LocalControlChecks.Accept(message.EntityID, message.TickNumber,
+                    TickNumber, position->Members._Position);
+            }
+
             _OnLocalControlUpdatedEntity(message.EntityID, message.TickNumber);
             return;
         }
@@ -1204,46 +1456,150 @@ DLLEXPORT void GameWorld::HandleEntityPacket(
         return;
     }
 
+    HandleEntityPacket(std::move(message));
+}
+
+DLLEXPORT void GameWorld::HandleEntityPacket(ResponseEntityUpdate&& message)
+{
+    if(NetworkSettings.IsAuthoritative) {
+
+        LOG_WARNING("GameWorld: authoritative world is ignoring ResponseEntityUpdate without "
+                    "a connection");
+        return;
+    }
+
+    if(pimpl->Recorder)
+        pimpl->Recorder->RecordPacket(message);
+
+    if(NetworkSettings.UseJitterBuffer) {
+
+        pimpl->EntityPackets.Add(message.EntityID, message.TickNumber,
+            std::make_unique<ResponseEntityUpdate>(message.GetResponseID(), message.WorldID,
+                message.TickNumber, message.ReferenceTick, message.EntityID,
+                std::move(message.UpdateData)),
+            Time::GetTimeMs64());
+        return;
+    }
+
+    if(!_ApplyReceivedEntityStates(
+           message.EntityID, message.TickNumber, message.UpdateData, message.ReferenceTick)) {
+
+        LOG_WARNING(
+            "GameWorld: HandleEntityPacket: received update for non-existing entity, id: " +
+            std::to_string(message.EntityID));
+    }
+}
+
+DLLEXPORT void GameWorld::HandleEntityPacket(ResponseWorldSnapshot&& message)
+{
+    if(NetworkSettings.IsAuthoritative) {
+
+        LOG_WARNING("GameWorld: authoritative world is ignoring ResponseWorldSnapshot");
+        return;
+    }
+
+    if(pimpl->Recorder)
+        pimpl->Recorder->RecordPacket(message);
+
+    if(NetworkSettings.UseJitterBuffer) {
+
+        pimpl->EntityPackets.Add(NULL_OBJECT, message.TickNumber,
+            std::make_unique<ResponseWorldSnapshot>(message.GetResponseID(), message.WorldID,
+                message.TickNumber, message.ReferenceTick, message.EntityCount,
+                std::move(message.SnapshotData)),
+            Time::GetTimeMs64());
+        return;
+    }
+
+    _ApplyWorldSnapshot(message);
+}
+
+void GameWorld::_ApplyWorldSnapshot(ResponseWorldSnapshot& message)
+{
+    auto& buffer = pimpl->EntityPackets;
+
+    const bool valid = WorldSnapshot::ReadDelta(message.SnapshotData, message.EntityCount,
+        [&](ObjectID id, int32_t capturedtick, int32_t referencetick, sf::Packet& statedata) {
+            if(!NetworkSettings.UseJitterBuffer) {
+
+                if(!_ApplyReceivedEntityStates(id, capturedtick, statedata, referencetick)) {
+                    LOG_WARNING("GameWorld: HandleEntityPacket: received snapshot state for "
+                                "non-existing entity, id: " +
+                                std::to_string(id));
+                }
+                return;
+            }
+
+            if(buffer.IsObsolete(id, capturedtick))
+                return;
+
+            if(_ApplyReceivedEntityStates(id, capturedtick, statedata, referencetick)) {
+
+                buffer.MarkPlayed(id, capturedtick);
+                return;
+            }
+
+            // Kept as a separate update until the creation message is received
+            buffer.Add(id, capturedtick,
+                std::make_unique<ResponseEntityUpdate>(
+                    0, message.WorldID, capturedtick, referencetick, id, std::move(statedata)),
+                Time::GetTimeMs64());
+        });
+
+    if(!valid) {
+        LOG_ERROR("GameWorld: HandleEntityPacket: invalid snapshot data for tick: " +
+                  std::to_string(message.TickNumber));
+    }
+}
+
+bool GameWorld::_ApplyReceivedEntityStates(
+    ObjectID id, int32_t ticknumber, sf::Packet& data, int32_t referencetick)
+{
     // Don't apply if we don't have the entity
     bool found = false;
 
     for(auto entity : Entities) {
-        if(entity == message.EntityID) {
+        if(entity == id) {
 
             found = true;
             break;
         }
     }
 
-    if(!found) {
-
-        LOG_WARNING(
-            "GameWorld: HandleEntityPacket: received update for non-existing entity, id: " +
-            std::to_string(message.EntityID) +
-            " TODO: queue for later applying in case packets are out of order");
-        return;
-    }
+    if(!found)
+        return false;
 
     // If this is controlled by us this is handled differently
     for(auto entity : OurActiveLocalControl) {
 
-        if(entity == message.EntityID) {
+        if(entity == id) {
 
-            // TODO: apply corrections if our simulation was incorrect / not allowed
-            return;
+            // Our prediction is used instead. The server sends
+            // ResponseEntityLocalControlCorrection if it didn't accept our state
+            return true;
         }
     }
 
     try {
-        _CreateStatesFromUpdateMessage(message.EntityID, message.TickNumber,
-            message.UpdateData, message.ReferenceTick, -1);
+        _CreateStatesFromUpdateMessage(id, ticknumber, data, referencetick, -1);
+    } catch(const InvalidState& e) {
+        // The reference state is missing so the server needs to send a full state
+        LOG_WARNING("GameWorld: HandleEntityPacket: can't decode received state, id: " +
+                    std::to_string(id) + ", requesting full states");
+        e.PrintToLog();
+
+        if(ClientToServerConnection)
+            _RequestFullEntityState(id, *ClientToServerConnection);
+
     } catch(const InvalidArgument& e) {
         LOG_ERROR("GameWorld: HandleEntityPacket: trying to load update packet data caused an "
                   "exception: ");
         e.PrintToLog();
         LOG_INFO("GameWorld: note: entity may have partially updated states, id: " +
-                 std::to_string(message.EntityID));
+                 std::to_string(id));
     }
+
+    return true;
 }
 
 DLLEXPORT ObjectID GameWorld::HandleEntityPacket(ResponseEntityCreation& message)
@@ -1254,6 +1610,9 @@ DLLEXPORT ObjectID GameWorld::HandleEntityPacket(ResponseEntityCreation& message
         return NULL_OBJECT;
     }
 
+    if(pimpl->Recorder)
+        pimpl->Recorder->RecordPacket(message);
+
     if(message.ComponentCount > 1000) {
         LOG_ERROR("GameWorld: HandleEntityPacket: entity has more than 1000 components. "
                   "Packet is likely corrupted / forged, ignoring");
@@ -1274,6 +1633,9 @@ DLLEXPORT ObjectID GameWorld::HandleEntityPacket(ResponseEntityCreation& message
         _CreateComponentsFromCreationMessage(
             message.EntityID, message.InitialComponentData, message.ComponentCount, -1);
 
+        // Updates that arrived before the entity can now be applied
+        pimpl->EntityPackets.OnEntityCreated(message.EntityID);
+
         return message.EntityID;
     } catch(const InvalidArgument& e) {
         LOG_ERROR(
@@ -1291,25 +1653,48 @@ DLLEXPORT void GameWorld::HandleEntityPacket(ResponseEntityDestruction& message)
 {
     if(NetworkSettings.IsAuthoritative) {
 
-        LOG_WARNING("GameWorld: authoritative world is ignoring ResponseEntityCreation");
+        LOG_WARNING("GameWorld: authoritative world is ignoring ResponseEntityDestruction");
         return;
     }
 
+    if(pimpl->Recorder)
+        pimpl->Recorder->RecordPacket(message);
+
+    if(NetworkSettings.UseJitterBuffer) {
+
+        // Destroyed after the states received before this have been played out
+        pimpl->EntityPackets.AddDestruction(message.EntityID,
+            std::make_unique<ResponseEntityDestruction>(
+                message.GetResponseID(), message.WorldID, message.EntityID),
+            Time::GetTimeMs64());
+        return;
+    }
+
+    if(!_DestroyReceivedEntity(message.EntityID)) {
+        LOG_WARNING("GameWorld: HandleEntityPacket: received destruction message for unknown "
+                    "entity, id: " +
+                    std::to_string(message.EntityID));
+    }
+}
+
+bool GameWorld::_DestroyReceivedEntity(ObjectID id)
+{
     for(auto entity : Entities) {
-        if(entity == message.EntityID) {
+        if(entity == id) {
 
-            DestroyEntity(message.EntityID);
-            return;
+            DestroyEntity(id);
+            return true;
         }
     }
 
-    // TODO: queue if we don't have an entity with the ID
-    LOG_WARNING("GameWorld: HandleEntityPacket: received destruction message for unknown "
-                "entity, TODO: queue");
+    return false;
 }
 
 DLLEXPORT void GameWorld::HandleEntityPacket(ResponseEntityLocalControlStatus& message)
 {
+    if(pimpl->Recorder)
+        pimpl->Recorder->RecordPacket(message);
+
     if(!message.Enabled) {
 
         for(auto iter = OurActiveLocalControl.begin(); iter != OurActiveLocalControl.end();
@@ -1317,6 +1702,7 @@ DLLEXPORT void GameWorld::HandleEntityPacket(ResponseEntityLocalControlStatus& m
 
             if(*iter == message.EntityID) {
                 OurActiveLocalControl.erase(iter);
+                pimpl->Prediction.Remove(message.EntityID);
                 return;
             }
         }
@@ -1354,12 +1740,22 @@ DLLEXPORT void GameWorld::SetLocalControl(
 
         // TODO: detect changing owner
         ActiveLocalControl[id] = allowedconnection.get();
+
+        Position* position = GetComponentPtr<Position>(id);
+
+        if(position) {
+            pimpl->LocalControlChecks.Reset(id, TickNumber, position->Members._Position);
+        } else {
+            pimpl->LocalControlChecks.Remove(id);
+        }
+
     } else {
 
         auto found = ActiveLocalControl.find(id);
 
         if(found != ActiveLocalControl.end()) {
             ActiveLocalControl.erase(found);
+            pimpl->LocalControlChecks.Remove(id);
         } else {
             LOG_ERROR("GameWorld: SetLocalControl: disable called on entity that wasn't being "
                       "controlled");
@@ -1385,19 +1781,205 @@ DLLEXPORT void GameWorld::_OnLocalControlUpdatedEntity(ObjectID id, int32_t tick
         }
     }
 }
+
+void GameWorld::_RejectLocalControlUpdate(ObjectID id, int32_t ticknumber,
+    Connection& connection, Position& position, const LocalControlRollback& oldstate,
+    bool sendcorrection)
+{
+    position.Members._Position = oldstate.Position;
+    position.Members._Orientation = oldstate.Orientation;
+    position.Marked = true;
+    NotifyEntityMoved(id);
+
+    Physics* physics = GetComponentPtr<Physics>(id);
+
+    if(physics) {
+        physics->JumpTo(position);
+
+        if(oldstate.HasBody && physics->GetBody()) {
+            physics->GetBody()->SetVelocity(oldstate.Velocity);
+            physics->GetBody()->SetAngularVelocity(oldstate.AngularVelocity);
+        }
+    }
+
+    if(!sendcorrection)
+        return;
+
+    pimpl->LocalControlChecks.Reject(id, ticknumber, TickNumber, oldstate.Position);
+
+    connection.SendPacketToConnection(
+        std::make_shared<ResponseEntityLocalControlCorrection>(
+            0, ID, id, ticknumber, oldstate.Position, oldstate.Orientation),
+        RECEIVE_GUARANTEE::ResendOnce);
+}
 // ------------------------------------ //
-DLLEXPORT void GameWorld::ApplyQueuedPackets()
+DLLEXPORT void GameWorld::RecordLocalControlInput(ObjectID id, sf::Packet&& input)
+{
+    pimpl->Prediction.RecordInput(id, TickNumber, std::move(input));
+}
+
+DLLEXPORT LocalControlPrediction& GameWorld::GetLocalControlPrediction()
+{
+    return pimpl->Prediction;
+}
+
+DLLEXPORT void GameWorld::HandleEntityPacket(ResponseEntityLocalControlCorrection& message)
+{
+    if(NetworkSettings.IsAuthoritative) {
+
+        LOG_WARNING("GameWorld: authoritative world is ignoring local control correction");
+        return;
+    }
+
+    if(pimpl->Recorder)
+        pimpl->Recorder->RecordPacket(message);
+
+    if(!IsUnderOurLocalControl(message.EntityID))
+        return;
+
+    Position* position = GetComponentPtr<Position>(message.EntityID);
+
+    if(!position) {
+        LOG_WARNING("GameWorld: received local control correction for entity with no "
+                    "position, id: " +
+                    std::to_string(message.EntityID));
+        return;
+    }
+
+    auto& prediction = pimpl->Prediction;
+
+    // Resent and out of order corrections are ignored
+    if(!prediction.Acknowledge(message.EntityID, message.TickNumber))
+        return;
+
+    if(!prediction.NeedsCorrection(message.EntityID, message.TickNumber, message.Position,
+           message.Orientation, NetworkSettings.PredictionTolerance))
+        return;
+
+    const Float3 oldPosition = position->Members._Position;
+    const Float4 oldOrientation = position->Members._Orientation;
+
+    position->Members._Position = message.Position;
+    position->Members._Orientation = message.Orientation;
+    position->Marked = true;
+
+    Physics* physics = GetComponentPtr<Physics>(message.EntityID);
+
+    if(physics)
+        physics->JumpTo(*position);
+
+    prediction.RecordResult(
+        message.EntityID, message.TickNumber, message.Position, message.Orientation);
+
+    // Simulate the ticks the server hasn't seen yet again from the corrected state
+    prediction.ReplayInputs(message.EntityID, message.TickNumber, TickNumber,
+        [&](int32_t tick, const sf::Packet& input) {
+            _ReplayLocalControlInput(message.EntityID, tick, input);
+
+            prediction.RecordResult(message.EntityID, tick, position->Members._Position,
+                position->Members._Orientation);
+        });
+
+    NotifyEntityMoved(message.EntityID);
+
+    // Too long jumps look better without smoothing
+    const bool smooth = oldPosition.Compare(
+        position->Members._Position, NetworkSettings.MaxSmoothedCorrection);
+
+    prediction.AddCorrection(message.EntityID, TickNumber, oldPosition, oldOrientation,
+        position->Members._Position, position->Members._Orientation,
+        smooth ? NetworkSettings.CorrectionSmoothingTicks : 0);
+}
+
+DLLEXPORT void GameWorld::_ReplayLocalControlInput(
+    ObjectID id, int32_t ticknumber, const sf::Packet& input)
+{}
+
+void GameWorld::_RecordLocalControlResults()
 {
-    if(!pimpl->QueuedEntityUpdates.empty()) {
+    auto& prediction = pimpl->Prediction;
+
+    for(const auto id : OurActiveLocalControl) {
+
+        const Position* position = GetComponentPtr<Position>(id);
+
+        if(position) {
+            prediction.RecordResult(
+                id, TickNumber, position->Members._Position, position->Members._Orientation);
+        }
     }
 
-    // Applies packets that were received out of order. And throws out any too old packets
+    if(prediction.HasCorrections())
+        prediction.RemoveFinishedCorrections(TickNumber);
+}
+// ------------------------------------ //
+DLLEXPORT void GameWorld::HandleEntityPacket(
+    ResponseEntityFullStateRequest& message, Connection& connection)
+{
+    pimpl->FullStateRequests.emplace_back(&connection, message.EntityID);
+}
 
-    // if(!InitialEntityPackets.empty())
-    //     _ApplyInitialEntityPackets();
+DLLEXPORT std::vector<std::tuple<Connection*, ObjectID>> GameWorld::TakeFullStateRequests()
+{
+    std::vector<std::tuple<Connection*, ObjectID>> requests;
+    requests.swap(pimpl->FullStateRequests);
+    return requests;
+}
 
-    // if(!EntityUpdatePackets.empty())
-    //     _ApplyEntityUpdatePackets();
+void GameWorld::_RequestFullEntityState(ObjectID id, Connection& connection)
+{
+    auto& sent = pimpl->SentFullStateRequests;
+    const auto now = Time::GetTimeMs64();
+
+    for(auto iter = sent.begin(); iter != sent.end();) {
+
+        if(now - iter->second >= FULL_STATE_REQUEST_INTERVAL) {
+            iter = sent.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    if(!sent.emplace(id, now).second)
+        return;
+
+    connection.SendPacketToConnection(
+        std::make_shared<ResponseEntityFullStateRequest>(0, ID, id),
+        RECEIVE_GUARANTEE::Critical);
+}
+// ------------------------------------ //
+DLLEXPORT void GameWorld::ApplyQueuedPackets()
+{
+    auto& buffer = pimpl->EntityPackets;
+
+    // Orphans need to expire even when nothing is queued
+    if(buffer.IsEmpty())
+        return;
+
+    buffer.PlayOut(Time::GetTimeMs64(), [&](NetworkResponse& message) {
+        switch(message.GetType()) {
+        case NETWORK_RESPONSE_TYPE::EntityUpdate: {
+            auto& update = static_cast<ResponseEntityUpdate&>(message);
+
+            return _ApplyReceivedEntityStates(update.EntityID, update.TickNumber,
+                       update.UpdateData, update.ReferenceTick) ?
+                       JITTER_BUFFER_APPLY::Applied :
+                       JITTER_BUFFER_APPLY::MissingEntity;
+        }
+        case NETWORK_RESPONSE_TYPE::WorldSnapshot:
+            _ApplyWorldSnapshot(static_cast<ResponseWorldSnapshot&>(message));
+            return JITTER_BUFFER_APPLY::Applied;
+        case NETWORK_RESPONSE_TYPE::EntityDestruction:
+            return _DestroyReceivedEntity(
+                       static_cast<ResponseEntityDestruction&>(message).EntityID) ?
+                       JITTER_BUFFER_APPLY::Applied :
+                       JITTER_BUFFER_APPLY::MissingEntity;
+        default:
+            LOG_ERROR("GameWorld: ApplyQueuedPackets: unexpected queued packet type: " +
+                      message.GetTypeStr());
+            return JITTER_BUFFER_APPLY::Applied;
+        }
+    });
 }
 // ------------------------------------ //
 // DLLEXPORT void GameWorld::HandleClockSyncPacket(RequestWorldClockSync* data)
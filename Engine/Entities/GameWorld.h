@@ -7,8 +7,10 @@
 #include "Common/ThreadSafe.h"
 #include "Component.h"
 #include "Networking/CommonNetwork.h"
+#include "Statistics/Profiler.h"
 #include "WorldNetworkSettings.h"
 
+#include <functional>
 #include <type_traits>
 
 
@@ -25,12 +27,21 @@ class Plane;
 namespace Leviathan {
 
 class Camera;
+class LocalControlPrediction;
+struct LocalControlRollback;
 class PhysicalWorld;
+class Position;
+class Random;
 class ScriptComponentHolder;
 class ResponseEntityCreation;
 class ResponseEntityDestruction;
 class ResponseEntityUpdate;
 class ResponseEntityLocalControlStatus;
+class ResponseEntityLocalControlCorrection;
+class ResponseEntityFullStateRequest;
+class ResponseWorldSnapshot;
+class RollingLatencyHistogram;
+class WorldRecorder;
 
 template<class StateT>
 class StateHolder;
@@ -134,11 +145,110 @@ public:
     }
 
     //! \brief Used to keep track of passed ticks and trigger timed triggers
-    //! \note This will be called (or should be) every time the engine ticks
+    //! \note This is called by RunPendingTicks at the tick rate of this world
     //! \note This cannot be used for accurate time keeping for that use timers, but for
     //! events that need to happen at certain game world times this is ideal
     DLLEXPORT void Tick(int currenttick);
 
+    //! \brief Runs Tick as many times as the tick interval of this world requires
+    //!
+    //! Called by Engine. Late ticks are ran at once up to the max catch up ticks limit,
+    //! after which the rest are dropped. The numbers of dropped ticks are skipped so the tick
+    //! number always matches the time
+    //! \param now Current time in milliseconds, Time::GetTimeMs64
+    //! \returns The number of ran ticks
+    DLLEXPORT int RunPendingTicks(int64_t now);
+
+    //! \brief Sets the length of the ticks of this world in milliseconds
+    //!
+    //! The default is TICKSPEED
+    //! \note State interpolation and networking assume TICKSPEED long ticks so this should
+    //! only be changed for worlds that aren't networked
+    DLLEXPORT void SetTickInterval(int interval);
+
+    DLLEXPORT int GetTickInterval() const;
+
+    //! \brief Sets how many late ticks are ran at once before dropping the rest
+    DLLEXPORT void SetMaxCatchUpTicks(int maxticks);
+
+    //! \returns How long until RunPendingTicks would run a tick, 0 if one is late
+    DLLEXPORT int64_t GetTimeUntilNextTick(int64_t now) const;
+
+    //! \returns The number of ticks that have been ran late to catch up
+    DLLEXPORT uint64_t GetCatchUpTickCount() const;
+
+    //! \returns The number of ticks that have been skipped due to falling too far behind
+    DLLEXPORT uint64_t GetDroppedTickCount() const;
+
+    //! \brief Allows Engine to tick this world on a worker thread at the same time as
+    //! other worlds that allow it
+    //!
+    //! Only set this on headless worlds that don't share entities or players with any
+    //! other world. Script systems of this world need to be safe to run on any thread.
+    //! While ticking Random::Get returns the generator of the world (see GetRandom) and
+    //! IDFactory is atomic, other engine singletons must not be touched from the tick.
+    //! Work from other threads needs to go through RunOnWorld
+    //! \note Graphical worlds are always ticked on the main thread
+    inline void SetTickConcurrently(bool concurrent)
+    {
+        TickConcurrently = concurrent;
+    }
+
+    inline bool GetTickConcurrently() const
+    {
+        return TickConcurrently && !GraphicalMode;
+    }
+
+    //! \brief Runs task so that it doesn't overlap with a tick of this world
+    //!
+    //! If the world isn't being ticked right now the task is ran immediately, otherwise
+    //! it is queued and ran by the thread that ticks this world before its next tick.
+    //! Use this to hand off data (like received packets) from other threads. In both cases
+    //! Random::Get returns the generator of this world while task runs
+    //! \note This is thread safe
+    DLLEXPORT void RunOnWorld(std::function<void()> task);
+
+    //! \returns The CPU time used by ticks of this world in microseconds
+    DLLEXPORT int64_t GetTickCPUTime() const;
+
+    //! \brief The generator used by this world, Random::Get returns this while ticking
+    //!
+    //! Seeded from the main generator when the world is created
+    //! \note Only use this from the thread ticking the world or through RunOnWorld
+    DLLEXPORT Random& GetRandom();
+
+    //! \brief Makes the position using tick systems only look at the moved entities
+    //!
+    //! The moved entities are the ones whose physics bodies moved during the tick, ones that
+    //! got a Position component or a received Position state and the ones passed to
+    //! NotifyEntityMoved. Only enable this if all other code changing positions calls
+    //! NotifyEntityMoved, otherwise those changes won't be seen by the systems
+    DLLEXPORT void SetTrackMovedEntities(bool track);
+
+    //! \returns The entities moved since the last tick ran its systems or null if
+    //! SetTrackMovedEntities hasn't been enabled
+    //! \note May contain duplicates and entities that have been destroyed
+    DLLEXPORT const std::vector<ObjectID>* GetMovedEntities() const;
+
+    //! \brief Starts recording the inputs of this world, pass null to stop
+    //!
+    //! The ticks and the entity packets received by a client are recorded. Commands that
+    //! game code applies outside those can be added with RecordCommand
+    //! \see WorldReplay
+    DLLEXPORT void SetRecorder(const std::shared_ptr<WorldRecorder>& recorder);
+
+    //! \returns The active recorder or null
+    DLLEXPORT const std::shared_ptr<WorldRecorder>& GetRecorder() const;
+
+    //! \brief Records a game specific command if this world is being recorded
+    //! \see WorldRecorder::RecordCommand
+    DLLEXPORT void RecordCommand(uint32_t type, const sf::Packet& data);
+
+    //! \brief Adds id to the moved entities. Call after changing a Position outside of
+    //! physics
+    //! \note This isn't thread safe, use RunOnWorld from other threads
+    DLLEXPORT void NotifyEntityMoved(ObjectID id);
+
     //! \brief Runs systems required for a rendering run. Also updates camera positions
     //! \todo Allow script systems to specify their type
     DLLEXPORT void Render(int mspassed, int tick, int timeintick);
@@ -155,7 +265,8 @@ public:
     //! \brief Returns a tuple of the current tick number and how long
     //! it has passed since last tick
     //!
-    //! The tick number is always adjusted so that the time since last tick is < TICKSPEED
+    //! The tick number is always adjusted so that the time since last tick is less than
+    //! the tick interval
     DLLEXPORT std::tuple<int, int> GetTickAndTime() const;
 
 
@@ -330,12 +441,23 @@ public:
         return _PhysicalWorld.get();
     }
 
+    //! \brief Makes the physics of this world step on the worker threads
+    //! \note Must be called before Init to have an effect
+    //! \see PhysicalWorld::PhysicalWorld
+    inline void SetMultithreadedPhysics(bool multithreaded)
+    {
+        MultithreadedPhysics = multithreaded;
+    }
+
     //! \returns the unique ID of this world
     DLLEXPORT inline int GetID() const
     {
         return ID;
     }
 
+    //! \brief Returns the durations of the ticks of the last minute in microseconds
+    DLLEXPORT RollingLatencyHistogram& GetTickDurations();
+
     //! \returns the type of this world
     DLLEXPORT inline int32_t GetType() const
     {
@@ -415,20 +537,52 @@ public:
         return ClientToServerConnection;
     }
 
+    //! \brief Records the input that was used on the current tick to move a locally
+    //! controlled entity on a client
+    //!
+    //! The inputs are given back to _ReplayLocalControlInput when the server corrects the
+    //! entity
+    DLLEXPORT void RecordLocalControlInput(ObjectID id, sf::Packet&& input);
+
+    //! \brief The client side prediction history of our locally controlled entities
+    DLLEXPORT LocalControlPrediction& GetLocalControlPrediction();
+
     //! \brief Applies an entity update packet
-    //! \note With updates the message is queued (and moved) if we don't have the entity
-    //! specified by the id
-    //! \todo If we receive an update after an entity is destroyed the message should not be
-    //! queued
+    //! \note On clients with WorldNetworkSettings::UseJitterBuffer the message is moved to a
+    //! queue and applied once its tick is played out
     DLLEXPORT void HandleEntityPacket(ResponseEntityUpdate&& message, Connection& connection);
 
+    //! \brief Applies an entity update received from the server
+    //! \note Authoritative worlds only accept updates with the sending connection
+    DLLEXPORT void HandleEntityPacket(ResponseEntityUpdate&& message);
+
     //! \returns The id of the created entity or NULL_OBJECT
     DLLEXPORT ObjectID HandleEntityPacket(ResponseEntityCreation& message);
 
+    //! \note Queued like updates so that the states received before this are applied first
     DLLEXPORT void HandleEntityPacket(ResponseEntityDestruction& message);
 
     DLLEXPORT void HandleEntityPacket(ResponseEntityLocalControlStatus& message);
 
+    //! \brief Resets a locally controlled entity to the state the server corrected it to and
+    //! simulates the ticks after it again
+    DLLEXPORT void HandleEntityPacket(ResponseEntityLocalControlCorrection& message);
+
+    //! \brief Applies the entity states in a snapshot sent by a server in snapshot mode
+    //! \see WorldNetworkSettings::UseSnapshots
+    DLLEXPORT void HandleEntityPacket(ResponseWorldSnapshot&& message);
+
+    //! \brief Queues sending full states of an entity to connection as it couldn't decode
+    //! the last ones
+    //!
+    //! SendableSystem handles these with TakeFullStateRequests on the next tick
+    DLLEXPORT void HandleEntityPacket(
+        ResponseEntityFullStateRequest& message, Connection& connection);
+
+    //! \returns The full state requests received since the last call
+    //! \note The connections are only meant for comparing, they may have been closed already
+    DLLEXPORT std::vector<std::tuple<Connection*, ObjectID>> TakeFullStateRequests();
+
     // //! \brief Handles a world clock synchronizing packet
     // //! \note This should only be allowed to be called on a client that has connected
     // //! to a server
@@ -501,8 +655,9 @@ public:
     REFERENCE_HANDLE_UNCOUNTED_TYPE(GameWorld);
 
 protected:
-    //! \brief Applies packets that were received out of order. And throws out any too old
-    //! packets
+    //! \brief Applies the received entity packets that should be played out by now in tick
+    //! order. And throws out any too old packets
+    //! \see EntityJitterBuffer
     DLLEXPORT void ApplyQueuedPackets();
 
 public:
@@ -588,6 +743,15 @@ protected:
     //! implementation resets the physics position of a moved entity
     DLLEXPORT virtual void _OnLocalControlUpdatedEntity(ObjectID id, int32_t ticknumber);
 
+    //! \brief Called on a client to simulate a locally controlled entity again for a single
+    //! tick after it has been corrected by the server
+    //!
+    //! Should apply input and move the entity like it was done originally on ticknumber. The
+    //! base implementation does nothing so the entity stays where it was corrected to
+    //! \param input The packet given to RecordLocalControlInput or an empty one
+    DLLEXPORT virtual void _ReplayLocalControlInput(
+        ObjectID id, int32_t ticknumber, const sf::Packet& input);
+
 private:
     //! \brief Updates a players position info in this world
     void UpdatePlayersPositionData(ConnectedPlayer& ply);
@@ -605,6 +769,30 @@ private:
     //! \brief Sends sendable updates to all clients
     void _SendEntityUpdates(ObjectID id, Sendable& sendable, int tick);
 
+    //! \brief Restores the state an entity had before a client sent state was applied
+    //! \param sendcorrection If true the client is sent a correction
+    void _RejectLocalControlUpdate(ObjectID id, int32_t ticknumber, Connection& connection,
+        Position& position, const LocalControlRollback& oldstate, bool sendcorrection);
+
+    //! \brief Stores the predicted results of this tick for our locally controlled entities
+    void _RecordLocalControlResults();
+
+    //! \brief Asks the sender of a state that couldn't be decoded to send full states
+    //!
+    //! The states that are already on the way fail the same way so the request isn't
+    //! repeated for a while
+    void _RequestFullEntityState(ObjectID id, Connection& connection);
+
+    //! \brief Creates states for a received entity on a client
+    //! \returns False if the entity doesn't exist
+    bool _ApplyReceivedEntityStates(
+        ObjectID id, int32_t ticknumber, sf::Packet& data, int32_t referencetick);
+
+    void _ApplyWorldSnapshot(ResponseWorldSnapshot& message);
+
+    //! \returns False if the entity doesn't exist
+    bool _DestroyReceivedEntity(ObjectID id);
+
 
 protected:
     //! \brief If false a graphical Ogre window hasn't been created
@@ -699,6 +887,12 @@ private:
     //! If true this will keep running while not attached to a window
     bool TickWhileInBackground = false;
 
+    //! If true Engine may tick this on a worker thread
+    bool TickConcurrently = false;
+
+    //! Passed to PhysicalWorld when it is created in Init
+    bool MultithreadedPhysics = false;
+
     //! Set by OnLinkToWindow when this is added to a Window
     //! \note This must be added to the same one that Init was called with
     //! \todo Determine if worlds could be linked to a different Window than the
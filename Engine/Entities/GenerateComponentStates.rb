@@ -13,8 +13,8 @@ generator.addImplInclude "Entities/Components.h"
 
 posState = ComponentState.new(
   "PositionState", members: [
-    Variable.new("_Position", "Float3"),
-    Variable.new("_Orientation", "Float4")],
+    Variable.new("_Position", "Float3", quantize: "Position"),
+    Variable.new("_Orientation", "Float4", quantize: "Rotation")],
   copyconstructors: true,
   copyoperators: true,
   constructors: [
@@ -124,14 +124,19 @@ worldClass = GameWorldClass.new(
     # This needs to be ran before systems that unmark the Position
     EntitySystem.new("SendableMarkFromSystem<Position>", ["Sendable", "Position"],
                      runtick: {group: 20,
-                               parameters: []}),
+                               parameters: ["GetMovedEntities()"]}),
     EntitySystem.new("SendableSystem", [],
                      runtick: {group: 70,
                                parameters: ["ComponentSendable.GetIndex()"]}),
+    # Records the final positions of the tick so this runs last
+    EntitySystem.new("LagCompensationSystem", [],
+                     runtick: {group: 80,
+                               parameters: ["ComponentPosition.GetIndex()",
+                                            "ComponentPhysics.GetIndex()"]}),
     EntitySystem.new("PositionStateSystem", [], runtick: {
                        group: 50,
-                       parameters: ["ComponentPosition.GetIndex()", "PositionStates",
-                                    "tick"]}),
+                       parameters: ["ComponentPosition.GetIndex()", "GetMovedEntities()",
+                                    "PositionStates", "tick"]}),
   ],
   systemspreticksetup: (<<-END
   const auto timeAndTickTuple = GetTickAndTime();
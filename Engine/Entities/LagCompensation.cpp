@@ -0,0 +1,351 @@
+// ------------------------------------ //
+#include "LagCompensation.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Leviathan;
+// ------------------------------------ //
+namespace {
+
+//! \brief Finds where a line from start along direction enters a box
+//! \param fraction Set to the entry point as a fraction of direction, 0 if start is inside
+//! \param normal Set to the normal of the entered face
+//! \returns False if the box isn't hit between 0 and 1
+bool IntersectSegmentBox(const Float3& start, const Float3& direction, const Float3& min,
+    const Float3& max, float& fraction, Float3& normal)
+{
+    const float origins[] = {start.X, start.Y, start.Z};
+    const float directions[] = {direction.X, direction.Y, direction.Z};
+    const float mins[] = {min.X, min.Y, min.Z};
+    const float maxs[] = {max.X, max.Y, max.Z};
+
+    float enter = 0;
+    float exit = 1;
+    int enterAxis = -1;
+    float enterSign = 0;
+
+    for(int axis = 0; axis < 3; ++axis) {
+
+        if(directions[axis] == 0) {
+
+            // Parallel to the slab so must already be between the planes
+            if(origins[axis] < mins[axis] || origins[axis] > maxs[axis])
+                return false;
+
+            continue;
+        }
+
+        const float inverse = 1 / directions[axis];
+        float entering = (mins[axis] - origins[axis]) * inverse;
+        float exiting = (maxs[axis] - origins[axis]) * inverse;
+        float sign = -1;
+
+        if(entering > exiting) {
+            std::swap(entering, exiting);
+            sign = 1;
+        }
+
+        if(entering > enter) {
+            enter = entering;
+            enterAxis = axis;
+            enterSign = sign;
+        }
+
+        exit = std::min(exit, exiting);
+
+        if(enter > exit)
+            return false;
+    }
+
+    fraction = enter;
+    normal = Float3(0, 0, 0);
+
+    if(enterAxis == 0) {
+        normal.X = enterSign;
+    } else if(enterAxis == 1) {
+        normal.Y = enterSign;
+    } else if(enterAxis == 2) {
+        normal.Z = enterSign;
+    }
+
+    return true;
+}
+
+//! \returns The half extents of the bounding box of a rotated box
+Float3 GetRotatedHalfExtents(const Float3& halfextents, const Float4& orientation)
+{
+    const Float3 x = orientation.RotateVector(Float3(halfextents.X, 0, 0));
+    const Float3 y = orientation.RotateVector(Float3(0, halfextents.Y, 0));
+    const Float3 z = orientation.RotateVector(Float3(0, 0, halfextents.Z));
+
+    return Float3(std::abs(x.X) + std::abs(y.X) + std::abs(z.X),
+        std::abs(x.Y) + std::abs(y.Y) + std::abs(z.Y),
+        std::abs(x.Z) + std::abs(y.Z) + std::abs(z.Z));
+}
+
+//! \returns The half extents that the query shape adds to the tested bounds
+Float3 GetQueryHalfExtents(const PhysicsQuery& query)
+{
+    switch(query.Type) {
+    case PHYSICS_QUERY_TYPE::Ray: return Float3(0, 0, 0);
+    case PHYSICS_QUERY_TYPE::SphereSweep:
+    case PHYSICS_QUERY_TYPE::SphereOverlap:
+        return Float3(query.Extents.X, query.Extents.X, query.Extents.X);
+    case PHYSICS_QUERY_TYPE::BoxSweep:
+    case PHYSICS_QUERY_TYPE::BoxOverlap:
+        return GetRotatedHalfExtents(query.Extents, query.Orientation);
+    }
+
+    return Float3(0, 0, 0);
+}
+
+void RunSingleQuery(const std::vector<RewoundEntity>& entities, const PhysicsQuery& query,
+    uint32_t index, std::vector<PhysicsQueryHit>& hits)
+{
+    const size_t firstHit = hits.size();
+
+    const bool overlap = query.Type == PHYSICS_QUERY_TYPE::SphereOverlap ||
+                         query.Type == PHYSICS_QUERY_TYPE::BoxOverlap;
+
+    const Float3 halfExtents = GetQueryHalfExtents(query);
+    const Float3 direction = overlap ? Float3(0, 0, 0) : query.To - query.From;
+
+    for(const auto& entity : entities) {
+
+        if(!entity.HasBounds ||
+            (query.Ignored != NULL_OBJECT && entity.ID == query.Ignored))
+            continue;
+
+        // The query shape is swept as a point against bounds grown by its size
+        const Float3 min = entity.BoundsMin - halfExtents;
+        const Float3 max = entity.BoundsMax + halfExtents;
+
+        float fraction;
+        Float3 normal;
+
+        if(!IntersectSegmentBox(query.From, direction, min, max, fraction, normal))
+            continue;
+
+        if(overlap) {
+
+            const Float3 point =
+                query.From.MaxElements(entity.BoundsMin).MinElements(entity.BoundsMax);
+
+            // The corners of the grown box are outside a sphere
+            if(query.Type == PHYSICS_QUERY_TYPE::SphereOverlap &&
+                (point - query.From).LengthSquared() > query.Extents.X * query.Extents.X)
+                continue;
+
+            hits.push_back(PhysicsQueryHit{index, entity.ID, point, Float3(0, 0, 0), 0});
+            continue;
+        }
+
+        hits.push_back(PhysicsQueryHit{
+            index, entity.ID, query.From + direction * fraction, normal, fraction});
+    }
+
+    std::sort(hits.begin() + firstHit, hits.end(),
+        [](const PhysicsQueryHit& first, const PhysicsQueryHit& second) {
+            return first.Fraction < second.Fraction;
+        });
+
+    if(query.MaxHits > 0 && hits.size() - firstHit > static_cast<size_t>(query.MaxHits))
+        hits.resize(firstHit + query.MaxHits);
+}
+
+} // namespace
+// ------------------ LagCompensationFrame ------------------ //
+DLLEXPORT void LagCompensationFrame::Clear(int32_t tick)
+{
+    Tick = tick;
+
+    IDs.clear();
+    Positions.Clear();
+    Orientations.Clear();
+    HasBounds.clear();
+    BoundsMin.Clear();
+    BoundsMax.Clear();
+}
+
+DLLEXPORT void LagCompensationFrame::Add(
+    ObjectID id, const Float3& position, const Float4& orientation)
+{
+    IDs.push_back(id);
+    Positions.PushBack(position);
+    Orientations.PushBack(orientation);
+    HasBounds.push_back(0);
+    BoundsMin.PushBack(position);
+    BoundsMax.PushBack(position);
+}
+
+DLLEXPORT void LagCompensationFrame::Add(ObjectID id, const Float3& position,
+    const Float4& orientation, const Float3& boundsmin, const Float3& boundsmax)
+{
+    IDs.push_back(id);
+    Positions.PushBack(position);
+    Orientations.PushBack(orientation);
+    HasBounds.push_back(1);
+    BoundsMin.PushBack(boundsmin);
+    BoundsMax.PushBack(boundsmax);
+}
+// ------------------------------------ //
+DLLEXPORT bool LagCompensationFrame::Find(ObjectID id, size_t& index) const
+{
+    const auto found = std::lower_bound(IDs.begin(), IDs.end(), id);
+
+    if(found == IDs.end() || *found != id)
+        return false;
+
+    index = found - IDs.begin();
+    return true;
+}
+
+DLLEXPORT RewoundEntity LagCompensationFrame::Get(size_t index) const
+{
+    return RewoundEntity{IDs[index], Positions.Get(index), Orientations.Get(index),
+        HasBounds[index] != 0, BoundsMin.Get(index), BoundsMax.Get(index)};
+}
+// ------------------ LagCompensationHistory ------------------ //
+DLLEXPORT LagCompensationHistory::LagCompensationHistory(size_t capacity /*= 1*/) :
+    Frames(std::max<size_t>(capacity, 1))
+{}
+// ------------------------------------ //
+DLLEXPORT LagCompensationFrame& LagCompensationHistory::BeginFrame(int32_t tick)
+{
+    auto& frame = Frames[Next];
+    frame.Clear(tick);
+
+    Next = (Next + 1) % Frames.size();
+    Count = std::min(Count + 1, Frames.size());
+
+    return frame;
+}
+
+DLLEXPORT const LagCompensationFrame* LagCompensationHistory::Find(int32_t tick) const
+{
+    const auto newest = GetNewest();
+
+    if(!newest || tick > newest->Tick)
+        return nullptr;
+
+    // Frames are usually recorded every tick so the index can be guessed
+    const auto age = static_cast<size_t>(newest->Tick - tick);
+
+    if(age < Count) {
+
+        const auto& guess = Frames[(Next + Frames.size() - 1 - age) % Frames.size()];
+
+        if(guess.Tick == tick)
+            return &guess;
+    }
+
+    for(size_t i = 0; i < Count; ++i) {
+
+        const auto& frame = Frames[(Next + Frames.size() - 1 - i) % Frames.size()];
+
+        if(frame.Tick == tick)
+            return &frame;
+    }
+
+    return nullptr;
+}
+
+DLLEXPORT const LagCompensationFrame* LagCompensationHistory::GetNewest() const
+{
+    if(Count == 0)
+        return nullptr;
+
+    return &Frames[(Next + Frames.size() - 1) % Frames.size()];
+}
+
+DLLEXPORT void LagCompensationHistory::SetCapacity(size_t capacity)
+{
+    Frames.clear();
+    Frames.resize(std::max<size_t>(capacity, 1));
+
+    Next = 0;
+    Count = 0;
+}
+
+DLLEXPORT void LagCompensationHistory::Clear()
+{
+    for(auto& frame : Frames)
+        frame.Clear(-1);
+
+    Next = 0;
+    Count = 0;
+}
+// ------------------------------------ //
+DLLEXPORT bool LagCompensationHistory::Rewind(int32_t tick, float progress,
+    const std::vector<ObjectID>* entities, std::vector<RewoundEntity>& result) const
+{
+    const LagCompensationFrame* frame = Find(tick);
+
+    if(!frame)
+        return false;
+
+    const LagCompensationFrame* next = progress > 0 ? Find(tick + 1) : nullptr;
+
+    const auto addEntity = [&](size_t index) {
+        RewoundEntity entity = frame->Get(index);
+
+        size_t nextIndex;
+
+        if(next && next->Find(entity.ID, nextIndex)) {
+
+            entity.Position = entity.Position.Lerp(next->Positions.Get(nextIndex), progress);
+            entity.Orientation =
+                entity.Orientation.Slerp(next->Orientations.Get(nextIndex), progress);
+
+            if(entity.HasBounds && next->HasBounds[nextIndex]) {
+                entity.BoundsMin =
+                    entity.BoundsMin.Lerp(next->BoundsMin.Get(nextIndex), progress);
+                entity.BoundsMax =
+                    entity.BoundsMax.Lerp(next->BoundsMax.Get(nextIndex), progress);
+            }
+        }
+
+        result.push_back(entity);
+    };
+
+    if(!entities) {
+
+        result.reserve(result.size() + frame->GetCount());
+
+        for(size_t i = 0; i < frame->GetCount(); ++i)
+            addEntity(i);
+
+        return true;
+    }
+
+    for(ObjectID id : *entities) {
+
+        size_t index;
+
+        if(frame->Find(id, index))
+            addEntity(index);
+    }
+
+    return true;
+}
+
+DLLEXPORT bool LagCompensationHistory::RunQueries(int32_t tick, float progress,
+    const std::vector<ObjectID>* entities, const std::vector<PhysicsQuery>& queries,
+    std::vector<PhysicsQueryHit>& hits) const
+{
+    std::vector<RewoundEntity> rewound;
+
+    if(!Rewind(tick, progress, entities, rewound))
+        return false;
+
+    RunQueries(rewound, queries, hits);
+    return true;
+}
+
+DLLEXPORT void LagCompensationHistory::RunQueries(const std::vector<RewoundEntity>& entities,
+    const std::vector<PhysicsQuery>& queries, std::vector<PhysicsQueryHit>& hits)
+{
+    for(size_t i = 0; i < queries.size(); ++i)
+        RunSingleQuery(entities, queries[i], static_cast<uint32_t>(i), hits);
+}
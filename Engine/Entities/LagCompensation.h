@@ -0,0 +1,140 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Common/BulkMath.h"
+#include "EntityCommon.h"
+#include "Physics/PhysicsQuery.h"
+
+#include <vector>
+
+namespace Leviathan {
+
+//! \brief Position and bounds of an entity at a past time
+struct RewoundEntity {
+
+    ObjectID ID;
+
+    Float3 Position;
+    Float4 Orientation;
+
+    //! False if the entity had no physics body, queries don't hit these
+    bool HasBounds;
+
+    //! World space axis aligned bounds of the physics body
+    Float3 BoundsMin;
+    Float3 BoundsMax;
+};
+
+//! \brief Positions and physics bounds of all entities on a single tick
+//!
+//! The values are stored as separate arrays sorted by entity id
+class LagCompensationFrame {
+public:
+    //! \brief Removes all entities but keeps the memory for reuse
+    DLLEXPORT void Clear(int32_t tick);
+
+    //! \brief Adds an entity without a physics body
+    //! \pre id is larger than the ids added before
+    DLLEXPORT void Add(ObjectID id, const Float3& position, const Float4& orientation);
+
+    //! \brief Adds an entity with bounds
+    //! \pre id is larger than the ids added before
+    DLLEXPORT void Add(ObjectID id, const Float3& position, const Float4& orientation,
+        const Float3& boundsmin, const Float3& boundsmax);
+
+    //! \brief Finds the index of an entity
+    //! \returns False if the entity didn't exist on this tick
+    DLLEXPORT bool Find(ObjectID id, size_t& index) const;
+
+    DLLEXPORT RewoundEntity Get(size_t index) const;
+
+    inline size_t GetCount() const
+    {
+        return IDs.size();
+    }
+
+    int32_t Tick = -1;
+
+    std::vector<ObjectID> IDs;
+
+    Float3Array Positions;
+    Float4Array Orientations;
+
+    //! 1 when the bounds are set
+    std::vector<uint8_t> HasBounds;
+    Float3Array BoundsMin;
+    Float3Array BoundsMax;
+};
+
+//! \brief Ring of the latest LagCompensationFrame objects for server side hit validation
+//!
+//! Clients see other entities some time in the past. With this the server can move the
+//! targets back to where the client saw them and check a hit against those positions. The
+//! queries are ran against the recorded bounds, which makes them conservative. A precise
+//! check can be done with the rewound position and orientation if needed
+class LagCompensationHistory {
+public:
+    DLLEXPORT LagCompensationHistory(size_t capacity = 1);
+
+    //! \brief Returns a cleared frame to fill for tick, reusing the memory of the oldest one
+    //! \pre tick is newer than the previously begun frame
+    DLLEXPORT LagCompensationFrame& BeginFrame(int32_t tick);
+
+    //! \returns The frame for tick or null if it isn't stored anymore
+    DLLEXPORT const LagCompensationFrame* Find(int32_t tick) const;
+
+    //! \returns The newest frame or null if empty
+    DLLEXPORT const LagCompensationFrame* GetNewest() const;
+
+    //! \brief Changes how many ticks are stored, this drops all the frames
+    DLLEXPORT void SetCapacity(size_t capacity);
+
+    DLLEXPORT void Clear();
+
+    //! \brief Gets the entities as they were at a past time
+    //!
+    //! Entities that didn't exist on tick are left out
+    //! \param progress Progress from tick to the next tick between 0 and 1. The values are
+    //! interpolated the same way clients interpolate them for rendering
+    //! \param entities The entities to get, or null for all
+    //! \returns False if tick isn't stored
+    DLLEXPORT bool Rewind(int32_t tick, float progress, const std::vector<ObjectID>* entities,
+        std::vector<RewoundEntity>& result) const;
+
+    //! \brief Rewinds entities and runs queries against them
+    //! \see Rewind and RunQueries
+    //! \returns False if tick isn't stored
+    DLLEXPORT bool RunQueries(int32_t tick, float progress,
+        const std::vector<ObjectID>* entities, const std::vector<PhysicsQuery>& queries,
+        std::vector<PhysicsQueryHit>& hits) const;
+
+    //! \brief Runs queries against the bounds of entities
+    //!
+    //! Works like PhysicalWorld::RunQueries but with the bounding boxes of the bodies.
+    //! Shapes of the sweeps and box queries are also replaced by their bounding boxes.
+    //! Overlap hits have the point on the bounds closest to the query position and no normal
+    //! \param hits The hits are appended here ordered by the query index and then distance
+    DLLEXPORT static void RunQueries(const std::vector<RewoundEntity>& entities,
+        const std::vector<PhysicsQuery>& queries, std::vector<PhysicsQueryHit>& hits);
+
+    inline size_t GetCapacity() const
+    {
+        return Frames.size();
+    }
+
+    inline size_t GetCount() const
+    {
+        return Count;
+    }
+
+protected:
+    std::vector<LagCompensationFrame> Frames;
+
+    //! Index where the next frame is stored
+    size_t Next = 0;
+    size_t Count = 0;
+};
+
+} // namespace Leviathan
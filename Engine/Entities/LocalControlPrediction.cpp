@@ -0,0 +1,282 @@
+// ------------------------------------ //
+#include "LocalControlPrediction.h"
+
+#include <algorithm>
+
+using namespace Leviathan;
+// ------------------------------------ //
+namespace {
+
+inline bool CompareOrientations(const Float4& first, const Float4& second, float tolerance)
+{
+    // Negated quaternions are the same rotation
+    return first.Compare(second, tolerance) || first.Compare(-second, tolerance);
+}
+
+} // namespace
+// ------------------ LocalControlPrediction ------------------ //
+DLLEXPORT LocalControlPrediction::LocalControlPrediction(size_t historysize /*= 64*/) :
+    HistorySize(std::max<size_t>(historysize, 1))
+{}
+// ------------------------------------ //
+DLLEXPORT void LocalControlPrediction::RecordInput(
+    ObjectID id, int32_t tick, sf::Packet&& input)
+{
+    auto& slot = _GetSlot(id, tick);
+    slot.Input = std::move(input);
+    slot.HasInput = true;
+}
+
+DLLEXPORT void LocalControlPrediction::RecordResult(
+    ObjectID id, int32_t tick, const Float3& position, const Float4& orientation)
+{
+    auto& slot = _GetSlot(id, tick);
+    slot.Position = position;
+    slot.Orientation = orientation;
+    slot.HasResult = true;
+}
+
+DLLEXPORT const PredictedTick* LocalControlPrediction::GetTick(ObjectID id, int32_t tick) const
+{
+    const auto found = Entities.find(id);
+
+    if(found == Entities.end() || tick < 0)
+        return nullptr;
+
+    const auto& slot = found->second.Ticks[tick % HistorySize];
+
+    if(slot.Tick != tick)
+        return nullptr;
+
+    return &slot;
+}
+// ------------------------------------ //
+DLLEXPORT bool LocalControlPrediction::NeedsCorrection(ObjectID id, int32_t tick,
+    const Float3& position, const Float4& orientation, float tolerance) const
+{
+    const auto* predicted = GetTick(id, tick);
+
+    if(!predicted || !predicted->HasResult)
+        return true;
+
+    return !predicted->Position.Compare(position, tolerance) ||
+           !CompareOrientations(predicted->Orientation, orientation, tolerance);
+}
+
+DLLEXPORT bool LocalControlPrediction::Acknowledge(ObjectID id, int32_t tick)
+{
+    auto& entity = _GetEntity(id);
+
+    if(tick <= entity.AcknowledgedTick)
+        return false;
+
+    entity.AcknowledgedTick = tick;
+    return true;
+}
+
+DLLEXPORT int LocalControlPrediction::ReplayInputs(ObjectID id, int32_t aftertick,
+    int32_t lasttick, const InputReplayer& replayer) const
+{
+    const auto found = Entities.find(id);
+
+    if(found == Entities.end())
+        return 0;
+
+    // Anything older than the history has been overwritten already
+    const int32_t first =
+        std::max(aftertick + 1, lasttick - static_cast<int32_t>(HistorySize) + 1);
+
+    static const sf::Packet emptyInput;
+
+    int replayed = 0;
+
+    for(int32_t tick = std::max(first, 0); tick <= lasttick; ++tick) {
+
+        const auto& slot = found->second.Ticks[tick % HistorySize];
+
+        if(slot.Tick != tick)
+            continue;
+
+        replayer(tick, slot.HasInput ? slot.Input : emptyInput);
+        ++replayed;
+    }
+
+    return replayed;
+}
+// ------------------------------------ //
+DLLEXPORT void LocalControlPrediction::AddCorrection(ObjectID id, int32_t tick,
+    const Float3& oldposition, const Float4& oldorientation, const Float3& newposition,
+    const Float4& neworientation, int smoothingticks)
+{
+    if(smoothingticks <= 0) {
+        Corrections.erase(id);
+        return;
+    }
+
+    // The offset that is currently shown needs to be kept to not cause a jump
+    Float3 shownPosition = oldposition;
+    Float4 shownOrientation = oldorientation;
+    ApplyCorrectionOffset(id, tick, 0, shownPosition, shownOrientation);
+
+    Correction correction;
+    correction.PositionError = shownPosition - newposition;
+    correction.OrientationError =
+        shownOrientation.QuaternionMultiply(neworientation.Inverse()).Normalize();
+    correction.StartTick = tick;
+    correction.SmoothingTicks = smoothingticks;
+
+    Corrections[id] = correction;
+}
+
+DLLEXPORT bool LocalControlPrediction::ApplyCorrectionOffset(ObjectID id, int32_t tick,
+    int timeintick, Float3& position, Float4& orientation) const
+{
+    const auto found = Corrections.find(id);
+
+    if(found == Corrections.end())
+        return false;
+
+    const float weight = _GetCorrectionWeight(found->second, tick, timeintick);
+
+    position = position + found->second.PositionError * weight;
+    orientation = Float4::IdentityQuaternion()
+                      .Slerp(found->second.OrientationError, weight)
+                      .QuaternionMultiply(orientation);
+    return true;
+}
+
+DLLEXPORT void LocalControlPrediction::RemoveFinishedCorrections(int32_t tick)
+{
+    for(auto iter = Corrections.begin(); iter != Corrections.end();) {
+
+        if(_GetCorrectionWeight(iter->second, tick, 0) <= 0.f) {
+            iter = Corrections.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+// ------------------------------------ //
+DLLEXPORT void LocalControlPrediction::Remove(ObjectID id)
+{
+    Entities.erase(id);
+    Corrections.erase(id);
+}
+
+DLLEXPORT void LocalControlPrediction::Clear()
+{
+    Entities.clear();
+    Corrections.clear();
+}
+// ------------------------------------ //
+LocalControlPrediction::EntityPrediction& LocalControlPrediction::_GetEntity(ObjectID id)
+{
+    auto& entity = Entities[id];
+
+    if(entity.Ticks.empty())
+        entity.Ticks.resize(HistorySize);
+
+    return entity;
+}
+
+PredictedTick& LocalControlPrediction::_GetSlot(ObjectID id, int32_t tick)
+{
+    auto& slot = _GetEntity(id).Ticks[std::max(tick, 0) % HistorySize];
+
+    if(slot.Tick != tick) {
+
+        slot.Tick = tick;
+        slot.Input.clear();
+        slot.HasInput = false;
+        slot.HasResult = false;
+    }
+
+    return slot;
+}
+
+float LocalControlPrediction::_GetCorrectionWeight(
+    const Correction& correction, int32_t tick, int timeintick)
+{
+    const float elapsed =
+        static_cast<float>((tick - correction.StartTick) * TICKSPEED + timeintick);
+
+    return std::clamp(1.f - elapsed / (correction.SmoothingTicks * TICKSPEED), 0.f, 1.f);
+}
+// ------------------ LocalControlValidator ------------------ //
+DLLEXPORT void LocalControlValidator::Reset(
+    ObjectID id, int32_t currenttick, const Float3& position)
+{
+    auto& record = Records[id];
+    record = Record();
+    record.LastPosition = position;
+    record.LastServerTick = currenttick;
+}
+// ------------------------------------ //
+DLLEXPORT bool LocalControlValidator::CheckTick(ObjectID id, int32_t tick) const
+{
+    const auto found = Records.find(id);
+
+    if(found == Records.end())
+        return true;
+
+    return tick > found->second.LastTick;
+}
+
+DLLEXPORT LOCAL_CONTROL_CHECK LocalControlValidator::CheckState(ObjectID id, int32_t tick,
+    int32_t currenttick, const Float3& position, float maxspeed, int tickslack,
+    int resendticks) const
+{
+    const auto found = Records.find(id);
+
+    if(maxspeed <= 0.f || found == Records.end())
+        return LOCAL_CONTROL_CHECK::Accepted;
+
+    const auto& record = found->second;
+
+    // The first state after control starts has no client tick to compare against
+    int32_t elapsedTicks = currenttick - record.LastServerTick + tickslack;
+
+    if(record.LastTick != -1)
+        elapsedTicks = std::min(tick - record.LastTick, elapsedTicks);
+
+    const float allowed = maxspeed * std::max(elapsedTicks, 1) * TICKSPEED / 1000.f;
+
+    if(record.LastPosition.Compare(position, allowed))
+        return LOCAL_CONTROL_CHECK::Accepted;
+
+    if(record.CorrectionSentTick != -1 &&
+        currenttick - record.CorrectionSentTick < resendticks)
+        return LOCAL_CONTROL_CHECK::Ignored;
+
+    return LOCAL_CONTROL_CHECK::Rejected;
+}
+// ------------------------------------ //
+DLLEXPORT void LocalControlValidator::Accept(
+    ObjectID id, int32_t tick, int32_t currenttick, const Float3& position)
+{
+    auto& record = Records[id];
+    record.LastTick = tick;
+    record.LastPosition = position;
+    record.LastServerTick = currenttick;
+    record.CorrectionSentTick = -1;
+}
+
+DLLEXPORT void LocalControlValidator::Reject(
+    ObjectID id, int32_t tick, int32_t currenttick, const Float3& correctedposition)
+{
+    auto& record = Records[id];
+    record.LastTick = tick;
+    record.LastPosition = correctedposition;
+    record.LastServerTick = currenttick;
+    record.CorrectionSentTick = currenttick;
+}
+// ------------------------------------ //
+DLLEXPORT void LocalControlValidator::Remove(ObjectID id)
+{
+    Records.erase(id);
+}
+
+DLLEXPORT void LocalControlValidator::Clear()
+{
+    Records.clear();
+}
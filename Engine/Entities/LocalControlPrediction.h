@@ -0,0 +1,220 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Common/SFMLPackets.h"
+#include "Common/Types.h"
+#include "EntityCommon.h"
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace Leviathan {
+
+//! \brief Recorded input and predicted result of a single tick of a locally controlled entity
+struct PredictedTick {
+
+    int32_t Tick = -1;
+
+    //! Game specific input command that was used to simulate this tick
+    sf::Packet Input;
+    bool HasInput = false;
+
+    //! Position of the entity after simulating this tick
+    Float3 Position = Float3(0, 0, 0);
+    Float4 Orientation = Float4::IdentityQuaternion();
+    bool HasResult = false;
+};
+
+//! \brief Client side prediction of entities that are under our local control
+//!
+//! Keeps a ring of the inputs and results of the latest ticks so that when the server corrects
+//! an entity the inputs after the corrected tick can be simulated again. The visual jump
+//! caused by the correction is smoothed out over a few ticks.
+//! \see GameWorld::RecordLocalControlInput
+class LocalControlPrediction {
+public:
+    //! \param historysize How many ticks of inputs are kept for each entity
+    DLLEXPORT LocalControlPrediction(size_t historysize = 64);
+
+    //! \brief Stores the input that was used to simulate tick
+    DLLEXPORT void RecordInput(ObjectID id, int32_t tick, sf::Packet&& input);
+
+    //! \brief Stores the predicted position of an entity after tick has been simulated
+    DLLEXPORT void RecordResult(
+        ObjectID id, int32_t tick, const Float3& position, const Float4& orientation);
+
+    //! \returns The recorded tick or null if it isn't stored anymore
+    DLLEXPORT const PredictedTick* GetTick(ObjectID id, int32_t tick) const;
+
+    //! \returns True if an authoritative state is further from the prediction than tolerance
+    //! or if there is no prediction to compare against
+    DLLEXPORT bool NeedsCorrection(ObjectID id, int32_t tick, const Float3& position,
+        const Float4& orientation, float tolerance) const;
+
+    //! \brief Marks that the server has confirmed the state of tick
+    //! \returns False if a newer tick has already been acknowledged. Corrections that are
+    //! older than the acknowledged tick should be ignored
+    DLLEXPORT bool Acknowledge(ObjectID id, int32_t tick);
+
+    using InputReplayer = std::function<void(int32_t tick, const sf::Packet& input)>;
+
+    //! \brief Calls replayer for each recorded tick after aftertick up to lasttick in order
+    //!
+    //! Ticks that have no input recorded are also replayed with an empty packet
+    //! \returns The number of ticks that were replayed
+    DLLEXPORT int ReplayInputs(ObjectID id, int32_t aftertick, int32_t lasttick,
+        const InputReplayer& replayer) const;
+
+    //! \brief Starts smoothing out the jump from the old predicted transform to the corrected
+    //! one
+    //!
+    //! If the entity was already being smoothed the remaining offset is kept
+    //! \param smoothingticks How many ticks it takes for the offset to disappear
+    DLLEXPORT void AddCorrection(ObjectID id, int32_t tick, const Float3& oldposition,
+        const Float4& oldorientation, const Float3& newposition, const Float4& neworientation,
+        int smoothingticks);
+
+    //! \brief Adds the remaining correction offset of an entity to a rendered transform
+    //! \param timeintick Milliseconds since tick started
+    //! \returns False if the entity isn't being smoothed
+    DLLEXPORT bool ApplyCorrectionOffset(ObjectID id, int32_t tick, int timeintick,
+        Float3& position, Float4& orientation) const;
+
+    //! \brief Removes the corrections that have been fully smoothed out by tick
+    DLLEXPORT void RemoveFinishedCorrections(int32_t tick);
+
+    //! \brief Forgets an entity that is no longer under our local control
+    DLLEXPORT void Remove(ObjectID id);
+
+    DLLEXPORT void Clear();
+
+    inline bool HasCorrections() const
+    {
+        return !Corrections.empty();
+    }
+
+    inline bool HasCorrection(ObjectID id) const
+    {
+        return Corrections.find(id) != Corrections.end();
+    }
+
+    inline size_t GetHistorySize() const
+    {
+        return HistorySize;
+    }
+
+protected:
+    struct EntityPrediction {
+
+        std::vector<PredictedTick> Ticks;
+        int32_t AcknowledgedTick = -1;
+    };
+
+    struct Correction {
+
+        Float3 PositionError;
+        Float4 OrientationError;
+        int32_t StartTick;
+        int SmoothingTicks;
+    };
+
+    EntityPrediction& _GetEntity(ObjectID id);
+
+    //! \brief Gets the slot of tick, clearing it if it held an older tick
+    PredictedTick& _GetSlot(ObjectID id, int32_t tick);
+
+    //! \returns How much of the error of correction is left
+    static float _GetCorrectionWeight(
+        const Correction& correction, int32_t tick, int timeintick);
+
+protected:
+    const size_t HistorySize;
+
+    std::unordered_map<ObjectID, EntityPrediction> Entities;
+    std::unordered_map<ObjectID, Correction> Corrections;
+};
+
+//! \brief Result of LocalControlValidator::CheckState
+enum class LOCAL_CONTROL_CHECK {
+
+    //! The state is valid
+    Accepted,
+
+    //! The state is invalid but a correction was sent recently so the client has probably sent
+    //! this before receiving it
+    Ignored,
+
+    //! The state is invalid and the client needs to be sent a correction
+    Rejected
+};
+
+//! \brief The state of a locally controlled entity from before a client sent state was
+//! applied on the server
+//!
+//! Restored in full if the client's state is rejected. The velocities are only used if the
+//! entity has a physics body
+struct LocalControlRollback {
+
+    Float3 Position = Float3(0);
+    Float4 Orientation = Float4::IdentityQuaternion();
+
+    bool HasBody = false;
+    Float3 Velocity = Float3(0);
+    Float3 AngularVelocity = Float3(0);
+};
+
+//! \brief Server side checks for the states clients send for their locally controlled entities
+//!
+//! Client tick numbers aren't synchronized with the server so all the ticks passed to this
+//! that aren't named currenttick are client ticks. The server ticks are used to limit how much
+//! time a client can claim has passed between its states
+class LocalControlValidator {
+public:
+    //! \brief Starts validating an entity from a known state
+    DLLEXPORT void Reset(ObjectID id, int32_t currenttick, const Float3& position);
+
+    //! \returns False if a state for tick is older than the newest accepted or corrected one
+    DLLEXPORT bool CheckTick(ObjectID id, int32_t tick) const;
+
+    //! \brief Checks that an entity hasn't moved faster than allowed since the last accepted
+    //! state
+    //! \param maxspeed In units per second. Movement isn't checked if this isn't positive
+    //! \param tickslack How many ticks more than the server has ran the client can claim to
+    //! have simulated
+    //! \param resendticks How many server ticks to wait before sending a correction again
+    DLLEXPORT LOCAL_CONTROL_CHECK CheckState(ObjectID id, int32_t tick, int32_t currenttick,
+        const Float3& position, float maxspeed, int tickslack, int resendticks) const;
+
+    //! \brief Stores a state as the newest accepted one
+    DLLEXPORT void Accept(
+        ObjectID id, int32_t tick, int32_t currenttick, const Float3& position);
+
+    //! \brief Stores the state the entity was corrected to on tick
+    DLLEXPORT void Reject(
+        ObjectID id, int32_t tick, int32_t currenttick, const Float3& correctedposition);
+
+    DLLEXPORT void Remove(ObjectID id);
+
+    DLLEXPORT void Clear();
+
+protected:
+    struct Record {
+
+        //! Client tick of the last accepted or corrected state
+        int32_t LastTick = -1;
+        Float3 LastPosition = Float3(0, 0, 0);
+
+        //! Server tick when the record was last updated
+        int32_t LastServerTick = -1;
+
+        //! Server tick when a correction was sent, -1 after the client has sent a valid state
+        int32_t CorrectionSentTick = -1;
+    };
+
+    std::unordered_map<ObjectID, Record> Records;
+};
+
+} // namespace Leviathan
@@ -0,0 +1,39 @@
+// ------------------------------------ //
+#include "PositionInterpolation.h"
+
+using namespace Leviathan;
+// ------------------------------------ //
+DLLEXPORT size_t PositionInterpolationBatch::Add(const Float3& startposition,
+    const Float4& startorientation, const Float3& endposition, const Float4& endorientation,
+    float progress)
+{
+    StartPositions.PushBack(startposition);
+    EndPositions.PushBack(endposition);
+    StartOrientations.PushBack(startorientation);
+    EndOrientations.PushBack(endorientation);
+
+    Progress.push_back(progress);
+    return Progress.size() - 1;
+}
+
+DLLEXPORT size_t PositionInterpolationBatch::Add(
+    const Float3& position, const Float4& orientation)
+{
+    // Interpolating to the same state with zero progress returns it exactly
+    return Add(position, orientation, position, orientation, 0.f);
+}
+// ------------------------------------ //
+DLLEXPORT void PositionInterpolationBatch::Run()
+{
+    BulkMath::Lerp(StartPositions, EndPositions, Progress.data(), Positions);
+    BulkMath::Slerp(StartOrientations, EndOrientations, Progress.data(), Orientations);
+}
+
+DLLEXPORT void PositionInterpolationBatch::Clear()
+{
+    StartPositions.Clear();
+    EndPositions.Clear();
+    StartOrientations.Clear();
+    EndOrientations.Clear();
+    Progress.clear();
+}
@@ -0,0 +1,58 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Common/BulkMath.h"
+
+namespace Leviathan {
+
+//! \brief Interpolates the positions and orientations of many entities at once
+//!
+//! The start and end transforms are gathered into packed arrays so that the interpolation
+//! runs as SIMD loops over all the entities with BulkMath. The results are the same as with
+//! Float3::Lerp and Float4::Slerp
+//! \see RenderingPositionSystem
+class PositionInterpolationBatch {
+public:
+    //! \brief Adds an entity that is between two states
+    //! \returns The index of the result
+    DLLEXPORT size_t Add(const Float3& startposition, const Float4& startorientation,
+        const Float3& endposition, const Float4& endorientation, float progress);
+
+    //! \brief Adds an entity that is shown at a single state
+    DLLEXPORT size_t Add(const Float3& position, const Float4& orientation);
+
+    //! \brief Calculates the results of all the added entities
+    DLLEXPORT void Run();
+
+    //! \brief Removes all entities but keeps the memory for the next frame
+    DLLEXPORT void Clear();
+
+    inline size_t GetCount() const
+    {
+        return Progress.size();
+    }
+
+    inline Float3 GetPosition(size_t index) const
+    {
+        return Positions.Get(index);
+    }
+
+    inline Float4 GetOrientation(size_t index) const
+    {
+        return Orientations.Get(index);
+    }
+
+protected:
+    Float3Array StartPositions;
+    Float3Array EndPositions;
+    Float4Array StartOrientations;
+    Float4Array EndOrientations;
+    AlignedVector<float> Progress;
+
+    Float3Array Positions;
+    Float4Array Orientations;
+};
+
+} // namespace Leviathan
@@ -5,7 +5,6 @@
 #include "Script/ScriptConversionHelpers.h"
 #include "Script/ScriptExecutor.h"
 
-#include <boost/range/adaptor/map.hpp>
 using namespace Leviathan;
 // ------------------------------------ //
 
@@ -25,17 +24,19 @@ DLLEXPORT ScriptComponentHolder::~ScriptComponentHolder()
 
     Factory->Release();
 
-    LEVIATHAN_ASSERT(CreatedObjects.empty(), "ScriptComponentHolder didn't properly clear");
+    LEVIATHAN_ASSERT(Objects.empty(), "ScriptComponentHolder didn't properly clear");
 }
 // ------------------------------------ //
 DLLEXPORT bool ScriptComponentHolder::ReleaseComponent(ObjectID entity)
 {
-    auto iter = CreatedObjects.find(entity);
+    const auto iter = EntityIndex.find(entity);
 
-    if(iter == CreatedObjects.end())
+    if(iter == EntityIndex.end())
         return false;
 
-    Removed.push_back(std::make_tuple(iter->second, entity));
+    asIScriptObject* object = Objects[iter->second];
+
+    Removed.push_back(std::make_tuple(object, entity));
 
     // Remove from added if there //
     for(auto iter = Added.begin(); iter != Added.end(); ++iter) {
@@ -48,24 +49,26 @@ DLLEXPORT bool ScriptComponentHolder::ReleaseComponent(ObjectID entity)
         }
     }
 
+    _RemoveAtIndex(iter->second);
+
     // TODO: call release on the actual script object to let it do shutdown stuff
     // Release our reference to let the object be destroyed once all references are released
-    iter->second->Release();
-
-    CreatedObjects.erase(iter);
+    object->Release();
 
     return true;
 }
 
 DLLEXPORT void ScriptComponentHolder::ReleaseAllComponents()
 {
-    for(auto iter = CreatedObjects.begin(); iter != CreatedObjects.end(); ++iter) {
+    for(asIScriptObject* object : Objects) {
 
         // TODO: also call release here
-        iter->second->Release();
+        object->Release();
     }
 
-    CreatedObjects.clear();
+    Entities.clear();
+    Objects.clear();
+    EntityIndex.clear();
     Added.clear();
     Removed.clear();
 }
@@ -113,7 +116,9 @@ DLLEXPORT asIScriptObject* ScriptComponentHolder::Create(ObjectID entity)
     // Remember that we take a reference to it
     result.Value->AddRef();
 
-    CreatedObjects[entity] = result.Value;
+    EntityIndex[entity] = Objects.size();
+    Entities.push_back(entity);
+    Objects.push_back(result.Value);
 
     // And we return it so increase refcount for that too //
     result.Value->AddRef();
@@ -122,13 +127,14 @@ DLLEXPORT asIScriptObject* ScriptComponentHolder::Create(ObjectID entity)
 
 DLLEXPORT asIScriptObject* ScriptComponentHolder::Find(ObjectID entity)
 {
-    auto iter = CreatedObjects.find(entity);
+    const auto iter = EntityIndex.find(entity);
 
-    if(iter == CreatedObjects.end())
+    if(iter == EntityIndex.end())
         return nullptr;
 
-    iter->second->AddRef();
-    return iter->second;
+    asIScriptObject* object = Objects[iter->second];
+    object->AddRef();
+    return object;
 }
 // ------------------------------------ //
 DLLEXPORT CScriptArray* ScriptComponentHolder::GetIndex() const
@@ -137,6 +143,49 @@ DLLEXPORT CScriptArray* ScriptComponentHolder::GetIndex() const
 
     asIScriptEngine* engine = ctx ? ctx->GetEngine() : ScriptExecutor::Get()->GetASEngine();
 
-    return ConvertIteratorToASArray((CreatedObjects | boost::adaptors::map_keys).begin(),
-        (CreatedObjects | boost::adaptors::map_keys).end(), engine, "array<ObjectID>");
+    return ConvertVectorToASArray(Entities, engine, "array<ObjectID>");
+}
+
+DLLEXPORT ObjectID ScriptComponentHolder::GetEntityAt(uint32_t index) const
+{
+    if(index >= Entities.size()) {
+
+        asIScriptContext* ctx = asGetActiveContext();
+        if(ctx)
+            ctx->SetException("ScriptComponentHolder: GetEntityAt: index out of range");
+        return NULL_OBJECT;
+    }
+
+    return Entities[index];
+}
+
+DLLEXPORT asIScriptObject* ScriptComponentHolder::GetAt(uint32_t index) const
+{
+    if(index >= Objects.size()) {
+
+        asIScriptContext* ctx = asGetActiveContext();
+        if(ctx)
+            ctx->SetException("ScriptComponentHolder: GetAt: index out of range");
+        return nullptr;
+    }
+
+    Objects[index]->AddRef();
+    return Objects[index];
+}
+// ------------------------------------ //
+void ScriptComponentHolder::_RemoveAtIndex(size_t index)
+{
+    EntityIndex.erase(Entities[index]);
+
+    const size_t last = Entities.size() - 1;
+
+    if(index != last) {
+
+        Entities[index] = Entities[last];
+        Objects[index] = Objects[last];
+        EntityIndex[Entities[index]] = index;
+    }
+
+    Entities.pop_back();
+    Objects.pop_back();
 }
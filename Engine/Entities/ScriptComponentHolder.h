@@ -5,7 +5,8 @@
 // ------------------------------------ //
 #include "Common/ReferenceCounted.h"
 
-#include <map>
+#include <unordered_map>
+#include <vector>
 
 class asIScriptFunction;
 class asIScriptObject;
@@ -60,11 +61,40 @@ public:
     //! \brief Returns all the created components
     //!
     //! Caller must release reference
-    //! \todo Check can we somehow return all the keys and the objects to avoid having to call
-    //! Find from scripts after this
-    //! \note This builds a new array object on each call.
+    //! \note This builds a new array object on each call. Use GetCount, GetEntityAt and GetAt
+    //! to go through the components without copying
     DLLEXPORT CScriptArray* GetIndex() const;
 
+    //! \returns The number of created components
+    inline uint32_t GetCount() const
+    {
+        return static_cast<uint32_t>(Entities.size());
+    }
+
+    //! \brief Returns the entity of the component at index
+    //!
+    //! Components are stored contiguously so this can be used to iterate them without
+    //! building an array. When a component is released the last one is moved to its index.
+    //! \returns NULL_OBJECT and sets a script exception if index is out of range
+    DLLEXPORT ObjectID GetEntityAt(uint32_t index) const;
+
+    //! \brief Returns the component at index
+    //! \note Increases refcount on returned object
+    //! \see GetEntityAt
+    DLLEXPORT asIScriptObject* GetAt(uint32_t index) const;
+
+    //! \brief Entities that have a component, in the same order as GetObjects
+    const auto& GetEntities() const
+    {
+        return Entities;
+    }
+
+    //! \brief The created components, in the same order as GetEntities
+    const auto& GetObjects() const
+    {
+        return Objects;
+    }
+
 
     //! \brief Returns a reference to the vector of removed elements
     const auto& GetRemoved() const
@@ -95,11 +125,20 @@ public:
 
     const std::string ComponentType;
 
+private:
+    //! \brief Removes the component at index by moving the last one there
+    void _RemoveAtIndex(size_t index);
+
 private:
     asIScriptFunction* Factory;
     GameWorld* World;
 
-    std::map<ObjectID, asIScriptObject*> CreatedObjects;
+    //! The created components stored densely for iterating. Objects[i] belongs to Entities[i]
+    std::vector<ObjectID> Entities;
+    std::vector<asIScriptObject*> Objects;
+
+    //! Index into Entities and Objects for each entity
+    std::unordered_map<ObjectID, size_t> EntityIndex;
 
     // Need to remember these for compatibility with caching
     std::vector<std::tuple<asIScriptObject*, ObjectID>> Added;
@@ -3,16 +3,21 @@
 
 #include "GameWorld.h"
 #include "Script/CustomScriptRunHelpers.h"
+#include "Script/PreparedScriptCall.h"
 #include "Script/ScriptExecutor.h"
 #include "ScriptComponentHolder.h"
 
 #include "add_on/scriptarray/scriptarray.h"
+
+#include <unordered_set>
+
 using namespace Leviathan;
 // ------------------------------------ //
 DLLEXPORT ScriptSystemWrapper::ScriptSystemWrapper(
     const std::string& name, asIScriptObject* impl) :
     Name(name),
-    ImplementationObject(impl)
+    ImplementationObject(impl),
+    RunZone(Profiler::RegisterZone("ScriptSystem::Run " + name))
 {
     if(!ImplementationObject)
         throw InvalidArgument("ScriptSystemWrapper not given an angelscript object");
@@ -86,23 +91,15 @@ DLLEXPORT void ScriptSystemWrapper::Release()
 // ------------------------------------ //
 DLLEXPORT void ScriptSystemWrapper::Run()
 {
-    // For performance reasons this might be good to store
-    if(!RunMethod) {
-
-        RunMethod = ImplementationObject->GetObjectType()->GetMethodByName("Run");
-        RunMethod->AddRef();
-    }
+    ProfileScope zone(RunZone);
 
-    if(!RunMethod) {
+    if(!_PrepareMethod(RunMethod, "Run")) {
 
         LOG_ERROR("Script system(" + Name + "): failed to find Run method on as object");
         return;
     }
 
-    ScriptRunningSetup setup;
-    auto result =
-        static_cast<ScriptExecutor*>(ImplementationObject->GetEngine()->GetUserData())
-            ->RunScriptMethod<void>(setup, RunMethod, ImplementationObject);
+    auto result = RunMethod->CallMethod(ImplementationObject);
 
     if(result.Result != SCRIPT_RUN_RESULT::Success) {
 
@@ -113,25 +110,14 @@ DLLEXPORT void ScriptSystemWrapper::Run()
 // ------------------------------------ //
 DLLEXPORT void ScriptSystemWrapper::CreateAndDestroyNodes()
 {
-    // For performance reasons this might be good to store
-    if(!CreateAndDestroyNodesMethod) {
-
-        CreateAndDestroyNodesMethod =
-            ImplementationObject->GetObjectType()->GetMethodByName("CreateAndDestroyNodes");
-        CreateAndDestroyNodesMethod->AddRef();
-    }
-
-    if(!CreateAndDestroyNodesMethod) {
+    if(!_PrepareMethod(CreateAndDestroyNodesMethod, "CreateAndDestroyNodes")) {
 
         LOG_ERROR("Script system(" + Name +
                   "): failed to find CreateAndDestroyNodes method on as object");
         return;
     }
 
-    ScriptRunningSetup setup;
-    auto result =
-        static_cast<ScriptExecutor*>(ImplementationObject->GetEngine()->GetUserData())
-            ->RunScriptMethod<void>(setup, CreateAndDestroyNodesMethod, ImplementationObject);
+    auto result = CreateAndDestroyNodesMethod->CallMethod(ImplementationObject);
 
     if(result.Result != SCRIPT_RUN_RESULT::Success) {
 
@@ -205,43 +191,46 @@ DLLEXPORT void ScriptSystemWrapper::Resume()
 // ------------------------------------ //
 DLLEXPORT void ScriptSystemWrapper::_ReleaseCachedFunctions()
 {
+    RunMethod.reset();
+    CreateAndDestroyNodesMethod.reset();
+}
 
-    if(RunMethod) {
-        RunMethod->Release();
-        RunMethod = nullptr;
-    }
+DLLEXPORT bool ScriptSystemWrapper::_PrepareMethod(
+    std::unique_ptr<PreparedScriptCall<void>>& call, const char* methodname)
+{
+    if(call)
+        return call->IsValid();
 
-    if(CreateAndDestroyNodesMethod) {
-        CreateAndDestroyNodesMethod->Release();
-        CreateAndDestroyNodesMethod = nullptr;
-    }
+    call = std::make_unique<PreparedScriptCall<void>>(
+        ImplementationObject->GetObjectType()->GetMethodByName(methodname));
+
+    return call->IsValid();
 }
 // ------------------------------------ //
 // ScriptSystemNodeHelper
 //! Helper for ScriptSystemNodeHelper
-//! \returns True on success. False if failed (will also set exception on context)
-inline bool GetCachedScriptObjectIDAtIndex(CScriptArray* cached, asUINT index,
-    asIScriptContext* context, ScriptExecutor* exec, ObjectID& id)
+//! \returns True if type of the cached objects has 'ObjectID id' as its first property.
+//! Otherwise sets an exception on context
+inline bool VerifyCachedScriptObjectType(asITypeInfo* cacheclass, asIScriptContext* context,
+    ScriptExecutor* exec)
 {
-    asIScriptObject* obj = *static_cast<asIScriptObject**>(cached->At(index));
+    if(cacheclass->GetPropertyCount() < 1) {
 
-    if(obj->GetPropertyCount() < 1) {
-
-        context->SetException(("cachedcomponents number " + std::to_string(index) +
+        context->SetException(("cachedcomponents type " + std::string(cacheclass->GetName()) +
                                " doesn't have 'ObjectID id' as its first property")
                                   .c_str());
         return false;
     }
 
-    // This check can be disabled once this is working (as reading 4 bytes will most
-    // often probably work, but for developing new systems this check is good)
-    const auto propertyType = obj->GetPropertyTypeId(0);
+    // Derived classes have the same first property so this only needs checking once per call
+    int propertyType = -1;
+    cacheclass->GetProperty(0, nullptr, &propertyType);
 
     const auto neededType = AngelScriptTypeIDResolver<ObjectID>::Get(exec);
 
     if(propertyType != neededType) {
 
-        context->SetException(("cachedcomponents number " + std::to_string(index) +
+        context->SetException(("cachedcomponents type " + std::string(cacheclass->GetName()) +
                                " doesn't have 'ObjectID id' as its first property. Type " +
                                std::to_string(propertyType) +
                                " doesn't match ObjectID type: " + std::to_string(neededType))
@@ -249,13 +238,17 @@ inline bool GetCachedScriptObjectIDAtIndex(CScriptArray* cached, asUINT index,
         return false;
     }
 
-    // Now that the property is (probably) validated we can read it
-    ObjectID* idProperty = static_cast<ObjectID*>(obj->GetAddressOfProperty(0));
-
-    id = *idProperty;
     return true;
 }
 
+//! Helper for ScriptSystemNodeHelper
+//! \pre VerifyCachedScriptObjectType has succeeded
+inline ObjectID GetCachedScriptObjectIDAtIndex(CScriptArray* cached, asUINT index)
+{
+    asIScriptObject* obj = *static_cast<asIScriptObject**>(cached->At(index));
+    return *static_cast<ObjectID*>(obj->GetAddressOfProperty(0));
+}
+
 struct ComponentFindStatusForCache {
 
     ComponentFindStatusForCache(asIScriptObject* as) :
@@ -276,18 +269,52 @@ struct ComponentFindStatusForCache {
     bool IsScript;
 };
 
+//! \brief Containers used by ScriptSystemNodeHelper
+//!
+//! These are kept between calls to not allocate memory on each tick
+struct ScriptSystemNodeHelperData {
+
+    void Clear()
+    {
+        AddedCpp.clear();
+        AddedScript.clear();
+        RemovedCpp.clear();
+        RemovedScript.clear();
+        ExistingIDs.clear();
+        RemovedIDs.clear();
+    }
+
+    std::vector<std::tuple<void*, ObjectID, ComponentTypeInfo>> AddedCpp;
+    std::vector<std::tuple<asIScriptObject*, ObjectID, ScriptComponentHolder*>> AddedScript;
+    std::vector<std::tuple<void*, ObjectID>> RemovedCpp;
+    std::vector<std::tuple<asIScriptObject*, ObjectID>> RemovedScript;
+
+    //! IDs that are already in the cached components
+    std::unordered_set<ObjectID> ExistingIDs;
+
+    //! IDs of entities that have lost at least one of the needed components
+    std::unordered_set<ObjectID> RemovedIDs;
+
+    std::vector<ComponentFindStatusForCache> FoundComponents;
+
+    //! Set while the data is being used. Component factories could in theory run other
+    //! systems
+    bool InUse = false;
+};
 
 //! Helper for ScriptSystemNodeHelper
 //! \returns False if failed and a script exception was set
 inline bool TryToCreateNewCachedComponentsForEntity(ObjectID newentity, CScriptArray* cached,
-    asIScriptFunction* factoryfunc,
-    std::vector<std::tuple<void*, ObjectID, ComponentTypeInfo>>& addedcpp,
-    std::vector<std::tuple<asIScriptObject*, ObjectID, ScriptComponentHolder*>>& addedscript,
-    GameWorld* world, CScriptArray& systemcomponents, asIScriptContext* context,
-    ScriptExecutor* exec)
+    asIScriptFunction* factoryfunc, ScriptSystemNodeHelperData& data, GameWorld* world,
+    CScriptArray& systemcomponents, asIScriptContext* context, ScriptExecutor* exec)
 {
+    // Skip if already exists //
+    if(data.ExistingIDs.find(newentity) != data.ExistingIDs.end())
+        return true;
+
     // Find the needed components //
-    std::vector<ComponentFindStatusForCache> foundComponents;
+    auto& foundComponents = data.FoundComponents;
+    foundComponents.clear();
 
     const auto sysSize = systemcomponents.GetSize();
 
@@ -302,7 +329,7 @@ inline bool TryToCreateNewCachedComponentsForEntity(ObjectID newentity, CScriptA
         if(type->UsesName) {
 
             // First search added //
-            for(const auto& addedTuple : addedscript) {
+            for(const auto& addedTuple : data.AddedScript) {
 
                 if(std::get<1>(addedTuple) != newentity ||
                     std::get<2>(addedTuple)->ComponentType != type->Name)
@@ -343,7 +370,7 @@ inline bool TryToCreateNewCachedComponentsForEntity(ObjectID newentity, CScriptA
         } else {
 
             // First search added //
-            for(const auto& addedTuple : addedcpp) {
+            for(const auto& addedTuple : data.AddedCpp) {
 
                 if(std::get<1>(addedTuple) != newentity ||
                     std::get<2>(addedTuple).LeviathanType != type->Type)
@@ -376,25 +403,6 @@ inline bool TryToCreateNewCachedComponentsForEntity(ObjectID newentity, CScriptA
         }
     }
 
-    // Skip if already exists //
-    bool exists = false;
-
-    for(asUINT i = 0; i < cached->GetSize(); ++i) {
-
-        ObjectID currentID;
-        if(!GetCachedScriptObjectIDAtIndex(cached, i, context, exec, currentID))
-            return false;
-
-        if(currentID == newentity) {
-
-            exists = true;
-            break;
-        }
-    }
-
-    if(exists)
-        return true;
-
     // Call factory to create it //
     auto scriptRunInfo = exec->PrepareCustomScriptRun(factoryfunc);
 
@@ -453,39 +461,18 @@ inline bool TryToCreateNewCachedComponentsForEntity(ObjectID newentity, CScriptA
     // The array increments reference count
     // handle type so we need to give this a pointer to a pointer
     cached->InsertLast(&result.Value);
+    data.ExistingIDs.insert(newentity);
     return true;
 }
 
-DLLEXPORT void Leviathan::ScriptSystemNodeHelper(
-    GameWorld* world, void* cachedcomponents, int cachedtypeid, CScriptArray& systemcomponents)
+//! \brief Applies the added and removed components in data to cachedcomponents
+//!
+//! Helper for ScriptSystemNodeHelper. Sets an exception on context on error
+static void ScriptSystemNodeHelperUpdate(GameWorld* world, void* cachedcomponents,
+    int cachedtypeid, CScriptArray& systemcomponents, ScriptSystemNodeHelperData& data,
+    asIScriptContext* context, ScriptExecutor* exec)
 {
-    asIScriptContext* context = asGetActiveContext();
-
-    if(!context)
-        throw InvalidState(
-            "ScriptSystemNodeHelper: not called from a script function (no active context)");
-
-    if(!world) {
-
-        context->SetException("ScriptSystemNodeHelper: world reference is null");
-        return;
-    }
-
     auto* engine = context->GetEngine();
-    auto* exec = static_cast<ScriptExecutor*>(engine->GetUserData());
-
-    // Verify types //
-    const auto elementID = systemcomponents.GetElementTypeId();
-    const auto wantedID = AngelScriptTypeIDResolver<ScriptSystemUses>::Get(exec);
-
-    if(elementID != wantedID) {
-
-        context->SetException(("expected systemcomponents array to hold objects of type " +
-                               std::to_string(wantedID) + " but it contains type " +
-                               std::to_string(elementID))
-                                  .c_str());
-        return;
-    }
 
     // And then the harder to verify the one that can be anything //
     asITypeInfo* givenComponentsType = engine->GetTypeInfoById(cachedtypeid);
@@ -524,32 +511,11 @@ DLLEXPORT void Leviathan::ScriptSystemNodeHelper(
         return;
     }
 
-    std::vector<std::tuple<void*, ObjectID, ComponentTypeInfo>> addedCpp;
-    std::vector<std::tuple<asIScriptObject*, ObjectID, ScriptComponentHolder*>> addedScript;
-    std::vector<std::tuple<void*, ObjectID>> removedCpp;
-    std::vector<std::tuple<asIScriptObject*, ObjectID>> removedScript;
-
-    // Get all the added and removed at once //
-    // TODO: Might be more cache efficient to first get all added c++ and then all added script
-    // and then move on to the removed ones
-    for(asUINT i = 0; i < systemcomponents.GetSize(); ++i) {
-
-        ScriptSystemUses* type = static_cast<ScriptSystemUses*>(systemcomponents.At(i));
-
-        if(type->UsesName) {
-
-            world->GetAddedForScriptDefined(type->Name, addedScript);
-            world->GetRemovedForScriptDefined(type->Name, removedScript);
-
-        } else {
-
-            world->GetAddedFor(static_cast<COMPONENT_TYPE>(type->Type), addedCpp);
-            world->GetRemovedFor(static_cast<COMPONENT_TYPE>(type->Type), removedCpp);
-        }
-    }
+    if(!VerifyCachedScriptObjectType(cacheclass, context, exec))
+        return;
 
     // Only do more checks if something has changed //
-    if(!addedCpp.empty() || !addedScript.empty()) {
+    if(!data.AddedCpp.empty() || !data.AddedScript.empty()) {
 
         // Handle added like in TupleCachedComponentCollectionHelper //
 
@@ -579,69 +545,43 @@ DLLEXPORT void Leviathan::ScriptSystemNodeHelper(
             return;
         }
 
+        // Look up the existing ones once instead of searching the array for each entity
+        for(asUINT i = 0; i < cached->GetSize(); ++i)
+            data.ExistingIDs.insert(GetCachedScriptObjectIDAtIndex(cached, i));
 
         // For sanity reasons this is split into a helper which goes through all of the added
-        // vectors again trying to build an enity of the ID
-        for(const auto& tuple : addedCpp) {
+        // vectors again trying to build an enity of the ID. Entities that are in both are
+        // skipped the second time as they are in ExistingIDs
+        for(const auto& tuple : data.AddedCpp) {
 
             if(!TryToCreateNewCachedComponentsForEntity(std::get<1>(tuple), cached,
-                   factoryFunc, addedCpp, addedScript, world, systemcomponents, context, exec))
+                   factoryFunc, data, world, systemcomponents, context, exec))
                 return;
         }
 
-        for(const auto& tuple : addedScript) {
-
-            // Skip if already checked //
-            bool inCpp = false;
-            for(const auto& alreadyDone : addedCpp) {
-
-                if(std::get<1>(tuple) == std::get<1>(alreadyDone)) {
-
-                    inCpp = true;
-                    break;
-                }
-            }
-
-            if(inCpp)
-                continue;
+        for(const auto& tuple : data.AddedScript) {
 
             if(!TryToCreateNewCachedComponentsForEntity(std::get<1>(tuple), cached,
-                   factoryFunc, addedCpp, addedScript, world, systemcomponents, context, exec))
+                   factoryFunc, data, world, systemcomponents, context, exec))
                 return;
         }
     }
 
-    if(!removedCpp.empty() || !removedScript.empty()) {
+    if(!data.RemovedCpp.empty() || !data.RemovedScript.empty()) {
         // And deleted like in any system that does CachedComponents.RemoveBasedOnKeyTupleList
 
-        // Cheaper to query each object only once about their id //
-        for(asUINT i = 0; i < cached->GetSize();) {
-
-            ObjectID currentID;
-            if(!GetCachedScriptObjectIDAtIndex(cached, i, context, exec, currentID))
-                return;
-
-            bool remove = false;
+        for(const auto& tuple : data.RemovedCpp)
+            data.RemovedIDs.insert(std::get<1>(tuple));
 
-            for(const auto& tuple : removedCpp) {
+        for(const auto& tuple : data.RemovedScript)
+            data.RemovedIDs.insert(std::get<1>(tuple));
 
-                if(std::get<1>(tuple) == currentID) {
-                    remove = true;
-                    break;
-                }
-            }
+        // Cheaper to query each object only once about their id //
+        for(asUINT i = 0; i < cached->GetSize();) {
 
-            if(!remove) {
-                for(const auto& tuple : removedScript) {
+            const ObjectID currentID = GetCachedScriptObjectIDAtIndex(cached, i);
 
-                    if(std::get<1>(tuple) == currentID) {
-                        remove = true;
-                        break;
-                    }
-                }
-            }
-
-            if(!remove) {
+            if(data.RemovedIDs.find(currentID) == data.RemovedIDs.end()) {
                 ++i;
                 continue;
             }
@@ -654,3 +594,76 @@ DLLEXPORT void Leviathan::ScriptSystemNodeHelper(
         }
     }
 }
+
+DLLEXPORT void Leviathan::ScriptSystemNodeHelper(
+    GameWorld* world, void* cachedcomponents, int cachedtypeid, CScriptArray& systemcomponents)
+{
+    asIScriptContext* context = asGetActiveContext();
+
+    if(!context)
+        throw InvalidState(
+            "ScriptSystemNodeHelper: not called from a script function (no active context)");
+
+    if(!world) {
+
+        context->SetException("ScriptSystemNodeHelper: world reference is null");
+        return;
+    }
+
+    auto* engine = context->GetEngine();
+    auto* exec = static_cast<ScriptExecutor*>(engine->GetUserData());
+
+    // Verify types //
+    const auto elementID = systemcomponents.GetElementTypeId();
+    const auto wantedID = AngelScriptTypeIDResolver<ScriptSystemUses>::Get(exec);
+
+    if(elementID != wantedID) {
+
+        context->SetException(("expected systemcomponents array to hold objects of type " +
+                               std::to_string(wantedID) + " but it contains type " +
+                               std::to_string(elementID))
+                                  .c_str());
+        return;
+    }
+
+    // This is called for each script system every tick so the containers are reused
+    static thread_local ScriptSystemNodeHelperData sharedData;
+
+    ScriptSystemNodeHelperData nestedData;
+    ScriptSystemNodeHelperData& data = sharedData.InUse ? nestedData : sharedData;
+
+    data.Clear();
+    data.InUse = true;
+
+    // Get all the added and removed at once //
+    // TODO: Might be more cache efficient to first get all added c++ and then all added script
+    // and then move on to the removed ones
+    for(asUINT i = 0; i < systemcomponents.GetSize(); ++i) {
+
+        ScriptSystemUses* type = static_cast<ScriptSystemUses*>(systemcomponents.At(i));
+
+        if(type->UsesName) {
+
+            world->GetAddedForScriptDefined(type->Name, data.AddedScript);
+            world->GetRemovedForScriptDefined(type->Name, data.RemovedScript);
+
+        } else {
+
+            world->GetAddedFor(static_cast<COMPONENT_TYPE>(type->Type), data.AddedCpp);
+            world->GetRemovedFor(static_cast<COMPONENT_TYPE>(type->Type), data.RemovedCpp);
+        }
+    }
+
+    // Most ticks don't add or remove anything so the rest of the checks can be skipped
+    if(data.AddedCpp.empty() && data.AddedScript.empty() && data.RemovedCpp.empty() &&
+        data.RemovedScript.empty()) {
+
+        data.InUse = false;
+        return;
+    }
+
+    ScriptSystemNodeHelperUpdate(
+        world, cachedcomponents, cachedtypeid, systemcomponents, data, context, exec);
+
+    data.InUse = false;
+}
@@ -4,6 +4,8 @@
 #include "Define.h"
 //! \file Wraps an angelscript object for use as a script defined system by GameWorld
 // ------------------------------------ //
+#include "Statistics/Profiler.h"
+
 
 class asIScriptObject;
 class asIScriptFunction;
@@ -13,6 +15,9 @@ namespace Leviathan {
 
 class GameWorld;
 
+template<typename ReturnT, class... Args>
+class PreparedScriptCall;
+
 //! \brief Holds a single component type from c++ or from script, which a ScriptSystem uses
 struct ScriptSystemUses {
 
@@ -82,14 +87,23 @@ protected:
     //! CreateAndDestroyNodesMethod)
     DLLEXPORT void _ReleaseCachedFunctions();
 
+    //! \brief Prepares call for methodname if not done already
+    //! \returns False if the method doesn't exist
+    DLLEXPORT bool _PrepareMethod(
+        std::unique_ptr<PreparedScriptCall<void>>& call, const char* methodname);
+
 private:
     //! This is the actual implementation of this system in angelscript
     //! This is reference counted so make sure to release the reference
     asIScriptObject* ImplementationObject;
 
-    // Cached methods for performance reasons
-    asIScriptFunction* RunMethod = nullptr;
-    asIScriptFunction* CreateAndDestroyNodesMethod = nullptr;
+    // Cached methods for performance reasons. These are called every tick so they keep their
+    // contexts prepared
+    std::unique_ptr<PreparedScriptCall<void>> RunMethod;
+    std::unique_ptr<PreparedScriptCall<void>> CreateAndDestroyNodesMethod;
+
+    //! Zone for profiling Run, named after this system
+    const ProfilerZoneID RunZone;
 };
 
 } // namespace Leviathan
@@ -6,56 +6,59 @@
 #include "Common/ObjectPool.h"
 #include "Common/SFMLPackets.h"
 #include "EntityCommon.h"
+#include "Exceptions.h"
 
-#include <array>
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <vector>
 
 namespace Leviathan {
 
-//! Number of states that are kept. Corresponds to time span of TICKSPEED * KEPT_STATES_COUNT
+//! Default number of states that are kept. Corresponds to time span of
+//! TICKSPEED * KEPT_STATES_COUNT
 constexpr auto KEPT_STATES_COUNT = 5;
 
 template<class StateT>
 class StateHolder;
 
-//! \brief Holds state objects of type StateT related to a single entity
+//! \brief Accesses the state slots of a single entity in a StateHolder
+//!
+//! Keeps the states with the newest ticks. States aren't created on every tick so a new
+//! state replaces the oldest one instead of going to a slot picked by its tick. Looking up
+//! a tick searches the tightly packed tick numbers of the slots
+//! \warning The returned state pointers are invalidated when states are added for a new
+//! entity. Store tick numbers instead
 template<class StateT>
 class ObjectsComponentStates {
 public:
+    ObjectsComponentStates(StateHolder<StateT>& owner, size_t firstslot) :
+        Owner(owner), FirstSlot(firstslot)
+    {}
+
     //! \brief Returns the state with the highest tick number
     StateT* GetNewest() const
     {
-        StateT* newest = nullptr;
-        int newestTick = 0;
-
-        for(StateT* state : StoredStates) {
-
-            if(state && state->TickNumber >= newestTick) {
-
-                newest = state;
-                newestTick = state->TickNumber;
-            }
-        }
+        if(NewestTick == -1)
+            return nullptr;
 
-        return newest;
+        return &Owner.States[NewestSlot];
     }
 
     //! \brief Returns the state with the lowest tick number
     StateT* GetOldest() const
     {
-        StateT* oldest = nullptr;
-        int oldestTick = std::numeric_limits<int>::max();
+        const int32_t* ticks = &Owner.Ticks[FirstSlot];
 
-        for(StateT* state : StoredStates) {
+        int32_t oldestTick = std::numeric_limits<int32_t>::max();
 
-            if(state && state->TickNumber <= oldestTick) {
+        for(size_t i = 0; i < Owner.HistorySize; ++i) {
 
-                oldest = state;
-                oldestTick = state->TickNumber;
-            }
+            if(ticks[i] != -1 && ticks[i] < oldestTick)
+                oldestTick = ticks[i];
         }
 
-        return oldest;
+        return GetState(oldestTick);
     }
 
     //! \brief Returns the state matching the tick number or the
@@ -66,115 +69,130 @@ public:
     //! the later state
     StateT* GetMatchingOrNewer(int ticknumber) const
     {
-        StateT* closest = nullptr;
-        int closestBy = std::numeric_limits<int>::max();
-
-        for(StateT* state : StoredStates) {
-
-            if(!state || state->TickNumber < ticknumber)
-                continue;
+        if(StateT* matching = GetState(ticknumber); matching)
+            return matching;
 
-            if(state->TickNumber == ticknumber) {
+        const int32_t* ticks = &Owner.Ticks[FirstSlot];
 
-                return state;
-            }
+        int32_t closestTick = std::numeric_limits<int32_t>::max();
 
-            const auto difference = state->TickNumber - ticknumber;
-            if(difference <= closestBy) {
+        for(size_t i = 0; i < Owner.HistorySize; ++i) {
 
-                closestBy = difference;
-                closest = state;
-            }
+            if(ticks[i] > ticknumber && ticks[i] < closestTick)
+                closestTick = ticks[i];
         }
 
-        return closest;
+        return GetState(closestTick);
     }
 
     //! \brief Returns state matching tick number
     StateT* GetState(int ticknumber) const
     {
-        for(StateT* state : StoredStates) {
+        if(ticknumber < 0 || ticknumber > NewestTick)
+            return nullptr;
+
+        const int32_t* ticks = &Owner.Ticks[FirstSlot];
 
-            if(state && state->TickNumber == ticknumber)
-                return state;
+        for(size_t i = 0; i < Owner.HistorySize; ++i) {
+
+            if(ticks[i] == ticknumber)
+                return &Owner.States[FirstSlot + i];
         }
 
         return nullptr;
     }
 
-    //! \brief Returns true if state is still valid
-    bool IsStateValid(StateT* statetocheck) const
+    //! \brief Stores a new state replacing the state with the same tick, or if there isn't
+    //! one, the oldest state once the history is full
+    //! \returns The stored state or null if the history is full of newer states. In that
+    //! case newstate is too old to fit in the history
+    StateT* Append(StateT&& newstate)
     {
-        for(StateT* state : StoredStates) {
-            if(state == statetocheck)
-                return true;
-        }
+        const int32_t tick = newstate.TickNumber;
 
-        return false;
-    }
+        if(tick < 0)
+            return nullptr;
 
-    //! \brief Appends a new state removing old states if they don't fit anymore
-    //! \todo It is probably more efficient to use a swap algorithm for ading new states
-    //! instead of this
-    void Append(StateT* newstate, StateHolder<StateT>& stateowner)
-    {
-        // Fill from the back and pop from the front if states don't fit //
+        const int32_t* ticks = &Owner.Ticks[FirstSlot];
 
-        // This would only speed up the first added state, so maybe the performance
-        // is better if we skip this check
-        // if(StoredStates[KEPT_STATES_COUNT - 1] == nullptr){
+        // Empty slots have tick -1 so they are used before any state is replaced
+        size_t target = 0;
 
-        //     StoredStates[KEPT_STATES_COUNT - 1] = newstate;
-        //     return;
-        // }
+        for(size_t i = 0; i < Owner.HistorySize; ++i) {
 
-        // First state will be popped off if it exists //
-        if(StoredStates[0] != nullptr) {
+            if(ticks[i] == tick) {
+                target = i;
+                break;
+            }
 
-            stateowner._DestroyStateObject(StoredStates[0]);
+            if(ticks[i] < ticks[target])
+                target = i;
         }
 
-        for(size_t i = 0; i < KEPT_STATES_COUNT - 1; ++i) {
+        if(ticks[target] > tick)
+            return nullptr;
+
+        const size_t slot = FirstSlot + target;
 
-            StoredStates[i] = StoredStates[i + 1];
+        Owner.Ticks[slot] = tick;
+        Owner.States[slot] = std::move(newstate);
+
+        if(tick >= NewestTick) {
+            NewestTick = tick;
+            NewestSlot = slot;
         }
 
-        StoredStates[KEPT_STATES_COUNT - 1] = newstate;
+        return &Owner.States[slot];
     }
 
     //! \brief Counts the filled number of state slots
-    //! \returns A number in range [0, KEPT_STATES_COUNT]
+    //! \returns A number in range [0, StateHolder::GetHistorySize()]
     auto GetNumberOfStates() const
     {
+        const int32_t* ticks = &Owner.Ticks[FirstSlot];
+
         int count = 0;
 
-        for(StateT* state : StoredStates) {
+        for(size_t i = 0; i < Owner.HistorySize; ++i) {
 
-            if(state)
+            if(ticks[i] != -1)
                 ++count;
         }
 
         return count;
     }
 
+    inline int32_t GetNewestTick() const
+    {
+        return NewestTick;
+    }
+
 protected:
-    std::array<StateT*, KEPT_STATES_COUNT> StoredStates;
+    StateHolder<StateT>& Owner;
+
+    //! Index of the first slot of this entity in the arrays of Owner
+    const size_t FirstSlot;
+
+    int32_t NewestTick = -1;
+
+    //! Index of the newest state in the arrays of Owner, valid when NewestTick isn't -1
+    size_t NewestSlot = 0;
 };
 
 //! \brief Holds state objects of type for quick access by ObjectID
+//!
+//! The states of all entities are stored inline in one array, with the tick numbers of the
+//! slots in a separate array, so that finding states only touches the tightly packed ticks
 //! \todo The GameWorld needs to notify this when ObjectID is deleted
 template<class StateT>
 class StateHolder {
     friend ObjectsComponentStates<StateT>;
 
 public:
-    StateHolder() {}
-
-    ~StateHolder()
-    {
-        // Both of the pools are released here so the destructor of ObjectsComponentStates
-        // doesn't need to notify us of the states it held
-    }
+    //! \param historysize How many ticks of states are kept for each entity
+    StateHolder(size_t historysize = KEPT_STATES_COUNT) :
+        HistorySize(std::max<size_t>(historysize, 1))
+    {}
 
     //! \brief Creates a new state for entity's component if it has changed
     //! \returns True if a new state was created
@@ -186,25 +204,17 @@ public:
         // Get latest state to compare current values against //
         StateT* latestState = entityStates->GetNewest();
 
-        // If empty always create //
-        if(!latestState) {
-
-            StateT* newState = _CreateNewState(ticknumber, component);
-            entityStates->Append(newState, *this);
-            return true;
-        }
-
-        // Check is the latest state still correct //
-        if(latestState->DoesMatchState(component))
+        // If not empty check is the latest state still correct //
+        if(latestState && latestState->DoesMatchState(component))
             return false;
 
         // Create a new state //
-        StateT* newState = _CreateNewState(ticknumber, component);
-        entityStates->Append(newState, *this);
-        return true;
+        return entityStates->Append(StateT(ticknumber, component)) != nullptr;
     }
 
     //! \brief Deserializes a state for entity's component from an archive
+    //! \exception InvalidState if the reference state is missing. The sender needs to send
+    //! a full state instead
     void DeserializeState(
         ObjectID id, int32_t ticknumber, sf::Packet& data, int32_t referencetick)
     {
@@ -215,6 +225,7 @@ public:
 
     //! \brief Deserializes a state for entity's component from an archive and applies it if it
     //! is the newest
+    //! \exception InvalidState if the reference state is missing
     template<class ComponentT>
     void DeserializeAndApplyState(ObjectID id, ComponentT& component, int32_t ticknumber,
         sf::Packet& data, int32_t referencetick)
@@ -226,7 +237,10 @@ public:
             this->_DeserializeState(entityStates, id, ticknumber, data, referencetick);
 
         if(!deserialized) {
-            LOG_ERROR("StateHolder: failed to deserialize state");
+            LOG_WARNING("StateHolder: DeserializeAndApplyState: received state is too old to "
+                        "be stored, received: " +
+                        std::to_string(ticknumber) +
+                        ", newest: " + std::to_string(entityStates->GetNewestTick()));
             return;
         }
 
@@ -237,12 +251,10 @@ public:
 
             component.ApplyState(*newest);
         } else {
-            int newestNumber = newest ? newest->TickNumber : -1;
-
             LOG_WARNING("StateHolder: DeserializeAndApplyState: received not the newest "
                         "packet, received: " +
                         std::to_string(deserialized->TickNumber) +
-                        ", newest: " + std::to_string(newestNumber));
+                        ", newest: " + std::to_string(entityStates->GetNewestTick()));
         }
     }
 
@@ -266,6 +278,11 @@ public:
         return StateObjects.Find(id);
     }
 
+    inline size_t GetHistorySize() const
+    {
+        return HistorySize;
+    }
+
 protected:
     inline StateT* _DeserializeState(ObjectsComponentStates<StateT>* entityStates, ObjectID id,
         int32_t ticknumber, sf::Packet& data, int32_t referencetick)
@@ -275,26 +292,21 @@ protected:
         if(referencetick != -1) {
             reference = entityStates->GetState(referencetick);
 
+            // A delta against some other state would decode into wrong values
             if(!reference) {
-
-                LOG_WARNING("StateHolder: DeserializeState: can't find reference tick: " +
-                            std::to_string(referencetick) +
-                            " for entity: " + std::to_string(id));
-
-                reference = entityStates->GetNewest();
+                throw InvalidState(
+                    "StateHolder: DeserializeState: can't find reference tick: " +
+                    std::to_string(referencetick) + " for entity: " + std::to_string(id));
             }
         }
 
         // Create a new state //
-        StateT* newState = _CreateNewState(reference, data);
+        StateT newState(reference, data);
 
         // This can't be deserialized from data so we forward it
-        newState->TickNumber = ticknumber;
+        newState.TickNumber = ticknumber;
 
-        // TODO: do we need to check whether the states already contain a state for this
-        // tick?
-        entityStates->Append(newState, *this);
-        return newState;
+        return entityStates->Append(std::move(newState));
     }
 
     inline ObjectsComponentStates<StateT>* GetStateFor(ObjectID id)
@@ -303,30 +315,26 @@ protected:
 
         if(!entityStates) {
 
-            entityStates = StateObjects.ConstructNew(id);
+            entityStates = StateObjects.ConstructNew(id, *this, Ticks.size());
+
+            Ticks.resize(Ticks.size() + HistorySize, -1);
+            States.resize(States.size() + HistorySize);
         }
 
         return entityStates;
     }
 
-    template<typename... Args>
-    StateT* _CreateNewState(Args&&... args)
-    {
-        return StatePool.ConstructNew(std::forward<Args>(args)...);
-    }
-
-    void _DestroyStateObject(StateT* state)
-    {
-        StatePool.Destroy(state);
-    }
-
 private:
-    //! Keeps track of states associated with an object
+    const size_t HistorySize;
+
+    //! Keeps track of the slots associated with an object
     ObjectPool<ObjectsComponentStates<StateT>, ObjectID> StateObjects;
 
-    //! All of the created StateT objects are held by this pool and
-    //! only referenced from StateObjects
-    BasicPool<StateT> StatePool;
+    //! Tick numbers of the states in the slots of all entities, -1 for empty slots
+    std::vector<int32_t> Ticks;
+
+    //! The states of all entities. HistorySize slots per entity in the same order as Ticks
+    std::vector<StateT> States;
 };
 
 } // namespace Leviathan
@@ -21,118 +21,159 @@ public:
         static std::tuple<bool, StateT> Interpolate(const StateHolder<StateT> &stateholder,
             ObjectID entity, ComponentT* entitycomponent, int currenttick, int timeintick)
     {
+        StateT* startState;
+        StateT* endState;
+        float progress;
+
+        if(!FindStates(stateholder, entity, entitycomponent, currenttick, timeintick,
+            startState, endState, progress))
+        {
+            return std::make_tuple(false, StateT());
+        }
+
+        if(!endState)
+            return std::make_tuple(true, *startState);
+
+        return std::make_tuple(true, startState->Interpolate(*endState, progress));
+    }
+
+    //! \brief Finds the states that component should be interpolated between without
+    //! copying them
+    //!
+    //! Updates the interpolation variables in the component the same way as Interpolate
+    //! \param endstate Set to null if startstate should be shown as is
+    //! \param progress Set to how far from startstate to endstate the result is
+    //! \returns False if there are no states
+    template<class StateT, class ComponentT>
+        static bool FindStates(const StateHolder<StateT> &stateholder, ObjectID entity,
+            ComponentT* entitycomponent, int currenttick, int timeintick, StateT*& startstate,
+            StateT*& endstate, float& progress)
+    {
+        endstate = nullptr;
+        progress = 0.f;
+
         // TODO: should this be stored in the component?
         auto* entitysStates = stateholder.GetEntityStates(entity);
 
         if(!entitysStates){
             // Probably shouldn't throw here to make the code that uses this simpler
             entitycomponent->StateMarked = false;
-            return std::make_tuple(false, StateT());
+            return false;
             //throw Leviathan::InvalidState("Interpolated entity has no states in StateHolder");
         }
 
-        // Find interpolation start spot //
-        if(!entitycomponent->InterpolatingStartState ||
-            !entitysStates->IsStateValid(entitycomponent->InterpolatingStartState))
-        {
-            entitycomponent->InterpolatingEndState = nullptr;
-            entitycomponent->InterpolatingStartState = entitysStates->GetOldest();
+        // We cast the time from int64_t to float (visual studio was giving warnings about 
+        // losing data here)
+        const float currentTime = static_cast<float>((currenttick * TICKSPEED) + timeintick);
 
-            if(!entitycomponent->InterpolatingStartState){
+        // Moves forward one state pair at a time until the pair containing currentTime
+        while(true){
 
-                // No states to interpolate //
-                entitycomponent->StateMarked = false;
-                return std::make_tuple(false, StateT());
-            }
+            // Find interpolation start spot //
+            startstate = entitysStates->GetState(entitycomponent->InterpolatingStartTick);
 
-            // Adjust clock if the initial tick has been changed //
-            if(entitycomponent->InterpolatingStartTime != 0.f){
+            if(!startstate)
+            {
+                entitycomponent->InterpolatingEndTick = -1;
+                startstate = entitysStates->GetOldest();
 
-                if(entitycomponent->InterpolatingRemoteStartTick !=
-                    entitycomponent->InterpolatingStartState->TickNumber)
-                {
-                    AdjustClock(entitycomponent);
+                if(!startstate){
+
+                    // No states to interpolate //
+                    entitycomponent->InterpolatingStartTick = -1;
+                    entitycomponent->StateMarked = false;
+                    return false;
+                }
+
+                entitycomponent->InterpolatingStartTick = startstate->TickNumber;
+
+                // Adjust clock if the initial tick has been changed //
+                if(entitycomponent->InterpolatingStartTime != 0.f){
+
+                    if(entitycomponent->InterpolatingRemoteStartTick !=
+                        entitycomponent->InterpolatingStartTick)
+                    {
+                        AdjustClock(entitycomponent);
+                    }
                 }
             }
-        }
 
-        // We cast the time from int64_t to float (visual studio was giving warnings about 
-        // losing data here)
-        const float currentTime = static_cast<float>((currenttick * TICKSPEED) + timeintick);
+            // Find ending state //
+            StateT* end = entitysStates->GetState(entitycomponent->InterpolatingEndTick);
 
-        // Find ending state //
-        if(!entitycomponent->InterpolatingEndState){
+            if(!end){
 
-            // TODO: should we only allow TickNumber + 2 states to be interpolated to
-            // as that is the way source engine does it and would avoid jitter if we miss
-            // one state packet later (use INTERPOLATION_TIME / TICKSPEED ?)
-            entitycomponent->InterpolatingEndState = entitysStates->GetMatchingOrNewer(
-                entitycomponent->InterpolatingStartState->TickNumber + 1);
+                // TODO: should we only allow TickNumber + 2 states to be interpolated to
+                // as that is the way source engine does it and would avoid jitter if we miss
+                // one state packet later (use INTERPOLATION_TIME / TICKSPEED ?)
+                end = entitysStates->GetMatchingOrNewer(
+                    entitycomponent->InterpolatingStartTick + 1);
 
-            if(!entitycomponent->InterpolatingEndState){
+                if(!end){
 
-                // No ending state found //
-                entitycomponent->StateMarked = false;
-                // Only one state should allow interpolating to the one available state
-                // with the same function so we return the first state here
-                //return std::make_tuple(false, StateT());
-                return std::make_tuple(true, *entitycomponent->InterpolatingStartState);
-            }
+                    // No ending state found //
+                    entitycomponent->InterpolatingEndTick = -1;
+                    entitycomponent->StateMarked = false;
+                    // Only one state should allow interpolating to the one available state
+                    // with the same function so the first state is used here
+                    return true;
+                }
+
+                entitycomponent->InterpolatingEndTick = end->TickNumber;
 
-            // Initialize the remote time counter if this is the first time we start
-            // interpolating
-            if(entitycomponent->InterpolatingStartTime == 0.f){
-                entitycomponent->InterpolatingStartTime = currentTime;
-                entitycomponent->InterpolatingRemoteStartTick =
-                    entitycomponent->InterpolatingStartState->TickNumber;
+                // Initialize the remote time counter if this is the first time we start
+                // interpolating
+                if(entitycomponent->InterpolatingStartTime == 0.f){
+                    entitycomponent->InterpolatingStartTime = currentTime;
+                    entitycomponent->InterpolatingRemoteStartTick =
+                        entitycomponent->InterpolatingStartTick;
+                }
             }
-        }
 
-        const float passed = currentTime - entitycomponent->InterpolatingStartTime;
+            const float passed = currentTime - entitycomponent->InterpolatingStartTime;
 
-        // TODO: do we need to check for currentTime < 0?
-        
-        if(passed <= EPSILON)
-            return std::make_tuple(true, *entitycomponent->InterpolatingStartState);
+            // TODO: do we need to check for currentTime < 0?
 
-        // Duration is clamped to INTERPOLATION_TIME to make entities
-        // that have stopped moving not take a ridiculously long time
-        // to move to their new positions
-        const auto duration = std::min((
-            entitycomponent->InterpolatingEndState->TickNumber -
-            entitycomponent->InterpolatingStartState->TickNumber) * TICKSPEED,
-            INTERPOLATION_TIME);
-        
-        if(passed == duration)
-            return std::make_tuple(true, *entitycomponent->InterpolatingEndState);
+            if(passed <= EPSILON)
+                return true;
 
-        // Check for having finished interpolating //
-        if(passed > duration){
+            // Duration is clamped to INTERPOLATION_TIME to make entities
+            // that have stopped moving not take a ridiculously long time
+            // to move to their new positions
+            const auto duration = std::min((
+                entitycomponent->InterpolatingEndTick -
+                entitycomponent->InterpolatingStartTick) * TICKSPEED,
+                INTERPOLATION_TIME);
 
-            entitycomponent->InterpolatingStartState = entitycomponent->InterpolatingEndState;
-            entitycomponent->InterpolatingEndState = nullptr;
+            if(passed == duration){
 
-            AdjustClock(entitycomponent);
+                startstate = end;
+                return true;
+            }
+
+            if(passed < duration){
 
-            // We need to recurse to get the correct interpolation state //
-            return Interpolate(stateholder, entity, entitycomponent, currenttick, timeintick);
+                endstate = end;
+                progress = passed / duration;
+                return true;
+            }
+
+            // Finished interpolating, continue from the end state //
+            entitycomponent->InterpolatingStartTick = entitycomponent->InterpolatingEndTick;
+            entitycomponent->InterpolatingEndTick = -1;
+
+            AdjustClock(entitycomponent);
         }
-        
-        const float progress = passed / duration;
-        
-        return std::make_tuple(true, entitycomponent->InterpolatingStartState->Interpolate(
-                *entitycomponent->InterpolatingEndState, progress));
     }
 
     template<class ComponentT>
         static void AdjustClock(ComponentT &entitycomponent)
     {
-        const auto difference = entitycomponent->InterpolatingStartState->TickNumber
+        const auto difference = entitycomponent->InterpolatingStartTick
             - entitycomponent->InterpolatingRemoteStartTick;
 
         entitycomponent->InterpolatingStartTime += difference * TICKSPEED;
-        entitycomponent->InterpolatingRemoteStartTick =
-            entitycomponent->InterpolatingStartState->TickNumber;
+        entitycomponent->InterpolatingRemoteStartTick = entitycomponent->InterpolatingStartTick;
     }
     
 };
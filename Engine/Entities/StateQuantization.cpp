@@ -0,0 +1,497 @@
+// ------------------------------------ //
+#include "StateQuantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace Leviathan;
+// ------------------------------------ //
+namespace {
+
+constexpr int MAX_POSITION_BITS = 30;
+constexpr int MAX_ROTATION_BITS = 30;
+
+//! The three smallest quaternion components are between these
+constexpr double ROTATION_COMPONENT_LIMIT = 0.70710678118654752440;
+
+inline double GetAxis(const Float3& value, int axis)
+{
+    return axis == 0 ? value.X : (axis == 1 ? value.Y : value.Z);
+}
+
+inline double GetComponent(const Float4& value, int index)
+{
+    switch(index) {
+    case 0: return value.X;
+    case 1: return value.Y;
+    case 2: return value.Z;
+    default: return value.W;
+    }
+}
+
+//! \brief Picks the position step and the bits that are needed for the whole bounds
+void CalculatePositionStep(const StateQuantizationSettings& settings, double& step, int& bits)
+{
+    double largestRange = 0;
+    double largestMagnitude = 0;
+
+    for(int axis = 0; axis < 3; ++axis) {
+
+        const double min = GetAxis(settings.WorldMin, axis);
+        const double max = GetAxis(settings.WorldMax, axis);
+
+        largestRange = std::max(largestRange, max - min);
+        largestMagnitude = std::max({largestMagnitude, std::abs(min), std::abs(max)});
+    }
+
+    // The error is at most half of a step
+    step = 2.0 * std::max(static_cast<double>(settings.PositionPrecision), 0.0);
+
+    // The receiver stores the dequantized values as floats and must be able to quantize them
+    // back to the same values for the changes from reference states to work
+    step = std::max(step, 4.0 * largestMagnitude * std::numeric_limits<float>::epsilon());
+    step = std::max(step, static_cast<double>(std::numeric_limits<float>::min()));
+
+    bits = 0;
+
+    while(bits < MAX_POSITION_BITS &&
+          static_cast<double>((uint64_t(1) << bits) - 1) * step < largestRange) {
+        ++bits;
+    }
+
+    if(static_cast<double>((uint64_t(1) << bits) - 1) * step < largestRange)
+        step = largestRange / static_cast<double>((uint64_t(1) << bits) - 1);
+}
+
+inline uint32_t GetRotationMaxValue()
+{
+    return static_cast<uint32_t>(
+        (uint64_t(1) << StateQuantization::GetSettings().RotationBits) - 1);
+}
+
+template<typename T>
+inline bool WriteChangedBit(BitWriter& writer, bool changed, const T* reference)
+{
+    if(!reference)
+        return true;
+
+    writer.WriteBool(changed);
+    return changed;
+}
+
+//! \returns False if the value is unchanged from reference and has been copied
+template<typename T>
+inline bool ReadChangedBit(BitReader& reader, T& value, const T* reference)
+{
+    if(!reference)
+        return true;
+
+    if(reader.ReadBool())
+        return true;
+
+    value = *reference;
+    return false;
+}
+
+} // namespace
+
+StateQuantizationSettings StateQuantization::Settings;
+int StateQuantization::PositionBits = 0;
+double StateQuantization::PositionStep = 0;
+
+// Derived values for the default settings
+static const bool DefaultQuantizationApplied = [] {
+    StateQuantization::SetSettings(StateQuantizationSettings());
+    return true;
+}();
+// ------------------------------------ //
+DLLEXPORT void StateQuantization::SetSettings(const StateQuantizationSettings& settings)
+{
+    Settings = settings;
+
+    Settings.RotationBits = std::min(std::max(Settings.RotationBits, 2), MAX_ROTATION_BITS);
+    Settings.PositionDeltaBits =
+        std::min(std::max(Settings.PositionDeltaBits, 2), MAX_POSITION_BITS);
+
+    CalculatePositionStep(Settings, PositionStep, PositionBits);
+
+    Settings.PositionPrecision = static_cast<float>(PositionStep / 2);
+}
+
+DLLEXPORT const StateQuantizationSettings& StateQuantization::GetSettings()
+{
+    return Settings;
+}
+
+DLLEXPORT int StateQuantization::GetPositionBits()
+{
+    return PositionBits;
+}
+
+DLLEXPORT float StateQuantization::GetPositionMaxError()
+{
+    return static_cast<float>(PositionStep / 2);
+}
+
+DLLEXPORT float StateQuantization::GetRotationMaxError()
+{
+    // The sent components are off by at most half a step. The rebuilt largest component is at
+    // least 0.5 which makes its error at most three times that
+    return static_cast<float>(3 * ROTATION_COMPONENT_LIMIT / GetRotationMaxValue());
+}
+// ------------------------------------ //
+DLLEXPORT bool StateQuantization::QuantizePosition(
+    const Float3& position, uint32_t quantized[3])
+{
+    const auto maxValue = static_cast<int64_t>((uint64_t(1) << PositionBits) - 1);
+
+    for(int axis = 0; axis < 3; ++axis) {
+
+        const double value = GetAxis(position, axis);
+
+        if(!std::isfinite(value))
+            return false;
+
+        const double scaled = (value - GetAxis(Settings.WorldMin, axis)) / PositionStep;
+
+        if(scaled < -0.5 || scaled > maxValue + 0.5)
+            return false;
+
+        const auto rounded = static_cast<int64_t>(std::llround(scaled));
+
+        if(rounded < 0 || rounded > maxValue)
+            return false;
+
+        quantized[axis] = static_cast<uint32_t>(rounded);
+    }
+
+    return true;
+}
+
+DLLEXPORT Float3 StateQuantization::DequantizePosition(const uint32_t quantized[3])
+{
+    return Float3(static_cast<float>(Settings.WorldMin.X + quantized[0] * PositionStep),
+        static_cast<float>(Settings.WorldMin.Y + quantized[1] * PositionStep),
+        static_cast<float>(Settings.WorldMin.Z + quantized[2] * PositionStep));
+}
+
+DLLEXPORT QuantizedQuaternion StateQuantization::QuantizeRotation(const Float4& rotation)
+{
+    double components[4];
+    double length = 0;
+
+    for(int i = 0; i < 4; ++i) {
+        components[i] = GetComponent(rotation, i);
+        length += components[i] * components[i];
+    }
+
+    QuantizedQuaternion result;
+
+    length = std::sqrt(length);
+
+    // Invalid rotations are sent as the identity
+    if(!std::isfinite(length) || length < 1e-6)
+        return result;
+
+    int largest = 0;
+
+    for(int i = 1; i < 4; ++i) {
+        if(std::abs(components[i]) > std::abs(components[largest]))
+            largest = i;
+    }
+
+    // q and -q are the same rotation so the largest can always be made positive and isn't
+    // needed to be sent
+    const double sign = components[largest] < 0 ? -1.0 : 1.0;
+    const double maxValue = GetRotationMaxValue();
+
+    result.Largest = static_cast<uint8_t>(largest);
+
+    int target = 0;
+
+    for(int i = 0; i < 4; ++i) {
+
+        if(i == largest)
+            continue;
+
+        const double normalized = std::min(
+            std::max(sign * components[i] / length, -ROTATION_COMPONENT_LIMIT),
+            ROTATION_COMPONENT_LIMIT);
+
+        result.Values[target++] = static_cast<uint32_t>(std::llround(
+            (normalized + ROTATION_COMPONENT_LIMIT) / (2 * ROTATION_COMPONENT_LIMIT) *
+            maxValue));
+    }
+
+    return result;
+}
+
+DLLEXPORT Float4 StateQuantization::DequantizeRotation(const QuantizedQuaternion& quantized)
+{
+    double components[4];
+    double sum = 0;
+    const double maxValue = GetRotationMaxValue();
+
+    int source = 0;
+
+    for(int i = 0; i < 4; ++i) {
+
+        if(i == quantized.Largest)
+            continue;
+
+        components[i] = quantized.Values[source++] / maxValue * 2 * ROTATION_COMPONENT_LIMIT -
+                        ROTATION_COMPONENT_LIMIT;
+        sum += components[i] * components[i];
+    }
+
+    components[quantized.Largest] = std::sqrt(std::max(1.0 - sum, 0.0));
+
+    // Normalizing again spreads the error from rounding
+    const double length = std::sqrt(sum + components[quantized.Largest] *
+                                              components[quantized.Largest]);
+
+    return Float4(static_cast<float>(components[0] / length),
+        static_cast<float>(components[1] / length), static_cast<float>(components[2] / length),
+        static_cast<float>(components[3] / length));
+}
+// ------------------------------------ //
+DLLEXPORT void StateQuantization::WriteField(BitWriter& writer, const Float3& value,
+    const Float3* reference, STATE_QUANTIZATION quantization)
+{
+    if(quantization != STATE_QUANTIZATION::Position) {
+
+        if(!WriteChangedBit(writer, reference && value != *reference, reference))
+            return;
+
+        writer.WriteFloat(value.X);
+        writer.WriteFloat(value.Y);
+        writer.WriteFloat(value.Z);
+        return;
+    }
+
+    uint32_t quantized[3];
+    const bool inBounds = QuantizePosition(value, quantized);
+
+    if(reference) {
+
+        uint32_t referenceQuantized[3];
+        const bool referenceInBounds = QuantizePosition(*reference, referenceQuantized);
+
+        bool changed;
+
+        if(inBounds != referenceInBounds) {
+            changed = true;
+        } else if(inBounds) {
+            changed = quantized[0] != referenceQuantized[0] ||
+                      quantized[1] != referenceQuantized[1] ||
+                      quantized[2] != referenceQuantized[2];
+        } else {
+            changed = value != *reference;
+        }
+
+        writer.WriteBool(changed);
+
+        if(!changed)
+            return;
+
+        // Small movements are sent as the change from the reference. The receiver only knows
+        // whether the reference is inside the bounds so this needs to be written even when
+        // the new position is outside them
+        if(referenceInBounds) {
+
+            const int64_t limit = int64_t(1) << (Settings.PositionDeltaBits - 1);
+
+            int64_t deltas[3];
+            bool fits = inBounds;
+
+            for(int axis = 0; fits && axis < 3; ++axis) {
+
+                deltas[axis] = static_cast<int64_t>(quantized[axis]) -
+                               static_cast<int64_t>(referenceQuantized[axis]);
+
+                if(deltas[axis] < -limit || deltas[axis] >= limit)
+                    fits = false;
+            }
+
+            writer.WriteBool(fits);
+
+            if(fits) {
+
+                for(int axis = 0; axis < 3; ++axis) {
+                    writer.WriteSigned(
+                        static_cast<int32_t>(deltas[axis]), Settings.PositionDeltaBits);
+                }
+
+                return;
+            }
+        }
+    }
+
+    writer.WriteBool(inBounds);
+
+    if(inBounds) {
+
+        for(int axis = 0; axis < 3; ++axis)
+            writer.Write(quantized[axis], PositionBits);
+
+    } else {
+
+        writer.WriteFloat(value.X);
+        writer.WriteFloat(value.Y);
+        writer.WriteFloat(value.Z);
+    }
+}
+
+DLLEXPORT void StateQuantization::ReadField(BitReader& reader, Float3& value,
+    const Float3* reference, STATE_QUANTIZATION quantization)
+{
+    if(quantization != STATE_QUANTIZATION::Position) {
+
+        if(!ReadChangedBit(reader, value, reference))
+            return;
+
+        value.X = reader.ReadFloat();
+        value.Y = reader.ReadFloat();
+        value.Z = reader.ReadFloat();
+        return;
+    }
+
+    if(!ReadChangedBit(reader, value, reference))
+        return;
+
+    if(reference) {
+
+        uint32_t referenceQuantized[3];
+
+        if(QuantizePosition(*reference, referenceQuantized) && reader.ReadBool()) {
+
+            uint32_t quantized[3];
+
+            for(int axis = 0; axis < 3; ++axis) {
+                quantized[axis] = static_cast<uint32_t>(
+                    static_cast<int64_t>(referenceQuantized[axis]) +
+                    reader.ReadSigned(Settings.PositionDeltaBits));
+            }
+
+            value = DequantizePosition(quantized);
+            return;
+        }
+    }
+
+    if(reader.ReadBool()) {
+
+        uint32_t quantized[3];
+
+        for(int axis = 0; axis < 3; ++axis)
+            quantized[axis] = reader.Read(PositionBits);
+
+        value = DequantizePosition(quantized);
+
+    } else {
+
+        value.X = reader.ReadFloat();
+        value.Y = reader.ReadFloat();
+        value.Z = reader.ReadFloat();
+    }
+}
+// ------------------------------------ //
+DLLEXPORT void StateQuantization::WriteField(BitWriter& writer, const Float4& value,
+    const Float4* reference, STATE_QUANTIZATION quantization)
+{
+    if(quantization != STATE_QUANTIZATION::Rotation) {
+
+        if(!WriteChangedBit(writer, reference && value != *reference, reference))
+            return;
+
+        writer.WriteFloat(value.X);
+        writer.WriteFloat(value.Y);
+        writer.WriteFloat(value.Z);
+        writer.WriteFloat(value.W);
+        return;
+    }
+
+    const auto quantized = QuantizeRotation(value);
+
+    if(!WriteChangedBit(
+           writer, reference && quantized != QuantizeRotation(*reference), reference))
+        return;
+
+    writer.Write(quantized.Largest, 2);
+
+    for(int i = 0; i < 3; ++i)
+        writer.Write(quantized.Values[i], Settings.RotationBits);
+}
+
+DLLEXPORT void StateQuantization::ReadField(BitReader& reader, Float4& value,
+    const Float4* reference, STATE_QUANTIZATION quantization)
+{
+    if(!ReadChangedBit(reader, value, reference))
+        return;
+
+    if(quantization != STATE_QUANTIZATION::Rotation) {
+
+        value.X = reader.ReadFloat();
+        value.Y = reader.ReadFloat();
+        value.Z = reader.ReadFloat();
+        value.W = reader.ReadFloat();
+        return;
+    }
+
+    QuantizedQuaternion quantized;
+    quantized.Largest = static_cast<uint8_t>(reader.Read(2));
+
+    for(int i = 0; i < 3; ++i)
+        quantized.Values[i] = reader.Read(Settings.RotationBits);
+
+    value = DequantizeRotation(quantized);
+}
+// ------------------------------------ //
+DLLEXPORT void StateQuantization::WriteField(BitWriter& writer, float value,
+    const float* reference, STATE_QUANTIZATION quantization)
+{
+    if(!WriteChangedBit(writer, reference && value != *reference, reference))
+        return;
+
+    writer.WriteFloat(value);
+}
+
+DLLEXPORT void StateQuantization::ReadField(BitReader& reader, float& value,
+    const float* reference, STATE_QUANTIZATION quantization)
+{
+    if(!ReadChangedBit(reader, value, reference))
+        return;
+
+    value = reader.ReadFloat();
+}
+
+DLLEXPORT void StateQuantization::WriteField(BitWriter& writer, int32_t value,
+    const int32_t* reference, STATE_QUANTIZATION quantization)
+{
+    if(!WriteChangedBit(writer, reference && value != *reference, reference))
+        return;
+
+    writer.WriteSigned(value, 32);
+}
+
+DLLEXPORT void StateQuantization::ReadField(BitReader& reader, int32_t& value,
+    const int32_t* reference, STATE_QUANTIZATION quantization)
+{
+    if(!ReadChangedBit(reader, value, reference))
+        return;
+
+    value = reader.ReadSigned(32);
+}
+
+DLLEXPORT void StateQuantization::WriteField(BitWriter& writer, bool value,
+    const bool* reference, STATE_QUANTIZATION quantization)
+{
+    // The value itself is one bit so there is no point in checking the reference
+    writer.WriteBool(value);
+}
+
+DLLEXPORT void StateQuantization::ReadField(BitReader& reader, bool& value,
+    const bool* reference, STATE_QUANTIZATION quantization)
+{
+    value = reader.ReadBool();
+}
@@ -0,0 +1,131 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Common/BitStream.h"
+#include "Common/Types.h"
+
+namespace Leviathan {
+
+//! \brief How a component state member is packed when sent
+enum class STATE_QUANTIZATION : uint8_t {
+
+    //! Sent with full precision
+    None,
+
+    //! Float3 that is a position inside the world bounds
+    Position,
+
+    //! Float4 that is a rotation quaternion. Sent as the smallest three components
+    Rotation
+};
+
+//! \brief Configures how component states are quantized
+//! \warning The server and the clients must use the same settings
+struct StateQuantizationSettings {
+
+    //! Positions inside these bounds are quantized, outside them full floats are sent
+    Float3 WorldMin = Float3(-4096.f);
+    Float3 WorldMax = Float3(4096.f);
+
+    //! Largest error allowed for quantized positions
+    //! \note This is raised if the float precision at the bounds isn't enough to rebuild
+    //! the quantized values on the receiving side
+    float PositionPrecision = 0.001f;
+
+    //! Bits used for each of the three sent quaternion components
+    int RotationBits = 10;
+
+    //! Bits used for each axis when sending a position as a change from the reference state
+    int PositionDeltaBits = 10;
+};
+
+//! \brief Quaternion packed by dropping the largest component
+struct QuantizedQuaternion {
+
+    inline bool operator==(const QuantizedQuaternion& other) const
+    {
+        return Largest == other.Largest && Values[0] == other.Values[0] &&
+               Values[1] == other.Values[1] && Values[2] == other.Values[2];
+    }
+
+    inline bool operator!=(const QuantizedQuaternion& other) const
+    {
+        return !(*this == other);
+    }
+
+    //! Index of the dropped component
+    uint8_t Largest = 3;
+    uint32_t Values[3] = {0, 0, 0};
+};
+
+//! \brief Writes and reads component state members to a bit stream
+//!
+//! Used by the generated component states. When a reference state is given each member
+//! starts with a bit telling whether it has changed from the reference and unchanged members
+//! aren't sent at all. Quantized positions that moved only a little are sent as the change
+//! from the reference.
+class StateQuantization {
+public:
+    //! \brief Changes the quantization settings
+    //!
+    //! Call this before any states are sent
+    DLLEXPORT static void SetSettings(const StateQuantizationSettings& settings);
+
+    DLLEXPORT static const StateQuantizationSettings& GetSettings();
+
+    //! \returns Bits used per axis by a quantized position
+    DLLEXPORT static int GetPositionBits();
+
+    //! \returns The largest error in a quantized position axis inside the bounds
+    DLLEXPORT static float GetPositionMaxError();
+
+    //! \returns The largest error in any component of a quantized quaternion
+    DLLEXPORT static float GetRotationMaxError();
+
+    // Field writing and reading, reference is null when a full state is sent
+    DLLEXPORT static void WriteField(BitWriter& writer, const Float3& value,
+        const Float3* reference, STATE_QUANTIZATION quantization);
+    DLLEXPORT static void ReadField(BitReader& reader, Float3& value, const Float3* reference,
+        STATE_QUANTIZATION quantization);
+
+    DLLEXPORT static void WriteField(BitWriter& writer, const Float4& value,
+        const Float4* reference, STATE_QUANTIZATION quantization);
+    DLLEXPORT static void ReadField(BitReader& reader, Float4& value, const Float4* reference,
+        STATE_QUANTIZATION quantization);
+
+    DLLEXPORT static void WriteField(BitWriter& writer, float value, const float* reference,
+        STATE_QUANTIZATION quantization);
+    DLLEXPORT static void ReadField(BitReader& reader, float& value, const float* reference,
+        STATE_QUANTIZATION quantization);
+
+    DLLEXPORT static void WriteField(BitWriter& writer, int32_t value,
+        const int32_t* reference, STATE_QUANTIZATION quantization);
+    DLLEXPORT static void ReadField(BitReader& reader, int32_t& value,
+        const int32_t* reference, STATE_QUANTIZATION quantization);
+
+    DLLEXPORT static void WriteField(BitWriter& writer, bool value, const bool* reference,
+        STATE_QUANTIZATION quantization);
+    DLLEXPORT static void ReadField(BitReader& reader, bool& value, const bool* reference,
+        STATE_QUANTIZATION quantization);
+
+    //! \brief Quantizes position to the world bounds
+    //! \returns False if position is outside the bounds, in which case it can't be quantized
+    DLLEXPORT static bool QuantizePosition(const Float3& position, uint32_t quantized[3]);
+
+    DLLEXPORT static Float3 DequantizePosition(const uint32_t quantized[3]);
+
+    DLLEXPORT static QuantizedQuaternion QuantizeRotation(const Float4& rotation);
+
+    DLLEXPORT static Float4 DequantizeRotation(const QuantizedQuaternion& quantized);
+
+private:
+    static StateQuantizationSettings Settings;
+
+    //! Derived from Settings
+    static int PositionBits;
+    static double PositionStep;
+};
+
+} // namespace Leviathan
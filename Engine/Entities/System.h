@@ -199,31 +199,58 @@ public:
         if(!world.GetNetworkSettings().DoInterpolation)
             return;
 
-        const bool authoritative = world.GetNetworkSettings().IsAuthoritative;
+        for(auto iter = index.begin(); iter != index.end(); ++iter)
+            ProcessComponent(world, iter->first, *iter->second, heldstates, worldtick);
+    }
 
-        for(auto iter = index.begin(); iter != index.end(); ++iter) {
-            auto& component = *iter->second;
+    //! \brief Variant that only checks the components of moved entities
+    //! \param moved From GameWorld::GetMovedEntities, if null all of index is checked
+    void Run(GameWorld& world, std::unordered_map<ObjectID, UsedComponent*>& index,
+        const std::vector<ObjectID>* moved, StateHolder<ComponentState>& heldstates,
+        int worldtick)
+    {
+        if(!moved) {
+            Run(world, index, heldstates, worldtick);
+            return;
+        }
 
-            if(!component.Marked)
-                continue;
+        if(!world.GetNetworkSettings().DoInterpolation)
+            return;
 
-            // And only for locally controlled entities
-            if(!authoritative && !world.IsUnderOurLocalControl(iter->first))
-                continue;
+        for(const auto id : *moved) {
 
-            // Ignore creating states on the server when using local control as that causes
-            // issues Actually this whole system is disabled when interpolating isn't needed
+            const auto found = index.find(id);
 
-            // Needs a new state //
-            if(heldstates.CreateStateIfChanged(iter->first, component, worldtick)) {
+            // Destroyed entities can be in the list
+            if(found != index.end())
+                ProcessComponent(world, id, *found->second, heldstates, worldtick);
+        }
+    }
 
-                component.StateMarked = true;
-            }
+protected:
+    void ProcessComponent(GameWorld& world, ObjectID id, UsedComponent& component,
+        StateHolder<ComponentState>& heldstates, int worldtick)
+    {
+        if(!component.Marked)
+            return;
+
+        const bool authoritative = world.GetNetworkSettings().IsAuthoritative;
 
-            component.Marked = false;
+        // And only for locally controlled entities
+        if(!authoritative && !world.IsUnderOurLocalControl(id))
+            return;
+
+        // Ignore creating states on the server when using local control as that causes
+        // issues Actually this whole system is disabled when interpolating isn't needed
+
+        // Needs a new state //
+        if(heldstates.CreateStateIfChanged(id, component, worldtick)) {
+
+            component.StateMarked = true;
         }
+
+        component.Marked = false;
     }
 };
 
-
 } // namespace Leviathan
@@ -11,9 +11,48 @@
 #include "Animation/OgreSkeletonAnimation.h"
 #include "Animation/OgreSkeletonInstance.h"
 #include "OgreItem.h"
+
+#include <algorithm>
 using namespace Leviathan;
 // ------------------------------------ //
 // SendableSystem
+//! \brief Sends the full state of an entity to a connection that hasn't received it yet
+//! \param sendcreation If true the static state is sent first, false when the
+//! WorldJoinStreamer has already sent it
+void SendInitialEntityState(ObjectID id, Sendable& obj, GameWorld& world,
+    const std::shared_ptr<Connection>& connection,
+    const std::shared_ptr<EntityState>& curstate, bool sendcreation)
+{
+    const auto ticknumber = world.GetTickNumber();
+
+    if(sendcreation) {
+        // First create a packet which will store the component initial data and lists all
+        // the components
+        // TODO: this data could be cached when an entity is created as it will be sent to
+        // all the players
+        sf::Packet initialComponentData;
+        uint32_t componentCount = world.CaptureEntityStaticState(id, initialComponentData);
+
+        // Send the initial response
+        connection->SendPacketToConnection(
+            std::make_shared<ResponseEntityCreation>(
+                0, world.GetID(), id, componentCount, std::move(initialComponentData)),
+            RECEIVE_GUARANTEE::Critical);
+    }
+
+    // And then send the initial state packet
+    sf::Packet updateData;
+
+    curstate->AddDataToPacket(updateData);
+
+    auto sentThing = connection->SendPacketToConnectionWithTrackingWithoutGuarantee(
+        ResponseEntityUpdate(0, world.GetID(), ticknumber, -1, id, std::move(updateData)));
+
+    // And add the connection to the receivers
+    obj.UpdateReceivers.emplace_back(connection);
+    obj.UpdateReceivers.back().AddSentPacket(ticknumber, curstate, sentThing);
+}
+
 //! \brief Helper for SendableSystem::HandleNode to not have as much code duplication for
 //! client and server code
 void SendableHandleHelper(ObjectID id, Sendable& obj, GameWorld& world,
@@ -70,32 +109,7 @@ void SendableHandleHelper(ObjectID id, Sendable& obj, GameWorld& world,
 
         // Only server sends the static state, as the server doesn't want to receive that data,
         // because it was the one who initially sent it to any client that has local control
-        if(server) {
-            // First create a packet which will store the component initial data and lists all
-            // the components
-            // TODO: this data could be cached when an entity is created as it will be sent to
-            // all the players
-            sf::Packet initialComponentData;
-            uint32_t componentCount = world.CaptureEntityStaticState(id, initialComponentData);
-
-            // Send the initial response
-            connection->SendPacketToConnection(
-                std::make_shared<ResponseEntityCreation>(
-                    0, world.GetID(), id, componentCount, std::move(initialComponentData)),
-                RECEIVE_GUARANTEE::Critical);
-        }
-
-        // And then send the initial state packet
-        sf::Packet updateData;
-
-        curstate->AddDataToPacket(updateData);
-
-        auto sentThing = connection->SendPacketToConnectionWithTrackingWithoutGuarantee(
-            ResponseEntityUpdate(0, world.GetID(), ticknumber, -1, id, std::move(updateData)));
-
-        // And add the connection to the receivers
-        obj.UpdateReceivers.emplace_back(connection);
-        obj.UpdateReceivers.back().AddSentPacket(ticknumber, curstate, sentThing);
+        SendInitialEntityState(id, obj, world, connection, curstate, server);
     }
 }
 
@@ -164,6 +178,10 @@ DLLEXPORT void SendableSystem::HandleNode(ObjectID id, Sendable& obj, GameWorld&
 
             const auto& connection = player->GetConnection();
 
+            // The client can't apply updates before it has created the entity
+            if(JoinStreams.IsPending(connection, id))
+                continue;
+
             SendableHandleHelper(id, obj, world, connection, curState, isServer);
         }
     } else {
@@ -174,6 +192,136 @@ DLLEXPORT void SendableSystem::HandleNode(ObjectID id, Sendable& obj, GameWorld&
         }
     }
 }
+
+DLLEXPORT void SendableSystem::_SendStreamedEntities(
+    GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index)
+{
+    for(const auto& received : StreamedEntities) {
+
+        const auto& connection = std::get<0>(received);
+        const ObjectID id = std::get<1>(received);
+
+        const auto found = index.find(id);
+
+        // Destroyed while its creation was being sent
+        if(found == index.end() || !connection->IsValidForSend())
+            continue;
+
+        auto& obj = *found->second;
+
+        // A receiver could only be left over from before the player rejoined
+        for(auto iter = obj.UpdateReceivers.begin(); iter != obj.UpdateReceivers.end();) {
+
+            if(iter->CorrespondingConnection == connection) {
+                iter = obj.UpdateReceivers.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+
+        // The entity might not be marked again for a long time so the current state is sent
+        // right away
+        auto curState = std::make_shared<EntityState>();
+        world.CaptureEntityState(id, *curState);
+
+        SendInitialEntityState(id, obj, world, connection, curState, false);
+    }
+}
+
+DLLEXPORT void SendableSystem::_HandleFullStateRequests(
+    GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index)
+{
+    for(const auto& request : world.TakeFullStateRequests()) {
+
+        const Connection* connection = std::get<0>(request);
+
+        // Snapshots are deltas of the whole world
+        if(_UseSnapshots(world)) {
+            Snapshots.RequestFullSnapshot(connection);
+            continue;
+        }
+
+        const auto found = index.find(std::get<1>(request));
+
+        if(found == index.end())
+            continue;
+
+        auto& obj = *found->second;
+
+        for(auto& receiver : obj.UpdateReceivers) {
+
+            if(receiver.CorrespondingConnection.get() == connection)
+                receiver.ResetReference();
+        }
+
+        // Sent right away even if the entity hasn't changed
+        obj.Marked = true;
+    }
+}
+
+DLLEXPORT bool SendableSystem::_UseSnapshots(GameWorld& world)
+{
+    // Clients send their local control updates per entity
+    const auto& settings = world.GetNetworkSettings();
+    return settings.UseSnapshots && settings.IsAuthoritative;
+}
+// ------------------------------------ //
+// LagCompensationSystem
+DLLEXPORT void LagCompensationSystem::Run(GameWorld& world,
+    std::unordered_map<ObjectID, Position*>& positions,
+    std::unordered_map<ObjectID, Physics*>& physics)
+{
+    const auto& settings = world.GetNetworkSettings();
+
+    // Without remote players there are no hits to validate
+    if(!settings.IsAuthoritative || settings.LagCompensationHistoryMS <= 0 ||
+        world.GetConnectedPlayers().empty()) {
+
+        if(History.GetCount() > 0)
+            History.Clear();
+        return;
+    }
+
+    // One extra frame so that a time between the two oldest ticks can be interpolated
+    const size_t capacity =
+        settings.LagCompensationHistoryMS / std::max(world.GetTickInterval(), 1) + 2;
+
+    if(History.GetCapacity() != capacity)
+        History.SetCapacity(capacity);
+
+    SortedEntities.clear();
+    SortedEntities.reserve(positions.size());
+
+    for(auto iter = positions.begin(); iter != positions.end(); ++iter)
+        SortedEntities.emplace_back(iter->first, iter->second);
+
+    std::sort(SortedEntities.begin(), SortedEntities.end(),
+        [](const std::tuple<ObjectID, Position*>& first,
+            const std::tuple<ObjectID, Position*>& second) {
+            return std::get<0>(first) < std::get<0>(second);
+        });
+
+    auto& frame = History.BeginFrame(world.GetTickNumber());
+
+    for(const auto& entity : SortedEntities) {
+
+        const ObjectID id = std::get<0>(entity);
+        const auto& position = std::get<1>(entity)->Members;
+
+        const auto body = physics.find(id);
+
+        if(body == physics.end() || !body->second->GetBody()) {
+            frame.Add(id, position._Position, position._Orientation);
+            continue;
+        }
+
+        Float3 min;
+        Float3 max;
+        body->second->GetBody()->GetAABB(min, max);
+
+        frame.Add(id, position._Position, position._Orientation, min, max);
+    }
+}
 // ------------------------------------ //
 // DLLEXPORT void ReceivedSystem::Run(
 //     GameWorld& world, std::unordered_map<ObjectID, Received*>& Index)
@@ -219,7 +367,7 @@ DLLEXPORT void SendableSystem::HandleNode(ObjectID id, Sendable& obj, GameWorld&
 DLLEXPORT void AnimationTimeAdder::Run(
     GameWorld& world, std::unordered_map<ObjectID, Animated*>& index, int tick, int timeintick)
 {
-    float timeNow = (tick * TICKSPEED + timeintick) / 1000.f;
+    float timeNow = (tick * world.GetTickInterval() + timeintick) / 1000.f;
 
     const float passed = timeNow - LastSeconds;
 
@@ -7,8 +7,13 @@
 #include "Include.h"
 
 #include "Components.h"
+#include "LagCompensation.h"
+#include "LocalControlPrediction.h"
+#include "PositionInterpolation.h"
 #include "StateInterpolator.h"
 #include "System.h"
+#include "WorldJoinStreamer.h"
+#include "WorldSnapshot.h"
 
 #include "Utility/Convert.h"
 
@@ -28,29 +33,39 @@ class PositionStateSystem : public StateCreationSystem<Position, PositionState>
 //! \brief Moves nodes of entities that have their positions changed
 class RenderingPositionSystem : public System<std::tuple<RenderNode&, Position&>> {
 
-    void ProcessNode(std::tuple<RenderNode&, Position&>& node, ObjectID id,
-        const StateHolder<PositionState>& heldstates, int tick, int timeintick)
+    //! \brief Adds the states of an entity to Batch if it needs to be updated
+    void GatherNode(std::tuple<RenderNode&, Position&>& node, ObjectID id,
+        const StateHolder<PositionState>& heldstates, int tick, int timeintick,
+        const LocalControlPrediction* corrections)
     {
         auto& pos = std::get<1>(node);
 
-        if(!pos.StateMarked)
+        // Entities that are being smoothed need to be updated until the offset is gone
+        const bool smoothed = corrections && corrections->HasCorrection(id);
+
+        if(!pos.StateMarked && !smoothed)
             return;
 
-        auto interpolated =
-            StateInterpolator::Interpolate(heldstates, id, &pos, tick, timeintick);
+        PositionState* startState;
+        PositionState* endState;
+        float progress;
 
-        auto& rendernode = std::get<0>(node);
+        if(!StateInterpolator::FindStates(
+               heldstates, id, &pos, tick, timeintick, startState, endState, progress)) {
 
-        if(!std::get<0>(interpolated)) {
-            // No states to interpolate //
-            rendernode.Node->setPosition(pos.Members._Position);
-            rendernode.Node->setOrientation(pos.Members._Orientation);
-            return;
+            Batch.Add(pos.Members._Position, pos.Members._Orientation);
+
+        } else if(!endState) {
+
+            Batch.Add(startState->_Position, startState->_Orientation);
+
+        } else {
+
+            Batch.Add(startState->_Position, startState->_Orientation, endState->_Position,
+                endState->_Orientation, progress);
         }
 
-        const auto& state = std::get<1>(interpolated);
-        rendernode.Node->setPosition(state._Position);
-        rendernode.Node->setOrientation(state._Orientation);
+        Targets.push_back(std::make_tuple(std::get<0>(node).Node, id, smoothed));
     }
 
 public:
@@ -58,10 +73,38 @@ public:
     void Run(GameWorldT& world, const StateHolder<PositionState>& heldstates, int tick,
         int timeintick)
     {
+        // Corrected locally controlled entities are smoothed on clients
+        const auto& prediction = world.GetLocalControlPrediction();
+        const LocalControlPrediction* corrections =
+            prediction.HasCorrections() ? &prediction : nullptr;
+
+        Batch.Clear();
+        Targets.clear();
+
         auto& index = CachedComponents.GetIndex();
         for(auto iter = index.begin(); iter != index.end(); ++iter) {
 
-            this->ProcessNode(*iter->second, iter->first, heldstates, tick, timeintick);
+            this->GatherNode(
+                *iter->second, iter->first, heldstates, tick, timeintick, corrections);
+        }
+
+        // All the moving entities are interpolated at once
+        Batch.Run();
+
+        for(size_t i = 0; i < Targets.size(); ++i) {
+
+            const auto& target = Targets[i];
+
+            Float3 position = Batch.GetPosition(i);
+            Float4 orientation = Batch.GetOrientation(i);
+
+            if(std::get<2>(target)) {
+                corrections->ApplyCorrectionOffset(
+                    std::get<1>(target), tick, timeintick, position, orientation);
+            }
+
+            std::get<0>(target)->setPosition(position);
+            std::get<0>(target)->setOrientation(orientation);
         }
     }
 
@@ -85,6 +128,12 @@ public:
         CachedComponents.RemoveBasedOnKeyTupleList(firstdata);
         CachedComponents.RemoveBasedOnKeyTupleList(seconddata);
     }
+
+protected:
+    PositionInterpolationBatch Batch;
+
+    //! The nodes for the results in Batch and whether they have a correction to apply
+    std::vector<std::tuple<Ogre::SceneNode*, ObjectID, bool>> Targets;
 };
 
 //! \brief Handles properties of Ogre nodes that have a changed RenderNode
@@ -130,6 +179,21 @@ public:
     //! \pre Final states for entities have been created for current tick
     void Run(GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index)
     {
+        StreamedEntities.clear();
+
+        _HandleFullStateRequests(world, index);
+
+        // Joining players are sent the existing entities over multiple ticks
+        if(world.GetNetworkSettings().IsAuthoritative)
+            JoinStreams.Run(world, index, StreamedEntities);
+
+        if(_UseSnapshots(world)) {
+            Snapshots.Run(world, index, &JoinStreams, &StreamedEntities);
+            return;
+        }
+
+        _SendStreamedEntities(world, index);
+
         for(auto iter = index.begin(); iter != index.end(); ++iter) {
 
             auto& node = *iter->second;
@@ -143,9 +207,61 @@ public:
         }
     }
 
+    inline const SnapshotReplicator& GetSnapshotReplicator() const
+    {
+        return Snapshots;
+    }
+
+    inline const WorldJoinStreamer& GetJoinStreamer() const
+    {
+        return JoinStreams;
+    }
+
 protected:
     //! \todo Something should be done with the required state allocation in this method
     DLLEXPORT void HandleNode(ObjectID id, Sendable& obj, GameWorld& world);
+
+    //! \brief Starts sending updates of the entities in StreamedEntities to their players
+    DLLEXPORT void _SendStreamedEntities(
+        GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index);
+
+    //! \brief Makes the next updates full states for receivers that couldn't decode a delta
+    DLLEXPORT void _HandleFullStateRequests(
+        GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index);
+
+    DLLEXPORT static bool _UseSnapshots(GameWorld& world);
+
+protected:
+    //! Used instead of HandleNode in snapshot mode
+    SnapshotReplicator Snapshots;
+
+    //! Sends the existing entities to joining players
+    WorldJoinStreamer JoinStreams;
+
+    //! Entities whose creation was received by a joining player on this tick
+    std::vector<WorldJoinStreamer::ReceivedEntity> StreamedEntities;
+};
+
+//! \brief Records the positions and physics bounds of entities on the server for hit
+//! validation
+//!
+//! Only records when WorldNetworkSettings::LagCompensationHistoryMS is set and there are
+//! players receiving the world
+class LagCompensationSystem {
+public:
+    DLLEXPORT void Run(GameWorld& world, std::unordered_map<ObjectID, Position*>& positions,
+        std::unordered_map<ObjectID, Physics*>& physics);
+
+    inline const LagCompensationHistory& GetHistory() const
+    {
+        return History;
+    }
+
+protected:
+    LagCompensationHistory History;
+
+    //! The entities of the current tick sorted by id. Kept to reuse the memory
+    std::vector<std::tuple<ObjectID, Position*>> SortedEntities;
 };
 
 //! \brief System type for marking Sendable as marked if a component of type T is marked
@@ -163,6 +279,24 @@ public:
         }
     }
 
+    //! \brief Variant that only checks the moved entities
+    //! \param moved From GameWorld::GetMovedEntities, if null all nodes are checked
+    void Run(GameWorld& world, const std::vector<ObjectID>* moved)
+    {
+        if(!moved) {
+            Run(world);
+            return;
+        }
+
+        for(const auto id : *moved) {
+
+            auto* node = this->CachedComponents.Find(id);
+
+            if(node && std::get<1>(*node).Marked)
+                std::get<0>(*node).Marked = true;
+        }
+    }
+
     void CreateNodes(const std::vector<std::tuple<Sendable*, ObjectID>>& firstdata,
         const std::vector<std::tuple<Position*, ObjectID>>& seconddata,
         const ComponentHolder<Sendable>& firstholder,
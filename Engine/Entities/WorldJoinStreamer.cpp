@@ -0,0 +1,282 @@
+// ------------------------------------ //
+#include "WorldJoinStreamer.h"
+
+#include "Common/BulkMath.h"
+#include "Components.h"
+#include "GameWorld.h"
+#include "Networking/ConnectedPlayer.h"
+#include "Networking/Connection.h"
+#include "Networking/NetworkResponse.h"
+#include "Networking/SentNetworkThing.h"
+
+#include <algorithm>
+
+using namespace Leviathan;
+// ------------------ EntityJoinQueue ------------------ //
+DLLEXPORT void EntityJoinQueue::Start(std::vector<std::tuple<ObjectID, float>>&& entities)
+{
+    // The nearest entity is sent first so it goes to the back. Ties are broken by id to
+    // keep the order the same between runs
+    using Entity = std::tuple<ObjectID, float>;
+
+    std::sort(entities.begin(), entities.end(), [](const Entity& first, const Entity& second) {
+        if(std::get<1>(first) != std::get<1>(second))
+            return std::get<1>(first) > std::get<1>(second);
+
+        return std::get<0>(first) > std::get<0>(second);
+    });
+
+    Queue.clear();
+    Queued.clear();
+
+    Queue.reserve(entities.size());
+
+    for(const auto& entity : entities) {
+
+        const ObjectID id = std::get<0>(entity);
+
+        if(InFlight.find(id) != InFlight.end() || !Queued.insert(id).second)
+            continue;
+
+        Queue.push_back(id);
+    }
+}
+
+DLLEXPORT size_t EntityJoinQueue::SendBatch(
+    size_t maxentities, size_t maxbytes, size_t maxinflight, const Sender& sender)
+{
+    size_t sent = 0;
+    size_t bytes = 0;
+
+    while(!Queue.empty() && sent < maxentities && bytes < maxbytes &&
+          InFlight.size() < maxinflight) {
+
+        const ObjectID id = Queue.back();
+        Queue.pop_back();
+
+        // Removed while queued
+        if(Queued.erase(id) == 0)
+            continue;
+
+        const int size = sender(id);
+
+        if(size < 0)
+            continue;
+
+        InFlight.insert(id);
+        ++sent;
+        bytes += size;
+    }
+
+    return sent;
+}
+// ------------------------------------ //
+DLLEXPORT void EntityJoinQueue::OnReceived(ObjectID id)
+{
+    InFlight.erase(id);
+}
+
+DLLEXPORT void EntityJoinQueue::OnLost(ObjectID id)
+{
+    if(InFlight.erase(id) == 0)
+        return;
+
+    if(Queued.insert(id).second)
+        Queue.push_back(id);
+}
+
+DLLEXPORT void EntityJoinQueue::Remove(ObjectID id)
+{
+    InFlight.erase(id);
+    Queued.erase(id);
+}
+// ------------------ WorldJoinStreamer ------------------ //
+DLLEXPORT void WorldJoinStreamer::Run(GameWorld& world,
+    std::unordered_map<ObjectID, Sendable*>& index, std::vector<ReceivedEntity>& received)
+{
+    _UpdateStreams(world, index);
+
+    for(auto iter = Streams.begin(); iter != Streams.end();) {
+
+        _CheckReceived(*iter, received);
+        _SendBatch(world, index, *iter);
+
+        if(iter->Queue.IsDone()) {
+
+            LOG_INFO("WorldJoinStreamer: finished sending world to: " +
+                     iter->CorrespondingConnection->GenerateFormatedAddressString());
+
+            iter = Streams.erase(iter);
+            continue;
+        }
+
+        ++iter;
+    }
+}
+
+DLLEXPORT bool WorldJoinStreamer::IsPending(
+    const std::shared_ptr<Connection>& connection, ObjectID id) const
+{
+    for(const auto& stream : Streams) {
+
+        if(stream.CorrespondingConnection == connection)
+            return stream.Queue.IsPending(id);
+    }
+
+    return false;
+}
+
+DLLEXPORT void WorldJoinStreamer::Clear()
+{
+    Streams.clear();
+    KnownConnections.clear();
+}
+// ------------------------------------ //
+void WorldJoinStreamer::_UpdateStreams(
+    GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index)
+{
+    const auto& players = world.GetConnectedPlayers();
+
+    const auto isConnected = [&](const std::shared_ptr<Connection>& connection) {
+        if(!connection->IsValidForSend())
+            return false;
+
+        return std::any_of(players.begin(), players.end(),
+            [&](const auto& player) { return player->GetConnection() == connection; });
+    };
+
+    // Players that leave are started again if they rejoin
+    KnownConnections.erase(
+        std::remove_if(KnownConnections.begin(), KnownConnections.end(),
+            [&](const std::shared_ptr<Connection>& connection) {
+                return !isConnected(connection);
+            }),
+        KnownConnections.end());
+
+    Streams.erase(std::remove_if(Streams.begin(), Streams.end(),
+                      [&](const Stream& stream) {
+                          return !isConnected(stream.CorrespondingConnection);
+                      }),
+        Streams.end());
+
+    for(const auto& player : players) {
+
+        const auto& connection = player->GetConnection();
+
+        if(!connection || !connection->IsValidForSend())
+            continue;
+
+        if(std::find(KnownConnections.begin(), KnownConnections.end(), connection) !=
+            KnownConnections.end())
+            continue;
+
+        KnownConnections.push_back(connection);
+        _StartStream(world, index, player->GetPositionInWorld(&world), connection);
+    }
+}
+
+void WorldJoinStreamer::_StartStream(GameWorld& world,
+    std::unordered_map<ObjectID, Sendable*>& index, ObjectID playerentity,
+    const std::shared_ptr<Connection>& connection)
+{
+    Float3 center(0, 0, 0);
+
+    if(playerentity != NULL_OBJECT) {
+
+        Position* position = world.GetComponentPtr<Position>(playerentity);
+
+        if(position)
+            center = position->Members._Position;
+    }
+
+    // Entities without a position are sent first as their importance isn't known
+    std::vector<std::tuple<ObjectID, float>> entities;
+    entities.reserve(index.size());
+
+    std::vector<size_t> positioned;
+    Float3Array positions;
+
+    for(auto iter = index.begin(); iter != index.end(); ++iter) {
+
+        Position* position = world.GetComponentPtr<Position>(iter->first);
+
+        if(position) {
+            positioned.push_back(entities.size());
+            positions.PushBack(position->Members._Position);
+        }
+
+        entities.emplace_back(iter->first, 0.f);
+    }
+
+    std::vector<float> distances(positions.GetSize());
+    BulkMath::DistanceSquared(positions, center, distances.data());
+
+    for(size_t i = 0; i < positioned.size(); ++i)
+        std::get<1>(entities[positioned[i]]) = distances[i];
+
+    LOG_INFO("WorldJoinStreamer: starting to send " + std::to_string(entities.size()) +
+             " entities to: " + connection->GenerateFormatedAddressString());
+
+    Streams.emplace_back(connection);
+    Streams.back().Queue.Start(std::move(entities));
+}
+// ------------------------------------ //
+void WorldJoinStreamer::_CheckReceived(Stream& stream, std::vector<ReceivedEntity>& received)
+{
+    for(auto iter = stream.SentCreations.begin(); iter != stream.SentCreations.end();) {
+
+        auto& sent = std::get<1>(*iter);
+
+        if(!sent->IsFinalized()) {
+            ++iter;
+            continue;
+        }
+
+        const ObjectID id = std::get<0>(*iter);
+
+        if(sent->GetStatus()) {
+
+            if(stream.Queue.IsPending(id)) {
+                stream.Queue.OnReceived(id);
+                received.emplace_back(stream.CorrespondingConnection, id);
+            }
+
+        } else {
+            stream.Queue.OnLost(id);
+        }
+
+        iter = stream.SentCreations.erase(iter);
+    }
+}
+
+void WorldJoinStreamer::_SendBatch(
+    GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index, Stream& stream)
+{
+    const auto& settings = world.GetNetworkSettings();
+
+    const auto sender = [&](ObjectID id) -> int {
+        if(index.find(id) == index.end())
+            return -1;
+
+        sf::Packet initialComponentData;
+        const uint32_t componentCount =
+            world.CaptureEntityStaticState(id, initialComponentData);
+
+        const int size = static_cast<int>(initialComponentData.getDataSize());
+
+        auto sent = stream.CorrespondingConnection->SendPacketToConnection(
+            std::make_shared<ResponseEntityCreation>(
+                0, world.GetID(), id, componentCount, std::move(initialComponentData)),
+            RECEIVE_GUARANTEE::Critical);
+
+        if(!sent)
+            return -1;
+
+        stream.SentCreations.emplace_back(id, sent);
+        return size;
+    };
+
+    stream.Queue.SendBatch(std::max(settings.JoinStreamEntitiesPerTick, 1),
+        std::max(settings.JoinStreamBytesPerTick, 1),
+        std::max(settings.JoinStreamMaxInFlight, 1), sender);
+}
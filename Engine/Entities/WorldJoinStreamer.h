@@ -0,0 +1,156 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "EntityCommon.h"
+
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Leviathan {
+
+class Connection;
+class GameWorld;
+class Sendable;
+class SentNetworkThing;
+
+//! \brief Order and progress of sending the existing entities of a world to a single client
+//!
+//! Doesn't do any networking itself so that WorldJoinStreamer can be tested without
+//! connections
+class EntityJoinQueue {
+public:
+    //! \brief Sends the creation message of an entity
+    //! \returns The size of the sent message in bytes or -1 if the entity doesn't exist
+    //! anymore and was skipped
+    using Sender = std::function<int(ObjectID id)>;
+
+    //! \brief Queues entities to be sent, the ones with the smallest distance first
+    //!
+    //! Replaces the entities that were queued before
+    //! \param entities Ids and their squared distances from the player
+    DLLEXPORT void Start(std::vector<std::tuple<ObjectID, float>>&& entities);
+
+    //! \brief Sends the nearest queued entities until one of the limits is reached
+    //!
+    //! The byte limit is checked before each message so the last one can go over it. This
+    //! way a single large entity can't stop the queue
+    //! \returns The number of sent entities
+    DLLEXPORT size_t SendBatch(
+        size_t maxentities, size_t maxbytes, size_t maxinflight, const Sender& sender);
+
+    //! \brief Marks the creation of an entity as received by the client
+    DLLEXPORT void OnReceived(ObjectID id);
+
+    //! \brief Queues an entity to be sent again next as its creation message was lost
+    DLLEXPORT void OnLost(ObjectID id);
+
+    //! \brief Stops sending an entity, used when it is destroyed
+    DLLEXPORT void Remove(ObjectID id);
+
+    //! \returns True if the entity is queued or its creation hasn't been received yet
+    inline bool IsPending(ObjectID id) const
+    {
+        return Queued.find(id) != Queued.end() || InFlight.find(id) != InFlight.end();
+    }
+
+    //! \returns True once all the entities have been received or removed
+    inline bool IsDone() const
+    {
+        return Queued.empty() && InFlight.empty();
+    }
+
+    inline size_t GetQueuedCount() const
+    {
+        return Queued.size();
+    }
+
+    inline size_t GetInFlightCount() const
+    {
+        return InFlight.size();
+    }
+
+protected:
+    //! Send order, the nearest is at the back. Removed entities are skipped when they come up
+    std::vector<ObjectID> Queue;
+
+    //! Entities in Queue that haven't been removed
+    std::unordered_set<ObjectID> Queued;
+
+    //! Entities that have been sent but not received
+    std::unordered_set<ObjectID> InFlight;
+};
+
+//! \brief Sends the existing entities of a world to joining players over multiple ticks
+//!
+//! Sending all of the entities at once floods the connection of a player joining a populated
+//! world. Instead the creation messages are sent in batches limited by the
+//! WorldNetworkSettings JoinStream values, starting from the entities nearest to the player.
+//! The entities are prioritized once when the player joins. Updates for an entity must not
+//! be sent to the player while IsPending returns true for it, Run reports when the creation
+//! has been received and normal updates can start
+class WorldJoinStreamer {
+public:
+    //! The connection and the entity whose creation message has been received
+    using ReceivedEntity = std::tuple<std::shared_ptr<Connection>, ObjectID>;
+
+    //! \brief Starts streaming to new players and sends the next batch to each of them
+    //! \param received The entities whose creation has been received since the last call are
+    //! added here
+    DLLEXPORT void Run(GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index,
+        std::vector<ReceivedEntity>& received);
+
+    //! \returns True if connection is still waiting for the creation of entity
+    DLLEXPORT bool IsPending(const std::shared_ptr<Connection>& connection, ObjectID id) const;
+
+    //! \brief Forgets all players and stops streaming
+    DLLEXPORT void Clear();
+
+    //! \returns The number of players that are still being sent the world
+    inline size_t GetActiveStreamCount() const
+    {
+        return Streams.size();
+    }
+
+protected:
+    //! \brief The entities being sent to a single player
+    struct Stream {
+
+        inline Stream(const std::shared_ptr<Connection>& connection) :
+            CorrespondingConnection(connection)
+        {}
+
+        std::shared_ptr<Connection> CorrespondingConnection;
+
+        EntityJoinQueue Queue;
+
+        //! Sent creation messages that haven't been received or lost yet
+        std::vector<std::tuple<ObjectID, std::shared_ptr<SentNetworkThing>>> SentCreations;
+    };
+
+    //! \brief Starts streams for new players and removes disconnected ones
+    void _UpdateStreams(GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index);
+
+    //! \brief Queues all the current entities for connection, nearest first
+    void _StartStream(GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index,
+        ObjectID playerentity, const std::shared_ptr<Connection>& connection);
+
+    void _CheckReceived(Stream& stream, std::vector<ReceivedEntity>& received);
+
+    void _SendBatch(
+        GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index, Stream& stream);
+
+protected:
+    //! Players that haven't received all of the entities yet
+    std::vector<Stream> Streams;
+
+    //! All players that have been started, including ones that have finished
+    std::vector<std::shared_ptr<Connection>> KnownConnections;
+};
+
+} // namespace Leviathan
@@ -1,6 +1,7 @@
 // Leviathan Game Engine
 // Copyright (c) 2012-2018 Henri Hyyryläinen
 #pragma once
+#include "Define.h"
 // ------------------------------------ //
 
 namespace Leviathan {
@@ -17,6 +18,7 @@ struct WorldNetworkSettings {
         settings.IsAuthoritative = true;
         settings.AutoCreateNetworkComponents = true;
         settings.DoInterpolation = false;
+        settings.LagCompensationHistoryMS = 500;
 
         return settings;
     }
@@ -65,6 +67,62 @@ struct WorldNetworkSettings {
 
     //! Enables clientside interpolation functions
     bool DoInterpolation = true;
+
+    //! When true the server sends all changed entities as one snapshot per tick to each
+    //! client instead of separately tracked updates for each entity
+    //! \see SnapshotReplicator
+    bool UseSnapshots = false;
+
+    //! Byte budget for a single snapshot message. Larger snapshots are split into multiple
+    //! messages so that they don't need to be fragmented. Keep this below the path MTU
+    int SnapshotPartBytes = 1200;
+
+    //! When true a client holds received entity packets in a jitter buffer and applies them in
+    //! tick order after a delay that adapts to the measured network jitter
+    //! \see EntityJitterBuffer
+    bool UseJitterBuffer = false;
+
+    //! Limits in milliseconds for the delay that is added on top of the fastest measured
+    //! transit time before received entity states are applied
+    int MinPlayoutDelay = TICKSPEED;
+    int MaxPlayoutDelay = 500;
+
+    //! Server side limit on how fast clients can move their locally controlled entities in
+    //! units per second. States that move faster are rejected and the client is sent a
+    //! correction. Games should set this to the top speed of their entities, setting it to 0
+    //! disables the check and trusts the clients
+    float MaxLocalControlSpeed = 50.f;
+
+    //! How many ticks more than the server has ran a client can claim to have simulated
+    //! between its local control states. Allows for network jitter
+    int LocalControlTickSlack = 5;
+
+    //! Server ticks to wait for a client to react to a correction before sending it again
+    int LocalControlCorrectionResendTicks = 10;
+
+    //! How far the client's prediction can be from the corrected state before the entity is
+    //! reset and the recorded inputs are simulated again
+    float PredictionTolerance = 0.01f;
+
+    //! How many ticks it takes to smooth out the visual jump after a correction. Corrections
+    //! longer than MaxSmoothedCorrection are applied immediately
+    int CorrectionSmoothingTicks = 4;
+    float MaxSmoothedCorrection = 5.f;
+
+    //! Limits for sending the existing entities to a player that joins the world. Each tick
+    //! at most JoinStreamEntitiesPerTick creation messages or JoinStreamBytesPerTick bytes of
+    //! them are sent, nearest entities first, and no more are sent while
+    //! JoinStreamMaxInFlight of them haven't been received
+    //! \see WorldJoinStreamer
+    int JoinStreamEntitiesPerTick = 32;
+    int JoinStreamBytesPerTick = 16 * 1024;
+    int JoinStreamMaxInFlight = 128;
+
+    //! How many milliseconds of entity positions and physics bounds the server keeps for
+    //! validating hits where clients saw the targets. 0 disables recording. Only the server
+    //! preset enables this, a hybrid world with remote players needs to set it
+    //! \see LagCompensationHistory
+    int LagCompensationHistoryMS = 0;
 };
 
 
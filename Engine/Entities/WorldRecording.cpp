@@ -0,0 +1,350 @@
+// ------------------------------------ //
+#include "WorldRecording.h"
+
+#include "Common/SFMLPackets.h"
+#include "Exceptions.h"
+#include "GameWorld.h"
+#include "Networking/NetworkResponse.h"
+#include "Statistics/Profiler.h"
+#include "TimeIncludes.h"
+#include "Utility/Random.h"
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+
+using namespace Leviathan;
+// ------------------------------------ //
+namespace {
+
+//! The buffer is written to the file once it grows over this
+constexpr size_t FILE_WRITE_THRESHOLD = 64 * 1024;
+
+constexpr uint8_t SETTING_AUTHORITATIVE = 0x1;
+constexpr uint8_t SETTING_AUTO_CREATE_NETWORK_COMPONENTS = 0x2;
+constexpr uint8_t SETTING_INTERPOLATION = 0x4;
+constexpr uint8_t SETTING_SNAPSHOTS = 0x8;
+
+} // namespace
+// ------------------ WorldRecorder ------------------ //
+DLLEXPORT WorldRecorder::WorldRecorder() {}
+
+DLLEXPORT WorldRecorder::WorldRecorder(const std::string& file) :
+    File(file, std::ios::out | std::ios::binary | std::ios::trunc), ToFile(true)
+{
+    if(!File.good())
+        throw InvalidArgument("WorldRecorder: can't open file for writing: " + file);
+}
+
+DLLEXPORT WorldRecorder::~WorldRecorder()
+{
+    Flush();
+}
+// ------------------------------------ //
+DLLEXPORT void WorldRecorder::RecordHeader(const GameWorld& world)
+{
+    Lock lock(RecordMutex);
+
+    if(HeaderWritten)
+        return;
+
+    HeaderWritten = true;
+
+    const auto& settings = world.GetNetworkSettings();
+
+    uint8_t flags = 0;
+
+    if(settings.IsAuthoritative)
+        flags |= SETTING_AUTHORITATIVE;
+    if(settings.AutoCreateNetworkComponents)
+        flags |= SETTING_AUTO_CREATE_NETWORK_COMPONENTS;
+    if(settings.DoInterpolation)
+        flags |= SETTING_INTERPOLATION;
+    if(settings.UseSnapshots)
+        flags |= SETTING_SNAPSHOTS;
+
+    Buffer << MAGIC << VERSION << world.GetType() << flags
+           << static_cast<int32_t>(world.GetTickInterval());
+}
+
+DLLEXPORT void WorldRecorder::RecordTick(int32_t ticknumber, Random& random)
+{
+    // Restarting the generator from a seed is the only way to put it into a known state
+    const int32_t seed = random.GetNumber();
+    random.SetSeed(seed);
+
+    Lock lock(RecordMutex);
+
+    Buffer << static_cast<uint8_t>(WORLD_RECORDING_ENTRY::Tick) << ticknumber << seed;
+    ++EntryCount;
+
+    _WriteBuffer();
+}
+
+DLLEXPORT void WorldRecorder::RecordPacket(const NetworkResponse& response)
+{
+    sf::Packet serialized;
+    response.AddDataToPacket(serialized);
+
+    Lock lock(RecordMutex);
+
+    Buffer << static_cast<uint8_t>(WORLD_RECORDING_ENTRY::Packet) << serialized;
+    ++EntryCount;
+
+    _WriteBuffer();
+}
+
+DLLEXPORT void WorldRecorder::RecordCommand(uint32_t type, const sf::Packet& data)
+{
+    Lock lock(RecordMutex);
+
+    Buffer << static_cast<uint8_t>(WORLD_RECORDING_ENTRY::Command) << type << data;
+    ++EntryCount;
+
+    _WriteBuffer();
+}
+// ------------------------------------ //
+DLLEXPORT void WorldRecorder::Flush()
+{
+    Lock lock(RecordMutex);
+
+    if(!ToFile || Buffer.getDataSize() == 0)
+        return;
+
+    File.write(static_cast<const char*>(Buffer.getData()), Buffer.getDataSize());
+    File.flush();
+    Buffer.clear();
+}
+
+void WorldRecorder::_WriteBuffer()
+{
+    if(!ToFile || Buffer.getDataSize() < FILE_WRITE_THRESHOLD)
+        return;
+
+    File.write(static_cast<const char*>(Buffer.getData()), Buffer.getDataSize());
+    Buffer.clear();
+}
+// ------------------ WorldReplay ------------------ //
+DLLEXPORT bool WorldReplay::LoadFromFile(const std::string& file)
+{
+    std::ifstream input(file, std::ios::in | std::ios::binary);
+
+    if(!input.good()) {
+        LOG_ERROR("WorldReplay: can't open recording: " + file);
+        return false;
+    }
+
+    const std::string data(
+        (std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    sf::Packet packet;
+    packet.append(data.data(), data.size());
+
+    return LoadFromMemory(packet);
+}
+
+DLLEXPORT bool WorldReplay::LoadFromMemory(const sf::Packet& data)
+{
+    Entries.clear();
+
+    // Reading moves the read position so a copy is needed
+    sf::Packet packet = data;
+
+    uint32_t magic;
+    uint16_t version;
+    uint8_t flags;
+    int32_t interval;
+
+    packet >> magic >> version >> WorldType >> flags >> interval;
+
+    if(!packet || magic != WorldRecorder::MAGIC) {
+        LOG_ERROR("WorldReplay: data is not a world recording");
+        return false;
+    }
+
+    if(version != WorldRecorder::VERSION) {
+        LOG_ERROR("WorldReplay: unsupported recording version: " + std::to_string(version));
+        return false;
+    }
+
+    TickInterval = interval;
+
+    Settings = WorldNetworkSettings();
+    Settings.IsAuthoritative = (flags & SETTING_AUTHORITATIVE) != 0;
+    Settings.AutoCreateNetworkComponents =
+        (flags & SETTING_AUTO_CREATE_NETWORK_COMPONENTS) != 0;
+    Settings.DoInterpolation = (flags & SETTING_INTERPOLATION) != 0;
+    Settings.UseSnapshots = (flags & SETTING_SNAPSHOTS) != 0;
+
+    try {
+        while(!packet.endOfPacket()) {
+
+            uint8_t type;
+            packet >> type;
+
+            WorldRecordingEntry entry;
+            entry.Type = static_cast<WORLD_RECORDING_ENTRY>(type);
+
+            switch(entry.Type) {
+            case WORLD_RECORDING_ENTRY::Tick:
+                packet >> entry.TickNumber >> entry.Seed;
+                break;
+            case WORLD_RECORDING_ENTRY::Packet: packet >> entry.Data; break;
+            case WORLD_RECORDING_ENTRY::Command:
+                packet >> entry.CommandType >> entry.Data;
+                break;
+            default:
+                LOG_ERROR("WorldReplay: unknown entry type: " + std::to_string(type));
+                return false;
+            }
+
+            if(!packet) {
+                LOG_ERROR("WorldReplay: recording ends in the middle of an entry");
+                return false;
+            }
+
+            Entries.push_back(std::move(entry));
+        }
+    } catch(const InvalidArgument& e) {
+        LOG_ERROR("WorldReplay: invalid entry data in recording:");
+        e.PrintToLog();
+        return false;
+    }
+
+    return true;
+}
+// ------------------------------------ //
+DLLEXPORT WorldNetworkSettings WorldReplay::GetRecordedSettings() const
+{
+    WorldNetworkSettings settings = Settings;
+
+    // Played out by time so it would only add delay
+    settings.UseJitterBuffer = false;
+    return settings;
+}
+// ------------------------------------ //
+DLLEXPORT void WorldReplay::Run(
+    GameWorld& world, const CommandHandler& commandhandler, WorldReplayResult& result) const
+{
+    result = WorldReplayResult();
+
+    const bool wasEnabled = Profiler::IsEnabled();
+
+    Profiler::Clear();
+    Profiler::SetEnabled(true);
+
+    std::unordered_map<ProfilerZoneID, WorldReplayZoneTiming> zones;
+
+    // The events are summed after each tick so that the profiler ring buffers can't wrap
+    // around. The time that takes is left out of the total
+    const auto collectEvents = [&]() {
+        for(const auto& thread : Profiler::GetEvents()) {
+            for(const auto& event : thread.Events) {
+
+                auto& zone = zones[event.Zone];
+                const int64_t duration = event.End - event.Start;
+
+                ++zone.Count;
+                zone.TotalNanoseconds += duration;
+                zone.MaxNanoseconds = std::max(zone.MaxNanoseconds, duration);
+            }
+        }
+
+        Profiler::Clear();
+    };
+
+    Random& random = world.GetRandom();
+
+    auto start = Time::GetTimeMicro64();
+
+    for(const auto& entry : Entries) {
+
+        switch(entry.Type) {
+        case WORLD_RECORDING_ENTRY::Tick: {
+
+            random.SetSeed(entry.Seed);
+
+            world.Tick(entry.TickNumber);
+            ++result.TickCount;
+
+            result.WallMicroseconds += Time::GetTimeMicro64() - start;
+            collectEvents();
+            start = Time::GetTimeMicro64();
+            break;
+        }
+        case WORLD_RECORDING_ENTRY::Packet: _ApplyPacket(world, entry); break;
+        case WORLD_RECORDING_ENTRY::Command: {
+
+            if(!commandhandler)
+                break;
+
+            sf::Packet data = entry.Data;
+            commandhandler(world, entry.CommandType, data);
+            break;
+        }
+        }
+    }
+
+    result.WallMicroseconds += Time::GetTimeMicro64() - start;
+    collectEvents();
+
+    Profiler::SetEnabled(wasEnabled);
+
+    for(auto& zone : zones) {
+
+        zone.second.Name = Profiler::GetZoneName(zone.first);
+        result.Zones.push_back(std::move(zone.second));
+    }
+
+    std::sort(result.Zones.begin(), result.Zones.end(),
+        [](const WorldReplayZoneTiming& first, const WorldReplayZoneTiming& second) {
+            return first.TotalNanoseconds > second.TotalNanoseconds;
+        });
+}
+
+void WorldReplay::_ApplyPacket(GameWorld& world, const WorldRecordingEntry& entry) const
+{
+    LEVIATHAN_PROFILE_ZONE("WorldReplay::ApplyPacket");
+
+    // Loaded again on each run so that the deserialization time is included
+    sf::Packet data = entry.Data;
+    std::shared_ptr<NetworkResponse> response;
+
+    try {
+        response = NetworkResponse::LoadFromPacket(data);
+    } catch(const InvalidArgument& e) {
+        LOG_ERROR("WorldReplay: recorded packet couldn't be loaded:");
+        e.PrintToLog();
+        return;
+    }
+
+    if(!response) {
+        LOG_ERROR("WorldReplay: recorded packet couldn't be loaded");
+        return;
+    }
+
+    switch(response->GetType()) {
+    case NETWORK_RESPONSE_TYPE::EntityCreation:
+        world.HandleEntityPacket(static_cast<ResponseEntityCreation&>(*response));
+        break;
+    case NETWORK_RESPONSE_TYPE::EntityUpdate:
+        world.HandleEntityPacket(std::move(static_cast<ResponseEntityUpdate&>(*response)));
+        break;
+    case NETWORK_RESPONSE_TYPE::WorldSnapshot:
+        world.HandleEntityPacket(std::move(static_cast<ResponseWorldSnapshot&>(*response)));
+        break;
+    case NETWORK_RESPONSE_TYPE::EntityDestruction:
+        world.HandleEntityPacket(static_cast<ResponseEntityDestruction&>(*response));
+        break;
+    case NETWORK_RESPONSE_TYPE::EntityLocalControlStatus:
+        world.HandleEntityPacket(static_cast<ResponseEntityLocalControlStatus&>(*response));
+        break;
+    case NETWORK_RESPONSE_TYPE::EntityLocalControlCorrection:
+        world.HandleEntityPacket(
+            static_cast<ResponseEntityLocalControlCorrection&>(*response));
+        break;
+    default:
+        LOG_ERROR("WorldReplay: unexpected recorded packet type: " + response->GetTypeStr());
+        break;
+    }
+}
@@ -0,0 +1,198 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Common/ThreadSafe.h"
+#include "WorldNetworkSettings.h"
+
+#include "SFML/Network/Packet.hpp"
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Leviathan {
+
+class GameWorld;
+class NetworkResponse;
+class Random;
+
+//! \brief Kinds of entries in a world recording
+enum class WORLD_RECORDING_ENTRY : uint8_t {
+
+    //! A tick was ran. Has the tick number and the seed the world's Random was reset to
+    Tick = 1,
+
+    //! A received entity packet. Has the serialized NetworkResponse
+    Packet,
+
+    //! A game specific command. Has the command type and its data
+    Command
+};
+
+//! \brief A single recorded input
+struct WorldRecordingEntry {
+
+    WORLD_RECORDING_ENTRY Type;
+
+    int32_t TickNumber = 0;
+    int32_t Seed = 0;
+
+    uint32_t CommandType = 0;
+
+    //! The response for Packet entries and the command data for Command entries
+    sf::Packet Data;
+};
+
+//! \brief Records everything that affects the simulation of a GameWorld into a compact
+//! binary log
+//!
+//! Attach to a world with GameWorld::SetRecorder. The world records its ticks and the entity
+//! packets it receives, game code records its own commands with RecordCommand. To keep the
+//! random numbers the same on replay the world's own Random (GameWorld::GetRandom) is reset
+//! to a recorded seed at the start of every tick.
+//! \see WorldReplay
+class WorldRecorder {
+public:
+    static constexpr uint32_t MAGIC = 0x4c575243;
+    static constexpr uint16_t VERSION = 1;
+
+    //! \brief Records into memory, get the result with GetData
+    DLLEXPORT WorldRecorder();
+
+    //! \brief Records into a file. The data is buffered and written in chunks
+    //! \exception InvalidArgument if the file can't be opened
+    DLLEXPORT WorldRecorder(const std::string& file);
+
+    DLLEXPORT ~WorldRecorder();
+
+    WorldRecorder(const WorldRecorder& other) = delete;
+    WorldRecorder& operator=(const WorldRecorder& other) = delete;
+
+    //! \brief Writes the settings of world that are needed to replay it
+    //!
+    //! Called by GameWorld::SetRecorder. Only the first call does anything
+    DLLEXPORT void RecordHeader(const GameWorld& world);
+
+    //! \brief Records the start of a tick and resets random to a new seed
+    //! \param random The generator of the recorded world, the main one isn't touched
+    DLLEXPORT void RecordTick(int32_t ticknumber, Random& random);
+
+    DLLEXPORT void RecordPacket(const NetworkResponse& response);
+
+    //! \brief Records a game specific command that changes the world outside the received
+    //! packets, like a locally applied player action
+    //!
+    //! The command is given to the WorldReplay::CommandHandler on replay
+    DLLEXPORT void RecordCommand(uint32_t type, const sf::Packet& data);
+
+    //! \brief Writes the buffered data to the file
+    DLLEXPORT void Flush();
+
+    //! \returns The recorded data when recording to memory
+    //! \note In file mode only the data that hasn't been flushed yet is here
+    inline const sf::Packet& GetData() const
+    {
+        return Buffer;
+    }
+
+    inline size_t GetEntryCount() const
+    {
+        return EntryCount;
+    }
+
+private:
+    //! \pre RecordMutex is locked
+    void _WriteBuffer();
+
+private:
+    Mutex RecordMutex;
+
+    sf::Packet Buffer;
+    std::ofstream File;
+    bool ToFile = false;
+
+    bool HeaderWritten = false;
+    size_t EntryCount = 0;
+};
+
+//! \brief Time spent in a single profiler zone during a replay
+struct WorldReplayZoneTiming {
+
+    std::string Name;
+
+    int64_t Count = 0;
+    int64_t TotalNanoseconds = 0;
+    int64_t MaxNanoseconds = 0;
+};
+
+struct WorldReplayResult {
+
+    int TickCount = 0;
+    int64_t WallMicroseconds = 0;
+
+    //! Sorted by the total time, largest first
+    std::vector<WorldReplayZoneTiming> Zones;
+};
+
+//! \brief Runs a WorldRecorder recording on a world as fast as possible
+//!
+//! This is meant for load tests and catching performance regressions with recordings of
+//! real sessions. Each tick of the recording is ran right after the previous one with the
+//! Profiler enabled and the time is summed for each profiled zone, which includes all the
+//! systems of a generated world.
+//! \note The world needs to be created with the same type and GetRecordedSettings to get
+//! the same results. Received packets are applied right away so the jitter buffer is
+//! turned off
+class WorldReplay {
+public:
+    //! \brief Called for recorded commands
+    using CommandHandler =
+        std::function<void(GameWorld& world, uint32_t type, sf::Packet& data)>;
+
+    //! \returns False if the file can't be read or isn't a valid recording
+    DLLEXPORT bool LoadFromFile(const std::string& file);
+
+    //! \returns False if the data isn't a valid recording
+    DLLEXPORT bool LoadFromMemory(const sf::Packet& data);
+
+    //! \brief Applies the recording to world
+    //!
+    //! Events recorded by the Profiler before this are cleared
+    //! \param commandhandler Receives the recorded commands, they are skipped if empty
+    DLLEXPORT void Run(GameWorld& world, const CommandHandler& commandhandler,
+        WorldReplayResult& result) const;
+
+    //! \returns The settings of the recorded world for initializing the replayed world
+    DLLEXPORT WorldNetworkSettings GetRecordedSettings() const;
+
+    inline int32_t GetWorldType() const
+    {
+        return WorldType;
+    }
+
+    inline int GetTickInterval() const
+    {
+        return TickInterval;
+    }
+
+    inline const std::vector<WorldRecordingEntry>& GetEntries() const
+    {
+        return Entries;
+    }
+
+private:
+    void _ApplyPacket(GameWorld& world, const WorldRecordingEntry& entry) const;
+
+private:
+    int32_t WorldType = 0;
+    int TickInterval = TICKSPEED;
+
+    WorldNetworkSettings Settings;
+
+    std::vector<WorldRecordingEntry> Entries;
+};
+
+} // namespace Leviathan
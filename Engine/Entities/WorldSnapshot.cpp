@@ -0,0 +1,459 @@
+// ------------------------------------ //
+#include "WorldSnapshot.h"
+
+#include "Components.h"
+#include "GameWorld.h"
+#include "StateHolder.h"
+#include "Networking/Connection.h"
+#include "Networking/NetworkResponse.h"
+#include "Networking/SentNetworkThing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace Leviathan;
+// ------------------------------------ //
+namespace {
+
+inline bool HasSameData(const sf::Packet& first, const sf::Packet& second)
+{
+    return first.getDataSize() == second.getDataSize() &&
+           (first.getDataSize() == 0 ||
+               std::memcmp(first.getData(), second.getData(), first.getDataSize()) == 0);
+}
+
+} // namespace
+// ------------------ WorldSnapshot ------------------ //
+DLLEXPORT const std::shared_ptr<const SnapshotEntity>* WorldSnapshot::Find(ObjectID id) const
+{
+    const auto found = std::lower_bound(Entities.begin(), Entities.end(), id,
+        [](const std::shared_ptr<const SnapshotEntity>& entity, ObjectID id) {
+            return entity->ID < id;
+        });
+
+    if(found == Entities.end() || (*found)->ID != id)
+        return nullptr;
+
+    return &*found;
+}
+
+DLLEXPORT uint32_t WorldSnapshot::WriteDelta(const WorldSnapshot* reference,
+    sf::Packet& packet,
+    const std::unordered_map<ObjectID, int32_t>* includedsince /*= nullptr*/) const
+{
+    std::vector<SnapshotPart> parts;
+    const auto written = WriteDelta(
+        reference, parts, std::numeric_limits<size_t>::max(), includedsince);
+
+    for(const auto& part : parts)
+        packet.append(part.Data.getData(), part.Data.getDataSize());
+
+    return written;
+}
+
+DLLEXPORT uint32_t WorldSnapshot::WriteDelta(const WorldSnapshot* reference,
+    std::vector<SnapshotPart>& parts, size_t maxpartbytes,
+    const std::unordered_map<ObjectID, int32_t>* includedsince /*= nullptr*/) const
+{
+    uint32_t written = 0;
+
+    for(const auto& entity : Entities) {
+
+        const WorldSnapshot* entityReference = reference;
+
+        if(includedsince) {
+
+            const auto included = includedsince->find(entity->ID);
+
+            if(included == includedsince->end())
+                continue;
+
+            // The receiver doesn't have the state from before the entity was included
+            if(reference && reference->TickNumber < included->second)
+                entityReference = nullptr;
+        }
+
+        const std::shared_ptr<const SnapshotEntity>* referenceEntity =
+            entityReference ? entityReference->Find(entity->ID) : nullptr;
+
+        sf::Packet stateData;
+        int32_t referenceTick = -1;
+
+        if(referenceEntity) {
+
+            // Unchanged entities share the same object
+            if(*referenceEntity == entity)
+                continue;
+
+            referenceTick = (*referenceEntity)->CapturedTick;
+            entity->State->CreateUpdatePacket(*(*referenceEntity)->State, stateData);
+
+        } else {
+            stateData = entity->FullData;
+        }
+
+        sf::Packet entry;
+        entry << entity->ID << entity->CapturedTick << referenceTick << stateData;
+
+        if(parts.empty() || (parts.back().EntityCount > 0 &&
+                                parts.back().Data.getDataSize() + entry.getDataSize() >
+                                    maxpartbytes)) {
+            parts.emplace_back();
+        }
+
+        auto& part = parts.back();
+        part.Data.append(entry.getData(), entry.getDataSize());
+        ++part.EntityCount;
+        ++written;
+    }
+
+    return written;
+}
+
+DLLEXPORT bool WorldSnapshot::ReadDelta(
+    sf::Packet& packet, uint32_t entitycount, const EntityReader& reader)
+{
+    for(uint32_t i = 0; i < entitycount; ++i) {
+
+        ObjectID id;
+        int32_t capturedTick;
+        int32_t referenceTick;
+        sf::Packet stateData;
+
+        try {
+            packet >> id >> capturedTick >> referenceTick >> stateData;
+        } catch(const InvalidArgument&) {
+            return false;
+        }
+
+        if(!packet)
+            return false;
+
+        reader(id, capturedTick, referenceTick, stateData);
+    }
+
+    return true;
+}
+// ------------------ SnapshotHistory ------------------ //
+DLLEXPORT SnapshotHistory::SnapshotHistory(size_t capacity) :
+    Snapshots(std::max<size_t>(capacity, 1))
+{}
+// ------------------------------------ //
+DLLEXPORT void SnapshotHistory::Add(const std::shared_ptr<WorldSnapshot>& snapshot)
+{
+    Snapshots[Next] = snapshot;
+    Next = (Next + 1) % Snapshots.size();
+    Count = std::min(Count + 1, Snapshots.size());
+}
+
+DLLEXPORT std::shared_ptr<WorldSnapshot> SnapshotHistory::Find(int32_t tick) const
+{
+    const auto newest = GetNewest();
+
+    if(!newest || tick > newest->TickNumber)
+        return nullptr;
+
+    // Snapshots are usually made every tick so the index can be guessed
+    const auto age = static_cast<size_t>(newest->TickNumber - tick);
+
+    if(age < Count) {
+
+        const auto& guess = Snapshots[(Next + Snapshots.size() - 1 - age) % Snapshots.size()];
+
+        if(guess && guess->TickNumber == tick)
+            return guess;
+    }
+
+    for(const auto& snapshot : Snapshots) {
+        if(snapshot && snapshot->TickNumber == tick)
+            return snapshot;
+    }
+
+    return nullptr;
+}
+
+DLLEXPORT std::shared_ptr<WorldSnapshot> SnapshotHistory::GetNewest() const
+{
+    if(Count == 0)
+        return nullptr;
+
+    return Snapshots[(Next + Snapshots.size() - 1) % Snapshots.size()];
+}
+
+DLLEXPORT void SnapshotHistory::Clear()
+{
+    for(auto& snapshot : Snapshots)
+        snapshot.reset();
+
+    Next = 0;
+    Count = 0;
+}
+// ------------------ SnapshotReceiver ------------------ //
+DLLEXPORT void SnapshotReceiver::CheckReceivedSnapshots(const SnapshotHistory& history)
+{
+    for(auto iter = SentSnapshots.begin(); iter != SentSnapshots.end();) {
+
+        const auto& parts = std::get<1>(*iter);
+
+        const bool failed = std::any_of(parts.begin(), parts.end(),
+            [](const std::shared_ptr<SentNetworkThing>& sent) {
+                return sent->IsFinalized() && !sent->GetStatus();
+            });
+
+        if(!failed && !std::all_of(parts.begin(), parts.end(),
+                          [](const std::shared_ptr<SentNetworkThing>& sent) {
+                              return sent->IsFinalized();
+                          })) {
+            ++iter;
+            continue;
+        }
+
+        const auto tick = std::get<0>(*iter);
+
+        // The client is missing some of the states if any part was lost
+        if(!failed && (!AckedSnapshot || tick > AckedSnapshot->TickNumber)) {
+
+            // Acks that arrive after the snapshot is dropped from history can't be used
+            auto snapshot = history.Find(tick);
+
+            if(snapshot)
+                AckedSnapshot = std::move(snapshot);
+        }
+
+        iter = SentSnapshots.erase(iter);
+    }
+
+    if(AckedSnapshot) {
+
+        const auto ackedTick = AckedSnapshot->TickNumber;
+
+        UnackedTicks.erase(std::remove_if(UnackedTicks.begin(), UnackedTicks.end(),
+                               [=](int32_t tick) { return tick <= ackedTick; }),
+            UnackedTicks.end());
+    }
+}
+
+DLLEXPORT const WorldSnapshot* SnapshotReceiver::GetReference(int32_t tick) const
+{
+    // Each sent snapshot may have added one state for an entity on the receiver. Even
+    // snapshots that are thought lost may have arrived
+    if(!AckedSnapshot || UnackedTicks.size() >= KEPT_STATES_COUNT - 1)
+        return nullptr;
+
+    // Ticks without changes aren't sent so the count alone doesn't limit the age
+    if(tick - AckedSnapshot->TickNumber >= KEPT_STATES_COUNT)
+        return nullptr;
+
+    return AckedSnapshot.get();
+}
+
+DLLEXPORT void SnapshotReceiver::ResetReference()
+{
+    AckedSnapshot.reset();
+    SentSnapshots.clear();
+    UnackedTicks.clear();
+}
+// ------------------ SnapshotReplicator ------------------ //
+DLLEXPORT SnapshotReplicator::SnapshotReplicator(size_t historysize /*= 32*/) :
+    History(historysize)
+{}
+// ------------------------------------ //
+DLLEXPORT void SnapshotReplicator::Run(GameWorld& world,
+    std::unordered_map<ObjectID, Sendable*>& index,
+    const WorldJoinStreamer* joinstreams /*= nullptr*/,
+    const std::vector<WorldJoinStreamer::ReceivedEntity>* streamed /*= nullptr*/)
+{
+    const auto previous = History.GetNewest();
+
+    auto snapshot = CaptureSnapshot(world, index, previous.get());
+    History.Add(snapshot);
+
+    _UpdateReceivers(world);
+
+    LastSentEntityCount = 0;
+
+    for(auto& receiver : Receivers)
+        _SendSnapshot(world, receiver, *snapshot, joinstreams, streamed);
+}
+
+DLLEXPORT void SnapshotReplicator::RequestFullSnapshot(const Connection* connection)
+{
+    for(auto& receiver : Receivers) {
+
+        if(receiver.CorrespondingConnection.get() == connection)
+            receiver.ResetReference();
+    }
+}
+
+DLLEXPORT void SnapshotReplicator::Clear()
+{
+    History.Clear();
+    Receivers.clear();
+    LastSentEntityCount = 0;
+}
+// ------------------------------------ //
+DLLEXPORT std::shared_ptr<WorldSnapshot> SnapshotReplicator::CaptureSnapshot(GameWorld& world,
+    std::unordered_map<ObjectID, Sendable*>& index, const WorldSnapshot* previous)
+{
+    auto snapshot = std::make_shared<WorldSnapshot>(world.GetTickNumber());
+    snapshot->Entities.reserve(index.size());
+
+    for(auto iter = index.begin(); iter != index.end(); ++iter) {
+
+        auto& sendable = *iter->second;
+
+        const std::shared_ptr<const SnapshotEntity>* old =
+            previous ? previous->Find(iter->first) : nullptr;
+
+        if(old && !sendable.Marked) {
+            snapshot->Entities.push_back(*old);
+            continue;
+        }
+
+        sendable.Marked = false;
+
+        auto entity = std::make_shared<SnapshotEntity>();
+        entity->ID = iter->first;
+        entity->CapturedTick = snapshot->TickNumber;
+        entity->State = std::make_shared<EntityState>();
+
+        world.CaptureEntityState(iter->first, *entity->State);
+        entity->State->AddDataToPacket(entity->FullData);
+
+        // Marked doesn't always mean that the sent data changes
+        if(old && HasSameData((*old)->FullData, entity->FullData)) {
+            snapshot->Entities.push_back(*old);
+            continue;
+        }
+
+        snapshot->Entities.push_back(std::move(entity));
+    }
+
+    std::sort(snapshot->Entities.begin(), snapshot->Entities.end(),
+        [](const std::shared_ptr<const SnapshotEntity>& first,
+            const std::shared_ptr<const SnapshotEntity>& second) {
+            return first->ID < second->ID;
+        });
+
+    return snapshot;
+}
+// ------------------------------------ //
+void SnapshotReplicator::_UpdateReceivers(GameWorld& world)
+{
+    const auto& players = world.GetConnectedPlayers();
+
+    for(auto iter = Receivers.begin(); iter != Receivers.end();) {
+
+        bool exists = false;
+
+        if(iter->CorrespondingConnection->IsValidForSend()) {
+            for(const auto& player : players) {
+
+                if(iter->CorrespondingConnection == player->GetConnection()) {
+                    exists = true;
+                    break;
+                }
+            }
+        }
+
+        if(!exists) {
+            iter = Receivers.erase(iter);
+            continue;
+        }
+
+        iter->CheckReceivedSnapshots(History);
+        ++iter;
+    }
+
+    for(const auto& player : players) {
+
+        const auto& connection = player->GetConnection();
+
+        if(!connection || !connection->IsValidForSend())
+            continue;
+
+        const bool found = std::any_of(Receivers.begin(), Receivers.end(),
+            [&](const SnapshotReceiver& receiver) {
+                return receiver.CorrespondingConnection == connection;
+            });
+
+        if(!found)
+            Receivers.emplace_back(connection);
+    }
+}
+
+void SnapshotReplicator::_SendSnapshot(GameWorld& world, SnapshotReceiver& receiver,
+    const WorldSnapshot& snapshot, const WorldJoinStreamer* joinstreams,
+    const std::vector<WorldJoinStreamer::ReceivedEntity>* streamed)
+{
+    const auto& connection = receiver.CorrespondingConnection;
+
+    // Entities that were destroyed don't need to be remembered
+    for(auto iter = receiver.CreatedEntities.begin(); iter != receiver.CreatedEntities.end();) {
+
+        if(!snapshot.Find(iter->first)) {
+            iter = receiver.CreatedEntities.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    // The join stream has sent the static state of these
+    if(streamed) {
+        for(const auto& received : *streamed) {
+
+            if(std::get<0>(received) == connection && snapshot.Find(std::get<1>(received)))
+                receiver.CreatedEntities.emplace(std::get<1>(received), snapshot.TickNumber);
+        }
+    }
+
+    // New entities need their static state sent before the first update
+    for(const auto& entity : snapshot.Entities) {
+
+        if(receiver.CreatedEntities.find(entity->ID) != receiver.CreatedEntities.end())
+            continue;
+
+        // Still being sent by the join stream
+        if(joinstreams && joinstreams->IsPending(connection, entity->ID))
+            continue;
+
+        receiver.CreatedEntities.emplace(entity->ID, snapshot.TickNumber);
+
+        sf::Packet initialComponentData;
+        const uint32_t componentCount =
+            world.CaptureEntityStaticState(entity->ID, initialComponentData);
+
+        connection->SendPacketToConnection(
+            std::make_shared<ResponseEntityCreation>(
+                0, world.GetID(), entity->ID, componentCount, std::move(initialComponentData)),
+            RECEIVE_GUARANTEE::Critical);
+    }
+
+    const WorldSnapshot* reference = receiver.GetReference(snapshot.TickNumber);
+
+    std::vector<SnapshotPart> parts;
+    const auto entityCount = snapshot.WriteDelta(reference, parts,
+        static_cast<size_t>(std::max(world.GetNetworkSettings().SnapshotPartBytes, 1)),
+        &receiver.CreatedEntities);
+
+    // Nothing has changed. The reference stays valid as no new states were sent
+    if(entityCount == 0)
+        return;
+
+    std::vector<std::shared_ptr<SentNetworkThing>> sentParts;
+    sentParts.reserve(parts.size());
+
+    for(auto& part : parts) {
+
+        sentParts.push_back(connection->SendPacketToConnectionWithTrackingWithoutGuarantee(
+            ResponseWorldSnapshot(0, world.GetID(), snapshot.TickNumber,
+                reference ? reference->TickNumber : -1, part.EntityCount,
+                std::move(part.Data))));
+    }
+
+    receiver.SentSnapshots.emplace_back(snapshot.TickNumber, std::move(sentParts));
+    receiver.UnackedTicks.push_back(snapshot.TickNumber);
+
+    LastSentEntityCount += entityCount;
+}
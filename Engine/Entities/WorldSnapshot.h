@@ -0,0 +1,227 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Common/SFMLPackets.h"
+#include "EntityCommon.h"
+#include "WorldJoinStreamer.h"
+
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace Leviathan {
+
+class Connection;
+class EntityState;
+class GameWorld;
+class Sendable;
+class SentNetworkThing;
+
+//! \brief State of a single entity in a WorldSnapshot
+//!
+//! Entities that haven't changed share the same object between snapshots
+struct SnapshotEntity {
+
+    ObjectID ID;
+
+    //! The tick the state was captured on. The receiver stores the state with this tick so
+    //! that it can be found when this is used as a reference
+    int32_t CapturedTick;
+
+    std::shared_ptr<EntityState> State;
+
+    //! The full serialized state, used to detect changes
+    sf::Packet FullData;
+};
+
+//! \brief Part of a WorldSnapshot that is small enough to be sent as one message
+struct SnapshotPart {
+
+    uint32_t EntityCount = 0;
+    sf::Packet Data;
+};
+
+//! \brief States of all the sendable entities in a world on a single tick
+class WorldSnapshot {
+public:
+    inline WorldSnapshot(int32_t tick) : TickNumber(tick) {}
+
+    //! \returns The entity with id or null
+    DLLEXPORT const std::shared_ptr<const SnapshotEntity>* Find(ObjectID id) const;
+
+    //! \brief Writes the entities that have changed since reference to packet
+    //! \param reference The snapshot the receiver has acknowledged or null for a full update
+    //! \param includedsince If not null only the entities in this are written. The value is
+    //! the first tick the entity was sent on, older references aren't used for it
+    //! \returns The number of entities that were written
+    DLLEXPORT uint32_t WriteDelta(const WorldSnapshot* reference, sf::Packet& packet,
+        const std::unordered_map<ObjectID, int32_t>* includedsince = nullptr) const;
+
+    //! \brief Variant of WriteDelta that splits the entities into parts
+    //!
+    //! A new part is started when the next entity would make the current one larger than
+    //! maxpartbytes. An entity that is alone larger than that gets a part of its own
+    //! \returns The total number of entities that were written
+    DLLEXPORT uint32_t WriteDelta(const WorldSnapshot* reference,
+        std::vector<SnapshotPart>& parts, size_t maxpartbytes,
+        const std::unordered_map<ObjectID, int32_t>* includedsince = nullptr) const;
+
+    using EntityReader = std::function<void(ObjectID id, int32_t capturedtick,
+        int32_t referencetick, sf::Packet& statedata)>;
+
+    //! \brief Calls reader for each entity written by WriteDelta
+    //! \returns False if the packet was malformed
+    DLLEXPORT static bool ReadDelta(
+        sf::Packet& packet, uint32_t entitycount, const EntityReader& reader);
+
+    int32_t TickNumber;
+
+    //! Sorted by id
+    std::vector<std::shared_ptr<const SnapshotEntity>> Entities;
+};
+
+//! \brief Ring of the latest snapshots
+class SnapshotHistory {
+public:
+    DLLEXPORT SnapshotHistory(size_t capacity);
+
+    //! \brief Adds a snapshot overwriting the oldest one if full
+    DLLEXPORT void Add(const std::shared_ptr<WorldSnapshot>& snapshot);
+
+    //! \returns The snapshot with tick or null if it isn't stored anymore
+    DLLEXPORT std::shared_ptr<WorldSnapshot> Find(int32_t tick) const;
+
+    DLLEXPORT std::shared_ptr<WorldSnapshot> GetNewest() const;
+
+    DLLEXPORT void Clear();
+
+    inline size_t GetCapacity() const
+    {
+        return Snapshots.size();
+    }
+
+    inline size_t GetCount() const
+    {
+        return Count;
+    }
+
+protected:
+    std::vector<std::shared_ptr<WorldSnapshot>> Snapshots;
+
+    //! Index where the next snapshot is stored
+    size_t Next = 0;
+    size_t Count = 0;
+};
+
+//! \brief Replication state for a single client in snapshot mode
+class SnapshotReceiver {
+public:
+    inline SnapshotReceiver(const std::shared_ptr<Connection>& connection) :
+        CorrespondingConnection(connection)
+    {}
+
+    //! \brief Moves AckedSnapshot forward if newer snapshots have been received
+    DLLEXPORT void CheckReceivedSnapshots(const SnapshotHistory& history);
+
+    //! \returns The snapshot to use as a reference or null if a full update must be sent
+    //!
+    //! The receiver keeps only KEPT_STATES_COUNT states per entity so the acknowledged
+    //! snapshot can't be used once too many newer ones could have been received or it is
+    //! KEPT_STATES_COUNT or more ticks older than the snapshot being sent
+    //! \param tick The tick of the snapshot that is going to be sent
+    DLLEXPORT const WorldSnapshot* GetReference(int32_t tick) const;
+
+    //! \brief Forgets the acknowledged snapshot so that the next snapshot is sent in full
+    //!
+    //! Used when the client couldn't decode a snapshot. The snapshots still on the way may
+    //! fail the same way so their acknowledgements are ignored
+    DLLEXPORT void ResetReference();
+
+    std::shared_ptr<Connection> CorrespondingConnection;
+
+    //! The newest snapshot that the client has received
+    std::shared_ptr<WorldSnapshot> AckedSnapshot;
+
+    //! Snapshots sent to this client that haven't failed or been received yet. A snapshot
+    //! counts as received only once all of its parts have been received
+    std::vector<std::tuple<int32_t, std::vector<std::shared_ptr<SentNetworkThing>>>>
+        SentSnapshots;
+
+    //! Ticks of all the snapshots sent after AckedSnapshot, including ones thought lost
+    std::vector<int32_t> UnackedTicks;
+
+    //! Entities that the client has been sent a creation message for and the tick of the
+    //! first snapshot they were included in
+    std::unordered_map<ObjectID, int32_t> CreatedEntities;
+};
+
+//! \brief Sends all the Sendable entities of a world as one snapshot per tick to each
+//! client
+//!
+//! Replaces the per entity update tracking of SendableSystem when
+//! WorldNetworkSettings::UseSnapshots is set. The snapshots are sent without guarantee and
+//! the delta is always against the newest snapshot the client has acknowledged. Snapshots
+//! are split into parts of at most WorldNetworkSettings::SnapshotPartBytes
+class SnapshotReplicator {
+public:
+    //! \param historysize How many ticks back acknowledgements can be used
+    DLLEXPORT SnapshotReplicator(size_t historysize = 32);
+
+    //! \brief Captures a snapshot of the current tick and sends it to all the players
+    //! \param joinstreams If not null entities that are pending in it are left out
+    //! \param streamed Entities that joinstreams has finished sending, they are included in
+    //! snapshots from now on
+    DLLEXPORT void Run(GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index,
+        const WorldJoinStreamer* joinstreams = nullptr,
+        const std::vector<WorldJoinStreamer::ReceivedEntity>* streamed = nullptr);
+
+    //! \brief Removes all snapshots and receivers
+    DLLEXPORT void Clear();
+
+    //! \brief Makes the next snapshot sent to connection a full one
+    DLLEXPORT void RequestFullSnapshot(const Connection* connection);
+
+    inline const SnapshotHistory& GetHistory() const
+    {
+        return History;
+    }
+
+    inline size_t GetReceiverCount() const
+    {
+        return Receivers.size();
+    }
+
+    //! \returns The number of entity states in the snapshots sent on the last tick
+    inline size_t GetLastSentEntityCount() const
+    {
+        return LastSentEntityCount;
+    }
+
+    //! \brief Captures a new snapshot, reusing unchanged entities from previous
+    //!
+    //! Only entities that have Sendable marked or are new are captured again. Captured
+    //! states that serialize the same as before are also replaced with the previous ones
+    DLLEXPORT static std::shared_ptr<WorldSnapshot> CaptureSnapshot(GameWorld& world,
+        std::unordered_map<ObjectID, Sendable*>& index, const WorldSnapshot* previous);
+
+protected:
+    //! \brief Adds new players and removes disconnected ones
+    void _UpdateReceivers(GameWorld& world);
+
+    void _SendSnapshot(GameWorld& world, SnapshotReceiver& receiver,
+        const WorldSnapshot& snapshot, const WorldJoinStreamer* joinstreams,
+        const std::vector<WorldJoinStreamer::ReceivedEntity>* streamed);
+
+protected:
+    SnapshotHistory History;
+
+    std::vector<SnapshotReceiver> Receivers;
+
+    size_t LastSentEntityCount = 0;
+};
+
+} // namespace Leviathan
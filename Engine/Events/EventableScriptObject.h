@@ -38,6 +38,8 @@ protected:
 
     //! Needed to pass the derived type to the callback
     //!
+    //! Implementations should keep the listeners prepared with PreparedScriptCall, like
+    //! GameModule does, as sargs is the same for every event of a type.
     //! \example \code{cpp}
     //!     if(event)
     //! return ScriptExecutor::Get()->RunScript<int>(
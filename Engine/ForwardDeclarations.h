@@ -31,6 +31,7 @@ class RenderingStatistics;
 class IDFactory;
 class Time;
 class ConsoleInput;
+class MainLoopWaiter;
 
 class Locker;
 
@@ -95,6 +96,7 @@ class NULLPtr;
 
 class ObjectFileTemplateInstance;
 class ObjectFileTemplateDefinition;
+class ObjectFileCache;
 
 class ObjectFileList;
 
@@ -183,8 +185,7 @@ class StringIterator;
 class Window;
 class Random;
 class VariableBlock;
-class TimingMonitor;
-class ScopeTimer;
+class Profiler;
 struct MasterServerInformation;
 class GlobalCEFHandler;
 } // namespace Leviathan
@@ -218,13 +219,11 @@ using Leviathan::NetworkClientInterface;
 using Leviathan::NetworkRequest;
 using Leviathan::NetworkResponse;
 using Leviathan::QueuedTask;
-using Leviathan::ScopeTimer;
 using Leviathan::SentNetworkThing;
 using Leviathan::StringIterator;
 using Leviathan::SyncedPrimitive;
 using Leviathan::SyncedResource;
 using Leviathan::SyncedValue;
-using Leviathan::TimingMonitor;
 using Leviathan::UTF8DataIterator;
 using Leviathan::VariableBlock;
 using Leviathan::GUI::GuiManager;
@@ -102,6 +102,9 @@ public:
 
     DLLEXPORT virtual void OnMouseButton(const SDL_Event& event, bool down) {}
 
+    //! \brief Called by GuiManager before each frame is rendered
+    DLLEXPORT virtual void OnRender() {}
+
 protected:
     // Callbacks vor derived classes
     DLLEXPORT virtual void _DoReleaseResources() {}
@@ -143,8 +143,9 @@ DLLEXPORT void GuiManager::SetDisableMouseCapture(bool newvalue)
 // ------------------------------------ //
 void GuiManager::Render()
 {
-    // Browser textures are now updated in the event loop (on the main thread between
-    // rendering)
+    // Browsers paint in the event loop and the changes are uploaded here
+    for(const auto& layer : ManagedLayers)
+        layer->OnRender();
 }
 // ------------------------------------ //
 DLLEXPORT void GuiManager::OnResize()
@@ -0,0 +1,254 @@
+// ------------------------------------ //
+#include "GuiPaintStaging.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Leviathan;
+using namespace Leviathan::GUI;
+// ------------------------------------ //
+DLLEXPORT PaintStaging::PaintStaging(float fulluploadthreshold /*= 0.5f*/)
+{
+    SetFullUploadThreshold(fulluploadthreshold);
+}
+// ------------------------------------ //
+DLLEXPORT void PaintStaging::Write(
+    const void* buffer, int width, int height, const std::vector<PaintRect>& dirty)
+{
+    if(!buffer || width <= 0 || height <= 0)
+        return;
+
+    StagedImage* image;
+    {
+        GUARD_LOCK();
+        Writing = true;
+        image = &Images[WriteIndex];
+    }
+
+    const PaintRect whole{0, 0, width, height};
+
+    // Everything needs uploading when the size changes
+    const bool sizeChanged = width != PaintedWidth || height != PaintedHeight;
+    PaintedWidth = width;
+    PaintedHeight = height;
+
+    std::vector<PaintRect> changed;
+
+    if(sizeChanged) {
+        changed.push_back(whole);
+    } else {
+        for(const auto& rect : dirty) {
+
+            const auto clamped = ClampRect(rect, width, height);
+
+            if(clamped.GetArea() > 0)
+                changed.push_back(clamped);
+        }
+    }
+
+    std::vector<PaintRect> toCopy = changed;
+
+    if(image->Width != width || image->Height != height) {
+
+        image->Pixels.resize(static_cast<size_t>(width) * height * BYTES_PER_PIXEL);
+        image->Width = width;
+        image->Height = height;
+        toCopy.assign(1, whole);
+
+    } else {
+        // The image also needs the parts that were painted to the other image. Those may
+        // be from before a resize
+        for(const auto& rect : image->Missing) {
+
+            const auto clamped = ClampRect(rect, width, height);
+
+            if(clamped.GetArea() > 0)
+                toCopy.push_back(clamped);
+        }
+    }
+
+    image->Missing.clear();
+
+    MergeRects(toCopy);
+
+    const size_t pitch = static_cast<size_t>(width) * BYTES_PER_PIXEL;
+
+    for(const auto& rect : toCopy)
+        CopyRect(static_cast<const uint8_t*>(buffer), pitch, image->Pixels.data(), pitch, rect);
+
+    GUARD_LOCK();
+    Writing = false;
+
+    if(sizeChanged) {
+        Unpublished.clear();
+        UnpublishedResize = true;
+    }
+
+    Unpublished.insert(Unpublished.end(), changed.begin(), changed.end());
+    MergeRects(Unpublished);
+
+    _Publish(guard);
+}
+
+DLLEXPORT bool PaintStaging::Read(const UploadCallback& uploader)
+{
+    const StagedImage* image;
+    std::vector<PaintRect> rects;
+    bool full;
+    {
+        GUARD_LOCK();
+
+        _Publish(guard);
+
+        if(PendingUpload.empty())
+            return false;
+
+        Reading = true;
+        rects.swap(PendingUpload);
+        image = &Images[1 - WriteIndex];
+
+        full = PendingFullUpload;
+        PendingFullUpload = false;
+    }
+
+    // The rects don't overlap after merging so the area isn't counted twice
+    int64_t changedArea = 0;
+
+    for(auto& rect : rects) {
+        rect = ClampRect(rect, image->Width, image->Height);
+        changedArea += rect.GetArea();
+    }
+
+    const int64_t totalArea = static_cast<int64_t>(image->Width) * image->Height;
+
+    if(changedArea >= FullUploadThreshold * totalArea)
+        full = true;
+
+    if(full) {
+        rects.clear();
+        rects.push_back(PaintRect{0, 0, image->Width, image->Height});
+        changedArea = totalArea;
+    }
+
+    try {
+        uploader(image->Pixels.data(), image->Width, image->Height, rects, full);
+    } catch(...) {
+        GUARD_LOCK();
+        Reading = false;
+        throw;
+    }
+
+    {
+        GUARD_LOCK();
+        Reading = false;
+    }
+
+    const auto bytes = static_cast<uint64_t>(changedArea) * BYTES_PER_PIXEL;
+
+    LastUploadBytes = bytes;
+    TotalUploadBytes += bytes;
+    ++UploadCount;
+
+    if(full)
+        ++FullUploadCount;
+
+    return true;
+}
+
+DLLEXPORT void PaintStaging::SetFullUploadThreshold(float threshold)
+{
+    FullUploadThreshold = std::min(std::max(threshold, 0.f), 1.f);
+}
+// ------------------------------------ //
+void PaintStaging::_Publish(Lock& guard)
+{
+    if(Writing || Reading || Unpublished.empty())
+        return;
+
+    WriteIndex = 1 - WriteIndex;
+
+    auto& missing = Images[WriteIndex].Missing;
+    missing.insert(missing.end(), Unpublished.begin(), Unpublished.end());
+
+    // Rects from before a resize don't mean anything for the new image
+    if(UnpublishedResize) {
+        PendingUpload.clear();
+        PendingFullUpload = true;
+        UnpublishedResize = false;
+    }
+
+    PendingUpload.insert(PendingUpload.end(), Unpublished.begin(), Unpublished.end());
+    MergeRects(PendingUpload);
+
+    Unpublished.clear();
+}
+// ------------------------------------ //
+DLLEXPORT void PaintStaging::MergeRects(std::vector<PaintRect>& rects)
+{
+    bool merged = true;
+
+    while(merged) {
+
+        merged = false;
+
+        for(size_t i = 0; i < rects.size(); ++i) {
+
+            size_t j = i + 1;
+
+            while(j < rects.size()) {
+
+                const auto& other = rects[j];
+                auto& current = rects[i];
+
+                if(!current.Touches(other)) {
+                    ++j;
+                    continue;
+                }
+
+                const int right = std::max(current.X + current.Width, other.X + other.Width);
+                const int bottom =
+                    std::max(current.Y + current.Height, other.Y + other.Height);
+
+                current.X = std::min(current.X, other.X);
+                current.Y = std::min(current.Y, other.Y);
+                current.Width = right - current.X;
+                current.Height = bottom - current.Y;
+
+                // The order doesn't matter so this can swap with the last
+                rects[j] = rects.back();
+                rects.pop_back();
+                merged = true;
+            }
+        }
+    }
+}
+
+DLLEXPORT void PaintStaging::CopyRect(const uint8_t* source, size_t sourcepitch,
+    uint8_t* target, size_t targetpitch, const PaintRect& rect)
+{
+    const size_t rowBytes = static_cast<size_t>(rect.Width) * BYTES_PER_PIXEL;
+    const size_t offset = static_cast<size_t>(rect.X) * BYTES_PER_PIXEL;
+
+    // Full rows with matching pitches are one continuous block
+    if(rect.X == 0 && rowBytes == sourcepitch && sourcepitch == targetpitch) {
+
+        std::memcpy(target + rect.Y * targetpitch, source + rect.Y * sourcepitch,
+            rowBytes * rect.Height);
+        return;
+    }
+
+    for(int y = rect.Y; y < rect.Y + rect.Height; ++y) {
+        std::memcpy(target + y * targetpitch + offset, source + y * sourcepitch + offset,
+            rowBytes);
+    }
+}
+
+DLLEXPORT PaintRect PaintStaging::ClampRect(const PaintRect& rect, int width, int height)
+{
+    const int left = std::min(std::max(rect.X, 0), width);
+    const int top = std::min(std::max(rect.Y, 0), height);
+    const int right = std::min(std::max(rect.X + rect.Width, left), width);
+    const int bottom = std::min(std::max(rect.Y + rect.Height, top), height);
+
+    return PaintRect{left, top, right - left, bottom - top};
+}
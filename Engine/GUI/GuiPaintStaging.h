@@ -0,0 +1,158 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2019 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Common/ThreadSafe.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Leviathan { namespace GUI {
+
+//! \brief Rectangle of changed pixels in a painted image
+struct PaintRect {
+
+    inline int64_t GetArea() const
+    {
+        return static_cast<int64_t>(Width) * Height;
+    }
+
+    //! \returns True if the rects overlap or share an edge
+    inline bool Touches(const PaintRect& other) const
+    {
+        return X <= other.X + other.Width && other.X <= X + Width &&
+               Y <= other.Y + other.Height && other.Y <= Y + Height;
+    }
+
+    inline bool operator==(const PaintRect& other) const
+    {
+        return X == other.X && Y == other.Y && Width == other.Width && Height == other.Height;
+    }
+
+    int X = 0;
+    int Y = 0;
+    int Width = 0;
+    int Height = 0;
+};
+
+//! \brief Stages images painted on one thread to be uploaded to a texture on another
+//!
+//! The painting thread copies the dirty rects row by row into one of two staging images while
+//! the uploading thread reads the other, so neither side holds the lock while copying pixels.
+//! The images are swapped once the painter is done with a frame and the uploader isn't
+//! reading. The staging image that was swapped out is brought up to date from the next
+//! painted frame by also copying the rects it missed.
+//!
+//! When the changed area is over FullUploadThreshold of the image or the image size has
+//! changed the uploader is told to upload the whole image as one block instead of the
+//! separate rects.
+class PaintStaging : public ThreadSafe {
+public:
+    static constexpr size_t BYTES_PER_PIXEL = 4;
+
+    //! \param uploader Receives the staged pixels, the image size, the rects that need
+    //! uploading and true if the whole image should be uploaded
+    using UploadCallback = std::function<void(const uint8_t* pixels, int width, int height,
+        const std::vector<PaintRect>& rects, bool full)>;
+
+    //! \param fulluploadthreshold Fraction of the image area above which everything is
+    //! uploaded at once, see SetFullUploadThreshold
+    DLLEXPORT PaintStaging(float fulluploadthreshold = 0.5f);
+
+    //! \brief Copies the dirty parts of buffer into staging
+    //! \param buffer The full painted image, width * height pixels without padding
+    //! \param dirty Changed rects, the parts outside the image are ignored
+    DLLEXPORT void Write(
+        const void* buffer, int width, int height, const std::vector<PaintRect>& dirty);
+
+    //! \brief Calls uploader with the changes since the last call
+    //! \returns False if there was nothing new to upload
+    DLLEXPORT bool Read(const UploadCallback& uploader);
+
+    //! \param threshold Clamped to [0, 1]. 0 always uploads everything and 1 only when
+    //! the whole image has changed
+    DLLEXPORT void SetFullUploadThreshold(float threshold);
+
+    //! \returns The amount of bytes the last Read uploaded
+    DLLEXPORT inline uint64_t GetLastUploadBytes() const
+    {
+        return LastUploadBytes;
+    }
+
+    DLLEXPORT inline uint64_t GetTotalUploadBytes() const
+    {
+        return TotalUploadBytes;
+    }
+
+    DLLEXPORT inline uint64_t GetUploadCount() const
+    {
+        return UploadCount;
+    }
+
+    DLLEXPORT inline uint64_t GetFullUploadCount() const
+    {
+        return FullUploadCount;
+    }
+
+    //! \brief Combines rects that touch until none of them do
+    DLLEXPORT static void MergeRects(std::vector<PaintRect>& rects);
+
+    //! \brief Copies rect from source to target with a memcpy per row
+    //! \param sourcepitch Bytes per row in source
+    DLLEXPORT static void CopyRect(const uint8_t* source, size_t sourcepitch, uint8_t* target,
+        size_t targetpitch, const PaintRect& rect);
+
+    //! \returns rect limited to be inside a width * height image
+    DLLEXPORT static PaintRect ClampRect(const PaintRect& rect, int width, int height);
+
+protected:
+    struct StagedImage {
+
+        std::vector<uint8_t> Pixels;
+        int Width = 0;
+        int Height = 0;
+
+        //! Rects changed in the other image since this was last written to
+        std::vector<PaintRect> Missing;
+    };
+
+    //! \brief Swaps the images if both sides are done with theirs
+    void _Publish(Lock& guard);
+
+protected:
+    float FullUploadThreshold;
+
+    StagedImage Images[2];
+
+    //! Image owned by the painter. The other image is read by the uploader
+    int WriteIndex = 0;
+
+    //! Size of the last painted image. Only used by the painter
+    int PaintedWidth = 0;
+    int PaintedHeight = 0;
+
+    bool Writing = false;
+    bool Reading = false;
+
+    //! Rects written to the write image that haven't been swapped to the uploader yet
+    std::vector<PaintRect> Unpublished;
+
+    //! Set when the size of the write image has changed and not yet been swapped
+    bool UnpublishedResize = false;
+
+    //! Rects in the read image that haven't been uploaded yet
+    std::vector<PaintRect> PendingUpload;
+
+    //! The read image was resized so everything needs to be uploaded
+    bool PendingFullUpload = false;
+
+    std::atomic<uint64_t> LastUploadBytes{0};
+    std::atomic<uint64_t> TotalUploadBytes{0};
+    std::atomic<uint64_t> UploadCount{0};
+    std::atomic<uint64_t> FullUploadCount{0};
+};
+
+}} // namespace Leviathan::GUI
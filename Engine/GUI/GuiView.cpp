@@ -470,7 +470,6 @@ void View::OnPaint(CefRefPtr<CefBrowser> browser, PaintElementType type,
     const RectList& dirtyRects, const void* buffer, int width, int height)
 {
     CEF_REQUIRE_UI_THREAD();
-    Engine::Get()->AssertIfNotMainThread();
 
     if(dirtyRects.empty()) {
 
@@ -478,98 +477,73 @@ void View::OnPaint(CefRefPtr<CefBrowser> browser, PaintElementType type,
         return;
     }
 
-    // Lock us, just for fun //
-    // As we are always on the main thread
-    GUARD_LOCK();
-
-    // Calculate the size of the buffer //
-    size_t buffSize = width * height * CEF_BYTES_PER_PIXEL;
-
-    Ogre::TexturePtr targettexture;
-
     switch(type) {
     case PET_POPUP: {
         LOG_ERROR("CEF PET_POPUP not handled");
         return;
     }
-    case PET_VIEW: {
-        targettexture = Texture;
-        break;
-    }
+    case PET_VIEW: break;
     default: LOG_FATAL("Unknown paint type in View: OnPaint"); return;
     }
 
-    if(!targettexture) {
-        LOG_WARNING(
-            "View: OnPaint: Ogre texture is null (perhaps released already?), skipping");
+    std::vector<PaintRect> dirty;
+    dirty.reserve(dirtyRects.size());
+
+    for(const auto& rect : dirtyRects)
+        dirty.push_back(PaintRect{rect.x, rect.y, rect.width, rect.height});
+
+    // This only copies to the staging image so this doesn't need to wait for rendering. The
+    // texture is updated in OnRender
+    Staging.Write(buffer, width, height, dirty);
+}
+
+DLLEXPORT void View::OnRender()
+{
+    if(!Texture)
         return;
-    }
 
+    Staging.Read([this](const uint8_t* pixels, int width, int height,
+                     const std::vector<PaintRect>& rects, bool full) {
+        _UploadPaint(pixels, width, height, rects, full);
+    });
+}
+
+void View::_UploadPaint(const uint8_t* pixels, int width, int height,
+    const std::vector<PaintRect>& rects, bool full)
+{
     // Make sure our texture is large enough //
-    if(targettexture->getWidth() != static_cast<size_t>(width) ||
-        targettexture->getHeight() != static_cast<size_t>(height)) {
+    if(Texture->getWidth() != static_cast<size_t>(width) ||
+        Texture->getHeight() != static_cast<size_t>(height)) {
 
         // Free resources and then change the size //
-        targettexture->freeInternalResources();
-        targettexture->setWidth(width);
-        targettexture->setHeight(height);
-        targettexture->createInternalResources();
+        Texture->freeInternalResources();
+        Texture->setWidth(width);
+        Texture->setHeight(height);
+        Texture->createInternalResources();
 
         LOG_INFO("GuiView: recreated texture for CEF browser");
     }
 
-    // Copy it to our texture //
-    Ogre::v1::HardwarePixelBufferSharedPtr pixelBuffer = targettexture->getBuffer();
-
-    LEVIATHAN_ASSERT(
-        pixelBuffer->getSizeInBytes() == buffSize, "CEF and Ogre buffer size mismatch");
-
-    // Copy the data over //
-    const auto firstRect = dirtyRects.front();
-    if(dirtyRects.size() == 1 && firstRect.x == 0 && firstRect.y == 0 &&
-        firstRect.width == width && firstRect.height == height) {
-
-        // Can directly copy the whole thing
-        pixelBuffer->lock(Ogre::v1::HardwareBuffer::HBL_DISCARD);
-        const Ogre::PixelBox& pixelBox = pixelBuffer->getCurrentLock();
-
-        uint8_t* destptr = static_cast<uint8_t*>(pixelBox.data);
-        std::memcpy(destptr, buffer, buffSize);
-
-        pixelBuffer->unlock();
-
-    } else {
-
-        // Lock buffer and get a target box for writing //
-        pixelBuffer->lock(Ogre::v1::HardwareBuffer::HBL_NORMAL);
-        const Ogre::PixelBox& pixelBox = pixelBuffer->getCurrentLock();
-
-        uint32_t* destptr = static_cast<uint32_t*>(pixelBox.data);
-        const uint32_t* source = static_cast<const uint32_t*>(buffer);
+    Ogre::v1::HardwarePixelBufferSharedPtr pixelBuffer = Texture->getBuffer();
 
-        const size_t rowElements = pixelBox.rowPitch;
+    LEVIATHAN_ASSERT(pixelBuffer->getSizeInBytes() ==
+                         static_cast<size_t>(width) * height * CEF_BYTES_PER_PIXEL,
+        "CEF and Ogre buffer size mismatch");
 
-        for(const auto rect : dirtyRects) {
+    // The old contents are only needed when some of it is kept
+    pixelBuffer->lock(
+        full ? Ogre::v1::HardwareBuffer::HBL_DISCARD : Ogre::v1::HardwareBuffer::HBL_NORMAL);
+    const Ogre::PixelBox& pixelBox = pixelBuffer->getCurrentLock();
 
-            const auto lastX = rect.x + rect.width;
-            const auto lastY = rect.y + rect.height;
+    uint8_t* destptr = static_cast<uint8_t*>(pixelBox.data);
 
-            for(int y = rect.y; y < lastY; ++y) {
-                for(int x = rect.x; x < lastX; ++x) {
+    const size_t sourcePitch = static_cast<size_t>(width) * CEF_BYTES_PER_PIXEL;
+    const size_t targetPitch = pixelBox.rowPitch * CEF_BYTES_PER_PIXEL;
 
-                    // Safety check. Comment out when not debugging
-                    // LEVIATHAN_ASSERT(y >= 0 && y < height, "View OnPaint y out of range");
-                    // LEVIATHAN_ASSERT(x >= 0 && x < width, "View OnPaint x out of range");
+    for(const auto& rect : rects)
+        PaintStaging::CopyRect(pixels, sourcePitch, destptr, targetPitch, rect);
 
-                    destptr[(rowElements * y) + x] = source[(y * width) + x];
-                }
-            }
-        }
-
-        // std::memset(destptr, 255, pixelBuffer->getSizeInBytes());
-        // Unlock the buffer //
-        pixelBuffer->unlock();
-    }
+    pixelBuffer->unlock();
 
     // // Save render result
     // Ogre::Image img;
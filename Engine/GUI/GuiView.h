@@ -6,6 +6,7 @@
 #include "Common/BaseNotifiable.h"
 #include "Events/CallableObject.h"
 #include "GuiLayer.h"
+#include "GuiPaintStaging.h"
 #include "JSProxyable.h"
 
 #include "include/cef_client.h"
@@ -100,6 +101,15 @@ public:
 
     DLLEXPORT void OnMouseButton(const SDL_Event& event, bool down) override;
 
+    //! \brief Uploads the parts CEF has painted since the last frame to the texture
+    DLLEXPORT void OnRender() override;
+
+    //! \returns The staging of painted images. Has the texture upload statistics
+    DLLEXPORT inline const PaintStaging& GetPaintStaging() const
+    {
+        return Staging;
+    }
+
     // CEF callbacks //
 
     virtual bool GetRootScreenRect(CefRefPtr<CefBrowser> browser, CefRect& rect) override;
@@ -281,6 +291,9 @@ protected:
 
     void _HandleDestroyProxyMsg(int id);
 
+    void _UploadPaint(const uint8_t* pixels, int width, int height,
+        const std::vector<PaintRect>& rects, bool full);
+
 protected:
     //! This View's security level
     //! \see VIEW_SECURITYLEVEL
@@ -319,6 +332,9 @@ protected:
 
     //! The direct texture pointer
     Ogre::TexturePtr Texture;
+
+    //! OnPaint writes here and OnRender uploads from here to Texture
+    PaintStaging Staging;
 };
 
 }} // namespace Leviathan::GUI
@@ -28,6 +28,14 @@ constexpr AVPixelFormat FFMPEG_DECODE_TARGET = AV_PIX_FMT_RGBA;
 // // This must match the above definition
 // constexpr AVPixelFormat FFMPEG_DECODE_TARGET_NO_ALPHA = AV_PIX_FMT_RGB24;
 
+//! Converted frames the decoder thread keeps ready
+constexpr size_t MAX_QUEUED_VIDEO_FRAMES = 4;
+
+//! Seconds of resampled audio the decoder thread keeps ready
+constexpr float MAX_QUEUED_AUDIO_SECONDS = 0.5f;
+
+//! How long the decoder thread waits when the queues are full if it isn't woken up
+constexpr auto DECODER_IDLE_WAIT = std::chrono::milliseconds(5);
 
 DLLEXPORT VideoPlayer::VideoPlayer() {}
 
@@ -83,6 +91,7 @@ DLLEXPORT bool VideoPlayer::Play(const std::string& videofile)
 
     // Make tick run
     IsPlaying = true;
+    DecoderThread = std::thread(&VideoPlayer::RunDecoderThread, this);
     RegisterForEvent(EVENT_TYPE_FRAME_BEGIN);
     return true;
 }
@@ -92,6 +101,9 @@ DLLEXPORT void VideoPlayer::Stop()
     // Close all ffmpeg resources //
     StreamValid = false;
 
+    // The decoder thread uses all the ffmpeg objects so it needs to quit first
+    StopDecoderThread();
+
     // Stop audio playing first //
     if(IsPlayingAudio) {
         IsPlayingAudio = false;
@@ -123,6 +135,15 @@ DLLEXPORT void VideoPlayer::Stop()
 
         // PlayingSource = nullptr;
         ReadAudioDataBuffer.clear();
+        FreeAudioPackets.clear();
+        QueuedAudioBytes = 0;
+    }
+
+    {
+        Lock lock(FrameMutex);
+
+        QueuedVideoFrames.clear();
+        FreeVideoFrames.clear();
     }
 
     // Video and Audio codecs are released by Context, but we still free them here?
@@ -148,10 +169,6 @@ DLLEXPORT void VideoPlayer::Stop()
         av_frame_free(&DecodedFrame);
     if(DecodedAudio)
         av_frame_free(&DecodedAudio);
-    if(ConvertedFrameBuffer)
-        av_freep(&ConvertedFrameBuffer);
-    if(ConvertedFrame)
-        av_frame_free(&ConvertedFrame);
 
     // if(ResourceReader){
 
@@ -301,10 +318,9 @@ bool VideoPlayer::FFMPEGLoadFile()
     }
 
     DecodedFrame = av_frame_alloc();
-    ConvertedFrame = av_frame_alloc();
     DecodedAudio = av_frame_alloc();
 
-    if(!DecodedFrame || !ConvertedFrame || !DecodedAudio) {
+    if(!DecodedFrame || !DecodedAudio) {
         LOG_ERROR("VideoPlayer: FFMPEG: av_frame_alloc failed");
         return false;
     }
@@ -316,14 +332,6 @@ bool VideoPlayer::FFMPEGLoadFile()
     ConvertedBufferSize =
         av_image_get_buffer_size(FFMPEG_DECODE_TARGET, FrameWidth, FrameHeight, 1);
 
-    ConvertedFrameBuffer =
-        reinterpret_cast<uint8_t*>(av_malloc(ConvertedBufferSize * sizeof(uint8_t)));
-
-    if(!ConvertedFrameBuffer) {
-        LOG_ERROR("VideoPlayer: FFMPEG: av_malloc failed for ConvertedFrameBuffer");
-        return false;
-    }
-
     if(ConvertedBufferSize != static_cast<size_t>(FrameWidth * FrameHeight * 4)) {
 
         LOG_ERROR("VideoPlayer: FFMPEG: FFMPEG and Ogre image data sizes don't match! "
@@ -331,12 +339,6 @@ bool VideoPlayer::FFMPEGLoadFile()
         return false;
     }
 
-    if(av_image_fill_arrays(ConvertedFrame->data, ConvertedFrame->linesize,
-           ConvertedFrameBuffer, FFMPEG_DECODE_TARGET, FrameWidth, FrameHeight, 1) < 0) {
-        LOG_ERROR("VideoPlayer: FFMPEG: av_image_fill_arrays failed");
-        return false;
-    }
-
     // Converting images to be ogre compatible is done by this
     // TODO: allow controlling how good conversion is done
     // SWS_FAST_BILINEAR is the fastest
@@ -421,10 +423,17 @@ bool VideoPlayer::FFMPEGLoadFile()
     FirstCallbackAfterPlay = true;
 
     PassedTimeSeconds = 0.f;
-    NextFrameReady = false;
     // This is -1 to make this smaller than 0
     CurrentlyDecodedTimeStamp = -1.f;
 
+    StopDecoder = false;
+    VideoDecodeEnded = false;
+    AudioDecodeEnded = !AudioCodec;
+
+    ShownFrames = 0;
+    DroppedFrames = 0;
+    AudioUnderruns = 0;
+
     StreamValid = true;
 
     LOG_INFO("VideoPlayer: successfully opened all the ffmpeg streams for video file");
@@ -498,17 +507,27 @@ bool VideoPlayer::OpenStream(unsigned int index, bool video)
     return true;
 }
 // ------------------------------------ //
-bool VideoPlayer::DecodeVideoFrame()
+bool VideoPlayer::DecodeVideoFrame(DecodedVideoFrame& target)
 {
     const auto result = avcodec_receive_frame(VideoCodec, DecodedFrame);
 
     if(result >= 0) {
 
         // Worked //
+        target.Pixels.resize(ConvertedBufferSize);
+
+        uint8_t* convertedData[4];
+        int convertedLinesize[4];
+
+        if(av_image_fill_arrays(convertedData, convertedLinesize, target.Pixels.data(),
+               FFMPEG_DECODE_TARGET, FrameWidth, FrameHeight, 1) < 0) {
+            LOG_ERROR("VideoPlayer: FFMPEG: av_image_fill_arrays failed");
+            return false;
+        }
 
         // Convert the image from its native format to RGB
         if(sws_scale(ImageConverter, DecodedFrame->data, DecodedFrame->linesize, 0,
-               FrameHeight, ConvertedFrame->data, ConvertedFrame->linesize) < 0) {
+               FrameHeight, convertedData, convertedLinesize) < 0) {
             // Failed to convert frame //
             LOG_ERROR("Converting video frame failed");
             return false;
@@ -524,7 +543,7 @@ bool VideoPlayer::DecodeVideoFrame()
         // Seems that the latest FFMPEG version has fixed this.
         // I would put this in a #IF macro bLock if ffmpeg provided a way to check the
         // version at compile time
-        CurrentlyDecodedTimeStamp = DecodedFrame->pts * VideoTimeBase;
+        target.Timestamp = DecodedFrame->pts * VideoTimeBase;
         return true;
     }
 
@@ -539,6 +558,174 @@ bool VideoPlayer::DecodeVideoFrame()
     return false;
 }
 
+bool VideoPlayer::DecodeNextVideoFrame(Lock& packetlock, DecodedVideoFrame& target)
+{
+    while(StreamValid && !StopDecoder) {
+
+        // Decode a packet if none are in queue
+        if(ReadOnePacket(packetlock, DecodePriority::Video) == PacketReadResult::Ended)
+            return false;
+
+        if(DecodeVideoFrame(target))
+            return true;
+    }
+
+    return false;
+}
+
+bool VideoPlayer::DecodeAudio(Lock& packetlock)
+{
+    const auto result = avcodec_receive_frame(AudioCodec, DecodedAudio);
+
+    if(result == AVERROR(EAGAIN)) {
+
+        // We need to read more data before a frame can be decoded
+        return ReadOnePacket(packetlock, DecodePriority::Audio) != PacketReadResult::Ended;
+    }
+
+    if(result < 0) {
+
+        // Some error //
+        LOG_ERROR("Failed receiving audio packet, stopping audio playback");
+        StreamValid = false;
+        return false;
+    }
+
+    // This is verified in open when setting up converting
+    // av_get_bytes_per_sample(AV_SAMPLE_FMT_S16) could also be used here
+    const auto bytesPerSample = 2;
+
+    std::unique_ptr<ReadAudioPacket> buffer;
+
+    {
+        Lock lock(AudioMutex);
+
+        if(!FreeAudioPackets.empty()) {
+            buffer = std::move(FreeAudioPackets.back());
+            FreeAudioPackets.pop_back();
+        }
+    }
+
+    if(!buffer)
+        buffer = std::make_unique<ReadAudioPacket>();
+
+    buffer->DecodedData.resize(bytesPerSample * DecodedAudio->nb_samples * ChannelCount);
+    buffer->CurrentReadOffset = 0;
+
+    uint8_t* decodeOutput = buffer->DecodedData.data();
+
+    // Convert into the output data
+    const auto converted = swr_convert(AudioConverter, &decodeOutput, DecodedAudio->nb_samples,
+        const_cast<const uint8_t**>(DecodedAudio->data), DecodedAudio->nb_samples);
+
+    if(converted < 0) {
+        LOG_ERROR("Invalid audio stream, converting failed");
+        StreamValid = false;
+        return false;
+    }
+
+    buffer->DecodedData.resize(bytesPerSample * converted * ChannelCount);
+
+    Lock lock(AudioMutex);
+
+    QueuedAudioBytes += buffer->DecodedData.size();
+    ReadAudioDataBuffer.push_back(std::move(buffer));
+    return true;
+}
+// ------------------------------------ //
+void VideoPlayer::RunDecoderThread()
+{
+    Lock packetLock(ReadPacketMutex);
+
+    const size_t maxAudioBytes =
+        static_cast<size_t>(MAX_QUEUED_AUDIO_SECONDS * SampleRate) * ChannelCount * 2;
+
+    while(!StopDecoder && StreamValid) {
+
+        bool decoded = false;
+
+        if(!VideoDecodeEnded) {
+
+            std::unique_ptr<DecodedVideoFrame> frame;
+            {
+                Lock lock(FrameMutex);
+
+                if(QueuedVideoFrames.size() < MAX_QUEUED_VIDEO_FRAMES) {
+
+                    if(!FreeVideoFrames.empty()) {
+                        frame = std::move(FreeVideoFrames.back());
+                        FreeVideoFrames.pop_back();
+                    } else {
+                        frame = std::make_unique<DecodedVideoFrame>();
+                    }
+                }
+            }
+
+            if(frame) {
+
+                decoded = true;
+
+                const bool got = DecodeNextVideoFrame(packetLock, *frame);
+
+                Lock lock(FrameMutex);
+
+                if(got) {
+                    QueuedVideoFrames.push_back(std::move(frame));
+                } else {
+                    FreeVideoFrames.push_back(std::move(frame));
+                    VideoDecodeEnded = true;
+                }
+            }
+        }
+
+        if(!AudioDecodeEnded) {
+
+            bool hasSpace;
+            {
+                Lock lock(AudioMutex);
+                hasSpace = QueuedAudioBytes < maxAudioBytes;
+            }
+
+            if(hasSpace) {
+
+                decoded = true;
+
+                if(!DecodeAudio(packetLock))
+                    AudioDecodeEnded = true;
+            }
+        }
+
+        if(VideoDecodeEnded && AudioDecodeEnded)
+            break;
+
+        if(!decoded) {
+
+            // The other threads don't lock FrameMutex when notifying so this can't wait
+            // forever
+            Lock lock(FrameMutex);
+            DecoderNotify.wait_for(lock, DECODER_IDLE_WAIT);
+        }
+    }
+
+    // The loop also quits on decode errors and when stopped. Nothing more is going to be
+    // queued so the main thread must see the streams as ended to not wait on the last frame
+    {
+        Lock lock(FrameMutex);
+        VideoDecodeEnded = true;
+    }
+
+    AudioDecodeEnded = true;
+}
+
+void VideoPlayer::StopDecoderThread()
+{
+    StopDecoder = true;
+    DecoderNotify.notify_all();
+
+    if(DecoderThread.joinable())
+        DecoderThread.join();
+}
+// ------------------------------------ //
 VideoPlayer::PacketReadResult VideoPlayer::ReadOnePacket(
     Lock& packetmutex, DecodePriority priority)
 {
@@ -689,11 +876,10 @@ VideoPlayer::PacketReadResult VideoPlayer::ReadOnePacket(
     return PacketReadResult::Ok;
 }
 // ------------------------------------ //
-void VideoPlayer::UpdateTexture()
+void VideoPlayer::UpdateTexture(const DecodedVideoFrame& frame)
 {
     Ogre::PixelBox pixelView(FrameWidth, FrameHeight, 1, OGRE_IMAGE_FORMAT,
-        // The data[0] buffer has some junk before the actual data so don't use that
-        /*&ConvertedFrame->data[0]*/ ConvertedFrameBuffer);
+        const_cast<uint8_t*>(frame.Pixels.data()));
 
     Ogre::v1::HardwarePixelBufferSharedPtr buffer = VideoOutputTexture->getBuffer();
     buffer->blitFromMemory(pixelView);
@@ -702,170 +888,57 @@ void VideoPlayer::UpdateTexture()
 size_t VideoPlayer::ReadAudioData(uint8_t* output, size_t amount)
 {
     Lock lock(AudioMutex);
-    Lock lock2(ReadPacketMutex);
 
     if(!AudioCodec || !StreamValid) {
         return 0;
     }
 
-    size_t readAmount = 0;
-
-    // Read audio data until the stream ends or we have reached amount
-    while(amount > 0) {
-
-        // First return from queue //
-        if(!ReadAudioDataBuffer.empty()) {
+    // The decoder thread has already resampled the data so this only copies
+    size_t readAmount = ReadDataFromAudioQueue(lock, output, amount);
 
-            // Try to read from the queue //
-            const auto read = ReadDataFromAudioQueue(lock, output, amount);
+    if(readAmount < amount && !AudioDecodeEnded) {
 
-            if(read == 0) {
-
-                // Queue is invalid... //
-                LOG_ERROR("Invalid audio queue, emptying the queue");
-                ReadAudioDataBuffer.clear();
-                continue;
-            }
-
-            // Adjust pointer and amount and try to read again if still some size left
-            readAmount += read;
-            output += read;
-            amount -= read;
-            continue;
-        }
-
-        const auto result = avcodec_receive_frame(AudioCodec, DecodedAudio);
-
-        if(result == AVERROR(EAGAIN)) {
-
-            if(this->ReadOnePacket(lock2, DecodePriority::Audio) == PacketReadResult::Ended) {
-
-                // Stream ended //
-                return readAmount;
-            }
-
-            // We have now read more data, try decoding again
-            continue;
-        }
-
-        if(result < 0) {
-
-            // Some error //
-            LOG_ERROR("Failed receiving audio packet, stopping audio playback");
-            StreamValid = false;
-            return 0;
-        }
-
-        // Received audio data //
-
-        // This is verified in open when setting up converting
-        // av_get_bytes_per_sample(AV_SAMPLE_FMT_S16) could also be used here
-        const auto bytesPerSample = 2;
-
-        const auto totalSize = bytesPerSample * (DecodedAudio->nb_samples * ChannelCount);
-
-        if(amount >= static_cast<size_t>(totalSize)) {
-
-            // Lets try to directly feed the converted data to the requester //
-            if(swr_convert(AudioConverter, &output, totalSize,
-                   const_cast<const uint8_t**>(DecodedAudio->data),
-                   DecodedAudio->nb_samples) < 0) {
-                LOG_ERROR("Invalid audio stream, converting to audio read buffer failed");
-                StreamValid = false;
-                return 0;
-            }
-
-            // Adjust pointer and amount and try to read again if still some size left
-            readAmount += totalSize;
-            output += totalSize;
-            amount -= totalSize;
-            continue;
-        }
-
-        // We need a buffer //
-        ReadAudioPacket* buffer = nullptr;
-
-        // Try to find a recycled one
-        for(auto iter = ReadAudioDataBuffer.begin(); iter != ReadAudioDataBuffer.end();
-            ++iter) {
-
-            if((*iter)->Played) {
-
-                buffer = iter->get();
-
-                // It needs to be moved to the back to play them in order
-                ReadAudioDataBuffer.splice(
-                    ReadAudioDataBuffer.end(), ReadAudioDataBuffer, iter);
-                break;
-            }
-        }
-
-        // Or make a new one
-        if(!buffer) {
-            ReadAudioDataBuffer.emplace_back(new ReadAudioPacket());
-            buffer = ReadAudioDataBuffer.back().get();
-        }
-
-        buffer->DecodedData.resize(totalSize);
-
-        uint8_t* decodeOutput = buffer->DecodedData.data();
-
-        // Convert into the output data
-        if(swr_convert(AudioConverter, &decodeOutput, totalSize,
-               const_cast<const uint8_t**>(DecodedAudio->data),
-               DecodedAudio->nb_samples) < 0) {
-            LOG_ERROR("Invalid audio stream, converting failed");
-            StreamValid = false;
-            return 0;
-        }
-
-        LEVIATHAN_ASSERT(decodeOutput == buffer->DecodedData.data(),
-            "Audio convert messed with our pointer");
-
-        // Reset played and offset
-        buffer->Played = false;
-        buffer->CurrentReadOffset = 0;
-
-        // Now we have more data so we can loop again to read from the buffer
-        continue;
+        // The decoder is behind. Returning less would end the sound stream so the rest is
+        // filled with silence
+        std::memset(output + readAmount, 0, amount - readAmount);
+        readAmount = amount;
+        ++AudioUnderruns;
     }
 
+    lock.unlock();
+    DecoderNotify.notify_one();
+
     return readAmount;
 }
 
 size_t VideoPlayer::ReadDataFromAudioQueue(Lock& audiolocked, uint8_t* output, size_t amount)
 {
-    // Find one that wasn't played
-    for(auto iter = ReadAudioDataBuffer.begin(); iter != ReadAudioDataBuffer.end(); ++iter) {
+    size_t readAmount = 0;
 
-        if((*iter)->Played)
-            continue;
+    while(amount > 0 && !ReadAudioDataBuffer.empty()) {
 
-        // This hasn't been played
-        auto buffer = iter->get();
-        auto& dataVector = buffer->DecodedData;
+        auto& buffer = *ReadAudioDataBuffer.front();
+        auto& dataVector = buffer.DecodedData;
 
-        const auto dataLeft = dataVector.size() - buffer->CurrentReadOffset;
+        const auto toCopy = std::min(dataVector.size() - buffer.CurrentReadOffset, amount);
 
-        if(amount >= dataLeft) {
+        std::memcpy(output, dataVector.data() + buffer.CurrentReadOffset, toCopy);
 
-            // Can move an entire packet //
-            std::memcpy(output, dataVector.data() + buffer->CurrentReadOffset, dataLeft);
+        buffer.CurrentReadOffset += toCopy;
+        output += toCopy;
+        amount -= toCopy;
+        readAmount += toCopy;
+        QueuedAudioBytes -= toCopy;
 
-            // Mark it as played
-            ReadAudioDataBuffer.pop_front();
+        // Played packets are recycled
+        if(buffer.CurrentReadOffset >= dataVector.size()) {
 
-            return dataLeft;
+            FreeAudioPackets.push_back(std::move(ReadAudioDataBuffer.front()));
+            ReadAudioDataBuffer.pop_front();
         }
-
-        // Only partial data is wanted
-        std::memcpy(output, dataVector.data() + buffer->CurrentReadOffset, amount);
-
-        buffer->CurrentReadOffset += amount;
-        return amount;
     }
 
-    return 0;
+    return readAmount;
 }
 
 // ------------------------------------ //
@@ -960,34 +1033,46 @@ DLLEXPORT int VideoPlayer::OnEvent(Event* event)
             IsPlayingAudio = true;
         }
 
-        // This loops until we are displaying a frame we should be showing at this time //
-        while(CurrentlyDecodedTimeStamp <= PassedTimeSeconds) {
+        // Pick the latest frame that should be visible by now and skip the older ones //
+        std::unique_ptr<DecodedVideoFrame> frame;
+        bool ended;
+        {
+            Lock lock(FrameMutex);
 
-            // Make sure the next frame is ready
-            if(!NextFrameReady) {
-                Lock lock(ReadPacketMutex);
+            while(!QueuedVideoFrames.empty() &&
+                  QueuedVideoFrames.front()->Timestamp <= PassedTimeSeconds) {
 
-                while(!NextFrameReady) {
+                if(frame) {
+                    ++DroppedFrames;
+                    FreeVideoFrames.push_back(std::move(frame));
+                }
 
-                    // Decode a packet if none are in queue
-                    if(ReadOnePacket(lock, DecodePriority::Video) == PacketReadResult::Ended) {
+                frame = std::move(QueuedVideoFrames.front());
+                QueuedVideoFrames.pop_front();
+            }
 
-                        // There are no more frames, end the playback
-                        lock.unlock();
-                        OnStreamEndReached();
-                        return -1;
-                    }
+            ended = !frame && QueuedVideoFrames.empty() && VideoDecodeEnded;
+        }
 
-                    NextFrameReady = DecodeVideoFrame();
-                }
-            }
+        if(ended) {
+
+            // There are no more frames, end the playback
+            OnStreamEndReached();
+            return -1;
+        }
+
+        if(frame) {
 
-            // Don't show a frame yet if it is too soon
-            if(PassedTimeSeconds < CurrentlyDecodedTimeStamp)
-                break;
+            UpdateTexture(*frame);
+            CurrentlyDecodedTimeStamp = frame->Timestamp;
+            ++ShownFrames;
+
+            {
+                Lock lock(FrameMutex);
+                FreeVideoFrames.push_back(std::move(frame));
+            }
 
-            UpdateTexture();
-            NextFrameReady = false;
+            DecoderNotify.notify_one();
         }
 
         return 0;
@@ -11,6 +11,9 @@
 #include "OgreTexture.h"
 
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
 #include <vector>
 
 extern "C" {
@@ -30,6 +33,9 @@ namespace Leviathan { namespace GUI {
 //! written by Henri Hyyryläinen which in turn was based on
 //! ogre-ffmpeg-videoplayer, but all original ogre-ffmpeg-videoplayer
 //! code has been removed in course of all the rewrites.
+//! Decoding, image conversion and audio resampling are done on a background thread that
+//! keeps a few frames and a bit of audio ready, so the main thread only needs to pick the
+//! frame to show and upload it.
 //! \todo Implement pausing and seeking
 //! \todo When Stop is called the OnPlaybackEnded should still be fired. If something was
 //! playing
@@ -50,8 +56,8 @@ protected:
         Audio
     };
 
-    //! Holds converted audio data that could not be immediately returned by ReadAudioData
-    //! \todo Allow reuse here to reduce memory allocations
+    //! Holds converted audio data waiting to be read by ReadAudioData. These are recycled
+    //! once played to not need to allocate memory for each packet
     struct ReadAudioPacket {
 
         std::vector<uint8_t> DecodedData;
@@ -59,9 +65,16 @@ protected:
         //! This is used by the audio thread if it can't read the whole thing at once
         //! in order to not need to free memory
         size_t CurrentReadOffset = 0;
+    };
+
+    //! A video frame converted to the texture format. These are recycled through
+    //! FreeVideoFrames
+    struct DecodedVideoFrame {
 
-        //! True once this has been played completely and can be recycled
-        bool Played = false;
+        std::vector<uint8_t> Pixels;
+
+        //! Time in seconds when this should be shown
+        float Timestamp = 0.f;
     };
 
     //! Holds raw packets before sending
@@ -143,7 +156,30 @@ public:
     //! \returns true if all the ffmpeg stream objects are valid for playback
     DLLEXPORT bool IsStreamValid() const
     {
-        return StreamValid && VideoCodec && ConvertedFrameBuffer;
+        return StreamValid && VideoCodec && ImageConverter;
+    }
+
+    // ------------------------------------ //
+    // Playback statistics
+
+    //! \returns The number of frames that were uploaded to the texture
+    DLLEXPORT uint64_t GetShownFrameCount() const
+    {
+        return ShownFrames;
+    }
+
+    //! \returns The number of decoded frames that were skipped as a later frame was already
+    //! due when they were picked
+    DLLEXPORT uint64_t GetDroppedFrameCount() const
+    {
+        return DroppedFrames;
+    }
+
+    //! \returns The number of times the audio had to be padded with silence as the decoder
+    //! was behind
+    DLLEXPORT uint64_t GetAudioUnderrunCount() const
+    {
+        return AudioUnderruns;
     }
 
     DLLEXPORT auto GetTextureName() const
@@ -184,15 +220,32 @@ protected:
     //! \returns true on success
     bool OpenStream(unsigned int index, bool video);
 
-    //! \brief Decodes one video frame. Returns false if more data is required
+    //! \brief Decodes one video frame into target. Returns false if more data is required
     //! by the decoder
-    bool DecodeVideoFrame();
+    bool DecodeVideoFrame(DecodedVideoFrame& target);
+
+    //! \brief Reads packets until a video frame is decoded into target
+    //! \returns False when the video stream has ended
+    bool DecodeNextVideoFrame(Lock& packetlock, DecodedVideoFrame& target);
+
+    //! \brief Decodes and resamples an audio frame into the audio queue or reads more
+    //! packets if the decoder needs more data
+    //! \returns False when the audio stream has ended
+    bool DecodeAudio(Lock& packetlock);
+
+    //! \brief Keeps the frame and audio queues filled until Stop is called
+    //!
+    //! Sets VideoDecodeEnded and AudioDecodeEnded when it quits for any reason
+    void RunDecoderThread();
+
+    //! \brief Stops and waits for the decoder thread
+    void StopDecoderThread();
 
     //! \brief Reads a single packet from the stream that matches Priority
     PacketReadResult ReadOnePacket(Lock& packetmutex, DecodePriority priority);
 
     //! \brief Updates the texture
-    void UpdateTexture();
+    void UpdateTexture(const DecodedVideoFrame& frame);
 
     //! \brief Reads already decoded audio data. The audio data vector must be locked
     //! before calling this
@@ -244,14 +297,6 @@ protected:
     AVFrame* DecodedFrame = nullptr;
     AVFrame* DecodedAudio = nullptr;
 
-    //! Once a frame has been loaded to DecodedFrame it is converted
-    //! to a format that Ogre texture can accept
-    AVFrame* ConvertedFrame = nullptr;
-
-    //! This is the backing buffer for ConvertedFrame
-    //! \note This is not a smart pointer because this needs to be released with av_freep
-    uint8_t* ConvertedFrameBuffer = nullptr;
-
     //! Required size for a single converted frame
     size_t ConvertedBufferSize = 0;
 
@@ -265,9 +310,25 @@ protected:
     int SampleRate = 0;
     int ChannelCount = 0;
 
-    std::list<std::unique_ptr<ReadAudioPacket>> ReadAudioDataBuffer;
+    //! Decoded audio waiting to be played. Protected by AudioMutex
+    std::deque<std::unique_ptr<ReadAudioPacket>> ReadAudioDataBuffer;
+    std::vector<std::unique_ptr<ReadAudioPacket>> FreeAudioPackets;
+    size_t QueuedAudioBytes = 0;
     Mutex AudioMutex;
 
+    //! Converted frames in timestamp order. Protected by FrameMutex
+    std::deque<std::unique_ptr<DecodedVideoFrame>> QueuedVideoFrames;
+    std::vector<std::unique_ptr<DecodedVideoFrame>> FreeVideoFrames;
+    Mutex FrameMutex;
+
+    //! Woken when the queues have space or the decoder needs to quit
+    std::condition_variable DecoderNotify;
+
+    std::thread DecoderThread;
+    std::atomic<bool> StopDecoder{false};
+    std::atomic<bool> VideoDecodeEnded{false};
+    std::atomic<bool> AudioDecodeEnded{false};
+
     //! Used to start the audio playback once
     bool IsPlayingAudio = false;
 
@@ -277,9 +338,9 @@ protected:
 
     // Timing control
     float PassedTimeSeconds = 0.f;
-    float CurrentlyDecodedTimeStamp = 0.f;
 
-    bool NextFrameReady = false;
+    //! Timestamp of the frame currently in the texture
+    float CurrentlyDecodedTimeStamp = 0.f;
 
     //! Set to false if an error occurs and playback should stop
     std::atomic<bool> StreamValid{false};
@@ -290,10 +351,15 @@ protected:
     //! Also if paused this will need to be set true when resuming
     bool FirstCallbackAfterPlay = true;
 
+    //! Held by the decoder thread while it reads packets
     Mutex ReadPacketMutex;
     std::list<std::unique_ptr<ReadPacket>> WaitingVideoPackets;
     std::list<std::unique_ptr<ReadPacket>> WaitingAudioPackets;
 
+    std::atomic<uint64_t> ShownFrames{0};
+    std::atomic<uint64_t> DroppedFrames{0};
+    std::atomic<uint64_t> AudioUnderruns{0};
+
 public:
     //! Called when current video stops player
     //! \todo Should be renamed to OnPlaybackEnded
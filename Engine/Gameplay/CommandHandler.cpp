@@ -1,6 +1,7 @@
 // ------------------------------------ //
 #include "CommandHandler.h"
 
+#include "Engine.h"
 #include "Iterators/StringIterator.h"
 #include "Threading/ThreadingManager.h"
 using namespace Leviathan;
@@ -40,6 +41,9 @@ DLLEXPORT Leviathan::CommandHandler::CommandHandler(NetworkServerInterface* owne
     Owner(owneraccess)
 {
 	Staticaccess = this;
+
+    // Built in handlers //
+    RegisterCustomCommandHandler(std::make_shared<TimingStatsCommandHandler>());
 }
 
 DLLEXPORT Leviathan::CommandHandler::~CommandHandler(){
@@ -76,8 +80,6 @@ DLLEXPORT void Leviathan::CommandHandler::QueueCommand(const std::string &comman
 	if(!firstword || firstword->empty())
 		return;
 
-
-
 	// Find a command handler that provides handling for this command //
 
 	// First check the default commands //
@@ -241,5 +243,26 @@ DLLEXPORT void Leviathan::CommandSender::SendPrivateMessage(const std::string &m
 		Logger::Get()->Write("[MESSAGE] => "+GetNickname()+": "+message);
 	}
 }
+// ------------------ TimingStatsCommandHandler ------------------ //
+DLLEXPORT bool TimingStatsCommandHandler::CanHandleCommand(const std::string& cmd) const
+{
+    return cmd == "stats";
+}
 
+DLLEXPORT void TimingStatsCommandHandler::ExecuteCommand(
+    const std::string& wholecommand, CommandSender* sender)
+{
+    // Only the console and admins can see how the server is running //
+    if(sender->GetPermissionMode() != COMMANDSENDER_PERMISSIONMODE_IGNORE) {
+
+        sender->SendPrivateMessage("You don't have permission to use \"stats\"");
+        return;
+    }
+
+    Engine* engine = Engine::Get();
 
+    if(!engine)
+        return;
+
+    sender->SendPrivateMessage(engine->GetTimingReport());
+}
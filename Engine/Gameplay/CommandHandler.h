@@ -15,6 +15,8 @@ namespace Leviathan{
 
 enum COMMANDSENDER_PERMISSIONMODE {
     COMMANDSENDER_PERMISSIONMODE_NORMAL,
+
+    //! Permissions aren't checked, used by the console and admins
     COMMANDSENDER_PERMISSIONMODE_IGNORE
 };
 
@@ -153,6 +155,18 @@ protected:
     static CommandHandler* Staticaccess;
 };
 
+//! \brief Handles "stats" by sending Engine::GetTimingReport to the sender
+//!
+//! Only senders with COMMANDSENDER_PERMISSIONMODE_IGNORE (the console and admins) are
+//! allowed to use this. Registered by default in all CommandHandlers
+class TimingStatsCommandHandler : public CustomCommandHandler {
+public:
+    DLLEXPORT bool CanHandleCommand(const std::string& cmd) const override;
+
+    DLLEXPORT void ExecuteCommand(
+        const std::string& wholecommand, CommandSender* sender) override;
+};
+
 }
 
 #ifdef LEAK_INTO_GLOBAL
@@ -0,0 +1,360 @@
+// ------------------------------------ //
+#include "ByteScanning.h"
+
+#include <bitset>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#define LEVIATHAN_BYTESCANNING_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LEVIATHAN_BYTESCANNING_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif //_MSC_VER
+
+using namespace Leviathan;
+// ------------------------------------ //
+namespace {
+
+inline bool IsLineTerminatorByte(unsigned char character)
+{
+    // \n \v \f \r
+    return character >= 0x0A && character <= 0x0D;
+}
+
+inline bool IsSpecialByte(unsigned char character, int stopcharacter)
+{
+    return character >= 0x80 || IsLineTerminatorByte(character) || character == '\\' ||
+           character == '"' || character == '\'' || character == '/' || character == '*' ||
+           character == stopcharacter;
+}
+
+inline bool IsSkippedByte(
+    unsigned char character, int skipped, bool lowcodes, bool stopatlineend)
+{
+    if(character == skipped)
+        return true;
+
+    if(!lowcodes || character > 32)
+        return false;
+
+    return !stopatlineend || !IsLineTerminatorByte(character);
+}
+
+inline bool IsAlphanumericByte(unsigned char character)
+{
+    return (character >= '0' && character <= '9') || (character >= 'a' && character <= 'z') ||
+           (character >= 'A' && character <= 'Z') || character == '_';
+}
+
+//! Returns an ASCII character or -1 so that vector compares can't match bytes >= 0x80
+inline int OnlyASCII(int character)
+{
+    return character >= 0 && character < 0x80 ? character : -1;
+}
+
+#if defined(LEVIATHAN_BYTESCANNING_AVX2) || defined(LEVIATHAN_BYTESCANNING_SSE2)
+
+inline unsigned CountTrailingZeros(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif //_MSC_VER
+}
+
+#ifdef LEVIATHAN_BYTESCANNING_AVX2
+using ByteVector = __m256i;
+constexpr size_t VECTOR_SIZE = 32;
+constexpr uint32_t FULL_MASK = 0xFFFFFFFF;
+
+inline ByteVector Load(const char* data)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+}
+
+inline ByteVector Splat(int value)
+{
+    return _mm256_set1_epi8(static_cast<char>(value));
+}
+
+inline ByteVector Equal(ByteVector left, ByteVector right)
+{
+    return _mm256_cmpeq_epi8(left, right);
+}
+
+inline ByteVector Or(ByteVector left, ByteVector right)
+{
+    return _mm256_or_si256(left, right);
+}
+
+inline ByteVector AndNot(ByteVector notted, ByteVector other)
+{
+    return _mm256_andnot_si256(notted, other);
+}
+
+inline ByteVector Min(ByteVector left, ByteVector right)
+{
+    return _mm256_min_epu8(left, right);
+}
+
+inline ByteVector Subtract(ByteVector left, ByteVector right)
+{
+    return _mm256_sub_epi8(left, right);
+}
+
+inline ByteVector Zero()
+{
+    return _mm256_setzero_si256();
+}
+
+inline uint32_t Mask(ByteVector value)
+{
+    return static_cast<uint32_t>(_mm256_movemask_epi8(value));
+}
+#else
+using ByteVector = __m128i;
+constexpr size_t VECTOR_SIZE = 16;
+constexpr uint32_t FULL_MASK = 0xFFFF;
+
+inline ByteVector Load(const char* data)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+inline ByteVector Splat(int value)
+{
+    return _mm_set1_epi8(static_cast<char>(value));
+}
+
+inline ByteVector Equal(ByteVector left, ByteVector right)
+{
+    return _mm_cmpeq_epi8(left, right);
+}
+
+inline ByteVector Or(ByteVector left, ByteVector right)
+{
+    return _mm_or_si128(left, right);
+}
+
+inline ByteVector AndNot(ByteVector notted, ByteVector other)
+{
+    return _mm_andnot_si128(notted, other);
+}
+
+inline ByteVector Min(ByteVector left, ByteVector right)
+{
+    return _mm_min_epu8(left, right);
+}
+
+inline ByteVector Subtract(ByteVector left, ByteVector right)
+{
+    return _mm_sub_epi8(left, right);
+}
+
+inline ByteVector Zero()
+{
+    return _mm_setzero_si128();
+}
+
+inline uint32_t Mask(ByteVector value)
+{
+    return static_cast<uint32_t>(_mm_movemask_epi8(value));
+}
+#endif // LEVIATHAN_BYTESCANNING_AVX2
+
+//! All bytes set in lanes that are in range [low, low + count - 1] (unsigned)
+inline ByteVector InRange(ByteVector value, int low, int count)
+{
+    const ByteVector shifted = Subtract(value, Splat(low));
+    return Equal(Min(shifted, Splat(count - 1)), shifted);
+}
+
+#define LEVIATHAN_BYTESCANNING_VECTOR
+#endif // LEVIATHAN_BYTESCANNING_AVX2 || LEVIATHAN_BYTESCANNING_SSE2
+
+} // namespace
+// ------------------------------------ //
+DLLEXPORT const char* ByteScanning::FindSpecialCharacter(
+    const char* begin, const char* end, int stopcharacter)
+{
+    stopcharacter = OnlyASCII(stopcharacter);
+
+#ifdef LEVIATHAN_BYTESCANNING_VECTOR
+    // Duplicate of an already checked character when there is no stop character
+    const ByteVector stop = Splat(stopcharacter != -1 ? stopcharacter : '\\');
+    const ByteVector backslash = Splat('\\');
+    const ByteVector doublequote = Splat('"');
+    const ByteVector singlequote = Splat('\'');
+    const ByteVector slash = Splat('/');
+    const ByteVector asterisk = Splat('*');
+
+    for(; end - begin >= static_cast<ptrdiff_t>(VECTOR_SIZE); begin += VECTOR_SIZE) {
+
+        const ByteVector data = Load(begin);
+
+        ByteVector found = Or(Equal(data, backslash), Equal(data, doublequote));
+        found = Or(found, Or(Equal(data, singlequote), Equal(data, slash)));
+        found = Or(found, Or(Equal(data, asterisk), Equal(data, stop)));
+        found = Or(found, InRange(data, 0x0A, 4));
+
+        // The high bit is the non-ASCII check
+        const uint32_t mask = Mask(found) | Mask(data);
+
+        if(mask)
+            return begin + CountTrailingZeros(mask);
+    }
+#endif // LEVIATHAN_BYTESCANNING_VECTOR
+
+    for(; begin < end; ++begin) {
+        if(IsSpecialByte(static_cast<unsigned char>(*begin), stopcharacter))
+            return begin;
+    }
+
+    return end;
+}
+
+DLLEXPORT const char* ByteScanning::SkipCharacters(const char* begin, const char* end,
+    int character, bool lowcodes, bool stopatlineend)
+{
+    character = OnlyASCII(character);
+
+#ifdef LEVIATHAN_BYTESCANNING_VECTOR
+    const ByteVector skipped = Splat(character);
+    const ByteVector space = Splat(32);
+
+    for(; end - begin >= static_cast<ptrdiff_t>(VECTOR_SIZE); begin += VECTOR_SIZE) {
+
+        const ByteVector data = Load(begin);
+
+        ByteVector skip = lowcodes ? Equal(Min(data, space), data) : Zero();
+
+        if(stopatlineend)
+            skip = AndNot(InRange(data, 0x0A, 4), skip);
+
+        if(character != -1)
+            skip = Or(skip, Equal(data, skipped));
+
+        const uint32_t mask = ~Mask(skip) & FULL_MASK;
+
+        if(mask)
+            return begin + CountTrailingZeros(mask);
+    }
+#endif // LEVIATHAN_BYTESCANNING_VECTOR
+
+    for(; begin < end; ++begin) {
+        if(!IsSkippedByte(static_cast<unsigned char>(*begin), character, lowcodes,
+               stopatlineend))
+            return begin;
+    }
+
+    return end;
+}
+
+DLLEXPORT const char* ByteScanning::SkipAlphanumeric(const char* begin, const char* end)
+{
+#ifdef LEVIATHAN_BYTESCANNING_VECTOR
+    const ByteVector lowercasebit = Splat(0x20);
+    const ByteVector underscore = Splat('_');
+
+    for(; end - begin >= static_cast<ptrdiff_t>(VECTOR_SIZE); begin += VECTOR_SIZE) {
+
+        const ByteVector data = Load(begin);
+
+        ByteVector valid = Or(InRange(data, '0', 10), Equal(data, underscore));
+        valid = Or(valid, InRange(Or(data, lowercasebit), 'a', 26));
+
+        const uint32_t mask = ~Mask(valid) & FULL_MASK;
+
+        if(mask)
+            return begin + CountTrailingZeros(mask);
+    }
+#endif // LEVIATHAN_BYTESCANNING_VECTOR
+
+    for(; begin < end; ++begin) {
+        if(!IsAlphanumericByte(static_cast<unsigned char>(*begin)))
+            return begin;
+    }
+
+    return end;
+}
+
+DLLEXPORT const char* ByteScanning::FindNonASCII(const char* begin, const char* end)
+{
+#ifdef LEVIATHAN_BYTESCANNING_VECTOR
+    for(; end - begin >= static_cast<ptrdiff_t>(VECTOR_SIZE); begin += VECTOR_SIZE) {
+
+        const uint32_t mask = Mask(Load(begin));
+
+        if(mask)
+            return begin + CountTrailingZeros(mask);
+    }
+#endif // LEVIATHAN_BYTESCANNING_VECTOR
+
+    for(; begin < end; ++begin) {
+        if(static_cast<unsigned char>(*begin) >= 0x80)
+            return begin;
+    }
+
+    return end;
+}
+// ------------------------------------ //
+DLLEXPORT size_t ByteScanning::CountLineChanges(
+    const char* begin, const char* end, const char* dataend)
+{
+    size_t count = 0;
+
+#ifdef LEVIATHAN_BYTESCANNING_VECTOR
+    const ByteVector carriagereturn = Splat('\r');
+    const ByteVector linefeed = Splat('\n');
+
+    // The next byte is also loaded so there needs to be one extra byte of data
+    for(; end - begin >= static_cast<ptrdiff_t>(VECTOR_SIZE) &&
+          dataend - begin > static_cast<ptrdiff_t>(VECTOR_SIZE);
+        begin += VECTOR_SIZE) {
+
+        const ByteVector data = Load(begin);
+
+        const uint32_t terminators = Mask(InRange(data, 0x0A, 4));
+
+        if(!terminators)
+            continue;
+
+        const uint32_t pairs =
+            Mask(Equal(data, carriagereturn)) & Mask(Equal(Load(begin + 1), linefeed));
+
+        count += std::bitset<32>(terminators & ~pairs).count();
+    }
+#endif // LEVIATHAN_BYTESCANNING_VECTOR
+
+    for(; begin < end; ++begin) {
+
+        if(!IsLineTerminatorByte(static_cast<unsigned char>(*begin)))
+            continue;
+
+        if(*begin == '\r' && begin + 1 < dataend && *(begin + 1) == '\n')
+            continue;
+
+        ++count;
+    }
+
+    return count;
+}
+// ------------------------------------ //
+DLLEXPORT const char* ByteScanning::GetImplementationName()
+{
+#if defined(LEVIATHAN_BYTESCANNING_AVX2)
+    return "AVX2";
+#elif defined(LEVIATHAN_BYTESCANNING_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,55 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2018 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include <cstddef>
+
+namespace Leviathan {
+
+//! \brief Finds runs of ASCII characters in narrow strings 16 or 32 bytes at a time
+//!
+//! Used by StringIterator to move over characters that can't change its state without
+//! going through StringDataIterator one character at a time. All of the functions stop at
+//! bytes that aren't ASCII so that multi byte sequences are always decoded normally.
+//! Uses AVX2 or SSE2 if the compiler targets them, otherwise plain loops
+class ByteScanning {
+public:
+    ByteScanning() = delete;
+
+    //! \brief Finds the first byte that StringIterator needs to look at
+    //!
+    //! Those are the characters that change StringIterator flags (\\ " ' / *), line
+    //! terminators, stopcharacter and everything that isn't ASCII
+    //! \param stopcharacter Additional character to stop at, -1 for none
+    //! \returns Pointer to the found byte or end
+    DLLEXPORT static const char* FindSpecialCharacter(
+        const char* begin, const char* end, int stopcharacter);
+
+    //! \brief Finds the first byte that isn't skipped
+    //! \param character Skipped character, -1 for none
+    //! \param lowcodes If true all bytes <= 32 are skipped
+    //! \param stopatlineend If true line terminators are not skipped even when they would
+    //! be by lowcodes
+    //! \returns Pointer to the first not skipped byte or end
+    DLLEXPORT static const char* SkipCharacters(const char* begin, const char* end,
+        int character, bool lowcodes, bool stopatlineend);
+
+    //! \brief Finds the first byte that isn't an ASCII letter, digit or underscore
+    DLLEXPORT static const char* SkipAlphanumeric(const char* begin, const char* end);
+
+    //! \returns Pointer to the first byte that is >= 0x80 or end
+    DLLEXPORT static const char* FindNonASCII(const char* begin, const char* end);
+
+    //! \brief Counts line changes the same way StringDataIterator::CheckLineChange does
+    //!
+    //! Every line terminator counts once except \\r that is directly followed by \\n
+    //! \param dataend End of the whole data, used to check the byte after end
+    DLLEXPORT static size_t CountLineChanges(
+        const char* begin, const char* end, const char* dataend);
+
+    //! \returns "AVX2", "SSE2" or "scalar" depending on what was compiled in
+    DLLEXPORT static const char* GetImplementationName();
+};
+
+} // namespace Leviathan
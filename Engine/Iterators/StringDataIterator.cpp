@@ -39,6 +39,17 @@ DLLEXPORT bool Leviathan::StringDataIterator::ReturnSubString(size_t startpos, s
     return false;
 }
 // ------------------------------------ //
+DLLEXPORT bool StringDataIterator::GetRemainingBytes(const char*& current, const char*& end)
+{
+    return false;
+}
+
+DLLEXPORT void StringDataIterator::MoveForwardASCII(size_t count)
+{
+    for(size_t i = 0; i < count; ++i)
+        MoveToNextCharacter();
+}
+// ------------------------------------ //
 DLLEXPORT size_t Leviathan::StringDataIterator::GetCurrentCharacterNumber() const{
     return CurrentCharacterNumber;
 }
@@ -87,6 +98,18 @@ DLLEXPORT bool UTF8PointerDataIterator::GetNextCharCode(int &codepointreceiver,
     if(Current + forward >= End)
         return false;
 
+    // Single byte characters don't need decoding //
+    size_t asciicount = 0;
+
+    while(asciicount <= forward && static_cast<unsigned char>(Current[asciicount]) < 0x80)
+        ++asciicount;
+
+    if(asciicount > forward){
+
+        codepointreceiver = Current[forward];
+        return true;
+    }
+
     // We can just peek the next character if forward is 0 //
     if(!forward){
 
@@ -163,15 +186,22 @@ DLLEXPORT void UTF8PointerDataIterator::MoveToNextCharacter(){
     if (!IsPositionValid())
         return;
 
-    // We need to move whole code points //
+    if(static_cast<unsigned char>(*Current) < 0x80){
+
+        ++Current;
+
+    } else {
+
+        // We need to move whole code points //
 #if !defined(ALTERNATIVE_EXCEPTIONS_FATAL) || defined(ALLOW_INTERNAL_EXCEPTIONS)
 
-    utf8::advance(Current, 1, End);
+        utf8::advance(Current, 1, End);
 
 #else
-    utf8::unchecked::advance(Current, 1);
+        utf8::unchecked::advance(Current, 1);
 
 #endif //ALTERNATIVE_EXCEPTIONS_FATAL
+    }
 
     // Don't forget to increment these //
     ++CurrentCharacterNumber;
@@ -180,8 +210,18 @@ DLLEXPORT void UTF8PointerDataIterator::MoveToNextCharacter(){
     if(!IsPositionValid())
         return;
 
-    // There might be a better way to check this //
-    CheckLineChange();
+    // Unicode line terminators need the full check //
+    if(static_cast<unsigned char>(*Current) >= 0x80){
+
+        CheckLineChange();
+        return;
+    }
+
+    if(StringOperations::IsLineTerminator(*Current) &&
+        !(*Current == '\r' && Current + 1 != End && *(Current + 1) == '\n'))
+    {
+        ++CurrentLineNumber;
+    }
 }
 // ------------------------------------ //
 DLLEXPORT size_t UTF8PointerDataIterator::CurrentIteratorPosition() const{
@@ -209,6 +249,25 @@ DLLEXPORT bool UTF8PointerDataIterator::ReturnSubString(size_t startpos, size_t
     return true;
 }
 
+DLLEXPORT bool UTF8PointerDataIterator::GetRemainingBytes(const char*& current,
+    const char*& end)
+{
+    if(!Current)
+        return false;
+
+    current = Current;
+    end = End;
+    return true;
+}
+
+DLLEXPORT void UTF8PointerDataIterator::MoveForwardASCII(size_t count){
+
+    CurrentLineNumber += ByteScanning::CountLineChanges(Current + 1, Current + count + 1, End);
+
+    Current += count;
+    CurrentCharacterNumber += count;
+}
+
     
 
 // ------------------------------------ //
@@ -2,6 +2,9 @@
 // ------------------------------------ //
 #include "Define.h"
 // ------------------------------------ //
+#include "ByteScanning.h"
+
+#include <type_traits>
 
 
 namespace Leviathan{
@@ -56,6 +59,22 @@ public:
     //! \brief Returns true when the iterator is still valid
     virtual bool IsPositionValid() const = 0;
 
+    //! \brief Gets the rest of the data as bytes
+    //!
+    //! Only supported by data sources that are contiguous narrow strings where ASCII
+    //! characters are single bytes. StringIterator uses this to find runs of characters
+    //! with ByteScanning
+    //! \param current Receives the byte the iterator is currently on
+    //! \param end Receives a pointer one past the last byte
+    //! \return False if not supported
+    DLLEXPORT virtual bool GetRemainingBytes(const char*& current, const char*& end);
+
+    //! \brief Moves forward by count characters which are all single byte ASCII characters
+    //!
+    //! The default implementation calls MoveToNextCharacter count times
+    //! \note The caller needs to check the bytes with GetRemainingBytes first
+    DLLEXPORT virtual void MoveForwardASCII(size_t count);
+
 
     // Basic functions that should all be the same //
 
@@ -149,6 +168,33 @@ public:
         return End-1;
     }
 
+    virtual bool GetRemainingBytes(const char*& current, const char*& end){
+        if constexpr(std::is_same_v<STRType, std::string>){
+
+            current = OurString.data() + Current;
+            end = OurString.data() + End;
+            return true;
+
+        } else {
+            return false;
+        }
+    }
+
+    virtual void MoveForwardASCII(size_t count){
+        if constexpr(std::is_same_v<STRType, std::string>){
+
+            const char* data = OurString.data();
+            CurrentLineNumber += ByteScanning::CountLineChanges(data + Current + 1,
+                data + Current + count + 1, data + End);
+
+            Current += count;
+            CurrentCharacterNumber += count;
+
+        } else {
+            StringDataIterator::MoveForwardASCII(count);
+        }
+    }
+
 
 
 protected:
@@ -228,6 +274,36 @@ public:
         return End-1;
     }
 
+    virtual bool GetRemainingBytes(const char*& current, const char*& end){
+        if constexpr(std::is_same_v<STRType, std::string>){
+
+            if(!OurString)
+                return false;
+
+            current = OurString->data() + Current;
+            end = OurString->data() + End;
+            return true;
+
+        } else {
+            return false;
+        }
+    }
+
+    virtual void MoveForwardASCII(size_t count){
+        if constexpr(std::is_same_v<STRType, std::string>){
+
+            const char* data = OurString->data();
+            CurrentLineNumber += ByteScanning::CountLineChanges(data + Current + 1,
+                data + Current + count + 1, data + End);
+
+            Current += count;
+            CurrentCharacterNumber += count;
+
+        } else {
+            StringDataIterator::MoveForwardASCII(count);
+        }
+    }
+
 protected:
 
     const STRType* OurString;
@@ -239,6 +315,9 @@ protected:
 };
 
 //! Raw pointer utf8 iterator
+//!
+//! ASCII characters are handled directly, only multi byte sequences go through the utf8
+//! library
 class UTF8PointerDataIterator : public StringDataIterator{
 public:
 
@@ -269,6 +348,10 @@ public:
     DLLEXPORT virtual bool ReturnSubString(size_t startpos, size_t endpos, 
         std::string &receiver);
 
+    DLLEXPORT virtual bool GetRemainingBytes(const char*& current, const char*& end);
+
+    DLLEXPORT virtual void MoveForwardASCII(size_t count);
+
 protected:
 
     //! The current position of the iterator
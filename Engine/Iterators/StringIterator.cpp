@@ -11,23 +11,33 @@ DLLEXPORT Leviathan::StringIterator::StringIterator(
     std::unique_ptr<StringDataIterator>&& iterator) :
     HandlesDelete(true),
     DataIterator(iterator.release())
-{}
+{
+    CheckCanScanBytes();
+}
 
 DLLEXPORT Leviathan::StringIterator::StringIterator(const string& text) :
     HandlesDelete(true), DataIterator(new StringClassDataIterator<string>(text))
-{}
+{
+    CheckCanScanBytes();
+}
 
 DLLEXPORT Leviathan::StringIterator::StringIterator(const wstring& text) :
     HandlesDelete(true), DataIterator(new StringClassDataIterator<wstring>(text))
-{}
+{
+    CheckCanScanBytes();
+}
 
 DLLEXPORT Leviathan::StringIterator::StringIterator(const wstring* text) :
     HandlesDelete(true), DataIterator(new StringClassPointerIterator<wstring>(text))
-{}
+{
+    CheckCanScanBytes();
+}
 
 DLLEXPORT Leviathan::StringIterator::StringIterator(const string* text) :
     HandlesDelete(true), DataIterator(new StringClassPointerIterator<string>(text))
-{}
+{
+    CheckCanScanBytes();
+}
 
 DLLEXPORT Leviathan::StringIterator::~StringIterator()
 {
@@ -53,6 +63,7 @@ DLLEXPORT void StringIterator::ReInit(std::unique_ptr<StringDataIterator>&& iter
     // Reset everything //
     CurrentCharacter = -1;
     CurrentStored = false;
+    CheckCanScanBytes();
 
 
     // Clear the flags //
@@ -92,6 +103,14 @@ DLLEXPORT int Leviathan::StringIterator::GetPreviousCharacter()
     return tmpval;
 }
 // ------------------------------------ //
+void StringIterator::CheckCanScanBytes()
+{
+    const char* current;
+    const char* end;
+
+    CanScanBytes = DataIterator && DataIterator->GetRemainingBytes(current, end);
+}
+// ------------------------------------ //
 DLLEXPORT void Leviathan::StringIterator::SkipLineEnd()
 {
     ITR_COREDEBUG("Skip line end");
@@ -3,6 +3,7 @@
 #include "Define.h"
 // ------------------------------------ //
 #include "../Common/StringOperations.h"
+#include "ByteScanning.h"
 #include "IteratorData.h"
 #include "StringDataIterator.h"
 
@@ -646,6 +647,9 @@ public:
 private:
     StringIterator(const StringIterator& other) = delete;
 
+    //! Updates CanScanBytes after DataIterator has changed
+    void CheckCanScanBytes();
+
     //! Checks if current character causes the flags to change
     inline ITERATORCALLBACK_RETURNTYPE HandleSpecialCharacters()
     {
@@ -941,6 +945,90 @@ private:
         return ITERATORCALLBACK_RETURNTYPE_CONTINUE;
     }
 
+    //! \brief Moves over following characters that can't change any flags
+    //!
+    //! Used by the iteration functions once the following characters can't affect their
+    //! result, the iterator is left on the last skipped character so that the
+    //! StartIterating loop handles the next character normally
+    //! \param stopcharacter A character the iteration function needs to see, -1 for none
+    inline void SkipPlainCharacters(int stopcharacter)
+    {
+        const char* current;
+        const char* end;
+
+        if(!GetScannableBytes(current, end))
+            return;
+
+        SkipBytesUntil(ByteScanning::FindSpecialCharacter(current + 1, end, stopcharacter),
+            current);
+    }
+
+    //! \brief Moves over following whitespace or characters equal to character
+    //! \see SkipPlainCharacters
+    inline void SkipMatchingCharacters(int character, bool lowcodes, int specialflags)
+    {
+        const char* current;
+        const char* end;
+
+        if(!GetScannableBytes(current, end))
+            return;
+
+        // Line ends only matter when stopping on them or ending a comment //
+        const bool stopatlineend = (specialflags & SPECIAL_ITERATOR_ONNEWLINE_STOP) ||
+                                   (CurrentFlags & ITERATORFLAG_SET_INSIDE_CPPCOMMENT);
+
+        if(character == '\\' || StringOperations::IsCharacterQuote(character) ||
+            character == '/' || character == '*' ||
+            (stopatlineend && StringOperations::IsLineTerminator(character))) {
+            character = -1;
+        }
+
+        SkipBytesUntil(ByteScanning::SkipCharacters(
+                           current + 1, end, character, lowcodes, stopatlineend),
+            current);
+    }
+
+    //! \brief Moves over following ASCII letters, numbers and underscores
+    //! \see SkipPlainCharacters
+    inline void SkipAlphanumericCharacters()
+    {
+        const char* current;
+        const char* end;
+
+        if(!GetScannableBytes(current, end))
+            return;
+
+        SkipBytesUntil(ByteScanning::SkipAlphanumeric(current + 1, end), current);
+    }
+
+    //! \returns True if the following characters can be scanned as bytes
+    inline bool GetScannableBytes(const char*& current, const char*& end)
+    {
+        // Flags that end on the next character need to be handled one character at a time
+        if(!CanScanBytes || (CurrentFlags & SINGLE_CHARACTER_FLAGS))
+            return false;
+
+        if(!DataIterator->GetRemainingBytes(current, end) || current == end)
+            return false;
+
+        // The current character must be a single byte for the next one to start after it
+        return static_cast<unsigned char>(*current) < 0x80;
+    }
+
+    //! \brief Moves to the character before stop
+    inline void SkipBytesUntil(const char* stop, const char* current)
+    {
+        const auto count = static_cast<size_t>(stop - current) - 1;
+
+        if(count == 0)
+            return;
+
+        ITR_COREDEBUG("Skipping " + Convert::ToString(count) + " plain characters");
+
+        DataIterator->MoveForwardASCII(count);
+        CurrentStored = false;
+    }
+
     template<typename T, typename R, typename... Args>
     R proxycall(T& obj, R (T::*mf)(Args...), Args&&... args)
     {
@@ -1025,6 +1113,13 @@ private:
     //! Set when we should delete DataIterator
     bool HandlesDelete = false;
 
+    //! Flags that are cleared by CheckActiveFlags on the next character
+    static constexpr int SINGLE_CHARACTER_FLAGS =
+        ITERATORFLAG_SET_IGNORE_SPECIAL | ITERATORFLAG_SET_IGNORE_SPECIAL_END |
+        ITERATORFLAG_SET_STOP | ITERATORFLAG_SET_INSIDE_STRING_SINGLE_END |
+        ITERATORFLAG_SET_INSIDE_STRING_DOUBLE_END | ITERATORFLAG_SET_COMMENT_BEGINNING |
+        ITERATORFLAG_SET_CPPCOMMENT_END | ITERATORFLAG_SET_CCOMMENT_END;
+
 #ifdef ITERATOR_ALLOW_DEBUG
     //! Controls debug output printing
     bool DebugMode = false;
@@ -1043,6 +1138,9 @@ private:
     //! Dirty flag for CurrentCharacter
     bool CurrentStored = false;
 
+    //! True when DataIterator supports GetRemainingBytes
+    bool CanScanBytes = false;
+
 protected:
     // Iteration functions //
 
@@ -1161,6 +1259,10 @@ protected:
             }
         }
 
+        // Nothing changes until the next quote //
+        if(End || TakeChar)
+            SkipPlainCharacters(-1);
+
         return ITERATORCALLBACK_RETURNTYPE_CONTINUE;
     }
 
@@ -1233,6 +1335,12 @@ protected:
                 ITR_FUNCDEBUG("Started: " + Convert::ToString(data->Positions.Start));
             }
 
+            // Letters and numbers are valid with all stop flags but underscores aren't
+            // with UNNORMALCHARACTER_TYPE_NON_ASCII //
+            if(!(CurrentFlags & ITERATORFLAG_SET_INSIDE_STRING) &&
+                !(stopflags & UNNORMALCHARACTER_TYPE_NON_ASCII))
+                SkipAlphanumericCharacters();
+
         } else {
 
         invalidcodelabelunnormalcharacter:
@@ -1430,6 +1538,8 @@ protected:
         // We can probably always skip inside a comment //
         if((specialflags & SPECIAL_ITERATOR_HANDLECOMMENTS_ASSTRING) &&
             (CurrentFlags & ITERATORFLAG_SET_INSIDE_COMMENT)) {
+
+            SkipPlainCharacters(-1);
             return ITERATORCALLBACK_RETURNTYPE_CONTINUE;
         }
 
@@ -1441,13 +1551,11 @@ protected:
         // Check does the character match what is being skipped //
         int curchara = GetCharacter();
 
-        if(additionalskip & UNNORMALCHARACTER_TYPE_LOWCODES) {
-            if(curchara <= 32)
-                return ITERATORCALLBACK_RETURNTYPE_CONTINUE;
-        }
+        const bool lowcodes = additionalskip & UNNORMALCHARACTER_TYPE_LOWCODES;
 
-        if(curchara == data.CharacterToUse) {
+        if((lowcodes && curchara <= 32) || curchara == data.CharacterToUse) {
             // We want to skip it //
+            SkipMatchingCharacters(data.CharacterToUse, lowcodes, specialflags);
             return ITERATORCALLBACK_RETURNTYPE_CONTINUE;
         }
 
@@ -1529,6 +1637,8 @@ protected:
                 data->Positions.End = data->Positions.Start;
                 ITR_FUNCDEBUG("Data started: " + Convert::ToString(data->Positions.Start));
             }
+
+            SkipPlainCharacters(character);
             return ITERATORCALLBACK_RETURNTYPE_CONTINUE;
         }
         // let's stop if we have found something //
@@ -1579,6 +1689,7 @@ protected:
             ITR_FUNCDEBUG("Data started: " + Convert::ToString(data->Positions));
         }
 
+        SkipPlainCharacters(-1);
         return ITERATORCALLBACK_RETURNTYPE_CONTINUE;
     }
 
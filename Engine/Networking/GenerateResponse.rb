@@ -127,6 +127,21 @@ thingsToGenerate = [
      Variable.new("Enabled", "bool"),
    ]],
 
+  ["EntityLocalControlCorrection",
+   [
+     Variable.new("WorldID", "int32_t"),
+     Variable.new("EntityID", "ObjectID"),
+     Variable.new("TickNumber", "int32_t"),
+     Variable.new("Position", "Float3"),
+     Variable.new("Orientation", "Float4"),
+   ]],
+
+  ["EntityFullStateRequest",
+   [
+     Variable.new("WorldID", "int32_t"),
+     Variable.new("EntityID", "ObjectID"),
+   ]],
+
   ["WorldFrozen",
    [
      Variable.new("WorldID", "int32_t"),
@@ -153,6 +168,15 @@ thingsToGenerate = [
      Variable.new("EntityID", "ObjectID"),
      Variable.new("UpdateData", "sf::Packet", move: true),
    ]],
+
+  ["WorldSnapshot",
+   [
+     Variable.new("WorldID", "int32_t"),
+     Variable.new("TickNumber", "int32_t"),
+     Variable.new("ReferenceTick", "int32_t"),
+     Variable.new("EntityCount", "uint32_t"),
+     Variable.new("SnapshotData", "sf::Packet", move: true),
+   ]],
   
   ["CacheUpdated",
    [
@@ -128,6 +128,21 @@ DLLEXPORT void NetworkClientInterface::HandleResponseOnlyPacket(
         world->HandleEntityPacket(std::move(*data), connection);
         return;
     }
+    case NETWORK_RESPONSE_TYPE::WorldSnapshot: {
+        auto data = static_cast<ResponseWorldSnapshot*>(message.get());
+
+        auto world = _GetWorldForEntityMessage(data->WorldID);
+
+        // TODO: this needs to be queued if we haven't received the world yet
+        if(!world) {
+            LOG_WARNING("NetworkClientInterface: no world found for WorldSnapshot. TODO: "
+                        "queue this message");
+            return;
+        }
+
+        world->HandleEntityPacket(std::move(*data));
+        return;
+    }
     case NETWORK_RESPONSE_TYPE::EntityLocalControlStatus: {
         auto data = static_cast<ResponseEntityLocalControlStatus*>(message.get());
 
@@ -145,6 +160,33 @@ DLLEXPORT void NetworkClientInterface::HandleResponseOnlyPacket(
         _OnLocalControlChanged(world);
         return;
     }
+    case NETWORK_RESPONSE_TYPE::EntityLocalControlCorrection: {
+        auto data = static_cast<ResponseEntityLocalControlCorrection*>(message.get());
+
+        auto world = _GetWorldForEntityMessage(data->WorldID);
+
+        if(!world) {
+            LOG_WARNING("NetworkClientInterface: no world found for "
+                        "EntityLocalControlCorrection");
+            return;
+        }
+
+        world->HandleEntityPacket(*data);
+        return;
+    }
+    case NETWORK_RESPONSE_TYPE::EntityFullStateRequest: {
+        auto data = static_cast<ResponseEntityFullStateRequest*>(message.get());
+
+        auto world = _GetWorldForEntityMessage(data->WorldID);
+
+        if(!world) {
+            LOG_WARNING("NetworkClientInterface: no world found for EntityFullStateRequest");
+            return;
+        }
+
+        world->HandleEntityPacket(*data, connection);
+        return;
+    }
     default: break;
     }
 
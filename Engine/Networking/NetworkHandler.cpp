@@ -9,6 +9,7 @@
 #include "NetworkRequest.h"
 #include "NetworkResponse.h"
 #include "SentNetworkThing.h"
+#include "Statistics/Profiler.h"
 #include "ObjectFiles/ObjectFile.h"
 #include "ObjectFiles/ObjectFileProcessor.h"
 #include "RemoteConsole.h"
@@ -228,6 +229,19 @@ bool Leviathan::NetworkHandler::_RunUpdateOnce(Lock &guard)
 
     sf::Socket::Status status;
 
+    // The main loop isn't waiting on the socket in blocking mode so it is woken up after
+    // handling a packet to send the replies and to handle what the packet queued //
+    const auto wakeMainLoop = [this](){
+
+        if(!BlockingMode)
+            return;
+
+        Engine* engine = Engine::Get();
+
+        if(engine)
+            engine->WakeMainLoop();
+    };
+
     while (true) {
 
         guard.unlock();
@@ -264,8 +278,11 @@ bool Leviathan::NetworkHandler::_RunUpdateOnce(Lock &guard)
             }
         }
 
-        if(Passed)
+        if(Passed){
+
+            wakeMainLoop();
             continue;
+        }
 
         shared_ptr<Connection> tmpconnect;
 
@@ -317,6 +334,7 @@ bool Leviathan::NetworkHandler::_RunUpdateOnce(Lock &guard)
         } else {
 
             tmpconnect->HandlePacket(receivedpacket);
+            wakeMainLoop();
         }
     }
 
@@ -458,6 +476,8 @@ DLLEXPORT void Leviathan::NetworkHandler::_RegisterConnection(
 // ------------------------------------ //
 DLLEXPORT void Leviathan::NetworkHandler::UpdateAllConnections(){
 
+    LEVIATHAN_PROFILE_ZONE("NetworkHandler::UpdateAllConnections");
+
     // Update remote console sessions if they exist //
     auto rconsole = Engine::Get()->GetRemoteConsole();
     if(rconsole)
@@ -484,6 +504,15 @@ DLLEXPORT void Leviathan::NetworkHandler::UpdateAllConnections(){
     // Interface might want to do something //
     GetInterface()->TickIt();
 }
+
+DLLEXPORT sf::UdpSocket* Leviathan::NetworkHandler::GetSocketForWaiting(){
+
+    // The listening thread wakes the main loop itself, see _RunUpdateOnce //
+    if(BlockingMode)
+        return nullptr;
+
+    return &_Socket;
+}
 // ------------------------------------ //
 Lock Leviathan::NetworkHandler::LockSocketForUse(){
     
@@ -52,6 +52,15 @@ public:
     //! \note  Call as often as possible to receive responses
     DLLEXPORT virtual void UpdateAllConnections();
 
+    //! \returns The socket that UpdateAllConnections receives from or null in blocking mode
+    //!
+    //! In blocking mode the listening thread is always reading the socket, so a wait on it
+    //! would either miss the packet or keep waking up until the thread has read it. Instead
+    //! the listening thread calls Engine::WakeMainLoop after handling each packet, which
+    //! wakes Engine::WaitForWork the same as the socket would
+    //! \note Only for waiting for the socket to become readable, don't read from it
+    DLLEXPORT sf::UdpSocket* GetSocketForWaiting();
+
     DLLEXPORT virtual void RemoveClosedConnections(Lock& guard);
 
     DLLEXPORT std::shared_ptr<std::promise<std::string>> QueryMasterServer(
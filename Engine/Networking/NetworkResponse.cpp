@@ -41,8 +41,14 @@ DLLEXPORT std::shared_ptr<NetworkResponse> NetworkResponse::LoadFromPacket(sf::P
         return std::make_shared<ResponseEntityDestruction>(responseid, packet);
     case NETWORK_RESPONSE_TYPE::EntityUpdate:
         return std::make_shared<ResponseEntityUpdate>(responseid, packet);
+    case NETWORK_RESPONSE_TYPE::WorldSnapshot:
+        return std::make_shared<ResponseWorldSnapshot>(responseid, packet);
     case NETWORK_RESPONSE_TYPE::EntityLocalControlStatus:
         return std::make_shared<ResponseEntityLocalControlStatus>(responseid, packet);
+    case NETWORK_RESPONSE_TYPE::EntityLocalControlCorrection:
+        return std::make_shared<ResponseEntityLocalControlCorrection>(responseid, packet);
+    case NETWORK_RESPONSE_TYPE::EntityFullStateRequest:
+        return std::make_shared<ResponseEntityFullStateRequest>(responseid, packet);
     // None based types
     case NETWORK_RESPONSE_TYPE::CloseConnection:
     case NETWORK_RESPONSE_TYPE::Keepalive:
@@ -94,9 +100,13 @@ DLLEXPORT std::string NetworkResponse::GetTypeStr() const
     case NETWORK_RESPONSE_TYPE::StartWorldReceive: return "ResponseStartWorldReceive";
     case NETWORK_RESPONSE_TYPE::EntityCreation: return "ResponseEntityCreation";
     case NETWORK_RESPONSE_TYPE::EntityUpdate: return "ResponseEntityUpdate";
+    case NETWORK_RESPONSE_TYPE::WorldSnapshot: return "ResponseWorldSnapshot";
     case NETWORK_RESPONSE_TYPE::EntityDestruction: return "ResponseEntityDestruction";
     case NETWORK_RESPONSE_TYPE::EntityLocalControlStatus:
         return "ResponseEntityLocalControlStatus";
+    case NETWORK_RESPONSE_TYPE::EntityLocalControlCorrection:
+        return "ResponseEntityLocalControlCorrection";
+    case NETWORK_RESPONSE_TYPE::EntityFullStateRequest: return "ResponseEntityFullStateRequest";
     case NETWORK_RESPONSE_TYPE::CacheUpdated: return "ResponseCacheUpdated";
     case NETWORK_RESPONSE_TYPE::CacheRemoved: return "ResponseCacheRemoved";
     case NETWORK_RESPONSE_TYPE::WorldFrozen: return "ResponseWorldFrozen";
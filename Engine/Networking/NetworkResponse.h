@@ -99,6 +99,16 @@ enum class NETWORK_RESPONSE_TYPE : uint16_t {
     //!  Special case is -1 which notes that there is no reference tick
     EntityUpdate,
 
+    //! Contains the changed entities of a world on a single tick
+    //! TickNumber The tick on which the snapshot was made
+    //!
+    //! ReferenceTick The snapshot against which this has been created, or -1
+    //! EntityCount The number of entity entries in SnapshotData
+    //! \note Large snapshots are split into multiple of these with the same TickNumber.
+    //! Each part can be applied on its own
+    //! \see WorldSnapshot
+    WorldSnapshot,
+
     //! Contains (list) an ID for entity to be deleted
     EntityDestruction,
 
@@ -106,6 +116,16 @@ enum class NETWORK_RESPONSE_TYPE : uint16_t {
     //! is the status)
     EntityLocalControlStatus,
 
+    //! Server rejected a state a client sent for its locally controlled entity
+    //! TickNumber The client tick of the rejected state. Position and Orientation are what the
+    //! entity should have been on that tick
+    EntityLocalControlCorrection,
+
+    //! A received entity state couldn't be decoded as its reference state is missing. The
+    //! sender should send full states until it gets a new acknowledged reference
+    //! EntityID The entity whose state failed, in snapshot mode the whole snapshot is sent
+    EntityFullStateRequest,
+
     //! Contains an updated cache variable
     CacheUpdated,
 
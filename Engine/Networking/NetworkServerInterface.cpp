@@ -179,7 +179,41 @@ DLLEXPORT void NetworkServerInterface::HandleResponseOnlyPacket(
             return;
         }
 
-        world->HandleEntityPacket(std::move(*data), connection);
+        // The shared_ptr keeps the connection alive in case this needs to wait for the world
+        // to finish ticking
+        auto senderConnection = Owner->GetConnection(&connection);
+
+        if(!senderConnection) {
+            LOG_WARNING("NetworkServerInterface: connection of EntityUpdate is already closed");
+            return;
+        }
+
+        world->RunOnWorld([world, message, data, senderConnection]() {
+            world->HandleEntityPacket(std::move(*data), *senderConnection);
+        });
+        return;
+    }
+    case NETWORK_RESPONSE_TYPE::EntityFullStateRequest: {
+        auto data = static_cast<ResponseEntityFullStateRequest*>(message.get());
+
+        auto world = _GetWorldForEntityMessage(data->WorldID);
+
+        if(!world) {
+            LOG_WARNING("NetworkServerInterface: no world found for EntityFullStateRequest");
+            return;
+        }
+
+        auto senderConnection = Owner->GetConnection(&connection);
+
+        if(!senderConnection) {
+            LOG_WARNING("NetworkServerInterface: connection of EntityFullStateRequest is "
+                        "already closed");
+            return;
+        }
+
+        world->RunOnWorld([world, message, data, senderConnection]() {
+            world->HandleEntityPacket(*data, *senderConnection);
+        });
         return;
     }
     default: break;
@@ -280,6 +280,7 @@ public:
 //! \brief Represents a template instantiation
 class ObjectFileTemplateInstance {
     friend ObjectFileTemplateDefinition;
+    friend ObjectFileCache;
 public:
 
     DLLEXPORT ObjectFileTemplateInstance(const std::string &mastertmplname,
@@ -308,6 +309,7 @@ protected:
 //! \todo Potentially allow changing the definition to update instantiations
 //! \todo Make this more robust and nice and reduce the bloat in the implementation
 class ObjectFileTemplateDefinition {
+    friend ObjectFileCache;
 public:
 
     //! \brief Creates a ObjectFileTemplateDefinition
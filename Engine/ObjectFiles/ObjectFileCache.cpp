@@ -0,0 +1,1070 @@
+// ------------------------------------ //
+#include "ObjectFileCache.h"
+
+#include "FileSystem.h"
+#include "Utility/MemoryMappedFile.h"
+
+#ifdef LEVIATHAN_USING_ANGELSCRIPT
+#include "Script/ScriptExecutor.h"
+#include "Script/ScriptModule.h"
+#include "Script/ScriptScript.h"
+#endif // LEVIATHAN_USING_ANGELSCRIPT
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <type_traits>
+
+using namespace Leviathan;
+// ------------------------------------ //
+//! Identifies compiled object files, "LVOC"
+constexpr uint32_t OBJECTFILE_CACHE_MAGIC = 0x434F564C;
+
+//! Increment when the layout changes to discard old compiled files
+constexpr uint32_t OBJECTFILE_CACHE_VERSION = 2;
+
+//! Catches reading files written on a machine with different endianness
+constexpr uint32_t OBJECTFILE_CACHE_BYTEORDER = 0x01020304;
+
+constexpr auto OBJECTFILE_CACHE_EXTENSION = ".levofc";
+
+namespace Leviathan {
+
+//! \brief Keeps compiled data alive while there are objects that haven't been materialized
+class ObjectFileCacheData {
+public:
+    //! Used when loading from a compiled file
+    MemoryMappedFile Mapping;
+
+    //! Used when loading from memory
+    std::string Buffer;
+
+    const uint8_t* Data = nullptr;
+    size_t Size = 0;
+
+    std::string SourceName;
+};
+
+} // namespace Leviathan
+
+namespace {
+
+//! \brief Appends native endian values to a string
+class BinaryWriter {
+public:
+    BinaryWriter(std::string& target) : Target(target) {}
+
+    template<class T>
+    void Write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "can only write plain values");
+        Target.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void WriteString(const std::string& str)
+    {
+        Write<uint32_t>(static_cast<uint32_t>(str.size()));
+        Target.append(str);
+    }
+
+    void WriteStrings(const std::vector<std::unique_ptr<std::string>>& strings)
+    {
+        Write<uint32_t>(static_cast<uint32_t>(strings.size()));
+
+        for(const auto& str : strings)
+            WriteString(*str);
+    }
+
+    std::string& Target;
+};
+
+//! \brief Bounds checked reading of values written by BinaryWriter
+class BinaryReader {
+public:
+    BinaryReader(const uint8_t* data, size_t size) : Data(data), Size(size) {}
+
+    template<class T>
+    bool Read(T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "can only read plain values");
+
+        if(Size - Position < sizeof(T))
+            return false;
+
+        std::memcpy(&value, Data + Position, sizeof(T));
+        Position += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string& str)
+    {
+        uint32_t length;
+
+        if(!Read(length) || Size - Position < length)
+            return false;
+
+        str.assign(reinterpret_cast<const char*>(Data + Position), length);
+        Position += length;
+        return true;
+    }
+
+    bool Skip(size_t count)
+    {
+        if(Size - Position < count)
+            return false;
+
+        Position += count;
+        return true;
+    }
+
+    bool SkipString()
+    {
+        uint32_t length;
+        return Read(length) && Skip(length);
+    }
+
+    bool ReadStrings(std::vector<std::unique_ptr<std::string>>& strings)
+    {
+        uint32_t count;
+
+        if(!Read(count))
+            return false;
+
+        strings.reserve(count);
+
+        for(uint32_t i = 0; i < count; ++i) {
+
+            auto str = std::make_unique<std::string>();
+
+            if(!ReadString(*str))
+                return false;
+
+            strings.push_back(std::move(str));
+        }
+
+        return true;
+    }
+
+    const uint8_t* Data;
+    size_t Size;
+    size_t Position = 0;
+};
+// ------------------------------------ //
+bool WriteVariableBlock(BinaryWriter& writer, const VariableBlock& block)
+{
+    const DataBlockAll* data = block.GetBlockConst();
+
+    if(!data)
+        return false;
+
+    writer.Write<int16_t>(data->Type);
+
+    switch(data->Type) {
+    case DATABLOCK_TYPE_INT: {
+        const auto* value = TvalToTypeResolver<DATABLOCK_TYPE_INT>::Conversion(data)->Value;
+        if(!value)
+            return false;
+        writer.Write<int32_t>(*value);
+        return true;
+    }
+    case DATABLOCK_TYPE_FLOAT: {
+        const auto* value = TvalToTypeResolver<DATABLOCK_TYPE_FLOAT>::Conversion(data)->Value;
+        if(!value)
+            return false;
+        writer.Write<float>(*value);
+        return true;
+    }
+    case DATABLOCK_TYPE_BOOL: {
+        const auto* value = TvalToTypeResolver<DATABLOCK_TYPE_BOOL>::Conversion(data)->Value;
+        if(!value)
+            return false;
+        writer.Write<uint8_t>(*value ? 1 : 0);
+        return true;
+    }
+    case DATABLOCK_TYPE_WSTRING: {
+        const auto* value =
+            TvalToTypeResolver<DATABLOCK_TYPE_WSTRING>::Conversion(data)->Value;
+        if(!value)
+            return false;
+        writer.WriteString(Convert::Utf16ToUtf8(*value));
+        return true;
+    }
+    case DATABLOCK_TYPE_STRING: {
+        const auto* value =
+            TvalToTypeResolver<DATABLOCK_TYPE_STRING>::Conversion(data)->Value;
+        if(!value)
+            return false;
+        writer.WriteString(*value);
+        return true;
+    }
+    case DATABLOCK_TYPE_CHAR: {
+        const auto* value = TvalToTypeResolver<DATABLOCK_TYPE_CHAR>::Conversion(data)->Value;
+        if(!value)
+            return false;
+        writer.Write<char>(*value);
+        return true;
+    }
+    case DATABLOCK_TYPE_DOUBLE: {
+        const auto* value =
+            TvalToTypeResolver<DATABLOCK_TYPE_DOUBLE>::Conversion(data)->Value;
+        if(!value)
+            return false;
+        writer.Write<double>(*value);
+        return true;
+    }
+    default:
+        // Pointers can't be stored
+        return false;
+    }
+}
+
+VariableBlock* ReadVariableBlock(BinaryReader& reader)
+{
+    int16_t type;
+
+    if(!reader.Read(type))
+        return nullptr;
+
+    switch(type) {
+    case DATABLOCK_TYPE_INT: {
+        int32_t value;
+        return reader.Read(value) ? new VariableBlock(new IntBlock(value)) : nullptr;
+    }
+    case DATABLOCK_TYPE_FLOAT: {
+        float value;
+        return reader.Read(value) ? new VariableBlock(new FloatBlock(value)) : nullptr;
+    }
+    case DATABLOCK_TYPE_BOOL: {
+        uint8_t value;
+        return reader.Read(value) ? new VariableBlock(new BoolBlock(value != 0)) : nullptr;
+    }
+    case DATABLOCK_TYPE_WSTRING: {
+        std::string value;
+        return reader.ReadString(value) ?
+                   new VariableBlock(new WstringBlock(Convert::Utf8ToUtf16(value))) :
+                   nullptr;
+    }
+    case DATABLOCK_TYPE_STRING: {
+        std::string value;
+        return reader.ReadString(value) ? new VariableBlock(new StringBlock(value)) : nullptr;
+    }
+    case DATABLOCK_TYPE_CHAR: {
+        char value;
+        return reader.Read(value) ? new VariableBlock(new CharBlock(value)) : nullptr;
+    }
+    case DATABLOCK_TYPE_DOUBLE: {
+        double value;
+        return reader.Read(value) ? new VariableBlock(new DoubleBlock(value)) : nullptr;
+    }
+    default: return nullptr;
+    }
+}
+
+bool WriteNamedVars(BinaryWriter& writer, NamedVars& variables)
+{
+    const auto& vec = *variables.GetVec();
+
+    writer.Write<uint32_t>(static_cast<uint32_t>(vec.size()));
+
+    for(const auto& list : vec) {
+
+        writer.WriteString(list->GetName());
+        writer.Write<uint32_t>(static_cast<uint32_t>(list->GetVariableCount()));
+
+        for(VariableBlock* block : list->GetValues()) {
+
+            if(!block || !WriteVariableBlock(writer, *block))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+//! \brief Reads variable lists passing each one to callback
+template<class CallbackT>
+bool ReadNamedVariableLists(BinaryReader& reader, CallbackT callback)
+{
+    uint32_t count;
+
+    if(!reader.Read(count))
+        return false;
+
+    for(uint32_t i = 0; i < count; ++i) {
+
+        std::string name;
+        uint32_t valuecount;
+
+        if(!reader.ReadString(name) || !reader.Read(valuecount))
+            return false;
+
+        std::vector<VariableBlock*> values;
+        values.reserve(valuecount);
+
+        for(uint32_t a = 0; a < valuecount; ++a) {
+
+            VariableBlock* block = ReadVariableBlock(reader);
+
+            if(!block) {
+
+                for(VariableBlock* created : values)
+                    delete created;
+                return false;
+            }
+
+            values.push_back(block);
+        }
+
+        if(!callback(std::make_shared<NamedVariableList>(name, values)))
+            return false;
+    }
+
+    return true;
+}
+
+bool SkipVariableBlock(BinaryReader& reader)
+{
+    int16_t type;
+
+    if(!reader.Read(type))
+        return false;
+
+    switch(type) {
+    case DATABLOCK_TYPE_INT: return reader.Skip(sizeof(int32_t));
+    case DATABLOCK_TYPE_FLOAT: return reader.Skip(sizeof(float));
+    case DATABLOCK_TYPE_BOOL: return reader.Skip(sizeof(uint8_t));
+    case DATABLOCK_TYPE_WSTRING:
+    case DATABLOCK_TYPE_STRING: return reader.SkipString();
+    case DATABLOCK_TYPE_CHAR: return reader.Skip(sizeof(char));
+    case DATABLOCK_TYPE_DOUBLE: return reader.Skip(sizeof(double));
+    default: return false;
+    }
+}
+
+bool SkipNamedVariableLists(BinaryReader& reader)
+{
+    uint32_t count;
+
+    if(!reader.Read(count))
+        return false;
+
+    for(uint32_t i = 0; i < count; ++i) {
+
+        uint32_t valuecount;
+
+        if(!reader.SkipString() || !reader.Read(valuecount))
+            return false;
+
+        for(uint32_t a = 0; a < valuecount; ++a) {
+            if(!SkipVariableBlock(reader))
+                return false;
+        }
+    }
+
+    return true;
+}
+// ------------------------------------ //
+//! \brief Writes the contents of an object into blob and the header part into writer
+bool WriteObject(BinaryWriter& writer, std::string& blob, ObjectFileObject& obj)
+{
+    writer.WriteString(obj.GetName());
+    writer.WriteString(obj.GetTypeName());
+
+    writer.Write<uint32_t>(static_cast<uint32_t>(obj.GetPrefixesCount()));
+
+    for(size_t i = 0; i < obj.GetPrefixesCount(); ++i)
+        writer.WriteString(obj.GetPrefix(i));
+
+    const uint64_t bodystart = blob.size();
+    BinaryWriter body(blob);
+
+    body.Write<uint32_t>(static_cast<uint32_t>(obj.GetListCount()));
+
+    for(size_t i = 0; i < obj.GetListCount(); ++i) {
+
+        ObjectFileList* list = obj.GetList(i);
+
+        body.WriteString(list->GetName());
+
+        if(!WriteNamedVars(body, list->GetVariables()))
+            return false;
+    }
+
+    body.Write<uint32_t>(static_cast<uint32_t>(obj.GetTextBlockCount()));
+
+    for(size_t i = 0; i < obj.GetTextBlockCount(); ++i) {
+
+        ObjectFileTextBlock* block = obj.GetTextBlock(i);
+
+        body.WriteString(block->GetName());
+        body.Write<uint32_t>(static_cast<uint32_t>(block->GetLineCount()));
+
+        for(size_t line = 0; line < block->GetLineCount(); ++line)
+            body.WriteString(block->GetLine(line));
+    }
+
+#ifdef LEVIATHAN_USING_ANGELSCRIPT
+    auto script = obj.GetScript();
+    auto module = script ? script->GetModuleSafe() : nullptr;
+
+    if(module) {
+
+        body.Write<uint8_t>(1);
+        body.WriteString(module->GetName());
+        body.WriteString(module->GetSource());
+
+        body.Write<uint32_t>(static_cast<uint32_t>(module->GetScriptSegmentCount()));
+
+        for(size_t i = 0; i < module->GetScriptSegmentCount(); ++i) {
+
+            auto segment = module->GetScriptSegment(i);
+
+            body.WriteString(segment->SourceFile);
+            body.Write<int32_t>(segment->StartLine);
+            body.WriteString(*segment->SourceCode);
+        }
+
+    } else {
+        body.Write<uint8_t>(0);
+    }
+#else
+    body.Write<uint8_t>(0);
+#endif // LEVIATHAN_USING_ANGELSCRIPT
+
+    writer.Write<uint64_t>(bodystart);
+    writer.Write<uint64_t>(blob.size() - bodystart);
+    return true;
+}
+
+std::shared_ptr<CachedObjectFileObject> ReadObject(
+    BinaryReader& reader, const std::shared_ptr<ObjectFileCacheData>& data)
+{
+    std::string name;
+    std::string type;
+    std::vector<std::unique_ptr<std::string>> prefixes;
+    uint64_t bodyoffset;
+    uint64_t bodysize;
+
+    if(!reader.ReadString(name) || !reader.ReadString(type) || !reader.ReadStrings(prefixes) ||
+        !reader.Read(bodyoffset) || !reader.Read(bodysize))
+        return nullptr;
+
+    return std::make_shared<CachedObjectFileObject>(
+        name, type, std::move(prefixes), data, bodyoffset, bodysize);
+}
+
+//! \brief Walks through an object body written by WriteObject without creating anything
+//!
+//! Used when loading so that materializing can't run into broken data after the file has
+//! already been accepted
+bool ValidateObjectBody(const ObjectFileCacheData& data, uint64_t offset, uint64_t size)
+{
+    if(offset > data.Size || data.Size - offset < size)
+        return false;
+
+    BinaryReader reader(data.Data + offset, static_cast<size_t>(size));
+
+    uint32_t listcount;
+
+    if(!reader.Read(listcount))
+        return false;
+
+    for(uint32_t i = 0; i < listcount; ++i) {
+        if(!reader.SkipString() || !SkipNamedVariableLists(reader))
+            return false;
+    }
+
+    uint32_t blockcount;
+
+    if(!reader.Read(blockcount))
+        return false;
+
+    for(uint32_t i = 0; i < blockcount; ++i) {
+
+        uint32_t linecount;
+
+        if(!reader.SkipString() || !reader.Read(linecount))
+            return false;
+
+        for(uint32_t line = 0; line < linecount; ++line) {
+            if(!reader.SkipString())
+                return false;
+        }
+    }
+
+    uint8_t hasscript;
+
+    if(!reader.Read(hasscript))
+        return false;
+
+    if(hasscript) {
+#ifdef LEVIATHAN_USING_ANGELSCRIPT
+        uint32_t segmentcount;
+
+        if(!reader.SkipString() || !reader.SkipString() || !reader.Read(segmentcount))
+            return false;
+
+        for(uint32_t i = 0; i < segmentcount; ++i) {
+            if(!reader.SkipString() || !reader.Skip(sizeof(int32_t)) || !reader.SkipString())
+                return false;
+        }
+#else
+        // Parsing the source again reports this properly
+        return false;
+#endif // LEVIATHAN_USING_ANGELSCRIPT
+    }
+
+    return reader.Position == reader.Size;
+}
+
+} // namespace
+// ------------------ CachedObjectFileObject ------------------ //
+DLLEXPORT CachedObjectFileObject::CachedObjectFileObject(const std::string& name,
+    const std::string& typesname, std::vector<std::unique_ptr<std::string>>&& prefix,
+    std::shared_ptr<ObjectFileCacheData> source, uint64_t bodyoffset, uint64_t bodysize) :
+    ObjectFileObjectProper(name, typesname, std::move(prefix)),
+    Source(std::move(source)), BodyOffset(bodyoffset), BodySize(bodysize)
+{}
+// ------------------------------------ //
+void CachedObjectFileObject::_Materialize() const
+{
+    if(!Source)
+        return;
+
+    // Released first so that the base class methods can't end up here again
+    const auto data = std::move(Source);
+
+    auto* us = const_cast<CachedObjectFileObject*>(this);
+
+    // The body was validated when loading. Everything is still read into temporaries and
+    // only added at the end so that an error can't leave this object half filled
+    const auto fail = [&](const std::string& problem) {
+        LOG_ERROR("ObjectFileCache: " + problem + " in object: " + Name +
+                  ", file: " + data->SourceName);
+    };
+
+    if(BodyOffset > data->Size || data->Size - BodyOffset < BodySize)
+        return fail("body is out of range");
+
+    BinaryReader reader(data->Data + BodyOffset, static_cast<size_t>(BodySize));
+
+    std::vector<std::unique_ptr<ObjectFileList>> lists;
+    std::vector<std::unique_ptr<ObjectFileTextBlock>> blocks;
+
+    uint32_t listcount;
+
+    if(!reader.Read(listcount))
+        return fail("truncated data");
+
+    for(uint32_t i = 0; i < listcount; ++i) {
+
+        std::string listname;
+
+        if(!reader.ReadString(listname))
+            return fail("truncated data");
+
+        auto list = std::make_unique<ObjectFileListProper>(listname);
+
+        if(!ReadNamedVariableLists(reader, [&](std::shared_ptr<NamedVariableList> var) {
+               return list->AddVariable(var);
+           }))
+            return fail("invalid list");
+
+        lists.push_back(std::move(list));
+    }
+
+    uint32_t blockcount;
+
+    if(!reader.Read(blockcount))
+        return fail("truncated data");
+
+    for(uint32_t i = 0; i < blockcount; ++i) {
+
+        std::string blockname;
+        uint32_t linecount;
+
+        if(!reader.ReadString(blockname) || !reader.Read(linecount))
+            return fail("truncated data");
+
+        auto block = std::make_unique<ObjectFileTextBlockProper>(blockname);
+
+        for(uint32_t line = 0; line < linecount; ++line) {
+
+            std::string text;
+
+            if(!reader.ReadString(text))
+                return fail("truncated data");
+
+            block->AddTextLine(text);
+        }
+
+        blocks.push_back(std::move(block));
+    }
+
+    uint8_t hasscript;
+
+    if(!reader.Read(hasscript))
+        return fail("truncated data");
+
+#ifdef LEVIATHAN_USING_ANGELSCRIPT
+    std::shared_ptr<ScriptScript> script;
+
+    if(hasscript) {
+
+        std::string modulename;
+        std::string modulesource;
+        uint32_t segmentcount;
+
+        if(!reader.ReadString(modulename) || !reader.ReadString(modulesource) ||
+            !reader.Read(segmentcount))
+            return fail("truncated script");
+
+        std::vector<std::tuple<std::string, int32_t, std::string>> segments;
+
+        for(uint32_t i = 0; i < segmentcount; ++i) {
+
+            std::string file;
+            int32_t startline;
+            std::string code;
+
+            if(!reader.ReadString(file) || !reader.Read(startline) ||
+                !reader.ReadString(code))
+                return fail("truncated script");
+
+            segments.emplace_back(std::move(file), startline, std::move(code));
+        }
+
+        script = std::make_shared<ScriptScript>(
+            ScriptExecutor::Get()->CreateNewModule(modulename, modulesource));
+
+        auto module = script->GetModuleSafe();
+
+        for(const auto& segment : segments) {
+            module->AddScriptSegment(
+                std::get<0>(segment), std::get<1>(segment), std::get<2>(segment));
+        }
+
+        module->SetBuildState(SCRIPTBUILDSTATE_READYTOBUILD);
+    }
+#else
+    if(hasscript)
+        return fail("script without script support compiled in");
+#endif // LEVIATHAN_USING_ANGELSCRIPT
+
+    for(auto& list : lists)
+        us->ObjectFileObjectProper::AddVariableList(std::move(list));
+
+    for(auto& block : blocks)
+        us->ObjectFileObjectProper::AddTextBlock(std::move(block));
+
+#ifdef LEVIATHAN_USING_ANGELSCRIPT
+    if(script)
+        us->ObjectFileObjectProper::AddScriptScript(script);
+#endif // LEVIATHAN_USING_ANGELSCRIPT
+}
+// ------------------------------------ //
+DLLEXPORT bool CachedObjectFileObject::AddVariableList(std::unique_ptr<ObjectFileList>&& list)
+{
+    _Materialize();
+    return ObjectFileObjectProper::AddVariableList(std::move(list));
+}
+
+DLLEXPORT bool CachedObjectFileObject::AddTextBlock(
+    std::unique_ptr<ObjectFileTextBlock>&& tblock)
+{
+    _Materialize();
+    return ObjectFileObjectProper::AddTextBlock(std::move(tblock));
+}
+
+DLLEXPORT void CachedObjectFileObject::AddScriptScript(std::shared_ptr<ScriptScript> script)
+{
+    _Materialize();
+    ObjectFileObjectProper::AddScriptScript(script);
+}
+
+DLLEXPORT ObjectFileList* CachedObjectFileObject::GetListWithName(
+    const std::string& name) const
+{
+    _Materialize();
+    return ObjectFileObjectProper::GetListWithName(name);
+}
+
+DLLEXPORT ObjectFileTextBlock* CachedObjectFileObject::GetTextBlockWithName(
+    const std::string& name) const
+{
+    _Materialize();
+    return ObjectFileObjectProper::GetTextBlockWithName(name);
+}
+
+DLLEXPORT std::shared_ptr<ScriptScript> CachedObjectFileObject::GetScript() const
+{
+    _Materialize();
+    return ObjectFileObjectProper::GetScript();
+}
+
+DLLEXPORT size_t CachedObjectFileObject::GetListCount() const
+{
+    _Materialize();
+    return ObjectFileObjectProper::GetListCount();
+}
+
+DLLEXPORT ObjectFileList* CachedObjectFileObject::GetList(size_t index) const
+{
+    _Materialize();
+    return ObjectFileObjectProper::GetList(index);
+}
+
+DLLEXPORT size_t CachedObjectFileObject::GetTextBlockCount() const
+{
+    _Materialize();
+    return ObjectFileObjectProper::GetTextBlockCount();
+}
+
+DLLEXPORT ObjectFileTextBlock* CachedObjectFileObject::GetTextBlock(size_t index) const
+{
+    _Materialize();
+    return ObjectFileObjectProper::GetTextBlock(index);
+}
+
+DLLEXPORT std::string CachedObjectFileObject::Serialize(size_t indentspaces) const
+{
+    _Materialize();
+    return ObjectFileObjectProper::Serialize(indentspaces);
+}
+// ------------------ ObjectFileCache ------------------ //
+std::string ObjectFileCache::CacheFolder;
+
+DLLEXPORT void ObjectFileCache::SetCacheFolder(const std::string& folder)
+{
+    CacheFolder = folder;
+}
+
+DLLEXPORT const std::string& ObjectFileCache::GetCacheFolder()
+{
+    return CacheFolder;
+}
+// ------------------------------------ //
+DLLEXPORT uint64_t ObjectFileCache::HashContents(const std::string& contents)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for(const char character : contents) {
+
+        hash ^= static_cast<uint8_t>(character);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+DLLEXPORT std::string ObjectFileCache::GetCachePathForFile(const std::string& sourcefile)
+{
+    std::stringstream stream;
+    stream << CacheFolder << "/" << std::hex << std::setw(16) << std::setfill('0')
+           << HashContents(sourcefile) << OBJECTFILE_CACHE_EXTENSION;
+    return stream.str();
+}
+// ------------------------------------ //
+DLLEXPORT bool ObjectFileCache::Compile(ObjectFile& data, std::string& receiver)
+{
+    BinaryWriter writer(receiver);
+
+    // Object bodies are collected here and appended last
+    std::string blob;
+
+    if(!WriteNamedVars(writer, *data.GetVariables()))
+        return false;
+
+    // Objects generated from templates are recreated when loading
+    uint32_t objectcount = 0;
+
+    for(size_t i = 0; i < data.GetTotalObjectCount(); ++i) {
+        if(!data.GetObjectFromIndex(i)->IsThisTemplated())
+            ++objectcount;
+    }
+
+    writer.Write<uint32_t>(objectcount);
+
+    for(size_t i = 0; i < data.GetTotalObjectCount(); ++i) {
+
+        ObjectFileObject* obj = data.GetObjectFromIndex(i);
+
+        if(obj->IsThisTemplated())
+            continue;
+
+        if(!WriteObject(writer, blob, *obj))
+            return false;
+    }
+
+    writer.Write<uint32_t>(static_cast<uint32_t>(data.GetTemplateDefinitionCount()));
+
+    for(size_t i = 0; i < data.GetTemplateDefinitionCount(); ++i) {
+
+        auto definition = data.GetTemplateDefinition(i);
+
+        writer.WriteString(definition->Name);
+        writer.WriteStrings(definition->Parameters);
+
+        if(!WriteObject(writer, blob, *definition->RepresentingObject))
+            return false;
+    }
+
+    writer.Write<uint32_t>(static_cast<uint32_t>(data.GetTemplateInstanceCount()));
+
+    for(size_t i = 0; i < data.GetTemplateInstanceCount(); ++i) {
+
+        auto instance = data.GetTemplateInstance(i);
+
+        writer.WriteString(instance->TemplatesName);
+        writer.WriteStrings(instance->Arguments);
+    }
+
+    writer.Write<uint64_t>(blob.size());
+    receiver.append(blob);
+    return true;
+}
+// ------------------------------------ //
+DLLEXPORT bool ObjectFileCache::Store(ObjectFile& data, const std::string& sourcefile,
+    uint64_t sourcesize, uint64_t sourcehash, LErrorReporter* reporterror)
+{
+    if(!IsEnabled())
+        return false;
+
+    std::string compiled;
+    BinaryWriter writer(compiled);
+
+    writer.Write<uint32_t>(OBJECTFILE_CACHE_MAGIC);
+    writer.Write<uint32_t>(OBJECTFILE_CACHE_VERSION);
+    writer.Write<uint32_t>(OBJECTFILE_CACHE_BYTEORDER);
+    writer.Write<uint64_t>(sourcesize);
+    writer.Write<uint64_t>(sourcehash);
+    writer.WriteString(sourcefile);
+
+    if(!Compile(data, compiled)) {
+
+        reporterror->Warning(
+            "ObjectFileCache: file contains data that can't be compiled: " + sourcefile);
+        return false;
+    }
+
+    boost::system::error_code error;
+    boost::filesystem::create_directories(CacheFolder, error);
+
+    // Write to a temporary file first to never leave a partially written file in place. This
+    // also keeps any mappings of the old file valid as they refer to the replaced file
+    const auto target = GetCachePathForFile(sourcefile);
+    const auto temporary = target + ".tmp";
+
+    if(!FileSystem::WriteToFile(compiled, temporary)) {
+
+        reporterror->Warning("ObjectFileCache: failed to write compiled file: " + temporary);
+        return false;
+    }
+
+    boost::filesystem::rename(temporary, target, error);
+
+    if(error) {
+
+        reporterror->Warning("ObjectFileCache: failed to move compiled file to: " + target);
+        boost::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    return true;
+}
+// ------------------------------------ //
+DLLEXPORT std::unique_ptr<ObjectFile> ObjectFileCache::Load(const std::string& sourcefile,
+    uint64_t sourcesize, uint64_t sourcehash, LErrorReporter* reporterror)
+{
+    if(!IsEnabled())
+        return nullptr;
+
+    const auto cachefile = GetCachePathForFile(sourcefile);
+
+    auto data = std::make_shared<ObjectFileCacheData>();
+
+    if(!data->Mapping.Open(cachefile))
+        return nullptr;
+
+    data->Data = data->Mapping.GetData();
+    data->Size = data->Mapping.GetSize();
+    data->SourceName = sourcefile;
+
+    BinaryReader reader(data->Data, data->Size);
+
+    uint32_t magic, version, byteorder;
+    uint64_t size;
+    uint64_t hash;
+    std::string path;
+
+    if(!reader.Read(magic) || !reader.Read(version) || !reader.Read(byteorder) ||
+        !reader.Read(size) || !reader.Read(hash) || !reader.ReadString(path))
+        return nullptr;
+
+    // Modification times aren't used as they can stay the same when a file is replaced
+    // quickly or its time is restored
+    if(magic != OBJECTFILE_CACHE_MAGIC || version != OBJECTFILE_CACHE_VERSION ||
+        byteorder != OBJECTFILE_CACHE_BYTEORDER || path != sourcefile || size != sourcesize ||
+        hash != sourcehash)
+        return nullptr;
+
+    return _LoadBody(data, reader.Position, reporterror);
+}
+
+DLLEXPORT std::unique_ptr<ObjectFile> ObjectFileCache::LoadCompiled(
+    const std::string& compiled, const std::string& nameforerrors, LErrorReporter* reporterror)
+{
+    auto data = std::make_shared<ObjectFileCacheData>();
+
+    data->Buffer = compiled;
+    data->Data = reinterpret_cast<const uint8_t*>(data->Buffer.data());
+    data->Size = data->Buffer.size();
+    data->SourceName = nameforerrors;
+
+    return _LoadBody(data, 0, reporterror);
+}
+// ------------------------------------ //
+std::unique_ptr<ObjectFile> ObjectFileCache::_LoadBody(
+    std::shared_ptr<ObjectFileCacheData> data, uint64_t offset, LErrorReporter* reporterror)
+{
+    if(offset > data->Size)
+        return nullptr;
+
+    BinaryReader reader(data->Data + offset, data->Size - static_cast<size_t>(offset));
+
+    auto ofile = std::make_unique<ObjectFile>();
+
+    if(!ReadNamedVariableLists(reader, [&](std::shared_ptr<NamedVariableList> var) {
+           return ofile->AddNamedVariable(var);
+       })) {
+
+        reporterror->Error("ObjectFileCache: invalid header variables in: " + data->SourceName);
+        return nullptr;
+    }
+
+    // The bodies are after the tables so the object offsets are adjusted once the blob
+    // start is known
+    uint32_t objectcount;
+
+    if(!reader.Read(objectcount))
+        return nullptr;
+
+    std::vector<std::shared_ptr<CachedObjectFileObject>> objects;
+    objects.reserve(objectcount);
+
+    std::vector<std::tuple<std::string, std::vector<std::unique_ptr<std::string>>,
+        std::shared_ptr<CachedObjectFileObject>>>
+        definitions;
+
+    for(uint32_t i = 0; i < objectcount; ++i) {
+
+        auto obj = ReadObject(reader, data);
+
+        if(!obj) {
+            reporterror->Error("ObjectFileCache: invalid object table in: " + data->SourceName);
+            return nullptr;
+        }
+
+        objects.push_back(obj);
+    }
+
+    uint32_t definitioncount;
+
+    if(!reader.Read(definitioncount))
+        return nullptr;
+
+    for(uint32_t i = 0; i < definitioncount; ++i) {
+
+        std::string name;
+        std::vector<std::unique_ptr<std::string>> parameters;
+
+        if(!reader.ReadString(name) || !reader.ReadStrings(parameters))
+            return nullptr;
+
+        auto obj = ReadObject(reader, data);
+
+        if(!obj) {
+            reporterror->Error(
+                "ObjectFileCache: invalid template table in: " + data->SourceName);
+            return nullptr;
+        }
+
+        definitions.emplace_back(name, std::move(parameters), obj);
+    }
+
+    uint32_t instancecount;
+
+    if(!reader.Read(instancecount))
+        return nullptr;
+
+    for(uint32_t i = 0; i < instancecount; ++i) {
+
+        std::string name;
+        std::vector<std::unique_ptr<std::string>> arguments;
+
+        if(!reader.ReadString(name) || !reader.ReadStrings(arguments))
+            return nullptr;
+
+        ofile->AddTemplateInstance(std::make_shared<ObjectFileTemplateInstance>(name, arguments));
+    }
+
+    uint64_t blobsize;
+
+    if(!reader.Read(blobsize) || reader.Size - reader.Position != blobsize) {
+
+        reporterror->Error("ObjectFileCache: truncated file: " + data->SourceName);
+        return nullptr;
+    }
+
+    // Objects add this to their relative offsets when materializing
+    const uint64_t blobstart = offset + reader.Position;
+
+    // Everything is checked now so that the file can be parsed again instead of objects
+    // coming out empty when they are materialized
+    for(auto& obj : objects) {
+
+        obj->BodyOffset += blobstart;
+
+        if(!ValidateObjectBody(*data, obj->BodyOffset, obj->BodySize)) {
+
+            reporterror->Error(
+                "ObjectFileCache: invalid data in object: " + obj->GetName() +
+                ", file: " + data->SourceName);
+            return nullptr;
+        }
+
+        if(!ofile->AddObject(obj)) {
+
+            reporterror->Error("ObjectFileCache: duplicate object name in: " + data->SourceName);
+            return nullptr;
+        }
+    }
+
+    for(auto& definition : definitions) {
+
+        auto& obj = std::get<2>(definition);
+        obj->BodyOffset += blobstart;
+
+        if(!ValidateObjectBody(*data, obj->BodyOffset, obj->BodySize)) {
+
+            reporterror->Error("ObjectFileCache: invalid data in template: " +
+                               std::get<0>(definition) + ", file: " + data->SourceName);
+            return nullptr;
+        }
+
+        if(!ofile->AddTemplate(std::make_shared<ObjectFileTemplateDefinition>(
+               std::get<0>(definition), std::get<1>(definition), obj))) {
+
+            reporterror->Error(
+                "ObjectFileCache: duplicate template name in: " + data->SourceName);
+            return nullptr;
+        }
+    }
+
+    if(!ofile->GenerateTemplatedObjects(reporterror))
+        return nullptr;
+
+    return ofile;
+}
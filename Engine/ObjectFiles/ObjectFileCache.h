@@ -0,0 +1,131 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2018 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "ErrorReporter.h"
+#include "ObjectFile.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Leviathan {
+
+class ObjectFileCacheData;
+
+//! \brief An ObjectFileObject that is loaded from the binary cache on first access
+//!
+//! The name, type and prefixes are available immediately as they are needed for looking up
+//! objects. Everything else is read from the mapped cache file when first requested
+class CachedObjectFileObject : public ObjectFileObjectProper {
+    friend ObjectFileCache;
+
+public:
+    DLLEXPORT CachedObjectFileObject(const std::string& name, const std::string& typesname,
+        std::vector<std::unique_ptr<std::string>>&& prefix,
+        std::shared_ptr<ObjectFileCacheData> source, uint64_t bodyoffset, uint64_t bodysize);
+
+    DLLEXPORT bool AddVariableList(std::unique_ptr<ObjectFileList>&& list) override;
+
+    DLLEXPORT bool AddTextBlock(std::unique_ptr<ObjectFileTextBlock>&& tblock) override;
+
+    DLLEXPORT void AddScriptScript(std::shared_ptr<ScriptScript> script) override;
+
+    DLLEXPORT ObjectFileList* GetListWithName(const std::string& name) const override;
+
+    DLLEXPORT ObjectFileTextBlock* GetTextBlockWithName(const std::string& name) const override;
+
+    DLLEXPORT std::shared_ptr<ScriptScript> GetScript() const override;
+
+    DLLEXPORT size_t GetListCount() const override;
+
+    DLLEXPORT ObjectFileList* GetList(size_t index) const override;
+
+    DLLEXPORT size_t GetTextBlockCount() const override;
+
+    DLLEXPORT ObjectFileTextBlock* GetTextBlock(size_t index) const override;
+
+    DLLEXPORT std::string Serialize(size_t indentspaces = 0) const override;
+
+    //! \returns True once the contents have been read from the cache
+    inline bool IsMaterialized() const
+    {
+        return !Source;
+    }
+
+protected:
+    //! \brief Reads the lists, text blocks and script from the cache if not done already
+    //!
+    //! This is const because the data is logically already part of this object
+    void _Materialize() const;
+
+protected:
+    //! Released after materializing to allow the mapping to close
+    mutable std::shared_ptr<ObjectFileCacheData> Source;
+    uint64_t BodyOffset;
+    uint64_t BodySize;
+};
+
+//! \brief Compiles ObjectFiles into a binary format that is stored on disk
+//!
+//! When enabled ObjectFileProcessor::ProcessObjectFile first checks for an up to date
+//! compiled version of the file. The cache is keyed by the source path and validated against
+//! the size and content hash of the source. Compiled files are memory mapped and objects are
+//! lazily materialized, but all of the data is validated when loading so that a broken file
+//! is parsed again instead.
+//! \note The cache is specific to the machine that wrote it and values registered with
+//! ObjectFileProcessor::RegisterValue are baked in, so the cache folder should be cleared if
+//! those change
+class ObjectFileCache {
+public:
+    ObjectFileCache() = delete;
+
+    //! \brief Sets the folder compiled files are written to. An empty string disables caching
+    DLLEXPORT static void SetCacheFolder(const std::string& folder);
+
+    DLLEXPORT static const std::string& GetCacheFolder();
+
+    inline static bool IsEnabled()
+    {
+        return !CacheFolder.empty();
+    }
+
+    //! \brief Loads a compiled version of sourcefile if there is an up to date one
+    //! \param sourcesize Size of the current contents of sourcefile
+    //! \param sourcehash HashContents of the current contents of sourcefile
+    //! \returns Null if there is no valid compiled file
+    DLLEXPORT static std::unique_ptr<ObjectFile> Load(const std::string& sourcefile,
+        uint64_t sourcesize, uint64_t sourcehash, LErrorReporter* reporterror);
+
+    //! \brief Compiles a parsed file and writes it to the cache folder
+    //! \param sourcesize Size of the raw file data that was parsed
+    //! \param sourcehash HashContents of the raw file data that was parsed
+    //! \note The size and hash must be from the same data that was parsed, not read again
+    //! from the file, as it may have changed in between
+    DLLEXPORT static bool Store(ObjectFile& data, const std::string& sourcefile,
+        uint64_t sourcesize, uint64_t sourcehash, LErrorReporter* reporterror);
+
+    //! \brief Serializes data into the binary format, without the source validation header
+    //! \returns False if something can't be represented (void pointer values)
+    DLLEXPORT static bool Compile(ObjectFile& data, std::string& receiver);
+
+    //! \brief Loads an ObjectFile from data created by Compile
+    //! \param nameforerrors Shown in errors about malformed data
+    DLLEXPORT static std::unique_ptr<ObjectFile> LoadCompiled(const std::string& compiled,
+        const std::string& nameforerrors, LErrorReporter* reporterror);
+
+    //! \returns The path of the compiled file for sourcefile
+    DLLEXPORT static std::string GetCachePathForFile(const std::string& sourcefile);
+
+    //! \brief 64-bit FNV-1a hash used for detecting changed sources
+    DLLEXPORT static uint64_t HashContents(const std::string& contents);
+
+private:
+    static std::unique_ptr<ObjectFile> _LoadBody(
+        std::shared_ptr<ObjectFileCacheData> data, uint64_t offset, LErrorReporter* reporterror);
+
+    static std::string CacheFolder;
+};
+
+} // namespace Leviathan
@@ -13,6 +13,9 @@
 #include "utf8/checked.h"
 
 #include "ObjectFile.h"
+#ifndef LEVIATHAN_UE_PLUGIN
+#include "ObjectFileCache.h"
+#endif // LEVIATHAN_UE_PLUGIN
 
 #ifdef ALLOW_INTERNAL_EXCEPTIONS
 #include "Exceptions.h"
@@ -106,6 +109,22 @@ DLLEXPORT std::unique_ptr<ObjectFile> Leviathan::ObjectFileProcessor::ProcessObj
 		return nullptr;
 	}
 
+#ifndef LEVIATHAN_UE_PLUGIN
+    // The hash is of the raw data so that it is checked against exactly what gets parsed //
+    const uint64_t sourcesize = filecontents.size();
+    const uint64_t sourcehash = ObjectFileCache::IsEnabled() ?
+        ObjectFileCache::HashContents(filecontents) : 0;
+
+    // Skip parsing if there is an up to date compiled version //
+    if(ObjectFileCache::IsEnabled()){
+
+        auto cached = ObjectFileCache::Load(file, sourcesize, sourcehash, reporterror);
+
+        if(cached)
+            return cached;
+    }
+#endif // LEVIATHAN_UE_PLUGIN
+
 	// Skip the BOM if there is one //
 	if(utf8::starts_with_bom(filecontents.begin(), filecontents.end())){
 
@@ -113,7 +132,14 @@ DLLEXPORT std::unique_ptr<ObjectFile> Leviathan::ObjectFileProcessor::ProcessObj
 		filecontents = filecontents.substr(3, filecontents.size()-3);
 	}
 
-    return ProcessObjectFileFromString(filecontents, file, reporterror);
+    auto result = ProcessObjectFileFromString(filecontents, file, reporterror);
+
+#ifndef LEVIATHAN_UE_PLUGIN
+    if(result && ObjectFileCache::IsEnabled())
+        ObjectFileCache::Store(*result, file, sourcesize, sourcehash, reporterror);
+#endif // LEVIATHAN_UE_PLUGIN
+
+    return result;
 }
 
 DLLEXPORT std::unique_ptr<Leviathan::ObjectFile>
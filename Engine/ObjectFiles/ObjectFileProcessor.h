@@ -21,6 +21,8 @@ public:
     DLLEXPORT static void Release();
 
     //! \brief Reads an ObjectFile to an in-memory data structure
+    //!
+    //! Uses the compiled version from ObjectFileCache when it is enabled and up to date
     DLLEXPORT static std::unique_ptr<ObjectFile> ProcessObjectFile(const std::string &file, 
         LErrorReporter* reporterror);
 
@@ -121,7 +121,8 @@ public:
     DLLEXPORT ~PhysicalMaterial();
 
     //! \brief Data pairing
-    //! \note The returned reference is valid only until the next call to FormPairWith
+    //! \note The returned reference stays valid, but calling this again with the same other
+    //! material resets the pair
     DLLEXPORT PhysMaterialDataPair& FormPairWith(const PhysicalMaterial& other);
 
     //! \brief Returns data for this material to interact with another
@@ -152,6 +153,9 @@ private:
     const std::string Name;
     const int ID;
 
+    //! Set when added to a manager, which needs to know when pairs are added
+    PhysicsMaterialManager* Owner = nullptr;
+
     //! The key is the ID of the other material
     std::unordered_map<int, PhysMaterialDataPair> InterractionsWith;
 };
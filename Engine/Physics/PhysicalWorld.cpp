@@ -5,11 +5,117 @@
 #include "Engine.h"
 #include "Events/EventHandler.h"
 #include "PhysicsMaterialManager.h"
-
+#include "Statistics/Profiler.h"
+#include "Threading/ThreadingManager.h"
+
+#include <bullet/BulletCollision/CollisionShapes/btTriangleCallback.h>
+#include <bullet/BulletCollision/CollisionShapes/btTriangleShape.h>
+#include <bullet/BulletCollision/NarrowPhaseCollision/btGjkEpaPenetrationDepthSolver.h>
+#include <bullet/BulletCollision/NarrowPhaseCollision/btGjkPairDetector.h>
+#include <bullet/BulletCollision/NarrowPhaseCollision/btPointCollector.h>
+#include <bullet/BulletCollision/NarrowPhaseCollision/btVoronoiSimplexSolver.h>
 #include <bullet/btBulletDynamicsCommon.h>
+
+#include <algorithm>
+
+#ifdef LEVIATHAN_MULTITHREADED_PHYSICS
+#include <bullet/BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <bullet/LinearMath/btThreads.h>
+
+#include <mutex>
+#include <thread>
+#endif // LEVIATHAN_MULTITHREADED_PHYSICS
+
 using namespace Leviathan;
 // ------------------------------------ //
 namespace Leviathan {
+#ifdef LEVIATHAN_MULTITHREADED_PHYSICS
+//! \brief Runs the parallel loops of Bullet with ThreadingManager::RunInParallel
+class LeviathanPhysicsTaskScheduler : public btITaskScheduler {
+public:
+    LeviathanPhysicsTaskScheduler() : btITaskScheduler("Leviathan") {}
+
+    int getMaxNumThreads() const override
+    {
+        return BT_MAX_THREAD_COUNT;
+    }
+
+    int getNumThreads() const override
+    {
+        return NumThreads;
+    }
+
+    void setNumThreads(int numthreads) override
+    {
+        NumThreads = std::max(1, std::min(numthreads, BT_MAX_THREAD_COUNT));
+    }
+
+    void parallelFor(
+        int begin, int end, int grainsize, const btIParallelForBody& body) override
+    {
+        const int grain = std::max(grainsize, 1);
+        const size_t chunks = static_cast<size_t>((end - begin + grain - 1) / grain);
+
+        if(chunks <= 1) {
+            body.forLoop(begin, end);
+            return;
+        }
+
+        ThreadingManager::Get()->RunInParallel(chunks, [&](size_t chunk) {
+            const int start = begin + static_cast<int>(chunk) * grain;
+            body.forLoop(start, std::min(start + grain, end));
+        });
+    }
+
+#if BT_BULLET_VERSION >= 288
+    btScalar parallelSum(
+        int begin, int end, int grainsize, const btIParallelSumBody& body) override
+    {
+        const int grain = std::max(grainsize, 1);
+        const size_t chunks = static_cast<size_t>((end - begin + grain - 1) / grain);
+
+        if(chunks <= 1)
+            return body.sumLoop(begin, end);
+
+        std::vector<btScalar> sums(chunks, 0);
+
+        ThreadingManager::Get()->RunInParallel(chunks, [&](size_t chunk) {
+            const int start = begin + static_cast<int>(chunk) * grain;
+            sums[chunk] = body.sumLoop(start, std::min(start + grain, end));
+        });
+
+        btScalar total = 0;
+
+        for(const auto sum : sums)
+            total += sum;
+
+        return total;
+    }
+#endif // BT_BULLET_VERSION >= 288
+
+private:
+    int NumThreads = 1;
+};
+
+//! \brief Sets the Bullet task scheduler to LeviathanPhysicsTaskScheduler once
+int InstallPhysicsTaskScheduler()
+{
+    static LeviathanPhysicsTaskScheduler scheduler;
+    static std::once_flag installed;
+
+    const int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    std::call_once(installed, [&]() {
+        scheduler.setNumThreads(threads);
+        btSetTaskScheduler(&scheduler);
+    });
+
+    return scheduler.getNumThreads();
+}
+#endif // LEVIATHAN_MULTITHREADED_PHYSICS
+
+
 //! \brief Handles AABB material callbacks
 class LeviathanPhysicsOverlapFilter : public btOverlapFilterCallback {
 public:
@@ -71,8 +177,329 @@ private:
 } // namespace Leviathan
 
 
-DLLEXPORT PhysicalWorld::PhysicalWorld(
-    GameWorld* owner, PhysicsMaterialManager* physicscallbacks) :
+// ------------------------------------ //
+namespace {
+
+//! Amount of queries RunQueries gives to a single task
+constexpr size_t QUERIES_PER_TASK = 32;
+
+//! \brief Collects the collision objects of the broadphase leaves a btDbvt query finds
+class QueryCandidateCollector : public btDbvt::ICollide {
+public:
+    QueryCandidateCollector(std::vector<const btCollisionObject*>& objects) : Objects(objects)
+    {}
+
+    void Process(const btDbvtNode* leaf) override
+    {
+        const auto* proxy = static_cast<const btDbvtProxy*>(leaf->data);
+        Objects.push_back(static_cast<const btCollisionObject*>(proxy->m_clientObject));
+    }
+
+private:
+    std::vector<const btCollisionObject*>& Objects;
+};
+
+//! \brief Keeps the closest hit of a ray on a single object
+class QueryRayCallback : public btCollisionWorld::RayResultCallback {
+public:
+    btScalar addSingleResult(
+        btCollisionWorld::LocalRayResult& result, bool normalinworldspace) override
+    {
+        m_closestHitFraction = result.m_hitFraction;
+        m_collisionObject = result.m_collisionObject;
+
+        Normal = normalinworldspace ?
+                     result.m_hitNormalLocal :
+                     m_collisionObject->getWorldTransform().getBasis() * result.m_hitNormalLocal;
+
+        return result.m_hitFraction;
+    }
+
+    btVector3 Normal;
+};
+
+//! \brief Keeps the closest hit of a sweep on a single object
+class QuerySweepCallback : public btCollisionWorld::ConvexResultCallback {
+public:
+    btScalar addSingleResult(
+        btCollisionWorld::LocalConvexResult& result, bool normalinworldspace) override
+    {
+        m_closestHitFraction = result.m_hitFraction;
+        Hit = true;
+
+        // Bullet gives the hit point in world space even though the name says otherwise
+        Point = result.m_hitPointLocal;
+        Normal = normalinworldspace ? result.m_hitNormalLocal :
+                                      result.m_hitCollisionObject->getWorldTransform().getBasis() *
+                                          result.m_hitNormalLocal;
+
+        return result.m_hitFraction;
+    }
+
+    bool Hit = false;
+    btVector3 Point;
+    btVector3 Normal;
+};
+
+ObjectID GetQueryObjectEntity(const btCollisionObject* object)
+{
+    const auto* body = static_cast<const PhysicsBody*>(object->getUserPointer());
+    return body ? body->GetOwningEntity() : NULL_OBJECT;
+}
+
+//! \brief Finds the objects whose bounding box is in volume
+void FindQueryCandidates(const btDbvtBroadphase& broadphase, const btVector3& min,
+    const btVector3& max, std::vector<const btCollisionObject*>& candidates)
+{
+    QueryCandidateCollector collector(candidates);
+    const auto volume = btDbvtVolume::FromMM(min, max);
+
+    // The first set has the moving bodies and the second the static ones
+    for(const auto& set : broadphase.m_sets)
+        set.collideTV(set.m_root, volume, collector);
+}
+
+//! \brief Checks if two convex shapes touch
+//!
+//! GJK is used directly instead of the collision dispatcher as the dispatcher allocates
+//! from shared pools, which isn't thread safe
+bool TestConvexOverlap(const btConvexShape& query, const btTransform& querytransform,
+    const btConvexShape& shape, const btTransform& transform, btVector3& point,
+    btVector3& normal)
+{
+    btVoronoiSimplexSolver simplexSolver;
+    btGjkEpaPenetrationDepthSolver penetrationSolver;
+    btGjkPairDetector detector(&query, &shape, &simplexSolver, &penetrationSolver);
+
+    btGjkPairDetector::ClosestPointInput input;
+    input.m_transformA = querytransform;
+    input.m_transformB = transform;
+
+    btPointCollector output;
+    detector.getClosestPoints(input, output, nullptr);
+
+    if(!output.m_hasResult || output.m_distance > 0)
+        return false;
+
+    point = output.m_pointInWorld;
+    normal = output.m_normalOnBInWorld;
+    return true;
+}
+
+//! \brief Tests the query shape against the triangles of a concave shape near it
+class QueryTriangleOverlapCallback : public btTriangleCallback {
+public:
+    QueryTriangleOverlapCallback(const btConvexShape& query,
+        const btTransform& querytransform, const btTransform& transform) :
+        Query(query), QueryTransform(querytransform), Transform(transform)
+    {}
+
+    void processTriangle(btVector3* triangle, int partid, int triangleindex) override
+    {
+        // There is no way to stop the iteration early
+        if(Hit)
+            return;
+
+        const btTriangleShape shape(triangle[0], triangle[1], triangle[2]);
+
+        Hit = TestConvexOverlap(Query, QueryTransform, shape, Transform, Point, Normal);
+    }
+
+    const btConvexShape& Query;
+    const btTransform& QueryTransform;
+    const btTransform& Transform;
+
+    bool Hit = false;
+    btVector3 Point;
+    btVector3 Normal;
+};
+
+//! \brief Checks if the convex query shape touches shape
+//!
+//! Concave shapes (meshes, planes and height fields) are checked against their triangles
+//! that are inside the bounding box of the query
+bool TestQueryOverlap(const btConvexShape& query, const btTransform& querytransform,
+    const btCollisionShape& shape, const btTransform& transform, btVector3& point,
+    btVector3& normal)
+{
+    if(shape.isCompound()) {
+
+        const auto& compound = static_cast<const btCompoundShape&>(shape);
+
+        for(int i = 0; i < compound.getNumChildShapes(); ++i) {
+            if(TestQueryOverlap(query, querytransform, *compound.getChildShape(i),
+                   transform * compound.getChildTransform(i), point, normal))
+                return true;
+        }
+
+        return false;
+    }
+
+    if(shape.isConvex()) {
+        return TestConvexOverlap(query, querytransform,
+            static_cast<const btConvexShape&>(shape), transform, point, normal);
+    }
+
+    if(shape.isConcave()) {
+
+        // The triangles are given in the local space of the shape
+        btVector3 min, max;
+        query.getAabb(transform.inverse() * querytransform, min, max);
+
+        QueryTriangleOverlapCallback callback(query, querytransform, transform);
+        static_cast<const btConcaveShape&>(shape).processAllTriangles(&callback, min, max);
+
+        if(!callback.Hit)
+            return false;
+
+        point = callback.Point;
+        normal = callback.Normal;
+        return true;
+    }
+
+    // Other shapes are only checked with their bounding boxes
+    point = transform.getOrigin();
+    normal = btVector3(0, 0, 0);
+    return true;
+}
+
+void RunShapeQuery(const btDbvtBroadphase& broadphase, const PhysicsQuery& query,
+    const btConvexShape& shape, uint32_t index,
+    std::vector<const btCollisionObject*>& candidates, std::vector<PhysicsQueryHit>& hits)
+{
+    const bool sweep = query.Type == PHYSICS_QUERY_TYPE::SphereSweep ||
+                       query.Type == PHYSICS_QUERY_TYPE::BoxSweep;
+
+    const btTransform start(query.Orientation, query.From);
+    const btTransform end(query.Orientation, sweep ? query.To : query.From);
+
+    btVector3 min, max, endMin, endMax;
+    shape.getAabb(start, min, max);
+    shape.getAabb(end, endMin, endMax);
+    min.setMin(endMin);
+    max.setMax(endMax);
+
+    FindQueryCandidates(broadphase, min, max, candidates);
+
+    btScalar closest = 1;
+
+    for(const btCollisionObject* object : candidates) {
+
+        const auto entity = GetQueryObjectEntity(object);
+
+        if(query.Ignored != NULL_OBJECT && entity == query.Ignored)
+            continue;
+
+        if(!sweep) {
+
+            btVector3 point, normal;
+
+            if(TestQueryOverlap(shape, start, *object->getCollisionShape(),
+                   object->getWorldTransform(), point, normal))
+                hits.push_back(PhysicsQueryHit{index, entity, point, normal, 0});
+
+            continue;
+        }
+
+        QuerySweepCallback callback;
+
+        // Objects further than the closest hit can be skipped when only it is wanted
+        if(query.MaxHits == 1)
+            callback.m_closestHitFraction = closest;
+
+        btCollisionWorld::objectQuerySingle(&shape, start, end,
+            const_cast<btCollisionObject*>(object), object->getCollisionShape(),
+            object->getWorldTransform(), callback, 0);
+
+        if(callback.Hit) {
+
+            closest = std::min(closest, callback.m_closestHitFraction);
+            hits.push_back(PhysicsQueryHit{index, entity, callback.Point, callback.Normal,
+                callback.m_closestHitFraction});
+        }
+    }
+}
+
+void RunRayQuery(const btDbvtBroadphase& broadphase, const PhysicsQuery& query,
+    uint32_t index, std::vector<const btCollisionObject*>& candidates,
+    std::vector<PhysicsQueryHit>& hits)
+{
+    const btVector3 from = query.From;
+    const btVector3 to = query.To;
+
+    QueryCandidateCollector collector(candidates);
+
+    for(const auto& set : broadphase.m_sets)
+        btDbvt::rayTest(set.m_root, from, to, collector);
+
+    const btTransform rayFrom(btQuaternion::getIdentity(), from);
+    const btTransform rayTo(btQuaternion::getIdentity(), to);
+
+    btScalar closest = 1;
+
+    for(const btCollisionObject* object : candidates) {
+
+        const auto entity = GetQueryObjectEntity(object);
+
+        if(query.Ignored != NULL_OBJECT && entity == query.Ignored)
+            continue;
+
+        QueryRayCallback callback;
+
+        if(query.MaxHits == 1)
+            callback.m_closestHitFraction = closest;
+
+        btCollisionWorld::rayTestSingle(rayFrom, rayTo, const_cast<btCollisionObject*>(object),
+            object->getCollisionShape(), object->getWorldTransform(), callback);
+
+        if(callback.hasHit()) {
+
+            closest = std::min(closest, callback.m_closestHitFraction);
+            hits.push_back(PhysicsQueryHit{index, entity,
+                from.lerp(to, callback.m_closestHitFraction), callback.Normal,
+                callback.m_closestHitFraction});
+        }
+    }
+}
+
+//! \brief Adds the hits of a query to hits. Only reads the broadphase and the objects so
+//! this can be called from multiple threads at once
+void RunSingleQuery(const btDbvtBroadphase& broadphase, const PhysicsQuery& query,
+    uint32_t index, std::vector<const btCollisionObject*>& candidates,
+    std::vector<PhysicsQueryHit>& hits)
+{
+    const size_t firstHit = hits.size();
+    candidates.clear();
+
+    switch(query.Type) {
+    case PHYSICS_QUERY_TYPE::Ray: RunRayQuery(broadphase, query, index, candidates, hits); break;
+    case PHYSICS_QUERY_TYPE::SphereSweep:
+    case PHYSICS_QUERY_TYPE::SphereOverlap: {
+        const btSphereShape sphere(query.Extents.X);
+        RunShapeQuery(broadphase, query, sphere, index, candidates, hits);
+        break;
+    }
+    case PHYSICS_QUERY_TYPE::BoxSweep:
+    case PHYSICS_QUERY_TYPE::BoxOverlap: {
+        const btBoxShape box(query.Extents);
+        RunShapeQuery(broadphase, query, box, index, candidates, hits);
+        break;
+    }
+    }
+
+    std::sort(hits.begin() + firstHit, hits.end(),
+        [](const PhysicsQueryHit& first, const PhysicsQueryHit& second) {
+            return first.Fraction < second.Fraction;
+        });
+
+    if(query.MaxHits > 0 && hits.size() - firstHit > static_cast<size_t>(query.MaxHits))
+        hits.resize(firstHit + query.MaxHits);
+}
+
+} // namespace
+
+DLLEXPORT PhysicalWorld::PhysicalWorld(GameWorld* owner,
+    PhysicsMaterialManager* physicscallbacks, bool multithreaded /*= false*/) :
     OwningWorld(owner),
     PhysicsMaterials(physicscallbacks),
     OverlapFilter(std::make_unique<LeviathanPhysicsOverlapFilter>(this))
@@ -80,17 +507,50 @@ DLLEXPORT PhysicalWorld::PhysicalWorld(
     // Setup physics world //
     CollisionConfiguration = std::make_unique<btDefaultCollisionConfiguration>();
 
-    // Non-parallel dispatcher
-    Dispatcher = std::make_unique<btCollisionDispatcher>(CollisionConfiguration.get());
-
     // According to docs this is a good general broadphase
     OverlappingPairCache = std::make_unique<btDbvtBroadphase>();
 
-    // Non-parallel solver
-    Solver = std::make_unique<btSequentialImpulseConstraintSolver>();
+#ifdef LEVIATHAN_MULTITHREADED_PHYSICS
+    if(multithreaded) {
+
+        Multithreaded = true;
+
+        const int threads = InstallPhysicsTaskScheduler();
+
+        Dispatcher = std::make_unique<btCollisionDispatcherMt>(CollisionConfiguration.get());
+
+        // One solver per thread so that islands can be solved at the same time
+        auto solverPool = std::make_unique<btConstraintSolverPoolMt>(threads);
+
+#if BT_BULLET_VERSION >= 288
+        DynamicsWorld = std::make_unique<btDiscreteDynamicsWorldMt>(Dispatcher.get(),
+            OverlappingPairCache.get(), solverPool.get(), nullptr,
+            CollisionConfiguration.get());
+#else
+        DynamicsWorld = std::make_unique<btDiscreteDynamicsWorldMt>(Dispatcher.get(),
+            OverlappingPairCache.get(), solverPool.get(), CollisionConfiguration.get());
+#endif // BT_BULLET_VERSION >= 288
 
-    DynamicsWorld = std::make_unique<btDiscreteDynamicsWorld>(Dispatcher.get(),
-        OverlappingPairCache.get(), Solver.get(), CollisionConfiguration.get());
+        Solver = std::move(solverPool);
+    }
+#else
+    if(multithreaded) {
+        LOG_WARNING("PhysicalWorld: multithreaded physics requested but the engine is built "
+                    "without LEVIATHAN_MULTITHREADED_PHYSICS");
+    }
+#endif // LEVIATHAN_MULTITHREADED_PHYSICS
+
+    if(!DynamicsWorld) {
+
+        // Non-parallel dispatcher
+        Dispatcher = std::make_unique<btCollisionDispatcher>(CollisionConfiguration.get());
+
+        // Non-parallel solver
+        Solver = std::make_unique<btSequentialImpulseConstraintSolver>();
+
+        DynamicsWorld = std::make_unique<btDiscreteDynamicsWorld>(Dispatcher.get(),
+            OverlappingPairCache.get(), Solver.get(), CollisionConfiguration.get());
+    }
 
     // Register required callbacks
     DynamicsWorld->setInternalTickCallback(&PhysicalWorld::OnPhysicsSubStep);
@@ -126,10 +586,21 @@ DLLEXPORT PhysicalWorld::~PhysicalWorld()
 // ------------------------------------ //
 DLLEXPORT void PhysicalWorld::SimulateWorld(float secondspassed, int maxsubsteps /*= 4*/)
 {
+    LEVIATHAN_PROFILE_ZONE("PhysicalWorld::SimulateWorld");
+
     PhysicsUpdateInProgress = true;
 
+    if(PhysicsMaterials)
+        MaterialPairs = PhysicsMaterials->GetPairTable();
+
+    PendingContacts.clear();
+    MovedEntities.clear();
+
     DynamicsWorld->stepSimulation(secondspassed, maxsubsteps);
 
+    // Bodies may not be destroyed by the callbacks so this is still counted as the update
+    _DispatchContacts();
+
     PhysicsUpdateInProgress = false;
 }
 
@@ -181,6 +652,7 @@ void PhysicalWorld::OnManifoldWithContact(btPersistentManifold* contactManifold,
     const btManifoldPoint& contactPoint, const btCollisionObject* objA,
     const btCollisionObject* objB)
 {
+    // The callbacks are called after the step to not run game code in the middle of it
     // Actual points touching
     // const btVector3& contactPointA = contactPoint.getPositionWorldOnA();
     // const btVector3& contactPointB = contactPoint.getPositionWorldOnB();
@@ -202,14 +674,83 @@ void PhysicalWorld::OnManifoldWithContact(btPersistentManifold* contactManifold,
 
             if(pair && pair->ContactCallback) {
 
-                pair->ContactCallback(*this, *body1, *body2);
+                PendingContacts.push_back(PhysicsContact{body1, body2, pair});
             }
         }
     }
 }
 
-const PhysMaterialDataPair* PhysicalWorld::GetMaterialPair(int id1, int id2) const
+DLLEXPORT void PhysicalWorld::_OnBodyMoved(PhysicsBody& body)
+{
+    // The motion states are synchronized once at the end of a step so there are no
+    // duplicates
+    const auto entity = body.GetOwningEntity();
+
+    if(entity != NULL_OBJECT)
+        MovedEntities.push_back(entity);
+}
+
+void PhysicalWorld::_DispatchContacts()
+{
+    LEVIATHAN_PROFILE_ZONE("PhysicalWorld::_DispatchContacts");
+
+    for(const auto& contact : PendingContacts)
+        contact.Pair->ContactCallback(*this, *contact.Body1, *contact.Body2);
+
+    PendingContacts.clear();
+}
+
+DLLEXPORT bool PhysicalWorld::RunQueries(const std::vector<PhysicsQuery>& queries,
+    std::vector<PhysicsQueryHit>& hits, bool parallel /*= true*/) const
 {
+    LEVIATHAN_PROFILE_ZONE("PhysicalWorld::RunQueries");
+
+    if(PhysicsUpdateInProgress) {
+        LOG_ERROR("PhysicalWorld: RunQueries: called while physics update is in progress");
+        return false;
+    }
+
+    const btDbvtBroadphase& broadphase = *OverlappingPairCache;
+
+    ThreadingManager* threads = ThreadingManager::Get();
+    const size_t tasks = (queries.size() + QUERIES_PER_TASK - 1) / QUERIES_PER_TASK;
+
+    if(!parallel || !threads || tasks <= 1) {
+
+        std::vector<const btCollisionObject*> candidates;
+
+        for(size_t i = 0; i < queries.size(); ++i)
+            RunSingleQuery(broadphase, queries[i], static_cast<uint32_t>(i), candidates, hits);
+
+        return true;
+    }
+
+    // Each task has its own hits to keep them in query order without locking
+    std::vector<std::vector<PhysicsQueryHit>> taskHits(tasks);
+
+    threads->RunInParallel(tasks, [&](size_t task) {
+        std::vector<const btCollisionObject*> candidates;
+
+        const size_t end = std::min(queries.size(), (task + 1) * QUERIES_PER_TASK);
+
+        for(size_t i = task * QUERIES_PER_TASK; i < end; ++i) {
+            RunSingleQuery(broadphase, queries[i], static_cast<uint32_t>(i), candidates,
+                taskHits[task]);
+        }
+    });
+
+    for(const auto& taskResult : taskHits)
+        hits.insert(hits.end(), taskResult.begin(), taskResult.end());
+
+    return true;
+}
+
+DLLEXPORT const PhysMaterialDataPair* PhysicalWorld::GetMaterialPair(int id1, int id2) const
+{
+    // Table lookup for the common case of known materials with small ids
+    if(MaterialPairs && MaterialPairs->Covers(id1, id2))
+        return MaterialPairs->Get(id1, id2);
+
     const auto material1 = PhysicsMaterials->GetMaterial(id1);
 
     const PhysMaterialDataPair* pair = nullptr;
@@ -314,6 +855,8 @@ DLLEXPORT PhysicsBody::pointer PhysicalWorld::CreateBodyFromCollision(
     if(positionsynchronization)
         positionBridge = std::make_unique<PhysicsDataBridge>(positionsynchronization);
 
+    PhysicsDataBridge* bridge = positionBridge.get();
+
     btRigidBody::btRigidBodyConstructionInfo info(
         mass, positionBridge.get(), shape->GetShape(), localInertia);
 
@@ -325,6 +868,9 @@ DLLEXPORT PhysicsBody::pointer PhysicalWorld::CreateBodyFromCollision(
         return nullptr;
     }
 
+    if(bridge)
+        bridge->_SetMoveReporting(this, body.get());
+
     // Apply material
     if(physicsmaterialid != -1 && PhysicsMaterials) {
         auto material = PhysicsMaterials->GetMaterial(physicsmaterialid);
@@ -6,6 +6,7 @@
 #include "Common/ThreadSafe.h"
 #include "Common/Types.h"
 #include "PhysicsBody.h"
+#include "PhysicsQuery.h"
 #include "PhysicsShape.h"
 
 #include "OgreMatrix4.h"
@@ -17,8 +18,8 @@ class btCollisionShape;
 class btRigidBody;
 class btDefaultCollisionConfiguration;
 class btCollisionDispatcher;
-class btBroadphaseInterface;
-class btSequentialImpulseConstraintSolver;
+class btDbvtBroadphase;
+class btConstraintSolver;
 class btDiscreteDynamicsWorld;
 class btDynamicsWorld;
 class btPersistentManifold;
@@ -36,6 +37,7 @@ namespace Leviathan {
 
 class LeviathanPhysicsOverlapFilter;
 struct PhysMaterialDataPair;
+struct PhysicsMaterialPairTable;
 
 constexpr auto PHYSICS_BASE_GRAVITY = -9.81f;
 
@@ -53,16 +55,48 @@ constexpr auto PHYSICS_BASE_GRAVITY = -9.81f;
 // int SingleBodyUpdate(
 //     const NewtonWorld* const newtonWorld, const void* islandHandle, int bodyCount);
 
+//! \brief Contact between bodies found during a physics sub step
+struct PhysicsContact {
+
+    PhysicsBody* Body1;
+    PhysicsBody* Body2;
+    const PhysMaterialDataPair* Pair;
+};
+
 class PhysicalWorld {
     // friend int SingleBodyUpdate(
     //     const NewtonWorld* const newtonWorld, const void* islandHandle, int bodyCount);
 public:
-    DLLEXPORT PhysicalWorld(GameWorld* owner, PhysicsMaterialManager* physicscallbacks);
+    //! \param multithreaded If true the Bullet world and solvers running on the
+    //! ThreadingManager worker threads are used. Requires the engine to be built with
+    //! LEVIATHAN_MULTITHREADED_PHYSICS, otherwise this is ignored
+    DLLEXPORT PhysicalWorld(GameWorld* owner, PhysicsMaterialManager* physicscallbacks,
+        bool multithreaded = false);
     DLLEXPORT ~PhysicalWorld();
 
     //! \brief Advances the simulation the specified amount of time
+    //!
+    //! The material contact callbacks are called once the whole step is done
     DLLEXPORT void SimulateWorld(float secondspassed, int maxsubsteps = 4);
 
+    //! \returns True if this is using the multithreaded Bullet world
+    inline bool IsMultithreaded() const
+    {
+        return Multithreaded;
+    }
+
+    //! \returns The entities whose bodies moved during the last SimulateWorld
+    //!
+    //! Sleeping bodies and bodies that stayed in place are not included so systems that
+    //! only care about changed positions can iterate this instead of all the positions
+    inline const std::vector<ObjectID>& GetMovedEntities() const
+    {
+        return MovedEntities;
+    }
+
+    //! \brief Called by PhysicsDataBridge when the transform of body has changed
+    DLLEXPORT void _OnBodyMoved(PhysicsBody& body);
+
     // ------------------------------------ //
     // Physics collision creation
     // NOTE: all created collisions HAVE to be destroyed after all bodies using them are
@@ -102,7 +136,18 @@ public:
 
 
     //! \brief Finds the information for contact between objects with two materials
-    const PhysMaterialDataPair* GetMaterialPair(int id1, int id2) const;
+    //! \returns The pair formed by either material or null for the default behaviour
+    DLLEXPORT const PhysMaterialDataPair* GetMaterialPair(int id1, int id2) const;
+
+    //! \brief Runs a batch of ray, sweep and overlap queries against the bodies
+    //!
+    //! The queries only read the world so they are split between the worker threads when
+    //! parallel is true and there are enough of them. Hits are appended to hits ordered by
+    //! the query index and then by distance
+    //! \returns False if called while the world is being simulated
+    //! \note Bodies may not be added, removed or moved while this runs
+    DLLEXPORT bool RunQueries(const std::vector<PhysicsQuery>& queries,
+        std::vector<PhysicsQueryHit>& hits, bool parallel = true) const;
 
     DLLEXPORT inline GameWorld* GetGameWorld()
     {
@@ -135,12 +180,15 @@ public:
 protected:
     static void OnPhysicsSubStep(btDynamicsWorld* world, btScalar timeStep);
 
-    //! \brief Calls appropriate material callbacks. This is called once per contact manifold
-    //! that has penetrating points
+    //! \brief Queues the material contact callback. This is called once per contact
+    //! manifold that has penetrating points
     void OnManifoldWithContact(btPersistentManifold* contactManifold,
         const btManifoldPoint& contactPoint, const btCollisionObject* objA,
         const btCollisionObject* objB);
 
+    //! \brief Calls the contact callbacks queued during the last step
+    void _DispatchContacts();
+
 protected:
     //! Total amount of seconds required to be simulated
     float PassedTimeTotal = 0;
@@ -148,6 +196,17 @@ protected:
     GameWorld* OwningWorld;
     PhysicsMaterialManager* PhysicsMaterials;
 
+    //! Fetched from PhysicsMaterials at the start of each step
+    std::shared_ptr<const PhysicsMaterialPairTable> MaterialPairs;
+
+    //! Contacts found during the current step. Kept to not allocate each step
+    std::vector<PhysicsContact> PendingContacts;
+
+    //! Filled by _OnBodyMoved during a step
+    std::vector<ObjectID> MovedEntities;
+
+    bool Multithreaded = false;
+
     //! This is a small sanity check for preventing destroying physics bodies during a tick
     bool PhysicsUpdateInProgress = false;
 
@@ -156,9 +215,9 @@ protected:
 
     std::unique_ptr<btCollisionDispatcher> Dispatcher;
 
-    std::unique_ptr<btBroadphaseInterface> OverlappingPairCache;
+    std::unique_ptr<btDbvtBroadphase> OverlappingPairCache;
 
-    std::unique_ptr<btSequentialImpulseConstraintSolver> Solver;
+    std::unique_ptr<btConstraintSolver> Solver;
 
     std::unique_ptr<btDiscreteDynamicsWorld> DynamicsWorld;
 
@@ -3,6 +3,7 @@
 
 #include "Common/Types.h"
 #include "Exceptions.h"
+#include "PhysicalWorld.h"
 #include "Utility/Convert.h"
 
 #include "BulletCollision/CollisionShapes/btCollisionShape.h"
@@ -97,6 +98,19 @@ DLLEXPORT Float3 PhysicsBody::GetPosition() const
 
     return Body->getCenterOfMassTransform().getOrigin();
 }
+
+DLLEXPORT void PhysicsBody::GetAABB(Float3& min, Float3& max) const
+{
+    if(!Body)
+        throw InvalidArgument("PhysicsBody has no longer an internal physics engine body");
+
+    btVector3 bodyMin;
+    btVector3 bodyMax;
+    Body->getAabb(bodyMin, bodyMax);
+
+    min = bodyMin;
+    max = bodyMax;
+}
 // ------------------------------------ //
 DLLEXPORT bool PhysicsBody::SetOnlyOrientation(const Float4& orientation)
 {
@@ -323,11 +337,25 @@ DLLEXPORT void PhysicsPositionProvider::getWorldTransform(btTransform& worldTran
 }
 
 DLLEXPORT void PhysicsPositionProvider::setWorldTransform(const btTransform& worldTrans)
+{
+    _ApplyTransformIfChanged(worldTrans);
+}
+
+DLLEXPORT bool PhysicsPositionProvider::_ApplyTransformIfChanged(const btTransform& worldTrans)
 {
     const Float3 position = worldTrans.getOrigin();
     const Float4 orientation = worldTrans.getRotation();
 
+    const Float3* currentPosition;
+    const Float4* currentOrientation;
+    GetPositionDataForPhysics(currentPosition, currentOrientation);
+
+    // The conversions are the same each time so an unchanged transform is exactly equal
+    if(position == *currentPosition && orientation == *currentOrientation)
+        return false;
+
     SetPositionDataFromPhysics(position, orientation);
+    return true;
 }
 // ------------------------------------ //
 // PhysicsDataBridge
@@ -348,6 +376,12 @@ DLLEXPORT PhysicsDataBridge::~PhysicsDataBridge()
     }
 }
 // ------------------------------------ //
+DLLEXPORT void PhysicsDataBridge::_SetMoveReporting(PhysicalWorld* world, PhysicsBody* body)
+{
+    World = world;
+    Body = body;
+}
+
 DLLEXPORT void PhysicsDataBridge::_OnDetachBridge(PhysicsPositionProvider* provider)
 {
     if(AttachedProvider == provider) {
@@ -367,6 +401,8 @@ DLLEXPORT void PhysicsDataBridge::getWorldTransform(btTransform& worldTrans) con
 
 DLLEXPORT void PhysicsDataBridge::setWorldTransform(const btTransform& worldTrans)
 {
-    if(AttachedProvider)
-        AttachedProvider->setWorldTransform(worldTrans);
+    // Bullet only calls this for bodies that aren't sleeping
+    if(AttachedProvider && AttachedProvider->_ApplyTransformIfChanged(worldTrans) && World &&
+        Body)
+        World->_OnBodyMoved(*Body);
 }
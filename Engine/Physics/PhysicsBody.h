@@ -16,6 +16,8 @@ class btRigidBody;
 namespace Leviathan {
 
 class PhysicalMaterial;
+class PhysicalWorld;
+class PhysicsBody;
 class PhysicsDataBridge;
 
 //! \brief This acts as a bridge between Leviathan positions and physics engine positions
@@ -37,6 +39,12 @@ public:
     DLLEXPORT void getWorldTransform(btTransform& worldTrans) const override final;
     DLLEXPORT void setWorldTransform(const btTransform& worldTrans) override final;
 
+    //! \brief Applies the transform unless the position and orientation are the same
+    //!
+    //! Bullet gives the same transform each step to active bodies that don't move
+    //! \returns True if the data changed
+    DLLEXPORT bool _ApplyTransformIfChanged(const btTransform& worldTrans);
+
 protected:
     DLLEXPORT void _OnAttachBridge(PhysicsDataBridge* bridge);
 
@@ -58,6 +66,10 @@ public:
         return AttachedProvider;
     }
 
+    //! \brief Makes this tell world when the transform of body has changed
+    //! \note Only PhysicalWorld should call this
+    DLLEXPORT void _SetMoveReporting(PhysicalWorld* world, PhysicsBody* body);
+
     // These are proxies to the AttachedProvider (otherwise these don't touch the transforms)
     DLLEXPORT void getWorldTransform(btTransform& worldTrans) const override final;
     DLLEXPORT void setWorldTransform(const btTransform& worldTrans) override final;
@@ -66,7 +78,10 @@ protected:
     DLLEXPORT void _OnDetachBridge(PhysicsPositionProvider* provider);
 
 private:
-    PhysicsPositionProvider* AttachedProvider;
+    PhysicsPositionProvider* AttachedProvider = nullptr;
+
+    PhysicalWorld* World = nullptr;
+    PhysicsBody* Body = nullptr;
 };
 
 
@@ -134,6 +149,9 @@ public:
     //! \returns The current physical body position
     DLLEXPORT Float3 GetPosition() const;
 
+    //! \brief Gets the world space axis aligned bounding box of the body
+    DLLEXPORT void GetAABB(Float3& min, Float3& max) const;
+
     //! \brief Same as SetPosition but only sets orientation
     DLLEXPORT bool SetOnlyOrientation(const Float4& orientation);
 
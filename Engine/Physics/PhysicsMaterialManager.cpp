@@ -1,8 +1,17 @@
 // ------------------------------------ //
 #include "PhysicsMaterialManager.h"
 
+#include <algorithm>
+
 using namespace Leviathan;
 // ------------------------------------ //
+DLLEXPORT PhysicsMaterialManager::~PhysicsMaterialManager()
+{
+    // The materials may outlive this if someone has taken them
+    for(const auto& material : LoadedMaterials)
+        material.second->Owner = nullptr;
+}
+// ------------------------------------ //
 DLLEXPORT void PhysicsMaterialManager::LoadedMaterialAdd(
     std::unique_ptr<PhysicalMaterial>&& material)
 {
@@ -13,6 +22,9 @@ DLLEXPORT void PhysicsMaterialManager::LoadedMaterialAdd(
     PhysicalMaterial* ptr = material.get();
     LoadedMaterials[material->GetName()] = std::move(material);
     LoadedMaterialsByID[ptr->GetID()] = ptr;
+
+    ptr->Owner = this;
+    _OnPairsChanged();
 }
 
 DLLEXPORT int PhysicsMaterialManager::GetMaterialID(const std::string& name)
@@ -55,3 +67,58 @@ DLLEXPORT PhysicalMaterial* PhysicsMaterialManager::GetMaterial(int id)
     // Not found //
     return nullptr;
 }
+// ------------------------------------ //
+DLLEXPORT std::shared_ptr<const PhysicsMaterialPairTable> PhysicsMaterialManager::GetPairTable()
+{
+    Lock lock(PairTableMutex);
+
+    if(PairTable)
+        return PairTable;
+
+    auto table = std::make_shared<PhysicsMaterialPairTable>();
+
+    // The ids are usually small and dense
+    for(const auto& material : LoadedMaterialsByID) {
+        if(material.first >= 0 && material.first < MAX_PAIR_TABLE_ID)
+            table->Size = std::max(table->Size, material.first + 1);
+    }
+
+    table->Exists.resize(table->Size, false);
+    table->Pairs.resize(table->Size * table->Size, nullptr);
+
+    for(const auto& material : LoadedMaterialsByID) {
+        if(material.first >= 0 && material.first < table->Size)
+            table->Exists[material.first] = true;
+    }
+
+    for(int id1 = 0; id1 < table->Size; ++id1) {
+
+        if(!table->Exists[id1])
+            continue;
+
+        const PhysicalMaterial* material1 = LoadedMaterialsByID[id1];
+
+        for(int id2 = 0; id2 < table->Size; ++id2) {
+
+            if(!table->Exists[id2])
+                continue;
+
+            // Same order as the lookup in PhysicalWorld::GetMaterialPair
+            const PhysMaterialDataPair* pair = material1->GetPairWith(id2);
+
+            if(!pair)
+                pair = LoadedMaterialsByID[id2]->GetPairWith(id1);
+
+            table->Pairs[id1 * table->Size + id2] = pair;
+        }
+    }
+
+    PairTable = table;
+    return PairTable;
+}
+
+void PhysicsMaterialManager::_OnPairsChanged()
+{
+    Lock lock(PairTableMutex);
+    PairTable.reset();
+}
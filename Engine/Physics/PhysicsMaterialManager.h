@@ -3,15 +3,47 @@
 #pragma once
 #include "Define.h"
 // ------------------------------------ //
+#include "Common/ThreadSafe.h"
 #include "PhysicalMaterial.h"
 
 namespace Leviathan {
 
+//! \brief Flat table of the pairs between all materials for fast lookups during physics
+//! updates
+//!
+//! Indexed by (id1, id2) and filled for both orders so the lookup is a single load. Only
+//! materials with ids below PhysicsMaterialManager::MAX_PAIR_TABLE_ID are included
+struct PhysicsMaterialPairTable {
+
+    //! \returns True if both materials exist and are in this table
+    inline bool Covers(int id1, int id2) const
+    {
+        return id1 >= 0 && id2 >= 0 && id1 < Size && id2 < Size && Exists[id1] && Exists[id2];
+    }
+
+    //! \pre Covers(id1, id2) is true
+    inline const PhysMaterialDataPair* Get(int id1, int id2) const
+    {
+        return Pairs[id1 * Size + id2];
+    }
+
+    int Size = 0;
+    std::vector<bool> Exists;
+    std::vector<const PhysMaterialDataPair*> Pairs;
+};
+
 //! \brief Contains a material list for applying automatic properties to PhysicsBody and
 //! collision callbacks
 //! \todo file loading function
 class PhysicsMaterialManager {
+    friend PhysicalMaterial;
+
 public:
+    //! Materials with ids at or above this are looked up without the pair table
+    static constexpr int MAX_PAIR_TABLE_ID = 256;
+
+    DLLEXPORT ~PhysicsMaterialManager();
+
     //! \brief Adds a physics material. This now takes effect instantly and all worlds using
     //! this material manager will see the change on next physics update.
     //! This will set the material ID.
@@ -28,12 +60,27 @@ public:
     //! \brief Accesses material by ID
     DLLEXPORT PhysicalMaterial* GetMaterial(int id);
 
+    //! \brief Returns the pair table of the current materials, rebuilding it if the
+    //! materials or their pairs have changed
+    //! \note This is thread safe. The pointers in the table stay valid as long as this
+    //! manager exists
+    DLLEXPORT std::shared_ptr<const PhysicsMaterialPairTable> GetPairTable();
+
+protected:
+    //! \brief Called by materials when FormPairWith is used
+    void _OnPairsChanged();
+
 
 private:
     //! Map for fast finding
     std::map<std::string, std::unique_ptr<PhysicalMaterial>> LoadedMaterials;
     //! Also for finding by id
     std::map<int, PhysicalMaterial*> LoadedMaterialsByID;
+
+    Mutex PairTableMutex;
+
+    //! Cleared when materials change and built again by GetPairTable
+    std::shared_ptr<const PhysicsMaterialPairTable> PairTable;
 };
 
 } // namespace Leviathan
@@ -0,0 +1,60 @@
+// ------------------------------------ //
+#include "PhysicsQuery.h"
+
+using namespace Leviathan;
+// ------------------------------------ //
+DLLEXPORT PhysicsQuery PhysicsQuery::Ray(const Float3& from, const Float3& to)
+{
+    PhysicsQuery query;
+    query.Type = PHYSICS_QUERY_TYPE::Ray;
+    query.From = from;
+    query.To = to;
+    return query;
+}
+
+DLLEXPORT PhysicsQuery PhysicsQuery::SphereSweep(
+    const Float3& from, const Float3& to, float radius)
+{
+    PhysicsQuery query;
+    query.Type = PHYSICS_QUERY_TYPE::SphereSweep;
+    query.From = from;
+    query.To = to;
+    query.Extents = Float3(radius);
+    return query;
+}
+
+DLLEXPORT PhysicsQuery PhysicsQuery::BoxSweep(const Float3& from, const Float3& to,
+    const Float3& halfextents, const Float4& orientation /*= Float4::IdentityQuaternion()*/)
+{
+    PhysicsQuery query;
+    query.Type = PHYSICS_QUERY_TYPE::BoxSweep;
+    query.From = from;
+    query.To = to;
+    query.Extents = halfextents;
+    query.Orientation = orientation;
+    return query;
+}
+
+DLLEXPORT PhysicsQuery PhysicsQuery::SphereOverlap(const Float3& position, float radius)
+{
+    PhysicsQuery query;
+    query.Type = PHYSICS_QUERY_TYPE::SphereOverlap;
+    query.From = position;
+    query.To = position;
+    query.Extents = Float3(radius);
+    query.MaxHits = 0;
+    return query;
+}
+
+DLLEXPORT PhysicsQuery PhysicsQuery::BoxOverlap(const Float3& position,
+    const Float3& halfextents, const Float4& orientation /*= Float4::IdentityQuaternion()*/)
+{
+    PhysicsQuery query;
+    query.Type = PHYSICS_QUERY_TYPE::BoxOverlap;
+    query.From = position;
+    query.To = position;
+    query.Extents = halfextents;
+    query.Orientation = orientation;
+    query.MaxHits = 0;
+    return query;
+}
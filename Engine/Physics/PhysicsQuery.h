@@ -0,0 +1,88 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2018 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Common/Types.h"
+
+namespace Leviathan {
+
+enum class PHYSICS_QUERY_TYPE : int32_t {
+
+    //! Finds bodies on the line from From to To
+    Ray,
+
+    //! Moves a sphere with radius Extents.X from From to To
+    SphereSweep,
+
+    //! Moves a box with half extents Extents and Orientation from From to To
+    BoxSweep,
+
+    //! Finds bodies touching a sphere with radius Extents.X at From
+    SphereOverlap,
+
+    //! Finds bodies touching a box with half extents Extents and Orientation at From
+    BoxOverlap
+};
+
+//! \brief A single query for PhysicalWorld::RunQueries
+//!
+//! Use the static functions to create these. Overlaps are tested exactly against convex,
+//! compound and concave (mesh, plane and height field) shapes. Any other kind of shape is
+//! only tested with its bounding box, which reports a hit at its origin with a zero normal
+struct PhysicsQuery {
+
+    DLLEXPORT static PhysicsQuery Ray(const Float3& from, const Float3& to);
+
+    DLLEXPORT static PhysicsQuery SphereSweep(
+        const Float3& from, const Float3& to, float radius);
+
+    DLLEXPORT static PhysicsQuery BoxSweep(const Float3& from, const Float3& to,
+        const Float3& halfextents, const Float4& orientation = Float4::IdentityQuaternion());
+
+    DLLEXPORT static PhysicsQuery SphereOverlap(const Float3& position, float radius);
+
+    DLLEXPORT static PhysicsQuery BoxOverlap(const Float3& position, const Float3& halfextents,
+        const Float4& orientation = Float4::IdentityQuaternion());
+
+    PHYSICS_QUERY_TYPE Type = PHYSICS_QUERY_TYPE::Ray;
+
+    Float3 From = Float3(0);
+
+    //! End point of rays and sweeps, not used by overlaps
+    Float3 To = Float3(0);
+
+    //! Radius is the X component for spheres, boxes use all as half extents
+    Float3 Extents = Float3(0);
+
+    Float4 Orientation = Float4::IdentityQuaternion();
+
+    //! How many of the closest hits are returned, 0 returns all hits. The overlap queries
+    //! default to 0
+    int32_t MaxHits = 1;
+
+    //! Hits on bodies of this entity are skipped. Use this to not hit the casting entity
+    ObjectID Ignored = NULL_OBJECT;
+};
+
+//! \brief Result of a PhysicsQuery
+struct PhysicsQueryHit {
+
+    //! Index of the query that this hit is for
+    uint32_t Query;
+
+    //! The entity owning the hit body. NULL_OBJECT if the body isn't owned by any
+    ObjectID Entity;
+
+    //! World space hit location. For overlaps this is the deepest point on the hit body
+    Float3 Point;
+
+    Float3 Normal;
+
+    //! How far along the ray or sweep the hit is, between 0 and 1. Always 0 for overlaps
+    float Fraction;
+
+    static constexpr auto ANGELSCRIPT_TYPE = "PhysicsQueryHit";
+};
+
+} // namespace Leviathan
@@ -504,6 +504,24 @@ bool BindScriptComponentTypeSupport(asIScriptEngine* engine)
         ANGELSCRIPT_REGISTERFAIL;
     }
 
+    // These allow going through the components without building an array
+    if(engine->RegisterObjectMethod("ScriptComponentHolder", "uint GetCount() const",
+           asMETHOD(ScriptComponentHolder, GetCount), asCALL_THISCALL) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectMethod("ScriptComponentHolder",
+           "ObjectID GetEntityAt(uint index) const",
+           asMETHOD(ScriptComponentHolder, GetEntityAt), asCALL_THISCALL) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectMethod("ScriptComponentHolder",
+           "ScriptComponent@ GetAt(uint index) const", asMETHOD(ScriptComponentHolder, GetAt),
+           asCALL_THISCALL) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
     // ------------------------------------ //
     // Helpers for creating and destroying nodes
     // The second argument should be of type array<ThisSystemsCachedType>
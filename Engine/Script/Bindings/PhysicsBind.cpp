@@ -4,6 +4,8 @@
 #include "Physics/PhysicalWorld.h"
 #include "Physics/PhysicsBody.h"
 #include "Physics/PhysicsShape.h"
+#include "Script/ScriptConversionHelpers.h"
+#include "Script/ScriptExecutor.h"
 
 #include "Define.h"
 #include "Logger.h"
@@ -13,6 +15,39 @@ using namespace Leviathan;
 
 // Proxies etc.
 // ------------------------------------ //
+void PhysicsQueryConstructorProxy(void* memory)
+{
+    new(memory) PhysicsQuery();
+}
+
+void PhysicsQueryHitConstructorProxy(void* memory)
+{
+    new(memory) PhysicsQueryHit();
+}
+
+CScriptArray* PhysicalWorldRunQueriesProxy(PhysicalWorld* self, CScriptArray* queries)
+{
+    std::vector<PhysicsQuery> converted;
+
+    if(queries) {
+
+        converted.reserve(queries->GetSize());
+
+        for(asUINT i = 0; i < queries->GetSize(); ++i)
+            converted.push_back(*static_cast<const PhysicsQuery*>(queries->At(i)));
+
+        queries->Release();
+    }
+
+    std::vector<PhysicsQueryHit> hits;
+    self->RunQueries(converted, hits);
+
+    asIScriptContext* ctx = asGetActiveContext();
+
+    asIScriptEngine* engine = ctx ? ctx->GetEngine() : ScriptExecutor::Get()->GetASEngine();
+
+    return ConvertVectorToASArray(hits, engine, "array<PhysicsQueryHit>");
+}
 
 // ------------------------------------ //
 // Start of the actual bind
@@ -142,6 +177,143 @@ bool BindBody(asIScriptEngine* engine)
 
     return true;
 }
+
+bool BindQueries(asIScriptEngine* engine)
+{
+    if(engine->RegisterEnum("PHYSICS_QUERY_TYPE") < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    ANGELSCRIPT_REGISTER_ENUM_VALUE(PHYSICS_QUERY_TYPE, Ray);
+    ANGELSCRIPT_REGISTER_ENUM_VALUE(PHYSICS_QUERY_TYPE, SphereSweep);
+    ANGELSCRIPT_REGISTER_ENUM_VALUE(PHYSICS_QUERY_TYPE, BoxSweep);
+    ANGELSCRIPT_REGISTER_ENUM_VALUE(PHYSICS_QUERY_TYPE, SphereOverlap);
+    ANGELSCRIPT_REGISTER_ENUM_VALUE(PHYSICS_QUERY_TYPE, BoxOverlap);
+
+    if(engine->RegisterObjectType("PhysicsQuery", sizeof(PhysicsQuery),
+           asOBJ_VALUE | asOBJ_POD | asGetTypeTraits<PhysicsQuery>()) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectBehaviour("PhysicsQuery", asBEHAVE_CONSTRUCT, "void f()",
+           asFUNCTION(PhysicsQueryConstructorProxy), asCALL_CDECL_OBJFIRST) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectProperty("PhysicsQuery", "PHYSICS_QUERY_TYPE Type",
+           asOFFSET(PhysicsQuery, Type)) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectProperty(
+           "PhysicsQuery", "Float3 From", asOFFSET(PhysicsQuery, From)) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectProperty("PhysicsQuery", "Float3 To", asOFFSET(PhysicsQuery, To)) <
+        0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectProperty(
+           "PhysicsQuery", "Float3 Extents", asOFFSET(PhysicsQuery, Extents)) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectProperty(
+           "PhysicsQuery", "Float4 Orientation", asOFFSET(PhysicsQuery, Orientation)) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectProperty(
+           "PhysicsQuery", "int MaxHits", asOFFSET(PhysicsQuery, MaxHits)) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectProperty(
+           "PhysicsQuery", "ObjectID Ignored", asOFFSET(PhysicsQuery, Ignored)) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectType("PhysicsQueryHit", sizeof(PhysicsQueryHit),
+           asOBJ_VALUE | asOBJ_POD | asGetTypeTraits<PhysicsQueryHit>()) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectBehaviour("PhysicsQueryHit", asBEHAVE_CONSTRUCT, "void f()",
+           asFUNCTION(PhysicsQueryHitConstructorProxy), asCALL_CDECL_OBJFIRST) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectProperty(
+           "PhysicsQueryHit", "uint Query", asOFFSET(PhysicsQueryHit, Query)) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectProperty(
+           "PhysicsQueryHit", "ObjectID Entity", asOFFSET(PhysicsQueryHit, Entity)) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectProperty(
+           "PhysicsQueryHit", "Float3 Point", asOFFSET(PhysicsQueryHit, Point)) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectProperty(
+           "PhysicsQueryHit", "Float3 Normal", asOFFSET(PhysicsQueryHit, Normal)) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterObjectProperty(
+           "PhysicsQueryHit", "float Fraction", asOFFSET(PhysicsQueryHit, Fraction)) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    // Factories are in a namespace to call them like PhysicsQuery::Ray(from, to)
+    if(engine->SetDefaultNamespace("PhysicsQuery") < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterGlobalFunction(
+           "PhysicsQuery Ray(const Float3 &in from, const Float3 &in to)",
+           asFUNCTION(PhysicsQuery::Ray), asCALL_CDECL) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterGlobalFunction("PhysicsQuery SphereSweep(const Float3 &in from, "
+                                      "const Float3 &in to, float radius)",
+           asFUNCTION(PhysicsQuery::SphereSweep), asCALL_CDECL) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterGlobalFunction(
+           "PhysicsQuery BoxSweep(const Float3 &in from, const Float3 &in to, "
+           "const Float3 &in halfextents, const Float4 &in orientation = "
+           "Float4::IdentityQuaternion)",
+           asFUNCTION(PhysicsQuery::BoxSweep), asCALL_CDECL) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterGlobalFunction(
+           "PhysicsQuery SphereOverlap(const Float3 &in position, float radius)",
+           asFUNCTION(PhysicsQuery::SphereOverlap), asCALL_CDECL) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->RegisterGlobalFunction(
+           "PhysicsQuery BoxOverlap(const Float3 &in position, const Float3 &in halfextents, "
+           "const Float4 &in orientation = Float4::IdentityQuaternion)",
+           asFUNCTION(PhysicsQuery::BoxOverlap), asCALL_CDECL) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    if(engine->SetDefaultNamespace("") < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
+    return true;
+}
 } // namespace Leviathan
 // ------------------------------------ //
 bool Leviathan::BindPhysics(asIScriptEngine* engine)
@@ -152,6 +324,9 @@ bool Leviathan::BindPhysics(asIScriptEngine* engine)
     if(!BindBody(engine))
         return false;
 
+    if(!BindQueries(engine))
+        return false;
+
     // These classes are Leviathan classes so these should not be in the newton namespace
     if(engine->RegisterObjectType("PhysicalWorld", 0, asOBJ_REF | asOBJ_NOCOUNT) < 0) {
         ANGELSCRIPT_REGISTERFAIL;
@@ -168,6 +343,12 @@ bool Leviathan::BindPhysics(asIScriptEngine* engine)
         ANGELSCRIPT_REGISTERFAIL;
     }
 
+    if(engine->RegisterObjectMethod("PhysicalWorld",
+           "array<PhysicsQueryHit>@ RunQueries(array<PhysicsQuery>@ queries)",
+           asFUNCTION(PhysicalWorldRunQueriesProxy), asCALL_CDECL_OBJFIRST) < 0) {
+        ANGELSCRIPT_REGISTERFAIL;
+    }
+
     // ------------------------------------ //
 
 
@@ -2,9 +2,13 @@
 #include "Script/Console.h"
 
 #include "Application/Application.h"
+#include "Engine.h"
 #include "Iterators/StringIterator.h"
 #include "ScriptModule.h"
+#include "Statistics/Profiler.h"
 #include "add_on/scripthelper/scripthelper.h"
+
+#include <sstream>
 using namespace Leviathan;
 // ------------------------------------ //
 DLLEXPORT Leviathan::ScriptConsole::ScriptConsole() :
@@ -71,7 +75,9 @@ DLLEXPORT int Leviathan::ScriptConsole::RunConsoleCommand(std::string cmd)
                       "\t> For example:\n"
                       "\t >ADDFUNC void MyFunc(int i){ Print(\"Val is: \"+i); }\n"
                       "\t(int i = 0; i < 10; i++){ MyFunc(i); }\n"
-                      "\t> Would output \"Val is: 0 Val is: 1 ...\"");
+                      "\t> Would output \"Val is: 0 Val is: 1 ...\"\n"
+                      "\t> \"profile [ticks] [file]\" records ticks into a Chrome trace file\n"
+                      "\t> \"stats\" prints tick, network and frame time percentiles");
         return CONSOLECOMMANDRESULTSTATE_SUCCEEDED;
 
     } else if(cmd == "commands") {
@@ -102,6 +108,30 @@ DLLEXPORT int Leviathan::ScriptConsole::RunConsoleCommand(std::string cmd)
         ConsoleOutput("Marking the program as closing");
         Leviathan::LeviathanApplication::Get()->MarkAsClosing();
         return CONSOLECOMMANDRESULTSTATE_SUCCEEDED;
+
+    } else if(cmd == "profile" ||
+              StringOperations::StringStartsWith(cmd, std::string("profile "))) {
+
+        std::istringstream arguments(cmd.substr(std::string("profile").size()));
+
+        int ticks = 0;
+        std::string file;
+        arguments >> ticks >> file;
+
+        if(ticks <= 0)
+            ticks = 100;
+
+        if(file.empty())
+            file = "ProfilerCapture.json";
+
+        Profiler::CaptureTicks(ticks, file);
+        ConsoleOutput("Profiling the next " + std::to_string(ticks) + " ticks to: " + file);
+        return CONSOLECOMMANDRESULTSTATE_SUCCEEDED;
+
+    } else if(cmd == "stats") {
+
+        ConsoleOutput(Engine::Get()->GetTimingReport());
+        return CONSOLECOMMANDRESULTSTATE_SUCCEEDED;
     }
 
     // first check if ">" is first character, we can easily reject command if it is missing //
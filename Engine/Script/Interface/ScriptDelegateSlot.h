@@ -3,6 +3,7 @@
 #pragma once
 // ------------------------------------ //
 #include "Events/DelegateSlot.h"
+#include "Script/PreparedScriptCall.h"
 #include "Script/ScriptExecutor.h"
 #include "Script/ScriptRunningSetup.h"
 
@@ -15,6 +16,9 @@ class ScriptDelegateSlot final : public BaseDelegateSlot{
 public:
     ScriptDelegateSlot(asIScriptFunction* callback) : Callback(callback){
 
+        // GUI and other delegates can fire often so the callback is kept prepared. Callbacks
+        // taking other types than NamedVars go through RunScript
+        PreparedCallback.SetFunction(Callback, false);
     }
 
     ~ScriptDelegateSlot(){
@@ -24,6 +28,13 @@ public:
     
     void OnCalled(const NamedVars::pointer &values) override{
 
+        if(PreparedCallback.IsValid()){
+
+            if(PreparedCallback.Call(values.get()).Result != SCRIPT_RUN_RESULT::Success)
+                LOG_WARNING("ScriptDelegateSlot: failed to call callback");
+            return;
+        }
+
         ScriptRunningSetup ssetup;
 
         auto result = ScriptExecutor::Get()->RunScript<void>(Callback, nullptr, ssetup,
@@ -36,6 +47,8 @@ public:
 private:
 
     asIScriptFunction* Callback;
+
+    PreparedScriptCall<void, NamedVars*> PreparedCallback;
 };
 
 
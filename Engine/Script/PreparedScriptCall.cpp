@@ -0,0 +1,191 @@
+// ------------------------------------ //
+#include "PreparedScriptCall.h"
+
+#include "ScriptExecutor.h"
+
+using namespace Leviathan;
+// ------------------------------------ //
+DLLEXPORT PreparedScriptCallBase::~PreparedScriptCallBase()
+{
+    Reset();
+}
+
+DLLEXPORT void PreparedScriptCallBase::Reset()
+{
+    if(Context) {
+        Executor->_DoneWithContext(Context);
+        Context = nullptr;
+    }
+
+    Executor = nullptr;
+
+    if(Func) {
+        Func->Release();
+        Func = nullptr;
+    }
+
+    ParameterCount = 0;
+}
+// ------------------------------------ //
+DLLEXPORT bool PreparedScriptCallBase::_SetFunction(asIScriptFunction* func,
+    const int* argtypes, asUINT argcount, int returntype, bool printerrors)
+{
+    Reset();
+
+    const asUINT parameterCount = func->GetParamCount();
+
+    if(parameterCount > argcount) {
+
+        if(printerrors)
+            LOG_ERROR("PreparedScriptCall: function takes more parameters (" +
+                      std::to_string(parameterCount) + ") than are passed (" +
+                      std::to_string(argcount) + "), func: " + func->GetDeclaration());
+        return false;
+    }
+
+    for(asUINT i = 0; i < parameterCount; ++i) {
+
+        int wantedTypeID;
+        asDWORD flags;
+
+        if(func->GetParam(i, &wantedTypeID, &flags) < 0) {
+
+            LOG_ERROR("PreparedScriptCall: failed to get param type from as: " +
+                      std::to_string(i) + ", for func: " + func->GetDeclaration());
+            return false;
+        }
+
+        if(wantedTypeID != argtypes[i]) {
+
+            if(printerrors)
+                LOG_ERROR("PreparedScriptCall: parameter " + std::to_string(i) + " type " +
+                          std::to_string(wantedTypeID) +
+                          " doesn't match passed type: " + std::to_string(argtypes[i]) +
+                          ", for func: " + func->GetDeclaration());
+            return false;
+        }
+
+        if(flags & asTM_OUTREF) {
+
+            if(printerrors)
+                LOG_ERROR("PreparedScriptCall: parameter " + std::to_string(i) +
+                          " is an outref which isn't supported, for func: " +
+                          func->GetDeclaration());
+            return false;
+        }
+    }
+
+    if(returntype != -1 && func->GetReturnTypeId() != returntype) {
+
+        if(printerrors)
+            LOG_ERROR("PreparedScriptCall: return type " +
+                      std::to_string(func->GetReturnTypeId()) +
+                      " doesn't match wanted type: " + std::to_string(returntype) +
+                      ", for func: " + func->GetDeclaration());
+        return false;
+    }
+
+    ScriptExecutor* executor = _GetExecutor(func);
+
+    Context = executor->_GetContextForExecution();
+
+    if(!Context) {
+
+        LOG_ERROR("PreparedScriptCall: failed to get a context");
+        return false;
+    }
+
+    Executor = executor;
+    func->AddRef();
+    Func = func;
+    ParameterCount = parameterCount;
+    return true;
+}
+// ------------------------------------ //
+DLLEXPORT asIScriptContext* PreparedScriptCallBase::_BeginCall(void* obj)
+{
+    if(!Func)
+        return nullptr;
+
+    asIScriptContext* context = Context;
+
+    if(ContextInUse.exchange(true)) {
+
+        // Called recursively from the script or from another thread
+        context = Executor->_GetContextForExecution();
+
+        if(!context) {
+
+            LOG_ERROR("PreparedScriptCall: failed to get a context for a nested call");
+            return nullptr;
+        }
+    }
+
+    // Preparing the same function again is much cheaper than preparing a new one
+    if(context->Prepare(Func) < 0) {
+
+        LOG_ERROR("PreparedScriptCall: prepare context failed, func: " +
+                  std::string(Func->GetDeclaration()));
+        _AbortCall(context);
+        return nullptr;
+    }
+
+    if(obj && context->SetObject(obj) < 0) {
+
+        LOG_ERROR("PreparedScriptCall: failed to set object for method: " +
+                  std::string(Func->GetDeclaration()));
+        _AbortCall(context);
+        return nullptr;
+    }
+
+    return context;
+}
+
+DLLEXPORT SCRIPT_RUN_RESULT PreparedScriptCallBase::_HandleFailedRun(
+    asIScriptContext* context, int retcode)
+{
+    switch(retcode) {
+    case asEXECUTION_EXCEPTION:
+        ScriptExecutor::PrintExceptionInfo(
+            context, *Logger::Get(), context->GetExceptionFunction());
+        return SCRIPT_RUN_RESULT::Error;
+    case asEXECUTION_SUSPENDED:
+        // There is no way to resume so this needs to be aborted for the context to be usable
+        // again
+        context->Abort();
+        return SCRIPT_RUN_RESULT::Suspended;
+    default: return SCRIPT_RUN_RESULT::Error;
+    }
+}
+
+DLLEXPORT void PreparedScriptCallBase::_EndCall(asIScriptContext* context)
+{
+    if(context == Context) {
+
+        ContextInUse = false;
+
+    } else {
+
+        Executor->_DoneWithContext(context);
+    }
+}
+
+DLLEXPORT void PreparedScriptCallBase::_AbortCall(asIScriptContext* context)
+{
+    if(context == Context) {
+
+        // Prepared again on the next call
+        context->Unprepare();
+        ContextInUse = false;
+
+    } else {
+
+        // This unprepares the context
+        Executor->_DoneWithContext(context);
+    }
+}
+// ------------------------------------ //
+DLLEXPORT ScriptExecutor* PreparedScriptCallBase::_GetExecutor(asIScriptFunction* func)
+{
+    return static_cast<ScriptExecutor*>(func->GetEngine()->GetUserData());
+}
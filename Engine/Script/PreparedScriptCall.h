@@ -0,0 +1,248 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2018 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Script/ScriptRunningSetup.h"
+#include "Script/ScriptTypeResolver.h"
+#include "Statistics/Profiler.h"
+
+#include "angelscript.h"
+
+#include <atomic>
+#include <type_traits>
+
+namespace Leviathan {
+
+//! \brief Non-template parts of PreparedScriptCall
+class PreparedScriptCallBase {
+public:
+    PreparedScriptCallBase(const PreparedScriptCallBase& other) = delete;
+    PreparedScriptCallBase& operator=(const PreparedScriptCallBase& other) = delete;
+
+    //! \brief Releases the function and the context
+    DLLEXPORT void Reset();
+
+    inline bool IsValid() const
+    {
+        return Func != nullptr;
+    }
+
+    inline asIScriptFunction* GetFunction() const
+    {
+        return Func;
+    }
+
+protected:
+    PreparedScriptCallBase() = default;
+    DLLEXPORT ~PreparedScriptCallBase();
+
+    //! \brief Sets the called function after checking that the types match
+    //! \param argtypes AngelScript type ids of the arguments the application passes. The
+    //! function may take less parameters than this
+    //! \param returntype The wanted return type id. -1 if any return type is fine
+    //! \returns False if the types didn't match, in which case this is reset
+    DLLEXPORT bool _SetFunction(asIScriptFunction* func, const int* argtypes, asUINT argcount,
+        int returntype, bool printerrors);
+
+    //! \brief Returns a context that is prepared for Func
+    //!
+    //! Context is used if it isn't currently running, otherwise a context is taken from the
+    //! ScriptExecutor context pool
+    //! \param obj The object a method is called on, null for functions and delegates
+    DLLEXPORT asIScriptContext* _BeginCall(void* obj);
+
+    //! \brief Prints errors for failed runs
+    //! \returns The result that should be reported to the caller
+    DLLEXPORT SCRIPT_RUN_RESULT _HandleFailedRun(asIScriptContext* context, int retcode);
+
+    //! \brief Returns a context from _BeginCall. Context is left prepared for the next call
+    DLLEXPORT void _EndCall(asIScriptContext* context);
+
+    //! \brief Returns a context from _BeginCall after a failed call
+    //!
+    //! The context is unprepared which releases the arguments that were already passed
+    DLLEXPORT void _AbortCall(asIScriptContext* context);
+
+    //! \returns The ScriptExecutor used to resolve type ids
+    DLLEXPORT static ScriptExecutor* _GetExecutor(asIScriptFunction* func);
+
+protected:
+    asIScriptFunction* Func = nullptr;
+
+    //! Contexts are taken from and returned to the pool of this
+    ScriptExecutor* Executor = nullptr;
+
+    //! Kept prepared for Func between calls. From the pool of Executor
+    asIScriptContext* Context = nullptr;
+
+    //! Set while Context is used. Recursive and concurrent calls use a different context
+    std::atomic<bool> ContextInUse{false};
+
+    //! The number of parameters Func takes
+    asUINT ParameterCount = 0;
+};
+
+//! \brief A script function or method that is called often with the same argument types
+//!
+//! Unlike ScriptExecutor::RunScript this checks the parameter and return types only once when
+//! the function is set and doesn't need a ScriptRunningSetup. A context is kept prepared for
+//! the function between calls, which lets AngelScript skip most of the preparation work.
+//! Only arithmetic types and pointers (handles) can be passed and only arithmetic types
+//! returned, for anything else use ScriptExecutor.
+//! \note The function must not be changed while calls are running
+template<typename ReturnT, class... Args>
+class PreparedScriptCall : public PreparedScriptCallBase {
+
+    static_assert(((std::is_arithmetic_v<Args> || std::is_pointer_v<Args>)&&...),
+        "PreparedScriptCall only supports arithmetic types and pointers as arguments");
+    static_assert(std::is_void_v<ReturnT> || std::is_arithmetic_v<ReturnT>,
+        "PreparedScriptCall only supports void and arithmetic return types");
+
+public:
+    PreparedScriptCall() = default;
+
+    //! \see SetFunction
+    PreparedScriptCall(asIScriptFunction* func)
+    {
+        SetFunction(func);
+    }
+
+    //! \brief Sets the called function. A reference is added to func
+    //! \param printerrors If false type mismatches aren't logged. Useful when there is a
+    //! fallback for functions that don't match
+    //! \returns False if func takes parameters that don't match Args or doesn't return
+    //! ReturnT
+    bool SetFunction(asIScriptFunction* func, bool printerrors = true)
+    {
+        if(!func) {
+            Reset();
+            return false;
+        }
+
+        ScriptExecutor* exec = _GetExecutor(func);
+
+        // One extra element to not have a zero sized array
+        const int argTypes[sizeof...(Args) + 1] = {
+            AngelScriptTypeIDResolver<Args>::Get(exec)..., 0};
+
+        int returnType = -1;
+
+        if constexpr(!std::is_void_v<ReturnT>)
+            returnType = AngelScriptTypeIDResolver<ReturnT>::Get(exec);
+
+        return _SetFunction(func, argTypes, sizeof...(Args), returnType, printerrors);
+    }
+
+    //! \brief Calls a function or a delegate
+    ScriptRunResult<ReturnT> Call(Args... args)
+    {
+        return _Call(nullptr, args...);
+    }
+
+    //! \brief Calls a method on obj
+    //! \note The caller is responsible for making sure that obj is of the right type
+    ScriptRunResult<ReturnT> CallMethod(void* obj, Args... args)
+    {
+        if(!obj)
+            return ScriptRunResult<ReturnT>(SCRIPT_RUN_RESULT::Error);
+
+        return _Call(obj, args...);
+    }
+
+protected:
+    ScriptRunResult<ReturnT> _Call(void* obj, Args... args)
+    {
+        LEVIATHAN_PROFILE_ZONE("PreparedScriptCall");
+
+        asIScriptContext* context = _BeginCall(obj);
+
+        if(!context)
+            return ScriptRunResult<ReturnT>(SCRIPT_RUN_RESULT::Error);
+
+        asUINT index = 0;
+
+        if(!(_PassArgument(context, index++, args) && ...)) {
+
+            LOG_ERROR("PreparedScriptCall: failed to pass parameter number: " +
+                      std::to_string(index - 1) + ", for func: " + Func->GetName());
+            _AbortCall(context);
+            return ScriptRunResult<ReturnT>(SCRIPT_RUN_RESULT::Error);
+        }
+
+        const int retcode = context->Execute();
+
+        if(retcode != asEXECUTION_FINISHED) {
+
+            const auto result = _HandleFailedRun(context, retcode);
+            _AbortCall(context);
+            return ScriptRunResult<ReturnT>(result);
+        }
+
+        if constexpr(std::is_void_v<ReturnT>) {
+
+            _EndCall(context);
+            return ScriptRunResult<ReturnT>(SCRIPT_RUN_RESULT::Success);
+
+        } else {
+
+            ReturnT value;
+
+            if constexpr(sizeof(ReturnT) == 1) {
+                value = static_cast<ReturnT>(context->GetReturnByte());
+            } else if constexpr(std::is_same_v<ReturnT, float>) {
+                value = context->GetReturnFloat();
+            } else if constexpr(std::is_same_v<ReturnT, double>) {
+                value = context->GetReturnDouble();
+            } else if constexpr(sizeof(ReturnT) == 2) {
+                value = static_cast<ReturnT>(context->GetReturnWord());
+            } else if constexpr(sizeof(ReturnT) == 4) {
+                value = static_cast<ReturnT>(context->GetReturnDWord());
+            } else {
+                value = static_cast<ReturnT>(context->GetReturnQWord());
+            }
+
+            _EndCall(context);
+            return ScriptRunResult<ReturnT>(SCRIPT_RUN_RESULT::Success, std::move(value));
+        }
+    }
+
+    //! \brief Sets an argument. The types have already been checked by SetFunction
+    template<class T>
+    bool _PassArgument(asIScriptContext* context, asUINT index, T value)
+    {
+        // The script doesn't want all of the arguments
+        if(index >= ParameterCount)
+            return true;
+
+        if constexpr(std::is_pointer_v<T>) {
+
+            // Script handles release their reference when done. If the call fails before
+            // running the reference is released when the context is unprepared, but only
+            // if the argument was set
+            IncrementRefCountIfRefCountedType(value);
+
+            if(context->SetArgAddress(index, value) < 0) {
+                DecrementRefCountIfRefCountedType(value);
+                return false;
+            }
+
+            return true;
+
+        } else if constexpr(std::is_same_v<T, float>) {
+            return context->SetArgFloat(index, value) >= 0;
+        } else if constexpr(std::is_same_v<T, double>) {
+            return context->SetArgDouble(index, value) >= 0;
+        } else if constexpr(sizeof(T) == 1) {
+            return context->SetArgByte(index, value) >= 0;
+        } else if constexpr(sizeof(T) == 2) {
+            return context->SetArgWord(index, value) >= 0;
+        } else if constexpr(sizeof(T) == 4) {
+            return context->SetArgDWord(index, value) >= 0;
+        } else {
+            return context->SetArgQWord(index, value) >= 0;
+        }
+    }
+};
+
+} // namespace Leviathan
@@ -10,6 +10,7 @@
 #include "Script/ScriptRunningSetup.h"
 #include "Script/ScriptScript.h"
 #include "Script/ScriptTypeResolver.h"
+#include "Statistics/Profiler.h"
 
 #include <memory>
 #include <string>
@@ -27,6 +28,7 @@
 namespace Leviathan {
 
 class ScriptExecutor;
+class PreparedScriptCallBase;
 
 //! \brief Contains data for script runs where arguments are passed manually
 //! \note This isn't the recommended way if the normal single function call script running can
@@ -55,6 +57,7 @@ private:
 //! \brief Handles ScriptModule creation and AngelScript code execution
 class ScriptExecutor {
     friend CustomScriptRun;
+    friend PreparedScriptCallBase;
     friend asIScriptContext* RequestContextCallback(asIScriptEngine* engine, void* userdata);
     friend void ReturnContextCallback(
         asIScriptEngine* engine, asIScriptContext* context, void* userdata);
@@ -100,6 +103,8 @@ public:
         if(!func)
             return ScriptRunResult<ReturnT>(SCRIPT_RUN_RESULT::Error);
 
+        LEVIATHAN_PROFILE_ZONE("ScriptExecutor::RunScript");
+
         if(!module) {
             // TODO: this is a performance waste if there are no errors
             // Find the right module //
@@ -159,6 +164,8 @@ public:
         if(!func || !obj)
             return ScriptRunResult<ReturnT>(SCRIPT_RUN_RESULT::Error);
 
+        LEVIATHAN_PROFILE_ZONE("ScriptExecutor::RunScriptMethod");
+
         // TODO: this is a performance waste if there are no errors
         std::shared_ptr<ScriptModule> module =
             GetScriptModuleByFunction(func, parameters.PrintErrors);
@@ -223,6 +230,8 @@ public:
         if(!run)
             return ScriptRunResult<ReturnT>(SCRIPT_RUN_RESULT::Error);
 
+        LEVIATHAN_PROFILE_ZONE("ScriptExecutor::ExecuteCustomRun");
+
         // Run the script //
         // TODO: timeout and debugging registering with linecallbacks here //
         int retcode = run->Context->Execute();
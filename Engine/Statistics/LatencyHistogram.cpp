@@ -0,0 +1,237 @@
+// ------------------------------------ //
+#include "LatencyHistogram.h"
+
+#include "Common/DataStoring/DataStore.h"
+#include "TimeIncludes.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Leviathan;
+// ------------------------------------ //
+namespace {
+
+inline int HighestBit(uint64_t value)
+{
+    int bit = 0;
+
+    while(value >>= 1)
+        ++bit;
+
+    return bit;
+}
+
+} // namespace
+// ------------------------------------ //
+DLLEXPORT std::string LatencySummary::ToString() const
+{
+    return "p50: " + std::to_string(P50) + " p95: " + std::to_string(P95) +
+           " p99: " + std::to_string(P99) + " max: " + std::to_string(Max) + " (" +
+           std::to_string(Count) + " samples)";
+}
+// ------------------ LatencyHistogram ------------------ //
+DLLEXPORT LatencyHistogram::LatencyHistogram()
+{
+    Buckets.fill(0);
+}
+// ------------------------------------ //
+DLLEXPORT void LatencyHistogram::Record(int64_t value)
+{
+    value = std::min(std::max<int64_t>(value, 0), MAX_VALUE);
+
+    ++Buckets[GetBucketIndex(value)];
+
+    if(Count == 0 || value < Min)
+        Min = value;
+
+    if(value > Max)
+        Max = value;
+
+    ++Count;
+    Total += value;
+}
+
+DLLEXPORT void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+    if(other.Count == 0)
+        return;
+
+    for(size_t i = 0; i < BUCKET_COUNT; ++i)
+        Buckets[i] += other.Buckets[i];
+
+    if(Count == 0 || other.Min < Min)
+        Min = other.Min;
+
+    Max = std::max(Max, other.Max);
+
+    Count += other.Count;
+    Total += other.Total;
+}
+
+DLLEXPORT void LatencyHistogram::Reset()
+{
+    Buckets.fill(0);
+    Count = 0;
+    Total = 0;
+    Min = 0;
+    Max = 0;
+}
+// ------------------------------------ //
+DLLEXPORT int64_t LatencyHistogram::GetValueAtPercentile(double percentile) const
+{
+    if(Count == 0)
+        return 0;
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+
+    // At least one value needs to be counted to not return the first bucket for 0
+    const uint64_t wanted = std::max<uint64_t>(
+        static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(Count))), 1);
+
+    uint64_t seen = 0;
+
+    for(size_t i = 0; i < BUCKET_COUNT; ++i) {
+
+        seen += Buckets[i];
+
+        if(seen >= wanted)
+            return std::min(GetBucketHighestValue(i), Max);
+    }
+
+    return Max;
+}
+
+DLLEXPORT LatencySummary LatencyHistogram::GetSummary() const
+{
+    LatencySummary summary;
+    summary.Count = Count;
+    summary.P50 = GetValueAtPercentile(50);
+    summary.P95 = GetValueAtPercentile(95);
+    summary.P99 = GetValueAtPercentile(99);
+    summary.Max = Max;
+    return summary;
+}
+
+DLLEXPORT double LatencyHistogram::GetMean() const
+{
+    if(Count == 0)
+        return 0;
+
+    return static_cast<double>(Total) / Count;
+}
+// ------------------------------------ //
+DLLEXPORT size_t LatencyHistogram::GetBucketIndex(int64_t value)
+{
+    // The first two sets of sub buckets have a width of one
+    if(value < 2 * SUB_BUCKET_COUNT)
+        return static_cast<size_t>(value);
+
+    const int shift = HighestBit(static_cast<uint64_t>(value)) - SUB_BUCKET_BITS;
+    const int64_t subBucket = value >> shift;
+
+    return static_cast<size_t>(
+        2 * SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_COUNT + (subBucket - SUB_BUCKET_COUNT));
+}
+
+DLLEXPORT int64_t LatencyHistogram::GetBucketHighestValue(size_t index)
+{
+    if(index < 2 * SUB_BUCKET_COUNT)
+        return static_cast<int64_t>(index);
+
+    const int64_t offset = static_cast<int64_t>(index) - 2 * SUB_BUCKET_COUNT;
+    const int shift = static_cast<int>(offset / SUB_BUCKET_COUNT) + 1;
+    const int64_t subBucket = offset % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+
+    return ((subBucket + 1) << shift) - 1;
+}
+// ------------------ RollingLatencyHistogram ------------------ //
+DLLEXPORT RollingLatencyHistogram::RollingLatencyHistogram(
+    size_t intervalcount /*= 6*/, int64_t intervallength /*= 10 * 1000 * 1000*/) :
+    IntervalLength(std::max<int64_t>(intervallength, 1)),
+    Intervals(std::max<size_t>(intervalcount, 1))
+{
+}
+// ------------------------------------ //
+DLLEXPORT void RollingLatencyHistogram::Record(int64_t value, int64_t now)
+{
+    GUARD_LOCK();
+
+    _AdvanceTo(guard, now);
+    Intervals[CurrentInterval].Record(value);
+}
+
+DLLEXPORT void RollingLatencyHistogram::Record(int64_t value)
+{
+    Record(value, Time::GetTimeMicro64());
+}
+// ------------------------------------ //
+DLLEXPORT LatencyHistogram RollingLatencyHistogram::GetWindow(int64_t now)
+{
+    GUARD_LOCK();
+
+    _AdvanceTo(guard, now);
+
+    LatencyHistogram result;
+
+    for(const auto& interval : Intervals)
+        result.Merge(interval);
+
+    return result;
+}
+
+DLLEXPORT LatencySummary RollingLatencyHistogram::GetSummary(int64_t now)
+{
+    return GetWindow(now).GetSummary();
+}
+
+DLLEXPORT LatencySummary RollingLatencyHistogram::GetSummary()
+{
+    return GetSummary(Time::GetTimeMicro64());
+}
+
+DLLEXPORT void RollingLatencyHistogram::ReportStats(
+    DataStore* dstore, const std::string& prefix)
+{
+    const auto summary = GetSummary();
+
+    dstore->SetValue(prefix + "P50", VariableBlock(static_cast<int>(summary.P50)));
+    dstore->SetValue(prefix + "P95", VariableBlock(static_cast<int>(summary.P95)));
+    dstore->SetValue(prefix + "P99", VariableBlock(static_cast<int>(summary.P99)));
+    dstore->SetValue(prefix + "Max", VariableBlock(static_cast<int>(summary.Max)));
+}
+
+DLLEXPORT void RollingLatencyHistogram::Reset()
+{
+    GUARD_LOCK();
+
+    for(auto& interval : Intervals)
+        interval.Reset();
+
+    CurrentInterval = 0;
+    CurrentIntervalStart = -1;
+}
+// ------------------------------------ //
+void RollingLatencyHistogram::_AdvanceTo(Lock& guard, int64_t now)
+{
+    if(CurrentIntervalStart < 0) {
+        CurrentIntervalStart = now;
+        return;
+    }
+
+    if(now - CurrentIntervalStart < IntervalLength)
+        return;
+
+    const int64_t passed = (now - CurrentIntervalStart) / IntervalLength;
+
+    // Everything is old if the whole window has passed
+    const size_t toClear = static_cast<size_t>(
+        std::min<int64_t>(passed, static_cast<int64_t>(Intervals.size())));
+
+    for(size_t i = 0; i < toClear; ++i) {
+
+        CurrentInterval = (CurrentInterval + 1) % Intervals.size();
+        Intervals[CurrentInterval].Reset();
+    }
+
+    CurrentIntervalStart += passed * IntervalLength;
+}
@@ -0,0 +1,143 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2018 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Common/ThreadSafe.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Leviathan {
+
+class DataStore;
+
+//! \brief Percentiles of a LatencyHistogram
+struct LatencySummary {
+
+    //! \returns The values formatted like "p50: 1 p95: 2 p99: 3 max: 4 (5 samples)"
+    DLLEXPORT std::string ToString() const;
+
+    uint64_t Count = 0;
+    int64_t P50 = 0;
+    int64_t P95 = 0;
+    int64_t P99 = 0;
+    int64_t Max = 0;
+};
+
+//! \brief Fixed size histogram for durations that keeps about 3% precision for any value
+//!
+//! Values are bucketed logarithmically with 32 linear sub buckets per power of two in the
+//! same way as HdrHistogram. So the memory use doesn't depend on the amount of samples and
+//! high percentiles can be read instead of only averages, which hide spikes.
+//! Values are expected to be microseconds but any non-negative integer works. Values above
+//! MAX_VALUE are clamped.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr int64_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+
+    //! Highest value that is stored precisely, about 19 hours of microseconds
+    static constexpr int64_t MAX_VALUE = (int64_t(1) << 36) - 1;
+
+    static constexpr size_t BUCKET_COUNT =
+        2 * SUB_BUCKET_COUNT + (36 - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT;
+
+    DLLEXPORT LatencyHistogram();
+
+    DLLEXPORT void Record(int64_t value);
+
+    //! \brief Adds all values in other to this
+    DLLEXPORT void Merge(const LatencyHistogram& other);
+
+    DLLEXPORT void Reset();
+
+    //! \returns The value that percentile (0-100) of the values are at or below. The
+    //! returned value is the highest value in the bucket, but at most GetMax
+    DLLEXPORT int64_t GetValueAtPercentile(double percentile) const;
+
+    DLLEXPORT LatencySummary GetSummary() const;
+
+    //! \returns Average of the recorded values, exact as the total is tracked separately
+    DLLEXPORT double GetMean() const;
+
+    inline uint64_t GetCount() const
+    {
+        return Count;
+    }
+
+    inline int64_t GetMin() const
+    {
+        return Count > 0 ? Min : 0;
+    }
+
+    inline int64_t GetMax() const
+    {
+        return Max;
+    }
+
+    //! \returns The bucket value is in
+    DLLEXPORT static size_t GetBucketIndex(int64_t value);
+
+    //! \returns The highest value that is put in bucket index
+    DLLEXPORT static int64_t GetBucketHighestValue(size_t index);
+
+private:
+    std::array<uint32_t, BUCKET_COUNT> Buckets;
+
+    uint64_t Count = 0;
+    int64_t Total = 0;
+    int64_t Min = 0;
+    int64_t Max = 0;
+};
+
+//! \brief Histogram of the values recorded during the last IntervalCount intervals
+//!
+//! Each interval has its own LatencyHistogram and the oldest is cleared when a new interval
+//! starts, so the memory use is fixed. This is thread safe.
+class RollingLatencyHistogram : public ThreadSafe {
+public:
+    //! \param intervallength Length of one interval in microseconds
+    DLLEXPORT RollingLatencyHistogram(
+        size_t intervalcount = 6, int64_t intervallength = 10 * 1000 * 1000);
+
+    //! \param now Current time in microseconds, Time::GetTimeMicro64
+    DLLEXPORT void Record(int64_t value, int64_t now);
+
+    //! \brief Records using the current time
+    DLLEXPORT void Record(int64_t value);
+
+    //! \returns All values recorded during the window ending at now
+    DLLEXPORT LatencyHistogram GetWindow(int64_t now);
+
+    DLLEXPORT LatencySummary GetSummary(int64_t now);
+
+    //! \brief Gets summary using the current time
+    DLLEXPORT LatencySummary GetSummary();
+
+    //! \brief Sets the window percentiles as values to DataStore
+    //!
+    //! The values are named prefix followed by P50, P95, P99 and Max
+    DLLEXPORT void ReportStats(DataStore* dstore, const std::string& prefix);
+
+    DLLEXPORT void Reset();
+
+private:
+    //! Clears the intervals that have ended before now
+    void _AdvanceTo(Lock& guard, int64_t now);
+
+private:
+    const int64_t IntervalLength;
+
+    std::vector<LatencyHistogram> Intervals;
+
+    //! Index in Intervals that is currently recorded to
+    size_t CurrentInterval = 0;
+
+    //! Start time of CurrentInterval, -1 before anything is recorded
+    int64_t CurrentIntervalStart = -1;
+};
+
+} // namespace Leviathan
@@ -0,0 +1,292 @@
+// ------------------------------------ //
+#include "Profiler.h"
+
+#include "Common/ThreadSafe.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <unordered_map>
+
+using namespace Leviathan;
+// ------------------------------------ //
+namespace {
+
+//! Events of a single thread. Only the owning thread writes to this
+struct ProfilerThreadBuffer {
+
+    ProfilerThreadBuffer(uint32_t thread) :
+        Thread(thread), Events(Profiler::THREAD_BUFFER_SIZE)
+    {
+    }
+
+    const uint32_t Thread;
+    std::vector<ProfilerEvent> Events;
+
+    //! Total number of events written. The ring buffer index is this modulo the size
+    std::atomic<uint64_t> Written{0};
+
+    //! Value of Written when Clear was last called
+    std::atomic<uint64_t> ClearedAt{0};
+
+    //! Active zones on this thread
+    uint32_t Depth = 0;
+};
+
+struct ProfilerState {
+
+    Mutex ZoneMutex;
+    std::vector<std::string> ZoneNames;
+    std::unordered_map<std::string, ProfilerZoneID> ZoneIDs;
+
+    //! Buffers are kept after their threads quit so that their events can still be read
+    Mutex BufferMutex;
+    std::vector<std::shared_ptr<ProfilerThreadBuffer>> Buffers;
+
+    Mutex CaptureMutex;
+    std::atomic<int> CaptureTicksLeft{0};
+    std::string CaptureFile;
+};
+
+ProfilerState& GetState()
+{
+    static ProfilerState state;
+    return state;
+}
+
+ProfilerThreadBuffer& GetThreadBuffer()
+{
+    static thread_local std::shared_ptr<ProfilerThreadBuffer> buffer;
+
+    if(!buffer) {
+
+        auto& state = GetState();
+        Lock lock(state.BufferMutex);
+
+        buffer = std::make_shared<ProfilerThreadBuffer>(
+            static_cast<uint32_t>(state.Buffers.size()));
+        state.Buffers.push_back(buffer);
+    }
+
+    return *buffer;
+}
+
+void WriteJSONString(std::ostream& output, const std::string& str)
+{
+    output << '"';
+
+    for(char character : str) {
+        switch(character) {
+        case '"': output << "\\\""; break;
+        case '\\': output << "\\\\"; break;
+        case '\n': output << "\\n"; break;
+        case '\t': output << "\\t"; break;
+        default:
+            if(static_cast<unsigned char>(character) < 0x20) {
+                output << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                       << static_cast<int>(character) << std::dec << std::setfill(' ');
+            } else {
+                output << character;
+            }
+        }
+    }
+
+    output << '"';
+}
+
+} // namespace
+// ------------------------------------ //
+std::atomic<bool> Profiler::Enabled{false};
+const std::chrono::steady_clock::time_point Profiler::Epoch = std::chrono::steady_clock::now();
+// ------------------------------------ //
+DLLEXPORT ProfilerZoneID Profiler::RegisterZone(const std::string& name)
+{
+    auto& state = GetState();
+    Lock lock(state.ZoneMutex);
+
+    const auto existing = state.ZoneIDs.find(name);
+
+    if(existing != state.ZoneIDs.end())
+        return existing->second;
+
+    const auto id = static_cast<ProfilerZoneID>(state.ZoneNames.size());
+
+    state.ZoneNames.push_back(name);
+    state.ZoneIDs[name] = id;
+    return id;
+}
+
+DLLEXPORT std::string Profiler::GetZoneName(ProfilerZoneID zone)
+{
+    auto& state = GetState();
+    Lock lock(state.ZoneMutex);
+
+    if(zone >= state.ZoneNames.size())
+        return "";
+
+    return state.ZoneNames[zone];
+}
+// ------------------------------------ //
+DLLEXPORT void Profiler::SetEnabled(bool enabled)
+{
+    Enabled.store(enabled);
+}
+
+DLLEXPORT void Profiler::Clear()
+{
+    auto& state = GetState();
+    Lock lock(state.BufferMutex);
+
+    // The owning threads may be writing so only the start of the readable range is moved
+    for(const auto& buffer : state.Buffers)
+        buffer->ClearedAt.store(buffer->Written.load(std::memory_order_acquire));
+}
+
+DLLEXPORT std::vector<ProfilerThreadEvents> Profiler::GetEvents()
+{
+    auto& state = GetState();
+    Lock lock(state.BufferMutex);
+
+    std::vector<ProfilerThreadEvents> result;
+    result.reserve(state.Buffers.size());
+
+    for(const auto& buffer : state.Buffers) {
+
+        const uint64_t written = buffer->Written.load(std::memory_order_acquire);
+        uint64_t begin = buffer->ClearedAt.load();
+
+        // Older events have been overwritten
+        if(written > THREAD_BUFFER_SIZE)
+            begin = std::max<uint64_t>(begin, written - THREAD_BUFFER_SIZE);
+
+        if(begin >= written)
+            continue;
+
+        ProfilerThreadEvents events;
+        events.Thread = buffer->Thread;
+        events.Events.reserve(static_cast<size_t>(written - begin));
+
+        for(uint64_t i = begin; i < written; ++i)
+            events.Events.push_back(buffer->Events[i % THREAD_BUFFER_SIZE]);
+
+        result.push_back(std::move(events));
+    }
+
+    return result;
+}
+// ------------------------------------ //
+DLLEXPORT void Profiler::WriteChromeTrace(std::ostream& output)
+{
+    const auto threads = GetEvents();
+
+    // Copy the names to not need the lock while writing
+    std::vector<std::string> zoneNames;
+    {
+        auto& state = GetState();
+        Lock lock(state.ZoneMutex);
+        zoneNames = state.ZoneNames;
+    }
+
+    output << "{\"traceEvents\":[";
+
+    bool first = true;
+
+    for(const auto& thread : threads) {
+
+        if(!first)
+            output << ",";
+        first = false;
+
+        output << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.Thread
+               << ",\"args\":{\"name\":\"Thread " << thread.Thread << "\"}}";
+
+        for(const auto& event : thread.Events) {
+
+            output << ",\n{\"name\":";
+            WriteJSONString(output,
+                event.Zone < zoneNames.size() ? zoneNames[event.Zone] : std::string("unknown"));
+
+            // Chrome wants microseconds
+            output << ",\"cat\":\"leviathan\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.Thread
+                   << ",\"ts\":" << std::fixed << std::setprecision(3) << event.Start / 1000.0
+                   << ",\"dur\":" << (event.End - event.Start) / 1000.0
+                   << ",\"args\":{\"depth\":" << event.Depth << "}}";
+        }
+    }
+
+    output << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+DLLEXPORT bool Profiler::WriteChromeTrace(const std::string& file)
+{
+    std::ofstream output(file, std::ios::out | std::ios::trunc);
+
+    if(!output.good())
+        return false;
+
+    WriteChromeTrace(output);
+    return output.good();
+}
+// ------------------------------------ //
+DLLEXPORT void Profiler::CaptureTicks(int ticks, const std::string& file)
+{
+    auto& state = GetState();
+    Lock lock(state.CaptureMutex);
+
+    Clear();
+
+    state.CaptureFile = file;
+
+    // The first call to OnNewTick starts the first captured tick
+    state.CaptureTicksLeft = ticks > 0 ? ticks + 1 : 0;
+
+    SetEnabled(ticks > 0);
+}
+
+DLLEXPORT bool Profiler::IsCapturing()
+{
+    return GetState().CaptureTicksLeft.load() > 0;
+}
+
+DLLEXPORT void Profiler::OnNewTick()
+{
+    auto& state = GetState();
+
+    if(state.CaptureTicksLeft.load() <= 0)
+        return;
+
+    Lock lock(state.CaptureMutex);
+
+    if(--state.CaptureTicksLeft > 0)
+        return;
+
+    SetEnabled(false);
+
+    if(!WriteChromeTrace(state.CaptureFile)) {
+
+        LOG_ERROR("Profiler: failed to write capture to: " + state.CaptureFile);
+        return;
+    }
+
+    LOG_INFO("Profiler: wrote capture to: " + state.CaptureFile);
+}
+// ------------------------------------ //
+DLLEXPORT uint32_t Profiler::_EnterZone()
+{
+    return GetThreadBuffer().Depth++;
+}
+
+DLLEXPORT void Profiler::_LeaveZone(
+    ProfilerZoneID zone, int64_t start, int64_t end, uint32_t depth)
+{
+    ProfilerThreadBuffer& buffer = GetThreadBuffer();
+
+    --buffer.Depth;
+
+    const uint64_t index = buffer.Written.load(std::memory_order_relaxed);
+
+    buffer.Events[index % THREAD_BUFFER_SIZE] = ProfilerEvent{start, end, zone, depth};
+
+    buffer.Written.store(index + 1, std::memory_order_release);
+}
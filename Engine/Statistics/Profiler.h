@@ -0,0 +1,164 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2018 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//! \brief Profiles the rest of the current scope as a zone called name
+//!
+//! The zone id is registered the first time execution reaches the macro and after that
+//! entering the zone only costs a flag check when the profiler isn't enabled
+#define LEVIATHAN_PROFILE_ZONE(name) LEVIATHAN_PROFILE_ZONE_LINE(name, __LINE__)
+
+#define LEVIATHAN_PROFILE_ZONE_LINE(name, line) LEVIATHAN_PROFILE_ZONE_IMPL(name, line)
+#define LEVIATHAN_PROFILE_ZONE_IMPL(name, line)                                              \
+    static const Leviathan::ProfilerZoneID profilerZone_##line =                             \
+        Leviathan::Profiler::RegisterZone(name);                                             \
+    Leviathan::ProfileScope profilerScope_##line(profilerZone_##line);
+
+//! \brief Profiles the current function
+#define LEVIATHAN_PROFILE_FUNCTION LEVIATHAN_PROFILE_ZONE(__FUNCTION__)
+
+//! Old name kept for code that used the TimingMonitor based scope timer
+#define QUICKTIME_THISSCOPE LEVIATHAN_PROFILE_FUNCTION
+
+namespace Leviathan {
+
+//! \brief Identifies a profiled location. Zones with the same name share the id
+using ProfilerZoneID = uint32_t;
+
+//! \brief A finished zone on some thread
+struct ProfilerEvent {
+
+    //! Nanoseconds since the profiler was started
+    int64_t Start;
+    int64_t End;
+    ProfilerZoneID Zone;
+
+    //! How many zones were active on the thread when this was entered
+    uint32_t Depth;
+};
+
+//! \brief Events that were recorded by a single thread
+struct ProfilerThreadEvents {
+
+    //! Number given to the thread when it first recorded something
+    uint32_t Thread;
+    std::vector<ProfilerEvent> Events;
+};
+
+//! \brief Hierarchical profiler for finding out where the time in a tick goes
+//!
+//! Each thread writes finished zones to its own fixed size ring buffer so recording doesn't
+//! lock or allocate. Nothing is recorded unless the profiler is enabled, either directly
+//! or by capturing a number of ticks with CaptureTicks, which also writes the result as a
+//! Chrome trace (open in chrome://tracing) once done.
+//! \note Reading the events while other threads are still recording is only safe if the
+//! ring buffers don't wrap around during the read
+class Profiler {
+public:
+    //! Amount of events each thread keeps before overwriting the oldest ones
+    static constexpr size_t THREAD_BUFFER_SIZE = 1 << 16;
+
+    Profiler() = delete;
+
+    //! \brief Returns the id for a zone called name
+    //!
+    //! Calling this again with the same name returns the same id
+    DLLEXPORT static ProfilerZoneID RegisterZone(const std::string& name);
+
+    //! \returns The name of a zone or an empty string
+    DLLEXPORT static std::string GetZoneName(ProfilerZoneID zone);
+
+    static bool IsEnabled()
+    {
+        return Enabled.load(std::memory_order_relaxed);
+    }
+
+    DLLEXPORT static void SetEnabled(bool enabled);
+
+    //! \brief Forgets all the recorded events
+    DLLEXPORT static void Clear();
+
+    //! \brief Copies all the recorded events, oldest first
+    DLLEXPORT static std::vector<ProfilerThreadEvents> GetEvents();
+
+    //! \brief Writes the recorded events in the Chrome trace event JSON format
+    DLLEXPORT static void WriteChromeTrace(std::ostream& output);
+
+    //! \returns False if file couldn't be written
+    DLLEXPORT static bool WriteChromeTrace(const std::string& file);
+
+    //! \brief Clears the existing events and records the next ticks ticks
+    //!
+    //! Once ticks full ticks have passed (Engine has called OnNewTick ticks + 1 times) the
+    //! profiler is disabled and the events are written to file
+    DLLEXPORT static void CaptureTicks(int ticks, const std::string& file);
+
+    //! \returns True while CaptureTicks is recording
+    DLLEXPORT static bool IsCapturing();
+
+    //! \brief Called by Engine when a new tick starts to finish captures
+    DLLEXPORT static void OnNewTick();
+
+    //! \returns Nanoseconds since the profiler epoch
+    static int64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - Epoch)
+            .count();
+    }
+
+    //! \brief Marks a zone as entered on this thread
+    //! \returns The depth of the entered zone
+    DLLEXPORT static uint32_t _EnterZone();
+
+    //! \brief Stores a finished zone on this thread
+    DLLEXPORT static void _LeaveZone(
+        ProfilerZoneID zone, int64_t start, int64_t end, uint32_t depth);
+
+private:
+    static std::atomic<bool> Enabled;
+
+    static const std::chrono::steady_clock::time_point Epoch;
+};
+
+//! \brief Records a zone from construction to destruction. Use LEVIATHAN_PROFILE_ZONE
+class ProfileScope {
+public:
+    ProfileScope(ProfilerZoneID zone)
+    {
+        if(!Profiler::IsEnabled()) {
+            Active = false;
+            return;
+        }
+
+        Active = true;
+        Zone = zone;
+        Depth = Profiler::_EnterZone();
+        Start = Profiler::Now();
+    }
+
+    ~ProfileScope()
+    {
+        if(Active)
+            Profiler::_LeaveZone(Zone, Start, Profiler::Now(), Depth);
+    }
+
+    ProfileScope(const ProfileScope& other) = delete;
+    ProfileScope& operator=(const ProfileScope& other) = delete;
+
+private:
+    bool Active;
+    ProfilerZoneID Zone;
+    uint32_t Depth;
+    int64_t Start;
+};
+
+} // namespace Leviathan
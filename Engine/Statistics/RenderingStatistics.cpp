@@ -5,7 +5,7 @@
 #include "../TimeIncludes.h"
 using namespace Leviathan;
 // ------------------------------------ //
-Leviathan::RenderingStatistics::RenderingStatistics() : LastMinuteFPS(80), LastMinuteRenderTimes(320){
+Leviathan::RenderingStatistics::RenderingStatistics(){
 
     Frames = 0;
 
@@ -27,10 +27,8 @@ Leviathan::RenderingStatistics::RenderingStatistics() : LastMinuteFPS(80), LastM
 
     DoubtfulCancel = 0;
 
-    LastMinuteFPSPos = 0;
-    LastMinuteRenderTimesPos = 0;
-
-
+    HalfMinuteFPSSum = 0;
+    HalfMinuteFPSCount = 0;
 
     IsFirstFrame = true;
     EraseOld = true;
@@ -52,10 +50,7 @@ void Leviathan::RenderingStatistics::RenderingEnd(){
     RenderMCRSeconds = (int)(RenderingEndTime-RenderingStartTime);
 
 
-    MakeSureHasEnoughRoom(LastMinuteRenderTimes, LastMinuteRenderTimesPos);
-
-    LastMinuteRenderTimes[LastMinuteRenderTimesPos] = RenderMCRSeconds;
-    ++LastMinuteRenderTimesPos;
+    FrameTimes.Record(RenderMCRSeconds, RenderingEndTime);
 
     // half minute check //
     if(RenderingEndTime > HalfMinuteStartTime+(1000000*30)){
@@ -79,47 +74,29 @@ void Leviathan::RenderingStatistics::ReportStats(DataStore* dstore){
     dstore->SetFrameTimeAverage(AverageRenderTime);
     dstore->SetFrameTimeMax(MaxFrameTime);
     dstore->SetFrameTimeMin(MinFrameTime);
+
+    FrameTimes.ReportStats(dstore, "FrameTime");
 }
 
 void Leviathan::RenderingStatistics::HalfMinuteMark(){
     EraseOld = true;
 
     // Calculate the averages //
-    int fpses = 0;
-
-    for(size_t i = 0; i < LastMinuteFPSPos+1; i++){
-        fpses += LastMinuteFPS[i];
-    }
-
-    if(LastMinuteFPSPos == 0){
+    if(HalfMinuteFPSCount == 0){
 
         AverageFps = 0;
 
     } else {
 
-        AverageFps = static_cast<int>(fpses/LastMinuteFPSPos+1);
+        AverageFps = static_cast<int>(HalfMinuteFPSSum / HalfMinuteFPSCount);
     }
 
     // Frame time averages //
-    int frametimes = 0;
+    AverageRenderTime = static_cast<int>(FrameTimes.GetWindow(RenderingEndTime).GetMean());
 
-
-    for(size_t i = 0; i < LastMinuteRenderTimesPos+1; i++){
-        
-        frametimes += LastMinuteRenderTimes[i];
-    }
-
-    if(LastMinuteRenderTimesPos == 0){
-        
-        AverageRenderTime = 0;
-    } else {
-        
-        AverageRenderTime = static_cast<int>(frametimes/LastMinuteRenderTimesPos+1);
-    }
-
-    // Reset the insert positions //
-    LastMinuteRenderTimesPos = 0;
-    LastMinuteFPSPos = 0;
+    // Start the next half minute //
+    HalfMinuteFPSSum = 0;
+    HalfMinuteFPSCount = 0;
 }
 
 void Leviathan::RenderingStatistics::SecondMark(){
@@ -141,10 +118,8 @@ void Leviathan::RenderingStatistics::SecondMark(){
         MinFrameTime = RenderMCRSeconds;
     }
     
-    MakeSureHasEnoughRoom(LastMinuteFPS, LastMinuteFPSPos);
-
-    LastMinuteFPS[LastMinuteFPSPos] = FPS;
-    ++LastMinuteFPSPos;
+    HalfMinuteFPSSum += FPS;
+    ++HalfMinuteFPSCount;
 
     EraseOld = false;
 }
@@ -215,29 +190,3 @@ bool Leviathan::RenderingStatistics::CanRenderNow(int maxfps, int& TimeSinceLast
 
     return false;
 }
-// ------------------------------------ //
-void RenderingStatistics::MakeSureHasEnoughRoom(std::vector<int> &tarvec,
-    const size_t &accessspot)
-{
-            
-    if(tarvec.size() <= accessspot+1){
-        if(tarvec.size() > 5000){
-
-            tarvec.resize((size_t)(tarvec.size()*1.35f));
-            Logger::Get()->Warning("RenderingStatistics: large frame time tracking buffer is "
-                "getting larger, size: "+Convert::ToString(tarvec.size()));
-
-        } else {
-
-            tarvec.resize((size_t)(tarvec.size()*1.8f));
-        }
-    }
-}
-
-
-
-
-
-
-
-
@@ -2,7 +2,7 @@
 // ------------------------------------ //
 #include "Include.h"
 #include "../ForwardDeclarations.h"
-#include <vector>
+#include "LatencyHistogram.h"
 #include <cstddef>
 
 namespace Leviathan{
@@ -20,14 +20,17 @@ namespace Leviathan{
 
 		DLLEXPORT void ReportStats(DataStore* dstore);
 
+		//! \brief Returns the render times of the last minute in microseconds
+		inline RollingLatencyHistogram& GetFrameTimes(){
+			return FrameTimes;
+		}
+
 	private:
 
 
 		void HalfMinuteMark();
 		void SecondMark();
 
-		static void MakeSureHasEnoughRoom(std::vector<int> &tarvec, const size_t &accessspot);
-
 		// ------------------------------------ //
 		int64_t HalfMinuteStartTime;
 		int64_t SecondStartTime;
@@ -52,11 +55,12 @@ namespace Leviathan{
 		bool IsFirstFrame;
 
 		// stored values //
-		std::vector<int> LastMinuteFPS;
-		size_t LastMinuteFPSPos;
+		//! For AverageFps, reset at each half minute mark
+		int64_t HalfMinuteFPSSum;
+		int HalfMinuteFPSCount;
 
-		std::vector<int> LastMinuteRenderTimes;
-		size_t LastMinuteRenderTimesPos;
+		//! Fixed size so long sessions don't grow this
+		RollingLatencyHistogram FrameTimes;
 
 
 		bool EraseOld;
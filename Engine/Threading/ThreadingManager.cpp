@@ -4,13 +4,67 @@
 #ifdef LEVIATHAN_USING_OGRE
 #include "OgreRoot.h"
 #endif // LEVIATHAN_USING_OGRE
-#include "../Statistics/TimingMonitor.h"
+#include "../Statistics/Profiler.h"
 #include "../Utility/Convert.h"
 #include "QueuedTask.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <thread>
 using namespace Leviathan;
 using namespace std;
 // ------------------------------------ //
+namespace {
+
+//! \brief Shared between the threads taking part in ThreadingManager::RunInParallel
+//!
+//! Tasks that start only after everything is done just see that there is nothing left, so
+//! they need their own reference to this
+struct ParallelRunState {
+
+    std::function<void(size_t)> Function;
+    size_t Count = 0;
+
+    std::atomic<size_t> NextIndex{0};
+    std::atomic<size_t> Finished{0};
+
+    Mutex FinishedMutex;
+    std::condition_variable FinishedNotify;
+
+    //! The first exception thrown by Function
+    std::exception_ptr Error;
+};
+
+//! \brief Runs items until none are left
+void RunParallelItems(ParallelRunState& state)
+{
+    while(true) {
+
+        const size_t index = state.NextIndex.fetch_add(1);
+
+        if(index >= state.Count)
+            return;
+
+        try {
+            state.Function(index);
+        } catch(...) {
+
+            Lock lock(state.FinishedMutex);
+
+            if(!state.Error)
+                state.Error = std::current_exception();
+        }
+
+        if(state.Finished.fetch_add(1) + 1 == state.Count) {
+
+            Lock lock(state.FinishedMutex);
+            state.FinishedNotify.notify_all();
+        }
+    }
+}
+} // namespace
 
 // ------------------ Utility functions for threads to run ------------------ //
 #ifdef LEVIATHAN_USING_OGRE
@@ -233,6 +287,36 @@ DLLEXPORT void Leviathan::ThreadingManager::RemoveTasksFromQueue(
     tasklist.clear();
 }
 // ------------------------------------ //
+DLLEXPORT void ThreadingManager::RunInParallel(
+    size_t count, const std::function<void(size_t)>& function)
+{
+    if(count == 0)
+        return;
+
+    auto state = std::make_shared<ParallelRunState>();
+    state->Function = function;
+    state->Count = count;
+
+    size_t helpers;
+
+    {
+        GUARD_LOCK();
+        helpers = std::min(count - 1, UsableThreads.size());
+    }
+
+    // The tasks hold a reference to the state as they might start only after this returns
+    for(size_t i = 0; i < helpers; ++i)
+        QueueTask(std::make_shared<QueuedTask>([state]() { RunParallelItems(*state); }));
+
+    RunParallelItems(*state);
+
+    Lock lock(state->FinishedMutex);
+    state->FinishedNotify.wait(lock, [&]() { return state->Finished == state->Count; });
+
+    if(state->Error)
+        std::rethrow_exception(state->Error);
+}
+// ------------------------------------ //
 DLLEXPORT void Leviathan::ThreadingManager::FlushActiveThreads()
 {
     // Disallow new tasks //
@@ -75,6 +75,14 @@ public:
         QueueTask(std::shared_ptr<QueuedTask>(newdtask));
     }
 
+    //! \brief Runs function once for each index in [0, count) using the worker threads
+    //!
+    //! The calling thread also runs items until there are none left, which makes this safe
+    //! to call from inside a task even when all of the workers are busy
+    //! \note Blocks until all items have finished. If any of them throws the first exception
+    //! is rethrown here after the others have finished
+    DLLEXPORT void RunInParallel(size_t count, const std::function<void(size_t)>& function);
+
     //! This function waits for all tasks to complete
     DLLEXPORT void FlushActiveThreads();
 
@@ -3,6 +3,7 @@
 
 #ifdef __linux__
 #include <sys/time.h>
+#include <time.h>
 #elif _WIN32
 #include "WindowsInclude.h"
 #endif
@@ -79,6 +80,38 @@ int64_t Time::GetTimeMicro64()
 #error no working get time on platform
 #endif
 }
+
+int64_t Time::GetThreadCPUTimeMicro64()
+{
+#ifdef _WIN32
+    /* Windows */
+    FILETIME creation, exit, kernel, user;
+
+    if(!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        return 0;
+
+    ULARGE_INTEGER kernelTime;
+    kernelTime.LowPart = kernel.dwLowDateTime;
+    kernelTime.HighPart = kernel.dwHighDateTime;
+
+    ULARGE_INTEGER userTime;
+    userTime.LowPart = user.dwLowDateTime;
+    userTime.HighPart = user.dwHighDateTime;
+
+    /* From 100 nano seconds (10^-7) to 1 microsecond (10^-6) intervals */
+    return static_cast<int64_t>((kernelTime.QuadPart + userTime.QuadPart) / 10);
+#elif defined __linux__
+    /* Linux */
+    struct timespec ts;
+
+    if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return 0;
+
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#else
+#error no working get time on platform
+#endif
+}
 // ------------------------------------ //
 DLLEXPORT WantedClockType::time_point Time::GetThreadSafeSteadyTimePoint()
 {
@@ -24,6 +24,9 @@ public:
     DLLEXPORT static int64_t GetTimeMs64();
     DLLEXPORT static int64_t GetTimeMicro64();
 
+    //! \returns The CPU time used by the calling thread in microseconds
+    DLLEXPORT static int64_t GetThreadCPUTimeMicro64();
+
     //! \note This should be not required when using the standard
     DLLEXPORT static WantedClockType::time_point GetThreadSafeSteadyTimePoint();
 };
@@ -0,0 +1,106 @@
+// ------------------------------------ //
+#include "MemoryMappedFile.h"
+
+#ifdef _WIN32
+#include "WindowsInclude.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif //_WIN32
+
+using namespace Leviathan;
+// ------------------------------------ //
+DLLEXPORT MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+// ------------------------------------ //
+DLLEXPORT bool MemoryMappedFile::Open(const std::string& file)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE filehandle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if(filehandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER filesize;
+
+    if(!GetFileSizeEx(filehandle, &filesize) || filesize.QuadPart == 0) {
+
+        CloseHandle(filehandle);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(filehandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if(!mapping) {
+
+        CloseHandle(filehandle);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if(!view) {
+
+        CloseHandle(mapping);
+        CloseHandle(filehandle);
+        return false;
+    }
+
+    FileHandle = filehandle;
+    MappingHandle = mapping;
+    Data = static_cast<const uint8_t*>(view);
+    Size = static_cast<size_t>(filesize.QuadPart);
+#else
+    const int fd = open(file.c_str(), O_RDONLY);
+
+    if(fd == -1)
+        return false;
+
+    struct stat st;
+
+    if(fstat(fd, &st) == -1 || st.st_size <= 0) {
+
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping stays valid after the descriptor is closed //
+    close(fd);
+
+    if(view == MAP_FAILED)
+        return false;
+
+    Data = static_cast<const uint8_t*>(view);
+    Size = static_cast<size_t>(st.st_size);
+#endif //_WIN32
+
+    return true;
+}
+
+DLLEXPORT void MemoryMappedFile::Close()
+{
+    if(!Data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(Data);
+    CloseHandle(MappingHandle);
+    CloseHandle(FileHandle);
+    MappingHandle = nullptr;
+    FileHandle = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(Data), Size);
+#endif //_WIN32
+
+    Data = nullptr;
+    Size = 0;
+}
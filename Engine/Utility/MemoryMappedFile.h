@@ -0,0 +1,56 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2018 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Leviathan {
+
+//! \brief Read only view of a whole file mapped into memory
+//!
+//! The pages are loaded by the OS on first access, so only the parts of the file that are
+//! actually touched are ever read from disk
+class MemoryMappedFile {
+public:
+    MemoryMappedFile() = default;
+    DLLEXPORT ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile& other) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile& other) = delete;
+
+    //! \brief Maps file into memory, releasing any previously mapped file
+    //! \returns False if the file couldn't be opened or is empty
+    DLLEXPORT bool Open(const std::string& file);
+
+    //! \brief Unmaps the file
+    DLLEXPORT void Close();
+
+    inline const uint8_t* GetData() const
+    {
+        return Data;
+    }
+
+    inline size_t GetSize() const
+    {
+        return Size;
+    }
+
+    inline bool IsOpen() const
+    {
+        return Data != nullptr;
+    }
+
+private:
+    const uint8_t* Data = nullptr;
+    size_t Size = 0;
+
+#ifdef _WIN32
+    void* FileHandle = nullptr;
+    void* MappingHandle = nullptr;
+#endif //_WIN32
+};
+
+} // namespace Leviathan
@@ -22,6 +22,13 @@ Mersenne twister. Code written based on pseudocode on
 #endif
 using namespace Leviathan;
 // ------------------------------------ //
+namespace {
+
+//! Overrides the main generator on a thread, see Random::SetThreadRandom
+thread_local Random* ThreadRandom = nullptr;
+
+} // namespace
+// ------------------------------------ //
 Leviathan::Random::Random()
 {
     Index = 0;
@@ -67,9 +74,19 @@ Leviathan::Random::~Random()
 
 Random* Leviathan::Random::Get()
 {
+    if(ThreadRandom)
+        return ThreadRandom;
+
     return staticaccess;
 }
 
+DLLEXPORT Random* Leviathan::Random::SetThreadRandom(Random* random)
+{
+    Random* previous = ThreadRandom;
+    ThreadRandom = random;
+    return previous;
+}
+
 Random* Leviathan::Random::staticaccess = NULL;
 // ------------------------------------ //
 int Leviathan::Random::GetSeed()
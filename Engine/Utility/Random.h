@@ -18,8 +18,17 @@ public:
     DLLEXPORT Random(int seed);
     DLLEXPORT ~Random();
 
+    //! \returns The main generator, or the one set with SetThreadRandom on this thread
     DLLEXPORT static Random* Get();
 
+    //! \brief Makes Get return random on the calling thread
+    //!
+    //! Used by GameWorld to give each world its own generator while it is ticking, as the
+    //! generator isn't thread safe and worlds can tick concurrently
+    //! \param random The generator to use, null to use the main one again
+    //! \returns The previous generator of this thread, which can be null
+    DLLEXPORT static Random* SetThreadRandom(Random* random);
+
     DLLEXPORT int GetSeed();
 
     DLLEXPORT int GetNumber();
@@ -57,4 +66,21 @@ private:
     static Random* staticaccess;
 };
 
+//! \brief Sets a thread specific Random for the lifetime of this object
+class RandomThreadOverride {
+public:
+    RandomThreadOverride(Random& random) : Previous(Random::SetThreadRandom(&random)) {}
+
+    ~RandomThreadOverride()
+    {
+        Random::SetThreadRandom(Previous);
+    }
+
+    RandomThreadOverride(const RandomThreadOverride& other) = delete;
+    RandomThreadOverride& operator=(const RandomThreadOverride& other) = delete;
+
+private:
+    Random* Previous;
+};
+
 } // namespace Leviathan
@@ -293,8 +293,12 @@ DLLEXPORT void Window::Tick(int mspassed)
 
 DLLEXPORT bool Window::Render(int mspassed, int tick, int timeintick)
 {
-    if(LinkedWorld)
-        LinkedWorld->Render(mspassed, tick, timeintick);
+    if(LinkedWorld) {
+
+        // Worlds have their own tick rates so the engine tick isn't used
+        const auto [worldTick, worldTimeInTick] = LinkedWorld->GetTickAndTime();
+        LinkedWorld->Render(mspassed, worldTick, worldTimeInTick);
+    }
 
     // Update GUI before each frame //
     WindowsGui->Render();
@@ -48,6 +48,8 @@ public:
     DLLEXPORT void Tick(int mspassed);
 
     //! This function uses the LinkObjects function objects
+    //! \note tick and timeintick are the engine's, the linked world is rendered using its
+    //! own tick
     DLLEXPORT bool Render(int mspassed, int tick, int timeintick);
 
     //! This function also updates the camera aspect ratio
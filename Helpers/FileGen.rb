@@ -633,6 +633,12 @@ class ComponentState < SFMLSerializeClass
     self.addDeserializeArg "#{name}* referencestate"
   end
 
+  def quantizationFor(member)
+    "STATE_QUANTIZATION::" + (member.Quantize || "None")
+  end
+
+  # The members are written to a bit stream after the type. The first bit tells whether
+  # olderstate was used as a reference in which case only changed members are included
   def genSerializer(f, opts)
 
     f.write "#{export}void #{qualifier opts}AddDataToPacket(sf::Packet &packet, " +
@@ -640,13 +646,36 @@ class ComponentState < SFMLSerializeClass
     if opts.include?(:impl)
       f.puts "{\n"
       f.puts "packet << static_cast<uint16_t>(#{@Type});"
-      f.puts genToPacket + ";"
+      f.puts "const auto* reference = static_cast<const #{@Name}*>(olderstate);"
+      f.puts "BitWriter writer;"
+      f.puts "writer.WriteBool(reference != nullptr);"
+      @Members.each{|a|
+        f.puts "StateQuantization::WriteField(writer, #{a.Name}, " +
+               "reference ? &reference->#{a.Name} : nullptr, #{quantizationFor a});"
+      }
+      f.puts "writer.AppendToPacket(packet);"
       f.puts "}"
     else
       f.puts ";"
     end
   end
 
+  def genDeserializer
+    # The reference is only used if the sender used one
+    str = "BitReader reader(packet);\n"
+    str += "const bool delta = reader.ReadBool();\n"
+    str += "if(delta && !referencestate)\n"
+    str += "    throw Leviathan::InvalidArgument(\"Missing reference state for: '#{@Name}'\");\n"
+    str += "const auto* reference = delta ? referencestate : nullptr;\n"
+
+    @Members.each{|a|
+      str += "StateQuantization::ReadField(reader, #{a.Name}, " +
+             "reference ? &reference->#{a.Name} : nullptr, #{quantizationFor a});\n"
+    }
+
+    str
+  end
+
   def genMethods(f, opts)
 
     super f, opts
@@ -1270,8 +1299,12 @@ END
           f.puts "// Begin of group #{s.RunTick[:group]} //"
         end
         
+        # Each system is its own profiler zone
+        f.puts "{"
+        f.puts "LEVIATHAN_PROFILE_ZONE(\"#{@Name}::#{s.Name}\");"
         f.puts "_#{s.Name}.Run(*this" +
                formatEntitySystemParameters(s.RunTick) + ");"
+        f.puts "}"
       }
       f.puts "}"
     else
@@ -1670,6 +1703,9 @@ END
           # just be able to echo the update message to other clients
           f.puts "    #{c.type}States.DeserializeAndApplyState(id, *#{c.type.downcase}, " +
                  "ticknumber, data, referencetick);"
+          if c.type == "Position"
+            f.puts "    NotifyEntityMoved(id);"
+          end
           f.puts "} else {"
           f.puts %{    LOG_ERROR("GameWorld: received local control states for not created , "}
           f.puts %{        "Component, this is the client's fault");}
@@ -1838,12 +1874,12 @@ end
 
 class Variable
   attr_reader :Name, :Type, :Default, :NonMethodParam, :AngelScriptRef, :AngelScriptUseInstead,
-              :MemberAccess, :NonSerializeParam, :NoConst
+              :MemberAccess, :NonSerializeParam, :NoConst, :Quantize
 
   def initialize(name, type, default: nil, noRef: false, noConst: false, nonMethodParam: false,
                  move: false, serializeas: nil,
                  angelScriptRef: "in", angelScriptUseInstead: nil, memberaccess: nil,
-                 nonserializeparam: false)
+                 nonserializeparam: false, quantize: nil)
 
     @Name = name
     @Type = type
@@ -1875,6 +1911,8 @@ class Variable
     @SerializeAs = serializeas
     @AngelScriptRef = angelScriptRef
     @AngelScriptUseInstead = angelScriptUseInstead
+    # Name of a STATE_QUANTIZATION value, used by component states
+    @Quantize = quantize
   end
 
   def formatDefinition()
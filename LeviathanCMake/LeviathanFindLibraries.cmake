@@ -71,6 +71,11 @@ if(LEVIATHAN_FULL_BUILD)
     "${LEVIATHAN_SRC}/build/ThirdParty/include/bullet"
     )
 
+  # The Bullet headers change the class layouts based on this
+  if(LEVIATHAN_MULTITHREADED_PHYSICS)
+    add_definitions(-DBT_THREADSAFE=1)
+  endif()
+
   # Find SDL2
   if(USE_SDL2)
     find_package(SDL2 REQUIRED)
@@ -2,6 +2,7 @@
 
 #include "Entities/GameWorld.h"
 #include "Entities/Components.h"
+#include "Entities/PositionInterpolation.h"
 #include "Entities/StateInterpolator.h"
 #include "Handlers/ObjectLoader.h"
 
@@ -147,6 +148,45 @@ TEST_CASE("PositionStateSystem creates state objects", "[entity]"){
     }
 }
 
+TEST_CASE("PositionStateSystem only checks moved entities", "[entity]"){
+
+    PartialEngine<false> engine;
+
+    StateHolder<PositionState> PositionStates;
+
+    PositionStateSystem _PositionStateSystem;
+
+    ComponentHolder<Position> ComponentPosition;
+
+    StandardWorld dummyWorld(nullptr);
+    dummyWorld.Init(WorldNetworkSettings::GetSettingsForHybrid(), nullptr);
+
+    ObjectID first = 36;
+    ObjectID second = 37;
+
+    ComponentPosition.ConstructNew(first,
+        Position::Data{Float3(0, 1, 2), Float4::IdentityQuaternion()});
+    ComponentPosition.ConstructNew(second,
+        Position::Data{Float3(0, 1, 2), Float4::IdentityQuaternion()});
+
+    // Destroyed entities can be in the list
+    std::vector<ObjectID> moved = {second, 50};
+
+    _PositionStateSystem.Run(
+        dummyWorld, ComponentPosition.GetIndex(), &moved, PositionStates, 1);
+
+    CHECK(PositionStates.GetNumberOfEntitiesWithStates() == 1);
+    CHECK(!PositionStates.GetEntityStates(first));
+    CHECK(PositionStates.GetEntityStates(second));
+
+    // Without the list everything is checked
+    _PositionStateSystem.Run(
+        dummyWorld, ComponentPosition.GetIndex(), nullptr, PositionStates, 2);
+
+    CHECK(PositionStates.GetNumberOfEntitiesWithStates() == 2);
+    CHECK(PositionStates.GetEntityStates(first));
+}
+
 TEST_CASE("PositionStateSystem single state is interpolated", "[entity]"){
 
     PartialEngine<false> engine;
@@ -374,3 +414,334 @@ TEST_CASE("PositionStateSystem multiple states with gaps can be interpolated", "
 }
 
 
+
+TEST_CASE("StateHolder keeps the newest states", "[entity]"){
+
+    PartialEngine<false> engine;
+
+    StateHolder<PositionState> PositionStates;
+
+    PositionStateSystem _PositionStateSystem;
+
+    ComponentHolder<Position> ComponentPosition;
+
+    StandardWorld dummyWorld(nullptr);
+    dummyWorld.Init(WorldNetworkSettings::GetSettingsForHybrid(), nullptr);
+
+    ObjectID id = 12;
+
+    auto pos = ComponentPosition.ConstructNew(id,
+        Position::Data{Float3(0, 0, 0), Float4::IdentityQuaternion()});
+
+    const int lastTick = KEPT_STATES_COUNT + 2;
+
+    for(int tick = 1; tick <= lastTick; ++tick){
+
+        pos->Members._Position = Float3(tick, 0, 0);
+        pos->Marked = true;
+
+        _PositionStateSystem.Run(dummyWorld, ComponentPosition.GetIndex(), PositionStates,
+            tick);
+    }
+
+    auto* entityStates = PositionStates.GetEntityStates(id);
+    REQUIRE(entityStates);
+
+    CHECK(PositionStates.GetHistorySize() == KEPT_STATES_COUNT);
+    CHECK(entityStates->GetNumberOfStates() == KEPT_STATES_COUNT);
+    CHECK(entityStates->GetNewestTick() == lastTick);
+
+    // The oldest states have been replaced
+    CHECK(!entityStates->GetState(1));
+    CHECK(!entityStates->GetState(2));
+
+    REQUIRE(entityStates->GetOldest());
+    CHECK(entityStates->GetOldest()->TickNumber == 3);
+    CHECK(entityStates->GetOldest()->_Position == Float3(3, 0, 0));
+
+    REQUIRE(entityStates->GetState(lastTick));
+    CHECK(entityStates->GetState(lastTick)->_Position == Float3(lastTick, 0, 0));
+
+    REQUIRE(entityStates->GetMatchingOrNewer(1));
+    CHECK(entityStates->GetMatchingOrNewer(1)->TickNumber == 3);
+    CHECK(!entityStates->GetMatchingOrNewer(lastTick + 1));
+
+    SECTION("States older than the history are not stored"){
+
+        pos->Members._Position = Float3(100, 0, 0);
+        pos->Marked = true;
+
+        CHECK(!PositionStates.CreateStateIfChanged(id, *pos, 2));
+        CHECK(entityStates->GetNumberOfStates() == KEPT_STATES_COUNT);
+        CHECK(entityStates->GetState(lastTick)->_Position == Float3(lastTick, 0, 0));
+    }
+
+    SECTION("History length can be configured"){
+
+        StateHolder<PositionState> shortStates(2);
+
+        _PositionStateSystem.Run(dummyWorld, ComponentPosition.GetIndex(), shortStates, 1);
+
+        pos->Members._Position = Float3(0, 1, 0);
+        pos->Marked = true;
+        _PositionStateSystem.Run(dummyWorld, ComponentPosition.GetIndex(), shortStates, 2);
+
+        pos->Members._Position = Float3(0, 2, 0);
+        pos->Marked = true;
+        _PositionStateSystem.Run(dummyWorld, ComponentPosition.GetIndex(), shortStates, 3);
+
+        REQUIRE(shortStates.GetEntityStates(id));
+        CHECK(shortStates.GetEntityStates(id)->GetNumberOfStates() == 2);
+        CHECK(!shortStates.GetEntityStates(id)->GetState(1));
+        CHECK(shortStates.GetEntityStates(id)->GetState(3));
+    }
+}
+
+TEST_CASE("StateHolder keeps the newest states when ticks have gaps", "[entity]"){
+
+    PartialEngine<false> engine;
+
+    StateHolder<PositionState> PositionStates;
+
+    ComponentHolder<Position> ComponentPosition;
+
+    ObjectID id = 12;
+
+    auto pos = ComponentPosition.ConstructNew(id,
+        Position::Data{Float3(0, 0, 0), Float4::IdentityQuaternion()});
+
+    // Many of these would go to the same slot if the slot was picked by the tick
+    const std::vector<int> ticks = {1, 3, 6, 11, 16, 21, 26};
+
+    for(int tick : ticks){
+
+        pos->Members._Position = Float3(tick, 0, 0);
+        REQUIRE(PositionStates.CreateStateIfChanged(id, *pos, tick));
+    }
+
+    auto* entityStates = PositionStates.GetEntityStates(id);
+    REQUIRE(entityStates);
+
+    CHECK(entityStates->GetNumberOfStates() == KEPT_STATES_COUNT);
+    CHECK(entityStates->GetNewestTick() == 26);
+
+    const size_t firstKept = ticks.size() - KEPT_STATES_COUNT;
+
+    for(size_t i = 0; i < ticks.size(); ++i){
+
+        const auto* state = entityStates->GetState(ticks[i]);
+
+        if(i < firstKept){
+            CHECK(!state);
+            continue;
+        }
+
+        REQUIRE(state);
+        CHECK(state->_Position == Float3(ticks[i], 0, 0));
+    }
+
+    REQUIRE(entityStates->GetOldest());
+    CHECK(entityStates->GetOldest()->TickNumber == ticks[firstKept]);
+
+    REQUIRE(entityStates->GetMatchingOrNewer(12));
+    CHECK(entityStates->GetMatchingOrNewer(12)->TickNumber == 16);
+
+    SECTION("A late state fills a gap by replacing the oldest one"){
+
+        pos->Members._Position = Float3(100, 0, 0);
+        REQUIRE(PositionStates.CreateStateIfChanged(id, *pos, 20));
+
+        CHECK(entityStates->GetNumberOfStates() == KEPT_STATES_COUNT);
+        CHECK(!entityStates->GetState(ticks[firstKept]));
+        REQUIRE(entityStates->GetState(20));
+        CHECK(entityStates->GetState(20)->_Position == Float3(100, 0, 0));
+
+        // The newest state doesn't change
+        CHECK(entityStates->GetNewestTick() == 26);
+        CHECK(entityStates->GetNewest()->_Position == Float3(26, 0, 0));
+    }
+}
+
+TEST_CASE("StateHolder doesn't decode a delta without its reference", "[entity]"){
+
+    PartialEngine<false> engine;
+
+    StateHolder<PositionState> PositionStates;
+
+    ObjectID id = 12;
+
+    PositionState first(1, Float3(1, 0, 0), Float4::IdentityQuaternion());
+    PositionState second(2, Float3(2, 0, 0), Float4::IdentityQuaternion());
+
+    // The component type is read by the world before it gets to the StateHolder
+    const auto makeData = [](const PositionState& state, PositionState* reference){
+        sf::Packet packet;
+        state.AddDataToPacket(packet, reference);
+
+        uint16_t type;
+        packet >> type;
+        REQUIRE(packet);
+        return packet;
+    };
+
+    sf::Packet data = makeData(first, nullptr);
+    PositionStates.DeserializeState(id, 1, data, -1);
+
+    auto* entityStates = PositionStates.GetEntityStates(id);
+    REQUIRE(entityStates);
+    REQUIRE(entityStates->GetState(1));
+
+    SECTION("Delta against a stored state is decoded"){
+
+        data = makeData(second, &first);
+        PositionStates.DeserializeState(id, 2, data, 1);
+
+        REQUIRE(entityStates->GetState(2));
+        CHECK(entityStates->GetState(2)->_Position.Compare(Float3(2, 0, 0), 0.01f));
+    }
+
+    SECTION("Missing reference fails instead of using another state"){
+
+        PositionState missing(5, Float3(50, 0, 0), Float4::IdentityQuaternion());
+
+        data = makeData(second, &missing);
+        CHECK_THROWS_AS(PositionStates.DeserializeState(id, 6, data, 5), InvalidState);
+
+        CHECK(!entityStates->GetState(6));
+        CHECK(entityStates->GetNewestTick() == 1);
+        CHECK(entityStates->GetNumberOfStates() == 1);
+    }
+}
+
+TEST_CASE("PositionInterpolationBatch matches Lerp and Slerp", "[entity]"){
+
+    INFO("Implementation: " << BulkMath::GetImplementationName());
+
+    PositionInterpolationBatch batch;
+
+    std::vector<std::tuple<Float3, Float4, Float3, Float4, float>> entities;
+
+    // Not a multiple of the vector width to also test the remainder loop
+    for(int i = 0; i < 37; ++i){
+
+        const Float3 start(i * 1.5f, std::sin(i * 0.3f), -2.f * i);
+        const Float3 end(i * 0.5f, std::cos(i * 0.7f) * 10.f, 4.f);
+
+        const Float4 startRotation = Float4(std::sin(i * 0.1f), std::cos(i * 0.2f),
+            0.3f, 1.f).Normalize();
+
+        // Mix of small rotations, large rotations and ones taking the other way around
+        Float4 endRotation = (i % 3 == 0) ?
+            Float4(startRotation.X + 0.01f, startRotation.Y, startRotation.Z,
+                startRotation.W).Normalize() :
+            Float4(std::cos(i * 0.9f), 0.5f, std::sin(i * 1.3f), -0.2f).Normalize();
+
+        if(i % 4 == 0)
+            endRotation = -endRotation;
+
+        const float progress = (i % 10) / 9.f;
+
+        entities.push_back(std::make_tuple(start, startRotation, end, endRotation,
+                progress));
+
+        if(i % 5 == 0){
+            batch.Add(start, startRotation);
+        } else {
+            batch.Add(start, startRotation, end, endRotation, progress);
+        }
+    }
+
+    batch.Run();
+
+    REQUIRE(batch.GetCount() == entities.size());
+
+    for(size_t i = 0; i < entities.size(); ++i){
+
+        const auto& entity = entities[i];
+
+        if(i % 5 == 0){
+
+            CHECK(batch.GetPosition(i) == std::get<0>(entity));
+            CHECK(batch.GetOrientation(i) == std::get<1>(entity));
+            continue;
+        }
+
+        const float progress = std::get<4>(entity);
+
+        CHECK(batch.GetPosition(i) == std::get<0>(entity).Lerp(std::get<2>(entity), progress));
+        CHECK(batch.GetOrientation(i) ==
+            std::get<1>(entity).Slerp(std::get<3>(entity), progress));
+    }
+
+    batch.Clear();
+    CHECK(batch.GetCount() == 0);
+}
+
+TEST_CASE("Interpolating many entity positions", "[.benchmark][entity]"){
+
+    PartialEngine<false> engine;
+
+    StateHolder<PositionState> PositionStates;
+
+    ComponentHolder<Position> ComponentPosition;
+
+    constexpr ObjectID ENTITY_COUNT = 10000;
+
+    INFO("Entities: " << ENTITY_COUNT << ", batch: " <<
+        BulkMath::GetImplementationName());
+
+    for(ObjectID id = 1; id <= ENTITY_COUNT; ++id){
+
+        auto pos = ComponentPosition.ConstructNew(id, Position::Data{Float3(id, 0, 0),
+                Float4(0.1f * (id % 7), 0.f, 0.f, 1.f).Normalize()});
+
+        PositionStates.CreateStateIfChanged(id, *pos, 1);
+
+        pos->Members._Position = Float3(id, 1, 0);
+        pos->Members._Orientation = Float4(0.f, 0.1f * (id % 11), 0.f, 1.f).Normalize();
+        PositionStates.CreateStateIfChanged(id, *pos, 2);
+    }
+
+    // Starts the interpolation of all the entities
+    for(ObjectID id = 1; id <= ENTITY_COUNT; ++id)
+        StateInterpolator::Interpolate(PositionStates, id, ComponentPosition.Find(id), 1, 0);
+
+    float total = 0.f;
+
+    BENCHMARK("One entity at a time"){
+
+        for(ObjectID id = 1; id <= ENTITY_COUNT; ++id){
+
+            const auto interpolated = StateInterpolator::Interpolate(PositionStates, id,
+                ComponentPosition.Find(id), 1, TICKSPEED / 2);
+
+            total += std::get<1>(interpolated)._Orientation.W;
+        }
+    }
+
+    PositionInterpolationBatch batch;
+
+    BENCHMARK("Batched"){
+
+        batch.Clear();
+
+        for(ObjectID id = 1; id <= ENTITY_COUNT; ++id){
+
+            PositionState* start;
+            PositionState* end;
+            float progress;
+
+            StateInterpolator::FindStates(PositionStates, id, ComponentPosition.Find(id),
+                1, TICKSPEED / 2, start, end, progress);
+
+            batch.Add(start->_Position, start->_Orientation, end->_Position,
+                end->_Orientation, progress);
+        }
+
+        batch.Run();
+
+        total += batch.GetOrientation(ENTITY_COUNT - 1).W;
+    }
+
+    CHECK(total != 0.f);
+}
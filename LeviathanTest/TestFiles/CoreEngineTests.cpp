@@ -1,10 +1,16 @@
 #include "../PartialEngine.h"
+#include "Application/MainLoopWaiter.h"
 #include "Engine.h"
+#include "TimeIncludes.h"
 
 #include "Utility/Random.h"
 
+#include "SFML/Network/IpAddress.hpp"
+
 #include "catch.hpp"
 
+#include <thread>
+
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
@@ -215,3 +221,78 @@ TEST_CASE("Random gives values between the correct things", "[engine][random]")
         }
     }
 }
+
+TEST_CASE("MainLoopWaiter wait ends on timeout, wake or socket data", "[engine][networking]")
+{
+    MainLoopWaiter waiter;
+    REQUIRE(waiter.Init());
+
+    const auto start = Time::GetTimeMs64();
+
+    SECTION("Timeout")
+    {
+        CHECK(!waiter.Wait(20, nullptr));
+        CHECK(Time::GetTimeMs64() - start >= 15);
+    }
+
+    SECTION("Wake before waiting")
+    {
+        waiter.Wake();
+        CHECK(waiter.Wait(5000, nullptr));
+        CHECK(Time::GetTimeMs64() - start < 2500);
+    }
+
+    SECTION("Wake from another thread")
+    {
+        std::thread waker([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            waiter.Wake();
+        });
+
+        CHECK(waiter.Wait(5000, nullptr));
+        CHECK(Time::GetTimeMs64() - start < 2500);
+
+        waker.join();
+    }
+
+    SECTION("Multiple wakes are handled by one wait")
+    {
+        waiter.Wake();
+        waiter.Wake();
+        waiter.Wake();
+
+        CHECK(waiter.Wait(5000, nullptr));
+        CHECK(!waiter.Wait(20, nullptr));
+
+        // And a later wake still works
+        waiter.Wake();
+        CHECK(waiter.Wait(5000, nullptr));
+    }
+
+    SECTION("Socket with data")
+    {
+        sf::UdpSocket receiver;
+        REQUIRE(receiver.bind(sf::Socket::AnyPort, sf::IpAddress::LocalHost) ==
+                sf::Socket::Done);
+        receiver.setBlocking(false);
+
+        CHECK(!waiter.Wait(20, &receiver));
+
+        sf::UdpSocket sender;
+        const char data = 1;
+        REQUIRE(sender.send(&data, sizeof(data), sf::IpAddress::LocalHost,
+                    receiver.getLocalPort()) == sf::Socket::Done);
+
+        const auto sent = Time::GetTimeMs64();
+        CHECK(waiter.Wait(5000, &receiver));
+        CHECK(Time::GetTimeMs64() - sent < 2500);
+
+        // The waiter doesn't read the socket
+        char received;
+        std::size_t receivedSize;
+        sf::IpAddress address;
+        unsigned short port;
+        CHECK(receiver.receive(&received, sizeof(received), receivedSize, address, port) ==
+              sf::Socket::Done);
+    }
+}
@@ -55,6 +55,18 @@ TEST_CASE("Script can register custom entity type and do stuff with it", "[scrip
         CHECK(returned2.Value == 141);
     }
 
+    SECTION("Components can be iterated with index views")
+    {
+        world.Tick(1);
+
+        ssetup.SetEntrypoint("VerifyRunResultWithView");
+
+        auto returned2 = exec.RunScript<int>(mod, ssetup, static_cast<GameWorld*>(&world));
+
+        CHECK(returned2.Result == SCRIPT_RUN_RESULT::Success);
+        CHECK(returned2.Value == 141);
+    }
+
     SECTION("Destroying entity removes it")
     {
         // This creates the cached components //
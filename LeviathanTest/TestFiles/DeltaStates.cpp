@@ -1,29 +1,413 @@
 #include "Entities/GameWorld.h"
 #include "Generated/ComponentStates.h"
 #include "Engine.h"
+#include "Common/BitStream.h"
 #include "Common/SFMLPackets.h"
 #include "Entities/Components.h"
+#include "Entities/StateQuantization.h"
 
 #include "../PartialEngine.h"
 
 #include "catch.hpp"
 
+#include <cmath>
+#include <random>
+
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
+namespace {
 
-TEST_CASE("Positionable delta state interpolation", "[networking][entity]"){
+//! \brief Reads a PositionState written with AddDataToPacket
+PositionState ReadPositionState(sf::Packet& packet, PositionState* reference)
+{
+    uint16_t type;
+    packet >> type;
+    REQUIRE(packet);
+    REQUIRE(type == static_cast<uint16_t>(COMPONENT_TYPE::Position));
 
+    return PositionState(reference, packet);
 }
 
-TEST_CASE("Position state through packet and interpolate", "[networking][entity]")
+//! \returns The amount of bytes a state takes in a packet
+size_t GetStateBytes(const PositionState& state, PositionState* reference)
+{
+    sf::Packet packet;
+    state.AddDataToPacket(packet, reference);
+    return packet.getDataSize();
+}
+
+//! \returns Random unit quaternion
+Float4 RandomRotation(std::mt19937& random)
+{
+    std::normal_distribution<float> distribution;
+
+    while(true) {
+
+        const Float4 value(distribution(random), distribution(random), distribution(random),
+            distribution(random));
+
+        if(value.Length() > 0.01f)
+            return value.Normalize();
+    }
+}
+
+//! \returns The largest component difference of two quaternions, q and -q are the same
+float RotationError(const Float4& first, const Float4& second)
+{
+    const float sign = first.Dot(second) < 0 ? -1.f : 1.f;
+
+    return std::max({std::abs(first.X - sign * second.X), std::abs(first.Y - sign * second.Y),
+        std::abs(first.Z - sign * second.Z), std::abs(first.W - sign * second.W)});
+}
+
+} // namespace
+
+TEST_CASE("BitWriter and BitReader round trip values", "[networking]")
+{
+    BitWriter writer;
+
+    writer.WriteBool(true);
+    writer.Write(5, 3);
+    writer.Write(0xABCDE, 20);
+    writer.WriteSigned(-3, 4);
+    writer.WriteFloat(1.5f);
+    writer.Write(0xFFFFFFFF, 32);
+    writer.WriteSigned(-100000, 18);
+
+    CHECK(writer.GetBitCount() == 1 + 3 + 20 + 4 + 32 + 32 + 18);
+    CHECK(writer.GetByteCount() == 14);
+
+    SECTION("From a buffer")
+    {
+        BitReader reader(writer.GetBytes().data(), writer.GetByteCount());
+
+        CHECK(reader.ReadBool());
+        CHECK(reader.Read(3) == 5);
+        CHECK(reader.Read(20) == 0xABCDE);
+        CHECK(reader.ReadSigned(4) == -3);
+        CHECK(reader.ReadFloat() == 1.5f);
+        CHECK(reader.Read(32) == 0xFFFFFFFF);
+        CHECK(reader.ReadSigned(18) == -100000);
+        CHECK(reader.IsValid());
+
+        // Only the padding is left
+        CHECK(reader.Read(2) == 0);
+        CHECK(reader.IsValid());
+
+        CHECK(reader.Read(1) == 0);
+        CHECK(!reader.IsValid());
+    }
+
+    SECTION("From a packet takes only the needed bytes")
+    {
+        sf::Packet packet;
+        writer.AppendToPacket(packet);
+        packet << static_cast<int32_t>(42);
+
+        {
+            BitReader reader(packet);
+
+            CHECK(reader.ReadBool());
+            CHECK(reader.Read(3) == 5);
+            CHECK(reader.Read(20) == 0xABCDE);
+            CHECK(reader.ReadSigned(4) == -3);
+            CHECK(reader.ReadFloat() == 1.5f);
+            CHECK(reader.Read(32) == 0xFFFFFFFF);
+            CHECK(reader.ReadSigned(18) == -100000);
+            CHECK(reader.IsValid());
+        }
+
+        int32_t after;
+        packet >> after;
+        REQUIRE(packet);
+        CHECK(after == 42);
+
+        BitReader reader(packet);
+        reader.Read(1);
+        CHECK(!reader.IsValid());
+        CHECK(!packet);
+    }
+}
+
+TEST_CASE("Quantized positions stay within the error bound", "[networking]")
+{
+    StateQuantization::SetSettings(StateQuantizationSettings());
+
+    const float maxError = StateQuantization::GetPositionMaxError();
+    CHECK(maxError <= StateQuantizationSettings().PositionPrecision);
+    CHECK(StateQuantization::GetPositionBits() == 22);
+
+    std::mt19937 random(4);
+    std::uniform_real_distribution<float> distribution(-4096.f, 4096.f);
+
+    for(int i = 0; i < 10000; ++i) {
+
+        const Float3 position(distribution(random), distribution(random), distribution(random));
+
+        uint32_t quantized[3];
+        REQUIRE(StateQuantization::QuantizePosition(position, quantized));
+
+        const auto result = StateQuantization::DequantizePosition(quantized);
+
+        // A little bit of extra for the float rounding of the result
+        CHECK(std::abs(result.X - position.X) <= maxError * 1.01f);
+        CHECK(std::abs(result.Y - position.Y) <= maxError * 1.01f);
+        CHECK(std::abs(result.Z - position.Z) <= maxError * 1.01f);
+
+        // The receiver must get the same values when quantizing the result for deltas to work
+        uint32_t requantized[3];
+        REQUIRE(StateQuantization::QuantizePosition(result, requantized));
+        CHECK(requantized[0] == quantized[0]);
+        CHECK(requantized[1] == quantized[1]);
+        CHECK(requantized[2] == quantized[2]);
+    }
+
+    uint32_t quantized[3];
+    CHECK(!StateQuantization::QuantizePosition(Float3(0, 5000, 0), quantized));
+    CHECK(StateQuantization::QuantizePosition(Float3(-4096, 4096, 0), quantized));
+
+    SECTION("Custom bounds")
+    {
+        StateQuantizationSettings settings;
+        settings.WorldMin = Float3(-100, 0, -100);
+        settings.WorldMax = Float3(100, 50, 100);
+        settings.PositionPrecision = 0.01f;
+        StateQuantization::SetSettings(settings);
+
+        CHECK(StateQuantization::GetPositionBits() == 14);
+
+        const Float3 position(12.345f, 0.5f, -99.99f);
+        REQUIRE(StateQuantization::QuantizePosition(position, quantized));
+
+        const auto result = StateQuantization::DequantizePosition(quantized);
+        CHECK(result.X == Approx(position.X).margin(0.01f));
+        CHECK(result.Y == Approx(position.Y).margin(0.01f));
+        CHECK(result.Z == Approx(position.Z).margin(0.01f));
+
+        CHECK(!StateQuantization::QuantizePosition(Float3(0, -1, 0), quantized));
+
+        StateQuantization::SetSettings(StateQuantizationSettings());
+    }
+}
+
+TEST_CASE("Smallest three quaternions stay within the error bound", "[networking]")
+{
+    StateQuantization::SetSettings(StateQuantizationSettings());
+
+    // A little bit of extra for the float rounding of the result
+    const float maxError = StateQuantization::GetRotationMaxError() * 1.01f;
+
+    std::mt19937 random(7);
+
+    for(int i = 0; i < 10000; ++i) {
+
+        const auto rotation = RandomRotation(random);
+
+        const auto quantized = StateQuantization::QuantizeRotation(rotation);
+        const auto result = StateQuantization::DequantizeRotation(quantized);
+
+        CHECK(result.IsNormalized());
+        CHECK(RotationError(rotation, result) <= maxError);
+    }
+
+    // Axis aligned rotations
+    for(const auto& rotation : {Float4::IdentityQuaternion(), Float4(1, 0, 0, 0),
+            Float4(0, -1, 0, 0), Float4(0, 0, 0.70710678f, 0.70710678f)}) {
+
+        const auto result = StateQuantization::DequantizeRotation(
+            StateQuantization::QuantizeRotation(rotation));
+
+        CHECK(RotationError(rotation, result) <= maxError);
+    }
+
+    SECTION("More bits are more precise")
+    {
+        StateQuantizationSettings settings;
+        settings.RotationBits = 16;
+        StateQuantization::SetSettings(settings);
+
+        const auto rotation = RandomRotation(random);
+        const auto result = StateQuantization::DequantizeRotation(
+            StateQuantization::QuantizeRotation(rotation));
+
+        CHECK(RotationError(rotation, result) <=
+              StateQuantization::GetRotationMaxError() * 1.01f);
+        CHECK(StateQuantization::GetRotationMaxError() < 0.0001f);
+
+        StateQuantization::SetSettings(StateQuantizationSettings());
+    }
+}
+
+TEST_CASE("Positionable delta state interpolation", "[networking][entity]")
 {
+    StateQuantization::SetSettings(StateQuantizationSettings());
+
+    PositionState first(1, Float3(0, 0, 0), Float4::IdentityQuaternion());
+    PositionState second(2, Float3(10, 0, -10), Float4::IdentityQuaternion());
+
+    sf::Packet packet;
+    second.AddDataToPacket(packet, &first);
+
+    auto received = ReadPositionState(packet, &first);
+    received.TickNumber = 2;
+
+    const auto halfway = first.Interpolate(received, 0.5f);
 
+    CHECK(halfway._Position.X == Approx(5).margin(0.01f));
+    CHECK(halfway._Position.Y == Approx(0).margin(0.01f));
+    CHECK(halfway._Position.Z == Approx(-5).margin(0.01f));
+    CHECK(RotationError(halfway._Orientation, Float4::IdentityQuaternion()) < 0.01f);
 }
 
-TEST_CASE("Position state fill missing data", "[networking][entity"){
+TEST_CASE("Position state through packet and interpolate", "[networking][entity]")
+{
+    StateQuantization::SetSettings(StateQuantizationSettings());
+
+    const float positionError = StateQuantization::GetPositionMaxError() * 1.01f;
+    const float rotationError = StateQuantization::GetRotationMaxError() * 1.01f;
+
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> positions(-1000.f, 1000.f);
+
+    SECTION("Full states")
+    {
+        for(int i = 0; i < 100; ++i) {
+
+            const PositionState state(i, Float3(positions(random), positions(random),
+                                             positions(random)),
+                RandomRotation(random));
+
+            sf::Packet packet;
+            state.AddDataToPacket(packet, nullptr);
+
+            // A reference on the receiving side must not matter for a full state
+            PositionState unrelated(0, Float3(1, 2, 3), Float4::IdentityQuaternion());
+            const auto received = ReadPositionState(packet, &unrelated);
+
+            CHECK(std::abs(received._Position.X - state._Position.X) <= positionError);
+            CHECK(std::abs(received._Position.Y - state._Position.Y) <= positionError);
+            CHECK(std::abs(received._Position.Z - state._Position.Z) <= positionError);
+            CHECK(RotationError(received._Orientation, state._Orientation) <= rotationError);
+
+            CHECK(packet.endOfPacket());
+        }
+    }
+
+    SECTION("Delta states against the received reference")
+    {
+        PositionState sentReference(0, Float3(100, 20, -300), RandomRotation(random));
+
+        sf::Packet packet;
+        sentReference.AddDataToPacket(packet, nullptr);
+        auto receivedReference = ReadPositionState(packet, nullptr);
+
+        std::uniform_real_distribution<float> movement(-3.f, 3.f);
+
+        for(int i = 0; i < 100; ++i) {
 
+            // Alternate between small movements, teleports and not moving
+            Float3 position = sentReference._Position;
+
+            if(i % 3 == 0) {
+                position += Float3(movement(random), movement(random), movement(random));
+            } else if(i % 3 == 1) {
+                position = Float3(positions(random), positions(random), positions(random));
+            }
+
+            const Float4 rotation =
+                i % 2 == 0 ? sentReference._Orientation : RandomRotation(random);
+
+            const PositionState state(i + 1, position, rotation);
+
+            packet.clear();
+            state.AddDataToPacket(packet, &sentReference);
+            const auto received = ReadPositionState(packet, &receivedReference);
+
+            CHECK(packet.endOfPacket());
+
+            CHECK(std::abs(received._Position.X - position.X) <= positionError);
+            CHECK(std::abs(received._Position.Y - position.Y) <= positionError);
+            CHECK(std::abs(received._Position.Z - position.Z) <= positionError);
+            CHECK(RotationError(received._Orientation, rotation) <= rotationError);
+        }
+    }
+
+    SECTION("Positions outside the world bounds are sent exactly")
+    {
+        PositionState reference(1, Float3(4000, 0, 0), Float4::IdentityQuaternion());
+        const PositionState state(2, Float3(5000.123f, -7000.5f, 1), Float4(0, 1, 0, 0));
+
+        sf::Packet packet;
+        state.AddDataToPacket(packet, &reference);
+
+        PositionState receivedReference = reference;
+        const auto received = ReadPositionState(packet, &receivedReference);
+
+        CHECK(received._Position == state._Position);
+    }
+
+    SECTION("Delta without a reference fails")
+    {
+        PositionState reference(1, Float3(0), Float4::IdentityQuaternion());
+        const PositionState state(2, Float3(1), Float4::IdentityQuaternion());
+
+        sf::Packet packet;
+        state.AddDataToPacket(packet, &reference);
+
+        uint16_t type;
+        packet >> type;
+
+        CHECK_THROWS_AS(PositionState(nullptr, packet), InvalidArgument);
+    }
 }
 
+TEST_CASE("Position state bytes per entity", "[networking][entity]")
+{
+    StateQuantization::SetSettings(StateQuantizationSettings());
+
+    // The type is sent with every state
+    constexpr size_t typeBytes = sizeof(uint16_t);
+
+    // The old format sent full floats
+    constexpr size_t unquantizedBytes = typeBytes + 3 * sizeof(float) + 4 * sizeof(float);
+
+    PositionState reference(1, Float3(100, 20, -300), Float4(0, 0.6f, 0, 0.8f));
+
+    const auto fullBytes = GetStateBytes(reference, nullptr);
+    const auto unchangedBytes = GetStateBytes(reference, &reference);
+
+    const auto movedBytes = GetStateBytes(
+        PositionState(2, reference._Position + Float3(0.2f, 0, -0.3f), reference._Orientation),
+        &reference);
+
+    const auto movedAndTurnedBytes =
+        GetStateBytes(PositionState(2, reference._Position + Float3(0.2f, 0, -0.3f),
+                          Float4(0, 0.8f, 0, 0.6f)),
+            &reference);
 
+    const auto teleportedBytes = GetStateBytes(
+        PositionState(2, Float3(-2000, 50, 1000), reference._Orientation), &reference);
 
+    INFO("unquantized: " << unquantizedBytes << " full: " << fullBytes
+                         << " unchanged: " << unchangedBytes << " moved: " << movedBytes
+                         << " moved and turned: " << movedAndTurnedBytes
+                         << " teleported: " << teleportedBytes);
+
+    CHECK(unquantizedBytes == 30);
+    CHECK(fullBytes == typeBytes + 13);
+    CHECK(unchangedBytes == typeBytes + 1);
+    CHECK(movedBytes == typeBytes + 5);
+    CHECK(movedAndTurnedBytes == typeBytes + 9);
+    CHECK(teleportedBytes == typeBytes + 9);
+}
+
+TEST_CASE("Position state fill missing data", "[networking][entity]")
+{
+    PositionState first(1, Float3(1, 2, 3), Float4::IdentityQuaternion());
+    PositionState second(2, Float3(4, 5, 6), Float4::IdentityQuaternion());
+
+    // Position states have no separately sent parts so they are always complete
+    CHECK(second.FillMissingData(first));
+    CHECK(second._Position == Float3(4, 5, 6));
+}
@@ -5,9 +5,13 @@
 #include "Handlers/ObjectLoader.h"
 
 #include "Generated/StandardWorld.h"
+#include "Utility/Random.h"
 
 #include "catch.hpp"
 
+#include <atomic>
+#include <thread>
+
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
@@ -59,3 +63,123 @@ TEST_CASE("Entity parent destruction deletes children", "[entity]"){
     TargetWorld.Release();
     CHECK(TargetWorld.GetEntityCount() == 0);
 }
+
+TEST_CASE("World tasks run immediately or before the next tick", "[entity]")
+{
+    PartialEngine<false> engine;
+
+    StandardWorld world(nullptr);
+
+    // The clock starts at 0 before Init so explicit times can be used
+    world.SetTickInterval(20);
+
+    SECTION("Tasks run immediately when the world isn't ticking")
+    {
+        bool ran = false;
+        world.RunOnWorld([&]() { ran = true; });
+        CHECK(ran);
+    }
+
+    SECTION("Tasks are queued while another thread is using the world")
+    {
+        std::atomic<bool> holding{false};
+        std::atomic<bool> release{false};
+
+        // The task run by RunOnWorld holds the tick lock until it returns
+        std::thread other([&]() {
+            world.RunOnWorld([&]() {
+                holding = true;
+
+                while(!release)
+                    std::this_thread::yield();
+            });
+        });
+
+        while(!holding)
+            std::this_thread::yield();
+
+        bool ran = false;
+        world.RunOnWorld([&]() { ran = true; });
+        CHECK(!ran);
+
+        release = true;
+        other.join();
+
+        CHECK(!ran);
+
+        // Queued tasks are ran before the next tick
+        CHECK(world.RunPendingTicks(10) == 0);
+        CHECK(ran);
+    }
+
+    world.Release();
+}
+
+TEST_CASE("Concurrently ticked worlds use their own Random", "[entity]")
+{
+    PartialEngine<false> engine;
+
+    StandardWorld first(nullptr);
+    StandardWorld second(nullptr);
+
+    first.SetTickConcurrently(true);
+    second.SetTickConcurrently(true);
+
+    REQUIRE(&first.GetRandom() != &second.GetRandom());
+
+    first.GetRandom().SetSeed(5);
+    second.GetRandom().SetSeed(5);
+
+    Random* main = Random::Get();
+    REQUIRE(main);
+    const int mainIndex = main->GetIndex();
+
+    constexpr int TICKS = 200;
+
+    const auto tickWorld = [](StandardWorld& world, std::vector<int>& numbers,
+                               bool& usedOwnRandom) {
+        usedOwnRandom = true;
+
+        for(int i = 1; i <= TICKS; ++i) {
+
+            world.RunPendingTicks(i * TICKSPEED);
+
+            world.RunOnWorld([&]() {
+                Random* random = Random::Get();
+
+                if(random != &world.GetRandom())
+                    usedOwnRandom = false;
+
+                numbers.push_back(random->GetNumber());
+            });
+        }
+    };
+
+    std::vector<int> firstNumbers;
+    std::vector<int> secondNumbers;
+    bool firstUsedOwn = false;
+    bool secondUsedOwn = false;
+
+    std::thread firstThread([&]() { tickWorld(first, firstNumbers, firstUsedOwn); });
+    std::thread secondThread([&]() { tickWorld(second, secondNumbers, secondUsedOwn); });
+
+    firstThread.join();
+    secondThread.join();
+
+    CHECK(firstUsedOwn);
+    CHECK(secondUsedOwn);
+
+    CHECK(first.GetTickNumber() == TICKS);
+    CHECK(second.GetTickNumber() == TICKS);
+
+    // Same seeds give the same numbers no matter how the threads were interleaved
+    REQUIRE(firstNumbers.size() == TICKS);
+    CHECK(firstNumbers == secondNumbers);
+
+    // And the main generator wasn't used
+    CHECK(main->GetIndex() == mainIndex);
+    CHECK(Random::Get() == main);
+
+    first.Release();
+    second.Release();
+}
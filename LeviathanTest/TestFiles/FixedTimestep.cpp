@@ -0,0 +1,97 @@
+#include "../PartialEngine.h"
+
+#include "Common/FixedTimestep.h"
+#include "Generated/StandardWorld.h"
+
+#include "catch.hpp"
+
+using namespace Leviathan;
+using namespace Leviathan::Test;
+
+TEST_CASE("FixedTimestep runs steps at the interval", "[engine]")
+{
+    FixedTimestep clock(50, 5, 1000);
+
+    CHECK(clock.Advance(1000) == 0);
+    CHECK(clock.Advance(1049) == 0);
+    CHECK(clock.GetTimeUntilNextStep(1049) == 1);
+
+    CHECK(clock.Advance(1050) == 1);
+    CHECK(clock.GetTimeSinceLastStep(1060) == 10);
+    CHECK(clock.GetTimeUntilNextStep(1060) == 40);
+
+    // Being a bit late doesn't move the schedule
+    CHECK(clock.Advance(1110) == 1);
+    CHECK(clock.GetTimeSinceLastStep(1110) == 10);
+
+    CHECK(clock.GetCatchUpSteps() == 0);
+    CHECK(clock.GetDroppedSteps() == 0);
+}
+
+TEST_CASE("FixedTimestep catches up and drops steps", "[engine]")
+{
+    FixedTimestep clock(50, 3, 0);
+
+    SECTION("Late steps are caught up")
+    {
+        int dropped = -1;
+        CHECK(clock.Advance(120, &dropped) == 2);
+        CHECK(dropped == 0);
+        CHECK(clock.GetCatchUpSteps() == 1);
+        CHECK(clock.GetDroppedSteps() == 0);
+        CHECK(clock.GetTimeSinceLastStep(120) == 20);
+    }
+
+    SECTION("Steps over the limit are dropped")
+    {
+        int dropped = 0;
+        CHECK(clock.Advance(1020, &dropped) == 3);
+        CHECK(clock.GetCatchUpSteps() == 2);
+        CHECK(clock.GetDroppedSteps() == 17);
+
+        // The dropped and ran steps together cover all of the passed time
+        CHECK(dropped == 17);
+        CHECK((dropped + 3) * 50 == 1000);
+
+        // The clock has jumped forward so the next step is on time
+        CHECK(clock.GetTimeSinceLastStep(1020) == 20);
+        CHECK(clock.Advance(1050) == 1);
+    }
+
+    SECTION("Changing the interval")
+    {
+        clock.SetInterval(20);
+        CHECK(clock.Advance(40) == 2);
+        CHECK(clock.GetInterval() == 20);
+    }
+}
+
+TEST_CASE("World tick clock runs pending ticks", "[engine][entity]")
+{
+    PartialEngine<false> engine;
+
+    StandardWorld world(nullptr);
+
+    // The clock starts at 0 before Init so explicit times can be used
+    world.SetTickInterval(20);
+    world.SetMaxCatchUpTicks(3);
+
+    CHECK(world.GetTickInterval() == 20);
+    CHECK(world.RunPendingTicks(10) == 0);
+    CHECK(world.GetTimeUntilNextTick(10) == 10);
+
+    CHECK(world.RunPendingTicks(45) == 2);
+    CHECK(world.GetTickNumber() == 2);
+    CHECK(world.GetCatchUpTickCount() == 1);
+
+    // Stalling past the catch up limit drops ticks but the tick number still follows the
+    // time
+    CHECK(world.RunPendingTicks(1000) == 3);
+    CHECK(world.GetDroppedTickCount() == 45);
+    CHECK(world.GetTickNumber() == 1000 / 20);
+
+    CHECK(world.RunPendingTicks(1020) == 1);
+    CHECK(world.GetTickNumber() == 1020 / 20);
+
+    world.Release();
+}
@@ -176,3 +176,41 @@ TEST_CASE("GameModule publicdefinitions and imports work", "[script][gamemodule]
 
     module->ReleaseScript();
 }
+
+TEST_CASE("GameModuleLoader loads multiple modules with imports", "[script][gamemodule]")
+{
+    PartialEngine<false> engine;
+
+    IDFactory ids;
+    ScriptExecutor exec;
+
+    // Filesystem required for search //
+    FileSystem filesystem;
+    REQUIRE(filesystem.Init(&engine.Log));
+    GameModuleLoader loader;
+    loader.Init();
+
+    std::vector<GameModule::pointer> modules;
+    REQUIRE_NOTHROW(modules = loader.LoadMultiple({"SimpleImportModule", "AccessTestModule"},
+                        ("GameModule test" + std::to_string(__LINE__)).c_str()));
+
+    REQUIRE(modules.size() == 2);
+    REQUIRE(modules[0]);
+    REQUIRE(modules[1]);
+    CHECK(modules[0]->GetName() == "SimpleImportModule");
+    CHECK(modules[1]->GetName() == "AccessTestModule");
+
+    // The import was loaded and built before the module that needs it
+    const auto& times = loader.GetLoadTimes();
+    CHECK(times.find("SimpleExportModule") != times.end());
+    CHECK(times.find("SimpleImportModule") != times.end());
+
+    ScriptRunningSetup setup("TestImportedFunction");
+    auto result = modules[0]->ExecuteOnModule<int>(setup, false, 13);
+
+    CHECK(result.Result == SCRIPT_RUN_RESULT::Success);
+    CHECK(result.Value == 13 * 13);
+
+    for(auto& module : modules)
+        module->ReleaseScript();
+}
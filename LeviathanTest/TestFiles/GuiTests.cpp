@@ -1,6 +1,7 @@
 //! \file Tests for various supporting GUI methods. Doesn't actually
 //! try any rendering or anything like that
 
+#include "GUI/GuiPaintStaging.h"
 #include "GUI/VideoPlayer.h"
 
 #include "../PartialEngine.h"
@@ -38,3 +39,203 @@ TEST_CASE("Leviathan VideoPlayer loads correctly", "[gui][video][xrequired][ogre
 
     sound.Release();
 }
+
+namespace {
+//! Allows running the decoder thread without opening a video
+class DecoderTestVideoPlayer : public VideoPlayer {
+public:
+    using VideoPlayer::AudioDecodeEnded;
+    using VideoPlayer::RunDecoderThread;
+    using VideoPlayer::StopDecoder;
+    using VideoPlayer::StreamValid;
+    using VideoPlayer::VideoDecodeEnded;
+};
+} // namespace
+
+TEST_CASE("VideoPlayer decoder thread marks streams ended on every exit", "[gui][video]")
+{
+    PartialEngine<false> engine;
+
+    DecoderTestVideoPlayer player;
+
+    SECTION("Decoding fails")
+    {
+        // Decode errors clear StreamValid
+        player.StreamValid = false;
+    }
+
+    SECTION("Stopped")
+    {
+        player.StreamValid = true;
+        player.StopDecoder = true;
+    }
+
+    REQUIRE(!player.VideoDecodeEnded);
+    REQUIRE(!player.AudioDecodeEnded);
+
+    std::thread decoder([&]() { player.RunDecoderThread(); });
+    decoder.join();
+
+    CHECK(player.VideoDecodeEnded);
+    CHECK(player.AudioDecodeEnded);
+}
+
+TEST_CASE("PaintStaging merges touching rects", "[gui]")
+{
+    std::vector<PaintRect> rects{{0, 0, 10, 10}, {5, 5, 10, 10}, {50, 50, 2, 2}, {15, 0, 5, 5}};
+
+    PaintStaging::MergeRects(rects);
+
+    REQUIRE(rects.size() == 2);
+    CHECK(std::find(rects.begin(), rects.end(), PaintRect{0, 0, 20, 15}) != rects.end());
+    CHECK(std::find(rects.begin(), rects.end(), PaintRect{50, 50, 2, 2}) != rects.end());
+}
+
+TEST_CASE("PaintStaging uploads only changed rects", "[gui]")
+{
+    constexpr int width = 64;
+    constexpr int height = 32;
+
+    std::vector<uint32_t> painted(width * height, 1);
+    std::vector<uint32_t> texture(width * height, 0);
+
+    PaintStaging staging(0.5f);
+
+    const auto upload = [&](const uint8_t* pixels, int imagewidth, int imageheight,
+                            const std::vector<PaintRect>& rects, bool full) {
+        REQUIRE(imagewidth == width);
+        REQUIRE(imageheight == height);
+
+        for(const auto& rect : rects) {
+            PaintStaging::CopyRect(pixels, width * 4,
+                reinterpret_cast<uint8_t*>(texture.data()), width * 4, rect);
+        }
+    };
+
+    SECTION("First paint is a full upload")
+    {
+        staging.Write(painted.data(), width, height, {{0, 0, 5, 5}});
+
+        CHECK(staging.Read(upload));
+        CHECK(staging.GetFullUploadCount() == 1);
+        CHECK(staging.GetLastUploadBytes() == width * height * 4);
+        CHECK(texture == painted);
+
+        CHECK(!staging.Read(upload));
+    }
+
+    SECTION("Small changes are uploaded alone")
+    {
+        staging.Write(painted.data(), width, height, {{0, 0, width, height}});
+        CHECK(staging.Read(upload));
+
+        painted[2 * width + 3] = 2;
+        painted[20 * width + 40] = 3;
+        staging.Write(painted.data(), width, height, {{3, 2, 1, 1}, {40, 20, 1, 1}});
+
+        // Changes from the earlier frame also need to reach the other staging image
+        painted[10 * width + 10] = 4;
+        staging.Write(painted.data(), width, height, {{10, 10, 1, 1}});
+
+        CHECK(staging.Read(upload));
+        CHECK(staging.GetLastUploadBytes() == 3 * 4);
+        CHECK(staging.GetFullUploadCount() == 1);
+        CHECK(texture == painted);
+    }
+
+    SECTION("Large changes are uploaded fully")
+    {
+        staging.Write(painted.data(), width, height, {{0, 0, width, height}});
+        CHECK(staging.Read(upload));
+
+        for(int y = 0; y < 20; ++y)
+            for(int x = 0; x < width; ++x)
+                painted[y * width + x] = 5;
+
+        staging.Write(painted.data(), width, height, {{0, 0, width, 20}});
+
+        CHECK(staging.Read(upload));
+        CHECK(staging.GetFullUploadCount() == 2);
+        CHECK(texture == painted);
+    }
+
+    SECTION("Rects outside the image are clamped")
+    {
+        staging.Write(painted.data(), width, height, {{0, 0, width, height}});
+        CHECK(staging.Read(upload));
+
+        painted[0] = 6;
+        painted[width * height - 1] = 7;
+        staging.Write(
+            painted.data(), width, height, {{-5, -5, 6, 6}, {width - 1, height - 1, 50, 50}});
+
+        CHECK(staging.Read(upload));
+        CHECK(staging.GetLastUploadBytes() == 2 * 4);
+        CHECK(texture == painted);
+    }
+}
+
+TEST_CASE("PaintStaging uploads everything after a resize", "[gui]")
+{
+    std::vector<uint32_t> small(16 * 8, 1);
+    std::vector<uint32_t> large(64 * 32, 2);
+
+    PaintStaging staging(0.5f);
+
+    int uploadedWidth = 0;
+    int uploadedHeight = 0;
+    std::vector<PaintRect> uploadedRects;
+    bool uploadedFull = false;
+
+    const auto upload = [&](const uint8_t* pixels, int imagewidth, int imageheight,
+                            const std::vector<PaintRect>& rects, bool full) {
+        uploadedWidth = imagewidth;
+        uploadedHeight = imageheight;
+        uploadedRects = rects;
+        uploadedFull = full;
+    };
+
+    staging.Write(large.data(), 64, 32, {{0, 0, 64, 32}});
+    CHECK(staging.Read(upload));
+
+    // Not uploaded before the resize so this shouldn't be seen by the uploader
+    staging.Write(large.data(), 64, 32, {{40, 20, 10, 10}});
+
+    staging.Write(small.data(), 16, 8, {{1, 1, 1, 1}});
+
+    CHECK(staging.Read(upload));
+    CHECK(uploadedWidth == 16);
+    CHECK(uploadedHeight == 8);
+    CHECK(uploadedFull);
+    CHECK(uploadedRects == std::vector<PaintRect>{{0, 0, 16, 8}});
+
+    // Small changes after that are uploaded alone again
+    staging.Write(small.data(), 16, 8, {{1, 1, 1, 1}});
+
+    CHECK(staging.Read(upload));
+    CHECK(!uploadedFull);
+    CHECK(uploadedRects == std::vector<PaintRect>{{1, 1, 1, 1}});
+}
+
+TEST_CASE("PaintStaging full upload threshold is clamped", "[gui]")
+{
+    std::vector<uint32_t> painted(16 * 8, 1);
+
+    PaintStaging staging(5.f);
+
+    bool uploadedFull = false;
+
+    const auto upload = [&](const uint8_t* pixels, int imagewidth, int imageheight,
+                            const std::vector<PaintRect>& rects, bool full) {
+        uploadedFull = full;
+    };
+
+    staging.Write(painted.data(), 16, 8, {{0, 0, 16, 8}});
+    CHECK(staging.Read(upload));
+
+    // The whole image changing is always a full upload
+    staging.Write(painted.data(), 16, 8, {{0, 0, 16, 8}});
+    CHECK(staging.Read(upload));
+    CHECK(uploadedFull);
+    CHECK(staging.GetFullUploadCount() == 2);
+}
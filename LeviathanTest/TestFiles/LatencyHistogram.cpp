@@ -0,0 +1,114 @@
+#include "Statistics/LatencyHistogram.h"
+
+#include "catch.hpp"
+
+using namespace Leviathan;
+
+TEST_CASE("LatencyHistogram buckets keep precision", "[statistics]")
+{
+    SECTION("Small values are exact")
+    {
+        for(int64_t i = 0; i < 64; ++i) {
+            CHECK(LatencyHistogram::GetBucketHighestValue(
+                      LatencyHistogram::GetBucketIndex(i)) == i);
+        }
+    }
+
+    SECTION("Large values are within one part in 32")
+    {
+        for(int64_t value = 64; value < LatencyHistogram::MAX_VALUE; value = value * 3 / 2) {
+
+            const auto index = LatencyHistogram::GetBucketIndex(value);
+            const auto highest = LatencyHistogram::GetBucketHighestValue(index);
+
+            REQUIRE(index < LatencyHistogram::BUCKET_COUNT);
+            CHECK(highest >= value);
+            CHECK(highest - value <= value / 32);
+
+            // Buckets don't overlap
+            CHECK(LatencyHistogram::GetBucketIndex(highest) == index);
+            CHECK(LatencyHistogram::GetBucketIndex(highest + 1) == index + 1);
+        }
+    }
+
+    SECTION("The largest value fits")
+    {
+        CHECK(LatencyHistogram::GetBucketIndex(LatencyHistogram::MAX_VALUE) ==
+              LatencyHistogram::BUCKET_COUNT - 1);
+    }
+}
+
+TEST_CASE("LatencyHistogram percentiles", "[statistics]")
+{
+    LatencyHistogram histogram;
+
+    CHECK(histogram.GetValueAtPercentile(50) == 0);
+
+    for(int64_t i = 1; i <= 1000; ++i)
+        histogram.Record(i * 100);
+
+    CHECK(histogram.GetCount() == 1000);
+    CHECK(histogram.GetMin() == 100);
+    CHECK(histogram.GetMax() == 100000);
+    CHECK(histogram.GetMean() == Approx(50050));
+
+    const auto summary = histogram.GetSummary();
+
+    CHECK(summary.P50 >= 50000);
+    CHECK(summary.P50 <= 50000 + 50000 / 32);
+    CHECK(summary.P95 >= 95000);
+    CHECK(summary.P95 <= 95000 + 95000 / 32);
+    CHECK(summary.P99 >= 99000);
+    CHECK(summary.P99 <= 100000);
+    CHECK(summary.Max == 100000);
+    CHECK(histogram.GetValueAtPercentile(100) == 100000);
+
+    SECTION("Merging combines counts")
+    {
+        LatencyHistogram other;
+        other.Record(5);
+        other.Record(1000000);
+
+        histogram.Merge(other);
+
+        CHECK(histogram.GetCount() == 1002);
+        CHECK(histogram.GetMin() == 5);
+        CHECK(histogram.GetMax() == 1000000);
+    }
+
+    SECTION("Reset clears everything")
+    {
+        histogram.Reset();
+
+        CHECK(histogram.GetCount() == 0);
+        CHECK(histogram.GetMax() == 0);
+        CHECK(histogram.GetValueAtPercentile(99) == 0);
+    }
+}
+
+TEST_CASE("RollingLatencyHistogram drops old intervals", "[statistics]")
+{
+    // 3 intervals of 10 units
+    RollingLatencyHistogram rolling(3, 10);
+
+    rolling.Record(500, 0);
+    rolling.Record(1, 5);
+
+    CHECK(rolling.GetWindow(9).GetCount() == 2);
+
+    rolling.Record(2, 15);
+    rolling.Record(3, 25);
+
+    CHECK(rolling.GetWindow(29).GetCount() == 4);
+    CHECK(rolling.GetSummary(29).Max == 500);
+
+    // The first interval is dropped once the fourth starts
+    CHECK(rolling.GetWindow(30).GetCount() == 2);
+    CHECK(rolling.GetSummary(30).Max == 3);
+
+    // Everything is old after a long pause
+    CHECK(rolling.GetWindow(1000).GetCount() == 0);
+
+    rolling.Record(7, 1001);
+    CHECK(rolling.GetSummary(1001).Max == 7);
+}
@@ -1,3 +1,4 @@
+#include "Common/BulkMath.h"
 #include "Common/Types.h"
 
 #include "catch.hpp"
@@ -37,4 +38,262 @@ TEST_CASE("Quaternion math works", "[math]"){
     const Float3 rotatedLev = levQuat.RotateVector(toRotate);
 
     CHECK(rotatedOgre == rotatedLev);
+
+    SECTION("Quaternion multiply matches Ogre"){
+
+        const Ogre::Quaternion ogreOther(
+            Ogre::Radian(1.5f), Ogre::Vector3(-0.25, 1, 2).normalisedCopy());
+        const Float4 levOther = ogreOther;
+
+        CHECK(levQuat.QuaternionMultiply(levOther).Compare(
+            Float4(ogreQuat * ogreOther), 0.0001f));
+        CHECK(levOther.QuaternionMultiply(levQuat).Compare(
+            Float4(ogreOther * ogreQuat), 0.0001f));
+    }
+}
+
+namespace {
+
+//! Varied test values with both small and large differences between the start and the end
+void FillBulkMathTestData(size_t count, Float3Array& points, Float3Array& otherpoints,
+    Float4Array& rotations, Float4Array& otherrotations, std::vector<float>& progress)
+{
+    for(size_t i = 0; i < count; ++i){
+
+        const float value = static_cast<float>(i);
+
+        points.PushBack(Float3(value * 1.5f, std::sin(value * 0.3f), -2.f * value));
+        otherpoints.PushBack(Float3(value * 0.5f, std::cos(value * 0.7f) * 10.f, 4.f));
+
+        const Float4 rotation = Float4(std::sin(value * 0.1f), std::cos(value * 0.2f),
+            0.3f, 1.f).Normalize();
+
+        Float4 otherRotation = (i % 3 == 0) ?
+            Float4(rotation.X + 0.01f, rotation.Y, rotation.Z, rotation.W).Normalize() :
+            Float4(std::cos(value * 0.9f), 0.5f, std::sin(value * 1.3f), -0.2f).Normalize();
+
+        if(i % 4 == 0)
+            otherRotation = -otherRotation;
+
+        rotations.PushBack(rotation);
+        otherrotations.PushBack(otherRotation);
+        progress.push_back((i % 10) / 9.f);
+    }
+
+    // Zero vectors are handled specially by normalization
+    points.Set(1, Float3(0, 0, 0));
+    rotations.Set(2, Float4(0, 0, 0, 0));
+}
+
+} // namespace
+
+TEST_CASE("BulkMath matches the Float3 and Float4 methods", "[math]"){
+
+    const auto previous = BulkMath::GetImplementation();
+
+    std::vector<BULK_MATH_IMPLEMENTATION> implementations;
+
+    for(auto implementation : {BULK_MATH_IMPLEMENTATION::Scalar,
+            BULK_MATH_IMPLEMENTATION::SSE2}){
+
+        if(BulkMath::IsSupported(implementation))
+            implementations.push_back(implementation);
+    }
+
+    CHECK(BulkMath::IsSupported(BULK_MATH_IMPLEMENTATION::Scalar));
+
+    // Not a multiple of the vector widths to also test the remaining values
+    constexpr size_t COUNT = 43;
+
+    Float3Array points;
+    Float3Array otherPoints;
+    Float4Array rotations;
+    Float4Array otherRotations;
+    std::vector<float> progress;
+
+    FillBulkMathTestData(COUNT, points, otherPoints, rotations, otherRotations, progress);
+
+    for(auto implementation : implementations){
+
+        REQUIRE(BulkMath::SetImplementation(implementation));
+        INFO("Implementation: " << BulkMath::GetImplementationName());
+
+        SECTION(std::string("Lerp and Slerp ") + BulkMath::GetImplementationName()){
+
+            Float3Array positions;
+            Float4Array orientations;
+
+            BulkMath::Lerp(points, otherPoints, progress.data(), positions);
+            BulkMath::Slerp(rotations, otherRotations, progress.data(), orientations);
+
+            REQUIRE(positions.GetSize() == COUNT);
+            REQUIRE(orientations.GetSize() == COUNT);
+
+            for(size_t i = 0; i < COUNT; ++i){
+
+                CHECK(positions.Get(i) == points.Get(i).Lerp(otherPoints.Get(i),
+                        progress[i]));
+                CHECK(orientations.Get(i) == rotations.Get(i).Slerp(otherRotations.Get(i),
+                        progress[i]));
+            }
+        }
+
+        SECTION(std::string("Normalize ") + BulkMath::GetImplementationName()){
+
+            Float3Array normalizedPoints = points;
+            Float4Array normalizedRotations = rotations;
+
+            BulkMath::Normalize(normalizedPoints);
+            BulkMath::Normalize(normalizedRotations);
+
+            for(size_t i = 0; i < COUNT; ++i){
+
+                CHECK(normalizedPoints.Get(i) == points.Get(i).Normalize());
+                CHECK(normalizedRotations.Get(i) == rotations.Get(i).Normalize());
+            }
+        }
+
+        SECTION(std::string("Transform ") + BulkMath::GetImplementationName()){
+
+            const Float4 orientation = Float4(0.2f, -0.5f, 0.1f, 0.8f).Normalize();
+            const Float3 translation(10, -3, 0.5f);
+
+            Float3Array transformed;
+
+            BulkMath::Transform(points, orientation, translation, transformed);
+
+            REQUIRE(transformed.GetSize() == COUNT);
+
+            for(size_t i = 0; i < COUNT; ++i){
+
+                CHECK(transformed.Get(i) ==
+                    orientation.RotateVector(points.Get(i)) + translation);
+            }
+        }
+
+        SECTION(std::string("Distance queries ") + BulkMath::GetImplementationName()){
+
+            const Float3 center(20, 0, -20);
+            const float radius = 15.f;
+
+            std::vector<float> distances(COUNT);
+            BulkMath::DistanceSquared(points, center, distances.data());
+
+            // The found indexes are added after the existing ones
+            std::vector<size_t> found = {1000};
+
+            const auto foundCount = BulkMath::FindInsideRadius(points, center, radius, found);
+
+            std::vector<size_t> expected = {1000};
+
+            for(size_t i = 0; i < COUNT; ++i){
+
+                const float distance = (points.Get(i) - center).LengthSquared();
+                CHECK(distances[i] == distance);
+
+                if(distance <= radius * radius)
+                    expected.push_back(i);
+            }
+
+            CHECK(foundCount == expected.size() - 1);
+            CHECK(found == expected);
+            CHECK(foundCount > 0);
+            CHECK(foundCount < COUNT);
+        }
+
+        SECTION(std::string("Box query ") + BulkMath::GetImplementationName()){
+
+            const Float3 min(0, -1, -40);
+            // The edge is exactly on a point
+            const Float3 max(30, 1, points.Get(3).Z);
+
+            std::vector<size_t> found;
+            BulkMath::FindInsideBox(points, min, max, found);
+
+            std::vector<size_t> expected;
+
+            for(size_t i = 0; i < COUNT; ++i){
+
+                const Float3 point = points.Get(i);
+
+                if(point.X >= min.X && point.Y >= min.Y && point.Z >= min.Z &&
+                    point.X <= max.X && point.Y <= max.Y && point.Z <= max.Z)
+                {
+                    expected.push_back(i);
+                }
+            }
+
+            CHECK(found == expected);
+            CHECK(!found.empty());
+        }
+    }
+
+    BulkMath::SetImplementation(previous);
+}
+
+TEST_CASE("BulkMath throughput", "[.benchmark][math]"){
+
+    constexpr size_t COUNT = 100000;
+
+    Float3Array points;
+    Float3Array otherPoints;
+    Float4Array rotations;
+    Float4Array otherRotations;
+    std::vector<float> progress;
+
+    FillBulkMathTestData(COUNT, points, otherPoints, rotations, otherRotations, progress);
+
+    const Float4 orientation = Float4(0.2f, -0.5f, 0.1f, 0.8f).Normalize();
+    const Float3 translation(10, -3, 0.5f);
+
+    Float3Array positions;
+    Float4Array orientations;
+    std::vector<size_t> found;
+    found.reserve(COUNT);
+
+    float total = 0.f;
+
+    BENCHMARK("Float3 and Float4 methods"){
+
+        for(size_t i = 0; i < COUNT; ++i){
+
+            const Float3 position = points.Get(i).Lerp(otherPoints.Get(i), progress[i]);
+            const Float4 rotation = rotations.Get(i).Slerp(otherRotations.Get(i),
+                progress[i]);
+            const Float3 moved = orientation.RotateVector(position) + translation;
+
+            total += moved.X + rotation.W;
+
+            if(moved.LengthSquared() < 100.f)
+                found.push_back(i);
+        }
+
+        found.clear();
+    }
+
+    const auto previous = BulkMath::GetImplementation();
+
+    for(auto implementation : {BULK_MATH_IMPLEMENTATION::Scalar,
+            BULK_MATH_IMPLEMENTATION::SSE2}){
+
+        if(!BulkMath::SetImplementation(implementation))
+            continue;
+
+        const std::string name = std::string("BulkMath ") + BulkMath::GetImplementationName();
+
+        BENCHMARK(name){
+
+            BulkMath::Lerp(points, otherPoints, progress.data(), positions);
+            BulkMath::Slerp(rotations, otherRotations, progress.data(), orientations);
+            BulkMath::Transform(positions, orientation, translation, positions);
+            BulkMath::FindInsideRadius(positions, Float3(0, 0, 0), 10.f, found);
+
+            total += positions.X.back() + orientations.W.back();
+            found.clear();
+        }
+    }
+
+    BulkMath::SetImplementation(previous);
+
+    CHECK(total != 0.f);
 }
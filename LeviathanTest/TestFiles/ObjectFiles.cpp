@@ -1,14 +1,19 @@
 #include "ObjectFiles/ObjectFileProcessor.h"
 
 #ifndef LEVIATHAN_UE_PLUGIN
+#include "FileSystem.h"
+#include "ObjectFiles/ObjectFileCache.h"
 #include "Script/ScriptExecutor.h"
 #include "../PartialEngine.h"
 using namespace Leviathan::Test;
+
+#include <boost/filesystem.hpp>
 #endif //LEVIATHAN_UE_PLUGIN
 
 #include "catch.hpp"
 #include "../DummyLog.h"
 
+#include <cstring>
 #include <regex>
 
 using namespace Leviathan;
@@ -308,6 +313,255 @@ TEST_CASE("Object file saving", "[objectfile]") {
 }
 
 
+#ifndef LEVIATHAN_UE_PLUGIN
+TEST_CASE("Compiled object files match parsed ones", "[objectfile]") {
+
+    DummyReporter reporter;
+
+    SECTION("Basic in-memory file") {
+
+        auto parsed = ObjectFileProcessor::ProcessObjectFileFromString(BasicTestStr,
+            "basic compile test", &reporter);
+
+        REQUIRE(parsed);
+
+        std::string compiled;
+        REQUIRE(ObjectFileCache::Compile(*parsed, compiled));
+
+        auto ofile = ObjectFileCache::LoadCompiled(compiled, "basic compile test", &reporter);
+
+        REQUIRE(ofile);
+
+        CHECK(ofile->GetVariables()->GetVariableCount() == 4);
+
+        bool usesomething = false;
+        CHECK(ObjectFileProcessor::LoadValueFromNamedVars(*ofile->GetVariables(),
+                "Use-Something", usesomething, false));
+        CHECK(usesomething);
+
+        REQUIRE(ofile->GetTotalObjectCount() == 1);
+
+        auto* obj = dynamic_cast<CachedObjectFileObject*>(ofile->GetObjectFromIndex(0));
+
+        REQUIRE(obj);
+        CHECK(obj->GetName() == "First object");
+        CHECK(obj->GetTypeName() == "TestType");
+        CHECK(!obj->IsMaterialized());
+
+        ObjectFileList* list = obj->GetListWithName("list");
+
+        REQUIRE(list);
+        CHECK(obj->IsMaterialized());
+
+        int firstValue = 0;
+        CHECK(ObjectFileProcessor::LoadValueFromNamedVars(list->GetVariables(),
+                "firstValue", firstValue, 0));
+        CHECK(firstValue == 1);
+
+        std::string secondValue;
+        CHECK(ObjectFileProcessor::LoadValueFromNamedVars(list->GetVariables(),
+                "secondValue", secondValue, std::string()));
+        CHECK(secondValue == "2");
+    }
+
+    SECTION("Text blocks and templates") {
+
+        auto parsed = ObjectFileProcessor::ProcessObjectFileFromString(
+            "template<TName, TValue> Tmpl: o Type \"TName\"{\n"
+            "    l values {\n"
+            "        value = TValue;\n"
+            "    }\n"
+            "}\n"
+            "o Other prefix1 \"obj\"{\n"
+            "    t block{\n"
+            "        some text\n"
+            "        more text\n"
+            "    }\n"
+            "}\n"
+            "template<> Tmpl<Generated, 42>\n",
+            "template compile test", &reporter);
+
+        REQUIRE(parsed);
+        REQUIRE(parsed->GetTotalObjectCount() == 2);
+
+        std::string compiled;
+        REQUIRE(ObjectFileCache::Compile(*parsed, compiled));
+
+        auto ofile = ObjectFileCache::LoadCompiled(compiled, "template compile test",
+            &reporter);
+
+        REQUIRE(ofile);
+        REQUIRE(ofile->GetTotalObjectCount() == 2);
+        CHECK(ofile->GetTemplateDefinitionCount() == 1);
+        CHECK(ofile->GetTemplateInstanceCount() == 1);
+
+        ObjectFileObject* obj = ofile->GetObjectFromIndex(0);
+
+        CHECK(obj->GetName() == "obj");
+        REQUIRE(obj->GetPrefixesCount() == 1);
+        CHECK(obj->GetPrefix(0) == "prefix1");
+
+        ObjectFileTextBlock* text = obj->GetTextBlockWithName("block");
+
+        REQUIRE(text);
+        REQUIRE(text->GetLineCount() == 2);
+        CHECK(text->GetLine(1) == "more text");
+
+        ObjectFileObject* generated = ofile->GetObjectFromIndex(1);
+
+        CHECK(generated->IsThisTemplated());
+        CHECK(generated->GetName() == "Generated");
+
+        ObjectFileList* list = generated->GetListWithName("values");
+
+        REQUIRE(list);
+
+        int value = 0;
+        CHECK(ObjectFileProcessor::LoadValueFromNamedVars(list->GetVariables(),
+                "value", value, 0));
+        CHECK(value == 42);
+    }
+
+    SECTION("Truncated data is rejected") {
+
+        auto parsed = ObjectFileProcessor::ProcessObjectFileFromString(BasicTestStr,
+            "truncated compile test", &reporter);
+
+        REQUIRE(parsed);
+
+        std::string compiled;
+        REQUIRE(ObjectFileCache::Compile(*parsed, compiled));
+
+        compiled.resize(compiled.size() / 2);
+
+        ReporterMatchMessagesRegex truncatedreporter({
+            ReporterMatchMessagesRegex::MessageToLookFor(std::regex(R"(.*ObjectFileCache.*)"))});
+
+        CHECK(!ObjectFileCache::LoadCompiled(compiled, "truncated compile test",
+            &truncatedreporter));
+        CHECK(truncatedreporter.MessagesToDetect[0].MatchCount > 0);
+    }
+}
+
+TEST_CASE("Object file cache on disk", "[objectfile]") {
+
+    constexpr auto CacheFolder = "Test/ObjectFileCache";
+    constexpr auto SourceFile = "Test/ObjectFileCacheTest.levof";
+
+    const std::string previousfolder = ObjectFileCache::GetCacheFolder();
+
+    boost::filesystem::remove_all(CacheFolder);
+    ObjectFileCache::SetCacheFolder(CacheFolder);
+
+    REQUIRE(FileSystem::WriteToFile(std::string(BasicTestStr), SourceFile));
+
+    DummyReporter reporter;
+
+    const auto firstValueOf = [](ObjectFile& ofile) {
+        REQUIRE(ofile.GetTotalObjectCount() == 1);
+
+        ObjectFileList* list = ofile.GetObjectFromIndex(0)->GetListWithName("list");
+        REQUIRE(list);
+
+        int firstValue = 0;
+        CHECK(ObjectFileProcessor::LoadValueFromNamedVars(
+            list->GetVariables(), "firstValue", firstValue, 0));
+        return firstValue;
+    };
+
+    const auto isCached = [](ObjectFile& ofile) {
+        return dynamic_cast<CachedObjectFileObject*>(ofile.GetObjectFromIndex(0)) != nullptr;
+    };
+
+    SECTION("Parsed file is written to disk and mapped on the next load") {
+
+        auto parsed = ObjectFileProcessor::ProcessObjectFile(SourceFile, &reporter);
+
+        REQUIRE(parsed);
+        CHECK(!isCached(*parsed));
+        CHECK(boost::filesystem::exists(ObjectFileCache::GetCachePathForFile(SourceFile)));
+
+        auto mapped = ObjectFileProcessor::ProcessObjectFile(SourceFile, &reporter);
+
+        REQUIRE(mapped);
+        REQUIRE(isCached(*mapped));
+        CHECK(!static_cast<CachedObjectFileObject*>(mapped->GetObjectFromIndex(0))
+                   ->IsMaterialized());
+        CHECK(firstValueOf(*mapped) == 1);
+    }
+
+    SECTION("Changed source of the same size is parsed again") {
+
+        REQUIRE(ObjectFileProcessor::ProcessObjectFile(SourceFile, &reporter));
+
+        std::string changed = BasicTestStr;
+        const auto valuepos = changed.find("firstValue = 1;");
+        REQUIRE(valuepos != std::string::npos);
+        changed[valuepos + std::strlen("firstValue = ")] = '7';
+
+        REQUIRE(FileSystem::WriteToFile(changed, SourceFile));
+
+        auto reparsed = ObjectFileProcessor::ProcessObjectFile(SourceFile, &reporter);
+
+        REQUIRE(reparsed);
+        CHECK(!isCached(*reparsed));
+        CHECK(firstValueOf(*reparsed) == 7);
+
+        auto mapped = ObjectFileProcessor::ProcessObjectFile(SourceFile, &reporter);
+
+        REQUIRE(mapped);
+        CHECK(isCached(*mapped));
+        CHECK(firstValueOf(*mapped) == 7);
+    }
+
+    SECTION("Broken object data makes the file be parsed again") {
+
+        REQUIRE(ObjectFileProcessor::ProcessObjectFile(SourceFile, &reporter));
+
+        const auto cachefile = ObjectFileCache::GetCachePathForFile(SourceFile);
+
+        std::string compiled;
+        REQUIRE(FileSystem::ReadFileEntirely(cachefile, compiled));
+
+        // The object body starts with the list count followed by the name of the list
+        const uint32_t namelength = 4;
+        std::string listname(reinterpret_cast<const char*>(&namelength), sizeof(namelength));
+        listname += "list";
+
+        const auto namepos = compiled.find(listname);
+        REQUIRE(namepos != std::string::npos);
+        REQUIRE(namepos >= sizeof(uint32_t));
+
+        const uint32_t listcount = 2;
+        compiled.replace(namepos - sizeof(uint32_t), sizeof(uint32_t),
+            reinterpret_cast<const char*>(&listcount), sizeof(listcount));
+
+        REQUIRE(FileSystem::WriteToFile(compiled, cachefile));
+
+        ReporterMatchMessagesRegex brokenreporter({ReporterMatchMessagesRegex::MessageToLookFor(
+            std::regex(R"(.*ObjectFileCache: invalid data in object.*)"))});
+
+        auto reparsed = ObjectFileProcessor::ProcessObjectFile(SourceFile, &brokenreporter);
+
+        REQUIRE(reparsed);
+        CHECK(brokenreporter.MessagesToDetect[0].MatchCount == 1);
+        CHECK(!isCached(*reparsed));
+        CHECK(firstValueOf(*reparsed) == 1);
+
+        // And the broken file was replaced
+        auto mapped = ObjectFileProcessor::ProcessObjectFile(SourceFile, &reporter);
+
+        REQUIRE(mapped);
+        CHECK(isCached(*mapped));
+        CHECK(firstValueOf(*mapped) == 1);
+    }
+
+    ObjectFileCache::SetCacheFolder(previousfolder);
+    boost::filesystem::remove_all(CacheFolder);
+    boost::filesystem::remove(SourceFile);
+}
+#endif //LEVIATHAN_UE_PLUGIN
+
 TEST_CASE("Fabricators permissions parse test", "[objectfile]") {
 
     constexpr auto File = "permissions_version: 1;\n"
@@ -1,16 +1,23 @@
 //! \file Tests for various supporting GUI methods. Doesn't actually
 //! try any rendering or anything like that
 
+#include "Entities/LagCompensation.h"
 #include "Generated/StandardWorld.h"
 #include "Physics/PhysicalWorld.h"
 #include "Physics/PhysicsMaterialManager.h"
+#include "Physics/PhysicsShape.h"
+#include "Threading/ThreadingManager.h"
 
 #include "../PartialEngine.h"
 
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
+#include "BulletCollision/CollisionShapes/btStaticPlaneShape.h"
 #include "BulletDynamics/Dynamics/btRigidBody.h"
 
 #include "catch.hpp"
 
+#include <tuple>
+
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
@@ -238,6 +245,162 @@ TEST_CASE("Physical compound bodies work with callbacks", "[physics][entity]")
     world.Release();
 }
 
+TEST_CASE("Physics material pair table lookups", "[physics]")
+{
+    PhysicsMaterialManager materials;
+
+    auto material1 = std::make_unique<PhysicalMaterial>("1", 1);
+    auto material2 = std::make_unique<PhysicalMaterial>("2", 2);
+    auto material3 = std::make_unique<PhysicalMaterial>("3", 3);
+
+    // Above the table size so this uses the slow lookup
+    auto bigMaterial =
+        std::make_unique<PhysicalMaterial>("big", PhysicsMaterialManager::MAX_PAIR_TABLE_ID);
+
+    const PhysMaterialDataPair* pair12 = &material1->FormPairWith(*material2);
+    const PhysMaterialDataPair* pairBig = &bigMaterial->FormPairWith(*material3);
+
+    materials.LoadedMaterialAdd(std::move(material1));
+    materials.LoadedMaterialAdd(std::move(material2));
+    materials.LoadedMaterialAdd(std::move(material3));
+    materials.LoadedMaterialAdd(std::move(bigMaterial));
+
+    auto table = materials.GetPairTable();
+    REQUIRE(table);
+
+    SECTION("Pairs are found in both orders")
+    {
+        REQUIRE(table->Covers(1, 2));
+        REQUIRE(table->Covers(2, 1));
+
+        CHECK(table->Get(1, 2) == pair12);
+        CHECK(table->Get(2, 1) == pair12);
+    }
+
+    SECTION("Unknown pairs use the default")
+    {
+        REQUIRE(table->Covers(1, 3));
+        CHECK(table->Get(1, 3) == nullptr);
+        CHECK(table->Get(3, 1) == nullptr);
+        CHECK(table->Get(2, 2) == nullptr);
+
+        CHECK(!table->Covers(0, 1));
+        CHECK(!table->Covers(-1, 1));
+        CHECK(!table->Covers(1, PhysicsMaterialManager::MAX_PAIR_TABLE_ID));
+    }
+
+    SECTION("Forming a pair rebuilds the table")
+    {
+        const PhysMaterialDataPair* pair23 =
+            &materials.GetMaterial(2)->FormPairWith(*materials.GetMaterial(3));
+
+        auto newTable = materials.GetPairTable();
+
+        CHECK(newTable != table);
+        CHECK(newTable->Get(2, 3) == pair23);
+        CHECK(newTable->Get(3, 2) == pair23);
+        CHECK(newTable->Get(1, 2) == pair12);
+    }
+
+    SECTION("PhysicalWorld uses the same pairs with and without the table")
+    {
+        PhysicalWorld world(nullptr, &materials);
+
+        // Before the first step there is no table
+        CHECK(world.GetMaterialPair(2, 1) == pair12);
+        CHECK(world.GetMaterialPair(1, 3) == nullptr);
+
+        world.SimulateWorld(0.01f);
+
+        CHECK(world.GetMaterialPair(1, 2) == pair12);
+        CHECK(world.GetMaterialPair(2, 1) == pair12);
+        CHECK(world.GetMaterialPair(1, 3) == nullptr);
+
+        CHECK(world.GetMaterialPair(PhysicsMaterialManager::MAX_PAIR_TABLE_ID, 3) == pairBig);
+        CHECK(world.GetMaterialPair(3, PhysicsMaterialManager::MAX_PAIR_TABLE_ID) == pairBig);
+        CHECK(world.GetMaterialPair(1, PhysicsMaterialManager::MAX_PAIR_TABLE_ID) == nullptr);
+    }
+}
+
+std::vector<std::tuple<PhysicsBody*, PhysicsBody*>> TestContacts;
+
+void TestContactCallback(PhysicalWorld& world, PhysicsBody& body1, PhysicsBody& body2)
+{
+    TestContacts.emplace_back(&body1, &body2);
+}
+
+//! Allows queuing contacts without setting up actual collisions
+class ContactQueueTestWorld : public PhysicalWorld {
+public:
+    using PhysicalWorld::PhysicalWorld;
+
+    void QueueContact(PhysicsBody& body1, PhysicsBody& body2)
+    {
+        btPersistentManifold manifold;
+        btManifoldPoint point;
+
+        OnManifoldWithContact(&manifold, point, body1.GetBody(), body2.GetBody());
+    }
+
+    void FlushContacts()
+    {
+        _DispatchContacts();
+    }
+};
+
+TEST_CASE("Physics contact callbacks are deferred until the step ends", "[physics]")
+{
+    TestContacts.clear();
+
+    PhysicsMaterialManager materials;
+
+    auto material1 = std::make_unique<PhysicalMaterial>("1", 1);
+    auto material2 = std::make_unique<PhysicalMaterial>("2", 2);
+    auto material3 = std::make_unique<PhysicalMaterial>("3", 3);
+
+    material1->FormPairWith(*material2).SetCallbacks(nullptr, TestContactCallback);
+    material2->FormPairWith(*material3).SetCallbacks(nullptr, TestContactCallback);
+
+    materials.LoadedMaterialAdd(std::move(material1));
+    materials.LoadedMaterialAdd(std::move(material2));
+    materials.LoadedMaterialAdd(std::move(material3));
+
+    ContactQueueTestWorld world(nullptr, &materials);
+
+    auto body1 = world.CreateBodyFromCollision(world.CreateSphere(1), 0, nullptr, 1);
+    auto body2 = world.CreateBodyFromCollision(world.CreateSphere(1), 0, nullptr, 2);
+    auto body3 = world.CreateBodyFromCollision(world.CreateSphere(1), 0, nullptr, 3);
+
+    REQUIRE(body1);
+    REQUIRE(body2);
+    REQUIRE(body3);
+
+    world.QueueContact(*body2, *body3);
+    world.QueueContact(*body1, *body2);
+
+    // No callback between these
+    world.QueueContact(*body1, *body3);
+
+    world.QueueContact(*body2, *body1);
+
+    CHECK(TestContacts.empty());
+
+    world.FlushContacts();
+
+    const std::vector<std::tuple<PhysicsBody*, PhysicsBody*>> expected = {
+        {body2.get(), body3.get()}, {body1.get(), body2.get()}, {body2.get(), body1.get()}};
+
+    CHECK(TestContacts == expected);
+
+    // Each contact is only reported once
+    world.FlushContacts();
+    CHECK(TestContacts == expected);
+
+    world.DestroyBody(body1.get());
+    world.DestroyBody(body2.get());
+    world.DestroyBody(body3.get());
+}
+
 TEST_CASE(
     "Plane constrainted physics sphere can be moved with an impulse", "[physics][entity]")
 {
@@ -271,3 +434,282 @@ TEST_CASE(
 
     world.DestroyBody(body.get());
 }
+
+TEST_CASE("Physics queries find the right bodies", "[physics]")
+{
+    PhysicsMaterialManager materials;
+    PhysicalWorld world(nullptr, &materials);
+
+    auto nearBody = world.CreateBodyFromCollision(world.CreateSphere(1), 0, nullptr);
+    auto farBody = world.CreateBodyFromCollision(world.CreateSphere(1), 0, nullptr);
+    REQUIRE(nearBody);
+    REQUIRE(farBody);
+
+    nearBody->SetOwningEntity(1);
+    farBody->SetOwningEntity(2);
+
+    nearBody->SetPosition(Float3(0, 0, 10), Float4::IdentityQuaternion());
+    farBody->SetPosition(Float3(0, 0, 20), Float4::IdentityQuaternion());
+
+    // Updates the bounding boxes
+    world.SimulateWorld(0.01f);
+
+    std::vector<PhysicsQuery> queries;
+    queries.push_back(PhysicsQuery::Ray(Float3(0, 0, 0), Float3(0, 0, 30)));
+
+    queries.push_back(PhysicsQuery::Ray(Float3(0, 0, 0), Float3(0, 0, 30)));
+    queries.back().MaxHits = 0;
+
+    queries.push_back(PhysicsQuery::Ray(Float3(0, 0, 0), Float3(0, 0, 30)));
+    queries.back().Ignored = 1;
+
+    queries.push_back(PhysicsQuery::Ray(Float3(0, 5, 0), Float3(0, 5, 30)));
+    queries.push_back(PhysicsQuery::SphereOverlap(Float3(0, 0, 11.5f), 1));
+    queries.push_back(PhysicsQuery::SphereSweep(Float3(0, 0, 0), Float3(0, 0, 30), 0.5f));
+
+    std::vector<PhysicsQueryHit> hits;
+    REQUIRE(world.RunQueries(queries, hits));
+
+    REQUIRE(hits.size() == 6);
+
+    CHECK(hits[0].Query == 0);
+    CHECK(hits[0].Entity == 1);
+    CHECK(hits[0].Point.Z == Approx(9).margin(0.05f));
+    CHECK(hits[0].Fraction == Approx(0.3f).margin(0.01f));
+
+    CHECK(hits[1].Query == 1);
+    CHECK(hits[1].Entity == 1);
+    CHECK(hits[2].Query == 1);
+    CHECK(hits[2].Entity == 2);
+
+    CHECK(hits[3].Query == 2);
+    CHECK(hits[3].Entity == 2);
+
+    CHECK(hits[4].Query == 4);
+    CHECK(hits[4].Entity == 1);
+
+    CHECK(hits[5].Query == 5);
+    CHECK(hits[5].Entity == 1);
+    CHECK(hits[5].Fraction < hits[0].Fraction);
+
+    world.DestroyBody(nearBody.get());
+    world.DestroyBody(farBody.get());
+}
+
+TEST_CASE("Physics overlap queries test concave shapes exactly", "[physics]")
+{
+    PhysicsMaterialManager materials;
+    PhysicalWorld world(nullptr, &materials);
+
+    // Tilted so that its bounding box covers everything around it
+    std::unique_ptr<btCollisionShape> planeShape =
+        std::make_unique<btStaticPlaneShape>(btVector3(1, 1, 0).normalized(), 0);
+
+    auto plane = world.CreateBodyFromCollision(
+        PhysicsShape::MakeShared<PhysicsShape>(std::move(planeShape)), 0, nullptr);
+    REQUIRE(plane);
+
+    plane->SetOwningEntity(1);
+
+    world.SimulateWorld(0.01f);
+
+    std::vector<PhysicsQuery> queries;
+    queries.push_back(PhysicsQuery::SphereOverlap(Float3(0, 0, 0), 1));
+    queries.push_back(PhysicsQuery::SphereOverlap(Float3(5, 5, 0), 1));
+    queries.push_back(PhysicsQuery::BoxOverlap(Float3(4, 3, 3), Float3(1)));
+    queries.push_back(PhysicsQuery::BoxOverlap(Float3(1, 0, 10), Float3(1)));
+
+    std::vector<PhysicsQueryHit> hits;
+    REQUIRE(world.RunQueries(queries, hits));
+
+    REQUIRE(hits.size() == 2);
+
+    CHECK(hits[0].Query == 0);
+    CHECK(hits[0].Entity == 1);
+
+    CHECK(hits[1].Query == 3);
+    CHECK(hits[1].Entity == 1);
+
+    world.DestroyBody(plane.get());
+}
+
+TEST_CASE("Physics queries give the same results in parallel", "[physics][threading]")
+{
+    ThreadingManager threads;
+    REQUIRE(threads.Init());
+
+    PhysicsMaterialManager materials;
+    PhysicalWorld world(nullptr, &materials);
+
+    std::vector<PhysicsBody::pointer> bodies;
+
+    for(int x = 0; x < 10; ++x) {
+        for(int z = 0; z < 10; ++z) {
+
+            auto body = world.CreateBodyFromCollision(
+                (x + z) % 2 ? world.CreateSphere(0.5f) : world.CreateBox(0.5f, 0.5f, 0.5f), 0,
+                nullptr);
+            REQUIRE(body);
+
+            body->SetOwningEntity(1 + x * 10 + z);
+            body->SetPosition(Float3(x * 2.f, 0, z * 2.f), Float4::IdentityQuaternion());
+            bodies.push_back(body);
+        }
+    }
+
+    world.SimulateWorld(0.01f);
+
+    // Enough queries to be split between multiple tasks
+    std::vector<PhysicsQuery> queries;
+
+    for(int i = 0; i < 500; ++i) {
+
+        const float x = (i % 25) * 0.8f;
+        const float z = (i / 25) * 0.9f;
+
+        switch(i % 4) {
+        case 0:
+            queries.push_back(PhysicsQuery::Ray(Float3(x, 5, z), Float3(x, -5, z)));
+            break;
+        case 1: queries.push_back(PhysicsQuery::SphereOverlap(Float3(x, 0, z), 1.2f)); break;
+        case 2:
+            queries.push_back(
+                PhysicsQuery::SphereSweep(Float3(-1, 0, z), Float3(20, 0, z), 0.3f));
+            queries.back().MaxHits = 0;
+            break;
+        case 3:
+            queries.push_back(PhysicsQuery::BoxOverlap(Float3(x, 0, z), Float3(0.7f)));
+            break;
+        }
+    }
+
+    std::vector<PhysicsQueryHit> serialHits;
+    std::vector<PhysicsQueryHit> parallelHits;
+
+    REQUIRE(world.RunQueries(queries, serialHits, false));
+    REQUIRE(world.RunQueries(queries, parallelHits, true));
+
+    REQUIRE(!serialHits.empty());
+    REQUIRE(serialHits.size() == parallelHits.size());
+
+    for(size_t i = 0; i < serialHits.size(); ++i) {
+
+        CHECK(serialHits[i].Query == parallelHits[i].Query);
+        CHECK(serialHits[i].Entity == parallelHits[i].Entity);
+        CHECK(serialHits[i].Point == parallelHits[i].Point);
+        CHECK(serialHits[i].Normal == parallelHits[i].Normal);
+        CHECK(serialHits[i].Fraction == parallelHits[i].Fraction);
+    }
+
+    for(const auto& body : bodies)
+        world.DestroyBody(body.get());
+
+    threads.Release();
+}
+
+TEST_CASE("LagCompensationHistory rewinds and queries past bounds", "[physics][networking]")
+{
+    LagCompensationHistory history(3);
+
+    // Entity 1 moves one unit per tick, 2 has no body and 3 is created on tick 12
+    for(int32_t tick = 10; tick <= 13; ++tick) {
+
+        auto& frame = history.BeginFrame(tick);
+
+        const Float3 position(static_cast<float>(tick - 10), 0, 0);
+        frame.Add(1, position, Float4::IdentityQuaternion(), position - Float3(0.5f),
+            position + Float3(0.5f));
+        frame.Add(2, Float3(0, 0, 0), Float4::IdentityQuaternion());
+
+        if(tick >= 12)
+            frame.Add(3, Float3(5, 0, 0), Float4::IdentityQuaternion(), Float3(4, -1, -1),
+                Float3(6, 1, 1));
+    }
+
+    CHECK(history.GetCount() == 3);
+    CHECK(!history.Find(10));
+    REQUIRE(history.Find(11));
+    REQUIRE(history.GetNewest());
+    CHECK(history.GetNewest()->Tick == 13);
+
+    std::vector<RewoundEntity> rewound;
+
+    SECTION("Rewinding interpolates to the next tick")
+    {
+        REQUIRE(history.Rewind(11, 0.5f, nullptr, rewound));
+
+        REQUIRE(rewound.size() == 2);
+        CHECK(rewound[0].ID == 1);
+        CHECK(rewound[0].HasBounds);
+        CHECK(rewound[0].Position.X == Approx(1.5f));
+        CHECK(rewound[0].BoundsMin.X == Approx(1));
+        CHECK(rewound[0].BoundsMax.X == Approx(2));
+
+        CHECK(rewound[1].ID == 2);
+        CHECK(!rewound[1].HasBounds);
+    }
+
+    SECTION("Only the wanted entities are rewound")
+    {
+        const std::vector<ObjectID> wanted = {3, 2};
+
+        REQUIRE(history.Rewind(13, 0, &wanted, rewound));
+        REQUIRE(rewound.size() == 2);
+        CHECK(rewound[0].ID == 3);
+        CHECK(rewound[1].ID == 2);
+
+        rewound.clear();
+        REQUIRE(history.Rewind(11, 0, &wanted, rewound));
+        REQUIRE(rewound.size() == 1);
+        CHECK(rewound[0].ID == 2);
+    }
+
+    SECTION("Dropped ticks can't be rewound")
+    {
+        CHECK(!history.Rewind(10, 0, nullptr, rewound));
+        CHECK(!history.Rewind(14, 0, nullptr, rewound));
+        CHECK(rewound.empty());
+    }
+
+    SECTION("Queries hit the bounds at the rewound tick")
+    {
+        std::vector<PhysicsQuery> queries;
+        queries.push_back(PhysicsQuery::Ray(Float3(1, 0, -10), Float3(1, 0, 10)));
+        queries.push_back(PhysicsQuery::Ray(Float3(3, 0, -10), Float3(3, 0, 10)));
+
+        queries.push_back(PhysicsQuery::Ray(Float3(-10, 0, 0), Float3(10, 0, 0)));
+        queries.back().MaxHits = 0;
+        queries.back().Ignored = 3;
+
+        queries.push_back(PhysicsQuery::SphereOverlap(Float3(1, 0.9f, 0), 0.5f));
+        queries.push_back(PhysicsQuery::SphereOverlap(Float3(1.8f, 0.8f, 0), 0.3f));
+
+        std::vector<PhysicsQueryHit> hits;
+        REQUIRE(history.RunQueries(11, 0, nullptr, queries, hits));
+
+        REQUIRE(hits.size() == 3);
+
+        CHECK(hits[0].Query == 0);
+        CHECK(hits[0].Entity == 1);
+        CHECK(hits[0].Fraction == Approx(0.475f));
+        CHECK(hits[0].Point.Z == Approx(-0.5f));
+        CHECK(hits[0].Normal.Z == Approx(-1));
+
+        CHECK(hits[1].Query == 2);
+        CHECK(hits[1].Entity == 1);
+        CHECK(hits[1].Normal.X == Approx(-1));
+
+        CHECK(hits[2].Query == 3);
+        CHECK(hits[2].Entity == 1);
+        CHECK(hits[2].Point.Y == Approx(0.5f));
+
+        hits.clear();
+        REQUIRE(history.RunQueries(13, 0, nullptr, queries, hits));
+
+        REQUIRE(hits.size() == 2);
+        CHECK(hits[0].Query == 1);
+        CHECK(hits[0].Entity == 1);
+        CHECK(hits[1].Query == 2);
+        CHECK(hits[1].Entity == 1);
+    }
+}
@@ -0,0 +1,163 @@
+#include "Statistics/Profiler.h"
+
+#include "../PartialEngine.h"
+#include "catch.hpp"
+
+#include <sstream>
+#include <thread>
+
+using namespace Leviathan;
+using namespace Leviathan::Test;
+
+void ProfilerTestInnerFunction()
+{
+    LEVIATHAN_PROFILE_ZONE("ProfilerTestInner");
+}
+
+void ProfilerTestOuterFunction()
+{
+    LEVIATHAN_PROFILE_ZONE("ProfilerTestOuter");
+
+    ProfilerTestInnerFunction();
+    ProfilerTestInnerFunction();
+}
+
+//! Finds the recorded events of a zone from all threads
+std::vector<ProfilerEvent> GetProfilerEventsForZone(ProfilerZoneID zone)
+{
+    std::vector<ProfilerEvent> result;
+
+    for(const auto& thread : Profiler::GetEvents()) {
+        for(const auto& event : thread.Events) {
+            if(event.Zone == zone)
+                result.push_back(event);
+        }
+    }
+
+    return result;
+}
+
+TEST_CASE("Profiler zones with the same name share ids", "[profiler]")
+{
+    const auto first = Profiler::RegisterZone("ProfilerTestSameName");
+
+    CHECK(Profiler::RegisterZone("ProfilerTestSameName") == first);
+    CHECK(Profiler::RegisterZone("ProfilerTestOtherName") != first);
+    CHECK(Profiler::GetZoneName(first) == "ProfilerTestSameName");
+}
+
+TEST_CASE("Profiler records nested zones", "[profiler]")
+{
+    const auto outer = Profiler::RegisterZone("ProfilerTestOuter");
+    const auto inner = Profiler::RegisterZone("ProfilerTestInner");
+
+    SECTION("Nothing is recorded when disabled")
+    {
+        Profiler::Clear();
+
+        ProfilerTestOuterFunction();
+
+        CHECK(GetProfilerEventsForZone(outer).empty());
+        CHECK(GetProfilerEventsForZone(inner).empty());
+    }
+
+    SECTION("Enabled profiler records depths and times")
+    {
+        Profiler::Clear();
+        Profiler::SetEnabled(true);
+
+        ProfilerTestOuterFunction();
+
+        Profiler::SetEnabled(false);
+
+        const auto outerEvents = GetProfilerEventsForZone(outer);
+        const auto innerEvents = GetProfilerEventsForZone(inner);
+
+        REQUIRE(outerEvents.size() == 1);
+        REQUIRE(innerEvents.size() == 2);
+
+        CHECK(innerEvents[0].Depth == outerEvents[0].Depth + 1);
+        CHECK(innerEvents[1].Depth == outerEvents[0].Depth + 1);
+
+        for(const auto& event : innerEvents) {
+            CHECK(event.Start >= outerEvents[0].Start);
+            CHECK(event.End <= outerEvents[0].End);
+        }
+
+        CHECK(innerEvents[0].End <= innerEvents[1].Start);
+    }
+
+    SECTION("Threads are recorded separately")
+    {
+        Profiler::Clear();
+        Profiler::SetEnabled(true);
+
+        ProfilerTestOuterFunction();
+
+        std::thread other([]() { ProfilerTestOuterFunction(); });
+        other.join();
+
+        Profiler::SetEnabled(false);
+
+        int threadsWithOuter = 0;
+
+        for(const auto& thread : Profiler::GetEvents()) {
+            for(const auto& event : thread.Events) {
+                if(event.Zone == outer) {
+                    ++threadsWithOuter;
+                    break;
+                }
+            }
+        }
+
+        CHECK(threadsWithOuter == 2);
+    }
+}
+
+TEST_CASE("Profiler writes Chrome trace", "[profiler]")
+{
+    Profiler::Clear();
+    Profiler::SetEnabled(true);
+
+    ProfilerTestOuterFunction();
+
+    Profiler::SetEnabled(false);
+
+    std::stringstream stream;
+    Profiler::WriteChromeTrace(stream);
+
+    const auto trace = stream.str();
+
+    CHECK(trace.find("\"traceEvents\"") != std::string::npos);
+    CHECK(trace.find("\"name\":\"ProfilerTestOuter\"") != std::string::npos);
+    CHECK(trace.find("\"name\":\"ProfilerTestInner\"") != std::string::npos);
+    CHECK(trace.find("\"ph\":\"X\"") != std::string::npos);
+}
+
+TEST_CASE("Profiler captures a set number of ticks", "[profiler]")
+{
+    TestLogger log;
+
+    const auto outer = Profiler::RegisterZone("ProfilerTestOuter");
+
+    Profiler::CaptureTicks(2, "ProfilerTestCapture.json");
+
+    CHECK(Profiler::IsCapturing());
+    CHECK(Profiler::IsEnabled());
+
+    Profiler::OnNewTick();
+    ProfilerTestOuterFunction();
+
+    Profiler::OnNewTick();
+    CHECK(Profiler::IsCapturing());
+    ProfilerTestOuterFunction();
+
+    Profiler::OnNewTick();
+    CHECK(!Profiler::IsCapturing());
+    CHECK(!Profiler::IsEnabled());
+
+    // Stopped so this isn't recorded
+    ProfilerTestOuterFunction();
+
+    CHECK(GetProfilerEventsForZone(outer).size() == 2);
+}
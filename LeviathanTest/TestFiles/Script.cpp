@@ -2,6 +2,7 @@
 
 #include "Handlers/IDFactory.h"
 #include "Script/Bindings/BindHelpers.h"
+#include "Script/PreparedScriptCall.h"
 #include "Script/ScriptExecutor.h"
 #include "Script/ScriptModule.h"
 
@@ -792,3 +793,217 @@ TEST_CASE("Script anonymous delegates don't leak GC objects", "[script]")
 
     CHECK(returned.Result == SCRIPT_RUN_RESULT::Success);
 }
+
+TEST_CASE("PreparedScriptCall calls functions and methods", "[script]")
+{
+    PartialEngine<false> engine;
+
+    IDFactory ids;
+    ScriptExecutor exec;
+
+    // setup the script //
+    auto mod = exec.CreateNewModule("TestScript", "ScriptGenerator").lock();
+
+    // Setup source for script //
+    auto sourcecode = std::make_shared<ScriptSourceFileData>("Script.cpp", __LINE__ + 1,
+        "int Multiply(int first, int second){\n"
+        "return first * second;\n"
+        "}\n"
+        "class Counter{\n"
+        "void Add(int amount){\n"
+        "Count += amount;\n"
+        "}\n"
+        "float GetHalf(){\n"
+        "return Count / 2.f;\n"
+        "}\n"
+        "int Count = 0;\n"
+        "}\n"
+        "Counter@ CreateCounter(){\n"
+        "return Counter();\n"
+        "}");
+
+    mod->AddScriptSegment(sourcecode);
+
+    auto module = mod->GetModule();
+
+    REQUIRE(module != nullptr);
+
+    asIScriptFunction* multiply = module->GetFunctionByName("Multiply");
+    REQUIRE(multiply);
+
+    SECTION("Function")
+    {
+        PreparedScriptCall<int, int, int> call(multiply);
+        REQUIRE(call.IsValid());
+
+        // The context is reused so this is ran multiple times
+        for(int i = 0; i < 5; ++i) {
+
+            const auto result = call.Call(i, 3);
+
+            REQUIRE(result.Result == SCRIPT_RUN_RESULT::Success);
+            CHECK(result.Value == i * 3);
+        }
+    }
+
+    SECTION("Extra parameters are ignored")
+    {
+        PreparedScriptCall<int, int, int, int> call(multiply);
+        REQUIRE(call.IsValid());
+
+        const auto result = call.Call(2, 5, 7);
+
+        REQUIRE(result.Result == SCRIPT_RUN_RESULT::Success);
+        CHECK(result.Value == 10);
+    }
+
+    SECTION("Wrong types are rejected")
+    {
+        PreparedScriptCall<int, float, int> wrongParameter;
+        CHECK(!wrongParameter.SetFunction(multiply, false));
+        CHECK(!wrongParameter.IsValid());
+
+        PreparedScriptCall<float, int, int> wrongReturn;
+        CHECK(!wrongReturn.SetFunction(multiply, false));
+
+        PreparedScriptCall<int, int> tooFewParameters;
+        CHECK(!tooFewParameters.SetFunction(multiply, false));
+
+        CHECK(tooFewParameters.Call(1).Result == SCRIPT_RUN_RESULT::Error);
+    }
+
+    SECTION("Methods")
+    {
+        ScriptRunningSetup ssetup("CreateCounter");
+        auto counter = exec.RunScript<asIScriptObject*>(mod, ssetup);
+
+        REQUIRE(counter.Result == SCRIPT_RUN_RESULT::Success);
+        REQUIRE(counter.Value);
+
+        PreparedScriptCall<void, int> add(
+            counter.Value->GetObjectType()->GetMethodByName("Add"));
+        PreparedScriptCall<float> getHalf(
+            counter.Value->GetObjectType()->GetMethodByName("GetHalf"));
+
+        REQUIRE(add.IsValid());
+        REQUIRE(getHalf.IsValid());
+
+        CHECK(add.CallMethod(nullptr, 1).Result == SCRIPT_RUN_RESULT::Error);
+
+        for(int i = 0; i < 3; ++i)
+            CHECK(add.CallMethod(counter.Value, 3).Result == SCRIPT_RUN_RESULT::Success);
+
+        const auto result = getHalf.CallMethod(counter.Value);
+        REQUIRE(result.Result == SCRIPT_RUN_RESULT::Success);
+        CHECK(result.Value == 4.5f);
+    }
+}
+
+TEST_CASE("PreparedScriptCall releases handles on failed calls", "[script]")
+{
+    TestMyRefCounted::pointer ourObj = ReferenceCounted::MakeShared<TestMyRefCounted>();
+
+    PartialEngine<false> engine;
+
+    IDFactory ids;
+    ScriptExecutor exec;
+
+    REQUIRE(RegisterTestMyRefCounted(exec.GetASEngine()));
+
+    auto mod = exec.CreateNewModule("TestScript", "ScriptGenerator").lock();
+
+    auto sourcecode = std::make_shared<ScriptSourceFileData>("Script.cpp", __LINE__ + 1,
+        "int Check(int value, TestMyRefCounted@ obj){\n"
+        "if(value < 0){\n"
+        "array<int> empty;\n"
+        "return empty[1];\n"
+        "}\n"
+        "return obj is null ? 0 : value;\n"
+        "}");
+
+    mod->AddScriptSegment(sourcecode);
+
+    auto module = mod->GetModule();
+
+    REQUIRE(module != nullptr);
+
+    PreparedScriptCall<int, int, TestMyRefCounted*> call(module->GetFunctionByName("Check"));
+    REQUIRE(call.IsValid());
+
+    CHECK(ourObj->GetRefCount() == 1);
+
+    const auto result = call.Call(3, ourObj.get());
+    REQUIRE(result.Result == SCRIPT_RUN_RESULT::Success);
+    CHECK(result.Value == 3);
+    CHECK(ourObj->GetRefCount() == 1);
+
+    CHECK(call.Call(-1, ourObj.get()).Result == SCRIPT_RUN_RESULT::Error);
+    CHECK(ourObj->GetRefCount() == 1);
+
+    // The context is still usable after the failed call
+    CHECK(call.Call(5, ourObj.get()).Value == 5);
+    CHECK(ourObj->GetRefCount() == 1);
+
+    call.Reset();
+    mod->DeleteThisModule();
+}
+
+TEST_CASE("Script call throughput", "[.benchmark][script]")
+{
+    PartialEngine<false> engine;
+
+    IDFactory ids;
+    ScriptExecutor exec;
+
+    auto mod = exec.CreateNewModule("TestScript", "ScriptGenerator").lock();
+
+    auto sourcecode = std::make_shared<ScriptSourceFileData>("Script.cpp", __LINE__ + 1,
+        "int Multiply(int first, int second){\n"
+        "return first * second;\n"
+        "}");
+
+    mod->AddScriptSegment(sourcecode);
+
+    auto module = mod->GetModule();
+
+    REQUIRE(module != nullptr);
+
+    asIScriptFunction* multiply = module->GetFunctionByName("Multiply");
+    REQUIRE(multiply);
+
+    constexpr int CALLS = 100000;
+
+    const auto measure = [&](const std::string& name, const std::function<int(int)>& call) {
+        int64_t total = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for(int i = 0; i < CALLS; ++i)
+            total += call(i);
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+            std::chrono::steady_clock::now() - start);
+
+        WARN(name << ": " << static_cast<int64_t>(CALLS / elapsed.count()) << " calls/s");
+        return total;
+    };
+
+    const auto byName = measure("RunScript by name", [&](int i) {
+        ScriptRunningSetup ssetup("Multiply");
+        return exec.RunScript<int>(mod, ssetup, i, 2).Value;
+    });
+
+    const auto byFunction = measure("RunScript with function", [&](int i) {
+        ScriptRunningSetup ssetup;
+        return exec.RunScript<int>(multiply, mod, ssetup, i, 2).Value;
+    });
+
+    PreparedScriptCall<int, int, int> prepared(multiply);
+    REQUIRE(prepared.IsValid());
+
+    const auto preparedTotal =
+        measure("PreparedScriptCall", [&](int i) { return prepared.Call(i, 2).Value; });
+
+    CHECK(byName == byFunction);
+    CHECK(byName == preparedTotal);
+}
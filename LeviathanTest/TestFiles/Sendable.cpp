@@ -2,10 +2,17 @@
 
 #include "Common/SFMLPackets.h"
 #include "Entities/Components.h"
+#include "Entities/EntityJitterBuffer.h"
 #include "Entities/GameWorld.h"
+#include "Entities/LocalControlPrediction.h"
+#include "Entities/StateHolder.h"
+#include "Entities/WorldJoinStreamer.h"
+#include "Entities/WorldRecording.h"
+#include "Entities/WorldSnapshot.h"
 #include "Generated/ComponentStates.h"
 #include "Generated/StandardWorld.h"
 #include "Networking/NetworkResponse.h"
+#include "Networking/SentNetworkThing.h"
 
 
 #include "catch.hpp"
@@ -44,3 +51,931 @@ TEST_CASE("Sendable get correct server states", "[entity][networking]")
 TEST_CASE("World interpolation system works with Brush", "[entity][networking]") {}
 
 TEST_CASE("GameWorld properly loads and applies state packets", "[networking][entity]") {}
+
+namespace {
+
+std::shared_ptr<const SnapshotEntity> MakeSnapshotEntity(
+    ObjectID id, int32_t tick, const Float3& position)
+{
+    auto entity = std::make_shared<SnapshotEntity>();
+    entity->ID = id;
+    entity->CapturedTick = tick;
+    entity->State = std::make_shared<EntityState>();
+    entity->State->Append(
+        std::make_unique<PositionState>(tick, position, Float4::IdentityQuaternion()));
+    entity->State->AddDataToPacket(entity->FullData);
+    return entity;
+}
+
+} // namespace
+
+TEST_CASE("SnapshotHistory keeps the newest snapshots", "[entity][networking]")
+{
+    SnapshotHistory history(3);
+
+    CHECK(!history.GetNewest());
+    CHECK(!history.Find(1));
+
+    for(int32_t tick = 1; tick <= 5; ++tick)
+        history.Add(std::make_shared<WorldSnapshot>(tick));
+
+    CHECK(history.GetCount() == 3);
+    REQUIRE(history.GetNewest());
+    CHECK(history.GetNewest()->TickNumber == 5);
+
+    CHECK(!history.Find(1));
+    CHECK(!history.Find(2));
+    REQUIRE(history.Find(3));
+    CHECK(history.Find(3)->TickNumber == 3);
+    REQUIRE(history.Find(5));
+    CHECK(!history.Find(6));
+
+    SECTION("Skipped ticks are found")
+    {
+        history.Add(std::make_shared<WorldSnapshot>(8));
+        history.Add(std::make_shared<WorldSnapshot>(12));
+
+        REQUIRE(history.Find(5));
+        REQUIRE(history.Find(8));
+        CHECK(history.Find(8)->TickNumber == 8);
+        CHECK(!history.Find(4));
+        CHECK(!history.Find(10));
+    }
+
+    history.Clear();
+    CHECK(!history.GetNewest());
+    CHECK(!history.Find(5));
+}
+
+TEST_CASE("WorldSnapshot delta skips unchanged entities", "[entity][networking]")
+{
+    WorldSnapshot reference(10);
+    reference.Entities.push_back(MakeSnapshotEntity(1, 4, Float3(1, 0, 0)));
+    reference.Entities.push_back(MakeSnapshotEntity(2, 10, Float3(2, 0, 0)));
+
+    WorldSnapshot current(12);
+
+    // Entity 1 hasn't changed so it is shared
+    current.Entities.push_back(reference.Entities[0]);
+    current.Entities.push_back(MakeSnapshotEntity(2, 12, Float3(2.5f, 0, 0)));
+    current.Entities.push_back(MakeSnapshotEntity(5, 11, Float3(5, 0, 0)));
+
+    REQUIRE(current.Find(2));
+    CHECK((*current.Find(2))->CapturedTick == 12);
+    CHECK(!current.Find(3));
+
+    struct ReadEntity {
+        ObjectID ID;
+        int32_t CapturedTick;
+        int32_t ReferenceTick;
+        Float3 Position;
+    };
+
+    const auto readAll = [](sf::Packet& packet, uint32_t count,
+                             const WorldSnapshot* receiverreference) {
+        std::vector<ReadEntity> result;
+
+        CHECK(WorldSnapshot::ReadDelta(packet, count,
+            [&](ObjectID id, int32_t capturedtick, int32_t referencetick,
+                sf::Packet& statedata) {
+                uint16_t type;
+                statedata >> type;
+                REQUIRE(type == static_cast<uint16_t>(COMPONENT_TYPE::Position));
+
+                PositionState* referenceState = nullptr;
+
+                if(referencetick != -1) {
+                    REQUIRE(receiverreference);
+                    const auto* entity = receiverreference->Find(id);
+                    REQUIRE(entity);
+                    CHECK((*entity)->CapturedTick == referencetick);
+                    referenceState = static_cast<PositionState*>(
+                        (*entity)->State->ComponentStates.front().get());
+                }
+
+                PositionState state(referenceState, statedata);
+                result.push_back({id, capturedtick, referencetick, state._Position});
+            }));
+
+        return result;
+    };
+
+    SECTION("Against the reference")
+    {
+        sf::Packet packet;
+        const auto count = current.WriteDelta(&reference, packet);
+
+        CHECK(count == 2);
+
+        const auto read = readAll(packet, count, &reference);
+
+        REQUIRE(read.size() == 2);
+
+        CHECK(read[0].ID == 2);
+        CHECK(read[0].CapturedTick == 12);
+        CHECK(read[0].ReferenceTick == 10);
+        CHECK(read[0].Position.X == Approx(2.5f).margin(0.01f));
+
+        CHECK(read[1].ID == 5);
+        CHECK(read[1].ReferenceTick == -1);
+        CHECK(read[1].Position.X == Approx(5).margin(0.01f));
+
+        CHECK(packet.endOfPacket());
+    }
+
+    SECTION("Full snapshot")
+    {
+        sf::Packet packet;
+        const auto count = current.WriteDelta(nullptr, packet);
+
+        CHECK(count == 3);
+
+        const auto read = readAll(packet, count, nullptr);
+
+        REQUIRE(read.size() == 3);
+        CHECK(read[0].ID == 1);
+        CHECK(read[0].CapturedTick == 4);
+
+        for(const auto& entity : read)
+            CHECK(entity.ReferenceTick == -1);
+    }
+
+    SECTION("Only included entities")
+    {
+        // Entity 2 was included after the reference so the receiver doesn't have its state
+        const std::unordered_map<ObjectID, int32_t> includedSince = {{1, 4}, {2, 11}};
+
+        sf::Packet packet;
+        const auto count = current.WriteDelta(&reference, packet, &includedSince);
+
+        CHECK(count == 1);
+
+        const auto read = readAll(packet, count, &reference);
+
+        REQUIRE(read.size() == 1);
+        CHECK(read[0].ID == 2);
+        CHECK(read[0].ReferenceTick == -1);
+        CHECK(read[0].Position.X == Approx(2.5f).margin(0.01f));
+    }
+
+    SECTION("Nothing changed")
+    {
+        sf::Packet packet;
+        CHECK(reference.WriteDelta(&reference, packet) == 0);
+        CHECK(packet.getDataSize() == 0);
+    }
+
+    SECTION("Truncated data fails")
+    {
+        sf::Packet packet;
+        const auto count = current.WriteDelta(nullptr, packet);
+
+        sf::Packet truncated;
+        truncated.append(packet.getData(), packet.getDataSize() / 2);
+
+        CHECK(!WorldSnapshot::ReadDelta(truncated, count,
+            [](ObjectID, int32_t, int32_t, sf::Packet&) {}));
+    }
+
+    SECTION("Split into parts")
+    {
+        sf::Packet whole;
+        const auto count = current.WriteDelta(nullptr, whole);
+
+        const size_t budget = whole.getDataSize() - 1;
+
+        std::vector<SnapshotPart> parts;
+        CHECK(current.WriteDelta(nullptr, parts, budget) == count);
+
+        REQUIRE(parts.size() > 1);
+
+        std::vector<ReadEntity> read;
+        uint32_t partCounts = 0;
+
+        for(auto& part : parts) {
+
+            REQUIRE(part.EntityCount > 0);
+            CHECK((part.EntityCount == 1 || part.Data.getDataSize() <= budget));
+
+            partCounts += part.EntityCount;
+
+            const auto partRead = readAll(part.Data, part.EntityCount, nullptr);
+            read.insert(read.end(), partRead.begin(), partRead.end());
+            CHECK(part.Data.endOfPacket());
+        }
+
+        CHECK(partCounts == count);
+
+        REQUIRE(read.size() == 3);
+        CHECK(read[0].ID == 1);
+        CHECK(read[1].ID == 2);
+        CHECK(read[2].ID == 5);
+    }
+
+    SECTION("Entities larger than the part size get their own parts")
+    {
+        std::vector<SnapshotPart> parts;
+        CHECK(current.WriteDelta(nullptr, parts, 1) == 3);
+
+        REQUIRE(parts.size() == 3);
+
+        for(const auto& part : parts)
+            CHECK(part.EntityCount == 1);
+    }
+}
+
+TEST_CASE("SnapshotReceiver reference is dropped after too many unacked snapshots",
+    "[entity][networking]")
+{
+    SnapshotReceiver receiver(nullptr);
+
+    CHECK(!receiver.GetReference(6));
+
+    receiver.AckedSnapshot = std::make_shared<WorldSnapshot>(5);
+    CHECK(receiver.GetReference(6) == receiver.AckedSnapshot.get());
+
+    for(int32_t tick = 6; tick < 6 + KEPT_STATES_COUNT - 2; ++tick)
+        receiver.UnackedTicks.push_back(tick);
+
+    CHECK(receiver.GetReference(6 + KEPT_STATES_COUNT - 2));
+
+    receiver.UnackedTicks.push_back(6 + KEPT_STATES_COUNT - 2);
+    CHECK(!receiver.GetReference(6 + KEPT_STATES_COUNT - 1));
+}
+
+TEST_CASE("SnapshotReceiver reference is dropped when it is too old", "[entity][networking]")
+{
+    SnapshotReceiver receiver(nullptr);
+
+    receiver.AckedSnapshot = std::make_shared<WorldSnapshot>(5);
+
+    // No snapshots were sent in between as nothing changed
+    CHECK(receiver.GetReference(5 + KEPT_STATES_COUNT - 1) == receiver.AckedSnapshot.get());
+    CHECK(!receiver.GetReference(5 + KEPT_STATES_COUNT));
+    CHECK(!receiver.GetReference(100));
+}
+
+TEST_CASE("SnapshotReceiver reference is dropped when a full state is requested",
+    "[entity][networking]")
+{
+    SnapshotReceiver receiver(nullptr);
+
+    receiver.AckedSnapshot = std::make_shared<WorldSnapshot>(5);
+    receiver.UnackedTicks.push_back(6);
+    receiver.SentSnapshots.emplace_back(6, std::vector<std::shared_ptr<SentNetworkThing>>{});
+
+    REQUIRE(receiver.GetReference(7));
+
+    receiver.ResetReference();
+
+    CHECK(!receiver.GetReference(7));
+    CHECK(!receiver.AckedSnapshot);
+
+    // Acks for snapshots sent before the request can't bring a reference back
+    CHECK(receiver.SentSnapshots.empty());
+    CHECK(receiver.UnackedTicks.empty());
+}
+
+TEST_CASE("SnapshotReceiver acks a split snapshot once all parts are received",
+    "[entity][networking]")
+{
+    SnapshotHistory history(8);
+    history.Add(std::make_shared<WorldSnapshot>(5));
+    history.Add(std::make_shared<WorldSnapshot>(6));
+
+    const auto makeSent = []() {
+        return std::make_shared<SentResponse>(
+            1, 1, RECEIVE_GUARANTEE::None, std::make_shared<ResponseConnect>(0));
+    };
+
+    SnapshotReceiver receiver(nullptr);
+
+    const auto first = makeSent();
+    const auto second = makeSent();
+
+    receiver.SentSnapshots.emplace_back(
+        5, std::vector<std::shared_ptr<SentNetworkThing>>{first, second});
+    receiver.UnackedTicks.push_back(5);
+
+    first->OnFinalized(true);
+    receiver.CheckReceivedSnapshots(history);
+
+    CHECK(!receiver.AckedSnapshot);
+    CHECK(receiver.SentSnapshots.size() == 1);
+
+    second->OnFinalized(true);
+    receiver.CheckReceivedSnapshots(history);
+
+    REQUIRE(receiver.AckedSnapshot);
+    CHECK(receiver.AckedSnapshot->TickNumber == 5);
+    CHECK(receiver.SentSnapshots.empty());
+    CHECK(receiver.UnackedTicks.empty());
+
+    SECTION("A lost part prevents the ack")
+    {
+        const auto third = makeSent();
+        const auto fourth = makeSent();
+
+        receiver.SentSnapshots.emplace_back(
+            6, std::vector<std::shared_ptr<SentNetworkThing>>{third, fourth});
+        receiver.UnackedTicks.push_back(6);
+
+        third->OnFinalized(false);
+        receiver.CheckReceivedSnapshots(history);
+
+        CHECK(receiver.AckedSnapshot->TickNumber == 5);
+        CHECK(receiver.SentSnapshots.empty());
+        CHECK(receiver.UnackedTicks == std::vector<int32_t>{6});
+
+        // The remaining part arriving can't ack it anymore
+        fourth->OnFinalized(true);
+        receiver.CheckReceivedSnapshots(history);
+
+        CHECK(receiver.AckedSnapshot->TickNumber == 5);
+    }
+}
+
+TEST_CASE("EntityJoinQueue sends nearest entities first within limits", "[entity][networking]")
+{
+    EntityJoinQueue queue;
+    queue.Start({{1, 100.f}, {2, 4.f}, {3, 0.f}, {4, 25.f}, {5, 9.f}});
+
+    CHECK(queue.GetQueuedCount() == 5);
+    CHECK(queue.IsPending(1));
+    CHECK(!queue.IsPending(6));
+
+    std::vector<ObjectID> sent;
+    const auto sender = [&](ObjectID id) {
+        sent.push_back(id);
+        return 100;
+    };
+
+    SECTION("Entity limit")
+    {
+        CHECK(queue.SendBatch(2, 10000, 10, sender) == 2);
+        CHECK(sent == std::vector<ObjectID>{3, 2});
+        CHECK(queue.GetInFlightCount() == 2);
+        CHECK(queue.GetQueuedCount() == 3);
+    }
+
+    SECTION("Byte limit allows going over with the last entity")
+    {
+        CHECK(queue.SendBatch(10, 150, 10, sender) == 2);
+        CHECK(queue.SendBatch(10, 1, 10, sender) == 1);
+        CHECK(sent == std::vector<ObjectID>{3, 2, 5});
+    }
+
+    SECTION("In flight limit waits for received entities")
+    {
+        CHECK(queue.SendBatch(10, 10000, 2, sender) == 2);
+        CHECK(queue.SendBatch(10, 10000, 2, sender) == 0);
+
+        queue.OnReceived(3);
+        CHECK(!queue.IsPending(3));
+        CHECK(queue.IsPending(2));
+
+        CHECK(queue.SendBatch(10, 10000, 2, sender) == 1);
+        CHECK(sent == std::vector<ObjectID>{3, 2, 5});
+    }
+
+    SECTION("Lost entities are sent again next")
+    {
+        CHECK(queue.SendBatch(2, 10000, 10, sender) == 2);
+
+        queue.OnLost(2);
+        CHECK(queue.IsPending(2));
+        CHECK(queue.GetInFlightCount() == 1);
+
+        CHECK(queue.SendBatch(1, 10000, 10, sender) == 1);
+        CHECK(sent == std::vector<ObjectID>{3, 2, 2});
+    }
+
+    SECTION("Removed and destroyed entities are skipped")
+    {
+        queue.Remove(2);
+        CHECK(!queue.IsPending(2));
+
+        const auto skipFive = [&](ObjectID id) {
+            if(id == 5)
+                return -1;
+            return sender(id);
+        };
+
+        CHECK(queue.SendBatch(10, 10000, 10, skipFive) == 3);
+        CHECK(sent == std::vector<ObjectID>{3, 4, 1});
+        CHECK(!queue.IsPending(5));
+
+        for(ObjectID id : sent)
+            queue.OnReceived(id);
+
+        CHECK(queue.IsDone());
+    }
+}
+
+TEST_CASE(
+    "LocalControlPrediction replays inputs after a corrected tick", "[entity][networking]")
+{
+    LocalControlPrediction prediction(8);
+
+    constexpr ObjectID id = 3;
+
+    // Each input moves the entity along X
+    Float3 position(0, 0, 0);
+
+    for(int32_t tick = 1; tick <= 10; ++tick) {
+
+        sf::Packet input;
+        input << static_cast<float>(tick);
+
+        prediction.RecordInput(id, tick, std::move(input));
+        position.X += tick;
+        prediction.RecordResult(id, tick, position, Float4::IdentityQuaternion());
+    }
+
+    CHECK(!prediction.GetTick(id, 2));
+    REQUIRE(prediction.GetTick(id, 5));
+    CHECK(prediction.GetTick(id, 5)->HasInput);
+    CHECK(prediction.GetTick(id, 5)->Position.X == 15);
+
+    CHECK(!prediction.NeedsCorrection(
+        id, 5, Float3(15.001f, 0, 0), Float4::IdentityQuaternion(), 0.01f));
+    CHECK(!prediction.NeedsCorrection(
+        id, 5, Float3(15, 0, 0), -Float4::IdentityQuaternion(), 0.01f));
+    CHECK(prediction.NeedsCorrection(
+        id, 5, Float3(14, 0, 0), Float4::IdentityQuaternion(), 0.01f));
+    CHECK(prediction.NeedsCorrection(
+        id, 1, Float3(1, 0, 0), Float4::IdentityQuaternion(), 0.01f));
+
+    SECTION("Replay from a correction")
+    {
+        CHECK(prediction.Acknowledge(id, 6));
+        CHECK(!prediction.Acknowledge(id, 6));
+        CHECK(!prediction.Acknowledge(id, 4));
+
+        std::vector<int32_t> replayed;
+        float moved = 0;
+
+        CHECK(prediction.ReplayInputs(id, 6, 10, [&](int32_t tick, const sf::Packet& input) {
+            sf::Packet copy = input;
+            float amount = 0;
+            copy >> amount;
+            moved += amount;
+            replayed.push_back(tick);
+        }) == 4);
+
+        CHECK(replayed == std::vector<int32_t>{7, 8, 9, 10});
+        CHECK(moved == 7 + 8 + 9 + 10);
+    }
+
+    SECTION("Overwritten ticks aren't replayed")
+    {
+        std::vector<int32_t> replayed;
+
+        prediction.ReplayInputs(id, 0, 10,
+            [&](int32_t tick, const sf::Packet& input) { replayed.push_back(tick); });
+
+        CHECK(replayed == std::vector<int32_t>{3, 4, 5, 6, 7, 8, 9, 10});
+    }
+
+    SECTION("Ticks without input get an empty one")
+    {
+        prediction.RecordResult(id, 11, position, Float4::IdentityQuaternion());
+
+        bool called = false;
+
+        prediction.ReplayInputs(id, 10, 11, [&](int32_t tick, const sf::Packet& input) {
+            CHECK(tick == 11);
+            CHECK(input.getDataSize() == 0);
+            called = true;
+        });
+
+        CHECK(called);
+    }
+}
+
+TEST_CASE("LocalControlPrediction smooths out corrections", "[entity][networking]")
+{
+    LocalControlPrediction prediction;
+
+    constexpr ObjectID id = 5;
+    const auto identity = Float4::IdentityQuaternion();
+
+    CHECK(!prediction.HasCorrections());
+
+    prediction.AddCorrection(id, 10, Float3(2, 0, 0), identity, Float3(0, 0, 0), identity, 4);
+
+    REQUIRE(prediction.HasCorrection(id));
+
+    Float3 position(0, 0, 0);
+    Float4 orientation = identity;
+
+    // At first the old position is shown
+    CHECK(prediction.ApplyCorrectionOffset(id, 10, 0, position, orientation));
+    CHECK(position.X == Approx(2));
+
+    position = Float3(0, 0, 0);
+    prediction.ApplyCorrectionOffset(id, 12, 0, position, orientation);
+    CHECK(position.X == Approx(1));
+
+    position = Float3(0, 0, 0);
+    prediction.ApplyCorrectionOffset(id, 12, TICKSPEED / 2, position, orientation);
+    CHECK(position.X == Approx(0.75f));
+
+    SECTION("New correction keeps the shown offset")
+    {
+        prediction.AddCorrection(
+            id, 12, Float3(0, 0, 0), identity, Float3(0, 0, 1), identity, 4);
+
+        position = Float3(0, 0, 1);
+        prediction.ApplyCorrectionOffset(id, 12, 0, position, orientation);
+        CHECK(position.X == Approx(1));
+        CHECK(position.Z == Approx(0));
+    }
+
+    SECTION("Finished corrections are removed")
+    {
+        prediction.RemoveFinishedCorrections(13);
+        CHECK(prediction.HasCorrection(id));
+
+        prediction.RemoveFinishedCorrections(14);
+        CHECK(!prediction.HasCorrections());
+    }
+
+    SECTION("Orientation is smoothed")
+    {
+        const Float4 turned = Float4(0, 0.7071068f, 0, 0.7071068f);
+
+        prediction.AddCorrection(id, 20, Float3(0, 0, 0), turned, Float3(0, 0, 0), identity, 2);
+
+        orientation = identity;
+        position = Float3(0, 0, 0);
+        prediction.ApplyCorrectionOffset(id, 20, 0, position, orientation);
+        CHECK(orientation.Compare(turned, 0.001f));
+
+        orientation = identity;
+        prediction.ApplyCorrectionOffset(id, 21, 0, position, orientation);
+        CHECK(orientation.Compare(identity.Slerp(turned, 0.5f), 0.001f));
+
+        orientation = identity;
+        prediction.ApplyCorrectionOffset(id, 22, 0, position, orientation);
+        CHECK(orientation.Compare(identity, 0.001f));
+    }
+
+    SECTION("No smoothing")
+    {
+        prediction.AddCorrection(
+            id, 12, Float3(0, 0, 0), identity, Float3(8, 0, 0), identity, 0);
+        CHECK(!prediction.HasCorrection(id));
+    }
+}
+
+TEST_CASE("LocalControlValidator limits client movement", "[entity][networking]")
+{
+    LocalControlValidator validator;
+
+    constexpr ObjectID id = 2;
+
+    // 10 units per second is 0.5 units per tick
+    constexpr float maxSpeed = 10.f;
+    constexpr int slack = 2;
+    constexpr int resend = 5;
+
+    validator.Reset(id, 100, Float3(0, 0, 0));
+
+    CHECK(validator.CheckTick(id, 7));
+    CHECK(validator.CheckState(id, 7, 101, Float3(1.4f, 0, 0), maxSpeed, slack, resend) ==
+          LOCAL_CONTROL_CHECK::Accepted);
+    validator.Accept(id, 7, 101, Float3(1.4f, 0, 0));
+
+    CHECK(!validator.CheckTick(id, 7));
+    CHECK(!validator.CheckTick(id, 6));
+    CHECK(validator.CheckTick(id, 8));
+
+    CHECK(validator.CheckState(id, 8, 102, Float3(1.8f, 0, 0), maxSpeed, slack, resend) ==
+          LOCAL_CONTROL_CHECK::Accepted);
+    CHECK(validator.CheckState(id, 8, 102, Float3(2.f, 0, 0), maxSpeed, slack, resend) ==
+          LOCAL_CONTROL_CHECK::Rejected);
+
+    SECTION("Claiming more ticks than the server has ran doesn't allow teleporting")
+    {
+        // The server has ran one tick so with the slack 1.5 units is allowed
+        CHECK(validator.CheckState(id, 50, 102, Float3(2.8f, 0, 0), maxSpeed, slack, resend) ==
+              LOCAL_CONTROL_CHECK::Accepted);
+        CHECK(validator.CheckState(id, 50, 102, Float3(3.f, 0, 0), maxSpeed, slack, resend) ==
+              LOCAL_CONTROL_CHECK::Rejected);
+    }
+
+    SECTION("States sent before a correction arrived are ignored")
+    {
+        validator.Reject(id, 8, 102, Float3(1.4f, 0, 0));
+
+        CHECK(validator.CheckState(id, 9, 103, Float3(5.f, 0, 0), maxSpeed, slack, resend) ==
+              LOCAL_CONTROL_CHECK::Ignored);
+        CHECK(validator.CheckState(id, 9, 107, Float3(5.f, 0, 0), maxSpeed, slack, resend) ==
+              LOCAL_CONTROL_CHECK::Rejected);
+
+        CHECK(validator.CheckState(id, 9, 103, Float3(1.6f, 0, 0), maxSpeed, slack, resend) ==
+              LOCAL_CONTROL_CHECK::Accepted);
+        validator.Accept(id, 9, 103, Float3(1.6f, 0, 0));
+
+        CHECK(validator.CheckState(id, 10, 104, Float3(5.f, 0, 0), maxSpeed, slack, resend) ==
+              LOCAL_CONTROL_CHECK::Rejected);
+    }
+
+    SECTION("Speed isn't checked without a limit")
+    {
+        CHECK(validator.CheckState(id, 8, 102, Float3(100.f, 0, 0), 0.f, slack, resend) ==
+              LOCAL_CONTROL_CHECK::Accepted);
+    }
+}
+
+TEST_CASE("PlayoutDelayEstimator adapts to jitter", "[entity][networking]")
+{
+    PlayoutDelayEstimator estimator(TICKSPEED, 500);
+
+    // Without samples everything is played out immediately
+    CHECK(!estimator.HasSamples());
+    CHECK(estimator.GetPlayoutTime(100) == 0);
+
+    estimator.AddSample(10, 1000);
+    estimator.AddSample(11, 1000 + TICKSPEED);
+
+    CHECK(estimator.HasSamples());
+    CHECK(estimator.GetNewestTick() == 11);
+    CHECK(estimator.GetJitter() == 0.f);
+    CHECK(estimator.GetTargetDelay() == TICKSPEED);
+    CHECK(estimator.GetPlayoutTime(12) == 1000 + 2 * TICKSPEED + TICKSPEED);
+
+    // Old ticks aren't used as samples
+    estimator.AddSample(5, 5000);
+    CHECK(estimator.GetNewestTick() == 11);
+    CHECK(estimator.GetJitter() == 0.f);
+
+    // Packets arriving late don't move the base but increase the delay
+    for(int32_t tick = 12; tick < 60; ++tick)
+        estimator.AddSample(tick, 1000 + (tick - 10) * TICKSPEED + (tick % 2) * 100);
+
+    CHECK(estimator.GetJitter() > 80.f);
+    CHECK(estimator.GetTargetDelay() > 250);
+    CHECK(estimator.GetTargetDelay() <= 500);
+    CHECK(estimator.GetPlayoutTime(60) ==
+          1000 + 50 * TICKSPEED + estimator.GetTargetDelay());
+
+    estimator.SetDelayLimits(TICKSPEED, 200);
+    CHECK(estimator.GetTargetDelay() == 200);
+}
+
+TEST_CASE("EntityJitterBuffer plays out packets in tick order", "[entity][networking]")
+{
+    EntityJitterBuffer buffer(TICKSPEED, 500, 2000);
+
+    std::vector<std::tuple<ObjectID, int32_t>> applied;
+
+    const auto applier = [&](NetworkResponse& message) {
+        REQUIRE(message.GetType() == NETWORK_RESPONSE_TYPE::EntityUpdate);
+        auto& update = static_cast<ResponseEntityUpdate&>(message);
+        applied.push_back(std::make_tuple(update.EntityID, update.TickNumber));
+        return JITTER_BUFFER_APPLY::Applied;
+    };
+
+    const auto makeUpdate = [](ObjectID id, int32_t tick) {
+        return std::make_unique<ResponseEntityUpdate>(0, 1, tick, -1, id, sf::Packet());
+    };
+
+    buffer.Add(1, 11, makeUpdate(1, 11), 1000);
+    buffer.Add(1, 10, makeUpdate(1, 10), 1010);
+    buffer.Add(2, 12, makeUpdate(2, 12), 1050);
+
+    CHECK(buffer.GetQueuedCount() == 3);
+
+    const auto playTick11 = buffer.GetEstimator().GetPlayoutTime(11);
+
+    CHECK(buffer.PlayOut(playTick11 - 1, applier) == 1);
+    CHECK(buffer.PlayOut(playTick11, applier) == 1);
+    CHECK(buffer.PlayOut(playTick11 + TICKSPEED, applier) == 1);
+
+    REQUIRE(applied.size() == 3);
+    CHECK(applied[0] == std::make_tuple<ObjectID, int32_t>(1, 10));
+    CHECK(applied[1] == std::make_tuple<ObjectID, int32_t>(1, 11));
+    CHECK(applied[2] == std::make_tuple<ObjectID, int32_t>(2, 12));
+
+    SECTION("Too old states are thrown out")
+    {
+        CHECK(buffer.IsObsolete(1, 11 - KEPT_STATES_COUNT));
+        CHECK(!buffer.IsObsolete(1, 12 - KEPT_STATES_COUNT));
+        CHECK(!buffer.IsObsolete(3, 1));
+
+        buffer.Add(1, 11 - KEPT_STATES_COUNT, makeUpdate(1, 11 - KEPT_STATES_COUNT), 2000);
+        buffer.Add(1, 9, makeUpdate(1, 9), 2000);
+
+        // Late states that are still kept can be used as delta references
+        CHECK(buffer.PlayOut(3000, applier) == 1);
+        REQUIRE(applied.size() == 4);
+        CHECK(applied[3] == std::make_tuple<ObjectID, int32_t>(1, 9));
+        CHECK(buffer.GetQueuedCount() == 0);
+    }
+}
+
+TEST_CASE("EntityJitterBuffer holds updates for entities that don't exist yet",
+    "[entity][networking]")
+{
+    EntityJitterBuffer buffer(TICKSPEED, 500, 2000);
+
+    std::vector<ObjectID> existing;
+    std::vector<std::tuple<ObjectID, int32_t>> applied;
+    std::vector<ObjectID> destroyed;
+
+    const auto applier = [&](NetworkResponse& message) {
+        const auto id = message.GetType() == NETWORK_RESPONSE_TYPE::EntityDestruction ?
+                            static_cast<ResponseEntityDestruction&>(message).EntityID :
+                            static_cast<ResponseEntityUpdate&>(message).EntityID;
+
+        const auto found = std::find(existing.begin(), existing.end(), id);
+
+        if(found == existing.end())
+            return JITTER_BUFFER_APPLY::MissingEntity;
+
+        if(message.GetType() == NETWORK_RESPONSE_TYPE::EntityDestruction) {
+
+            existing.erase(found);
+            destroyed.push_back(id);
+        } else {
+
+            applied.push_back(std::make_tuple(
+                id, static_cast<ResponseEntityUpdate&>(message).TickNumber));
+        }
+
+        return JITTER_BUFFER_APPLY::Applied;
+    };
+
+    constexpr ObjectID id = 3;
+
+    buffer.Add(id, 20, std::make_unique<ResponseEntityUpdate>(0, 1, 20, -1, id, sf::Packet()),
+        1000);
+
+    CHECK(buffer.PlayOut(2000, applier) == 0);
+    CHECK(buffer.GetOrphanCount() == 1);
+
+    existing.push_back(id);
+    buffer.OnEntityCreated(id);
+
+    CHECK(buffer.GetOrphanCount() == 0);
+    CHECK(buffer.PlayOut(2000, applier) == 1);
+    CHECK(applied.size() == 1);
+
+    SECTION("Destruction is applied after the states received before it")
+    {
+        buffer.Add(id, 21,
+            std::make_unique<ResponseEntityUpdate>(0, 1, 21, -1, id, sf::Packet()), 2000);
+        buffer.AddDestruction(id, std::make_unique<ResponseEntityDestruction>(0, 1, id), 2000);
+
+        CHECK(buffer.PlayOut(3000, applier) == 2);
+        REQUIRE(applied.size() == 2);
+        CHECK(std::get<1>(applied[1]) == 21);
+        CHECK(destroyed.size() == 1);
+
+        // Late packets for destroyed entities are ignored
+        buffer.Add(id, 22,
+            std::make_unique<ResponseEntityUpdate>(0, 1, 22, -1, id, sf::Packet()), 3000);
+        CHECK(buffer.GetQueuedCount() == 0);
+    }
+
+    SECTION("Updates for entities that are never created are thrown out")
+    {
+        buffer.Add(4, 30, std::make_unique<ResponseEntityUpdate>(0, 1, 30, -1, 4, sf::Packet()),
+            3000);
+
+        CHECK(buffer.PlayOut(4000, applier) == 0);
+        CHECK(buffer.GetOrphanCount() == 1);
+
+        // Nothing is queued but the orphan still needs to be played out to expire
+        CHECK(buffer.GetQueuedCount() == 0);
+        CHECK(!buffer.IsEmpty());
+
+        CHECK(buffer.PlayOut(5001, applier) == 0);
+        CHECK(buffer.GetOrphanCount() == 0);
+        CHECK(buffer.IsEmpty());
+    }
+
+    SECTION("Destroyed entity records expire with nothing queued")
+    {
+        buffer.AddDestruction(id, std::make_unique<ResponseEntityDestruction>(0, 1, id), 2000);
+
+        CHECK(buffer.PlayOut(3000, applier) == 1);
+        CHECK(buffer.GetQueuedCount() == 0);
+        CHECK(!buffer.IsEmpty());
+
+        CHECK(buffer.PlayOut(5001, applier) == 0);
+        CHECK(buffer.IsEmpty());
+    }
+}
+
+TEST_CASE("WorldReplay runs a recorded client world the same way", "[entity][networking]")
+{
+    PartialEngine<false> engine;
+    engine.InitRandomForTest();
+
+    StandardWorld server(nullptr);
+    REQUIRE(server.Init(WorldNetworkSettings::GetSettingsForServer(), nullptr));
+
+    const auto id = server.CreateEntity();
+    server.Create_Position(id, Float3(1, 2, 3), Float4::IdentityQuaternion());
+
+    sf::Packet initialData;
+    const auto componentCount = server.CaptureEntityStaticState(id, initialData);
+    ResponseEntityCreation creation(
+        0, server.GetID(), id, componentCount, std::move(initialData));
+
+    std::vector<int> randomNumbers;
+
+    const auto handler = [&](GameWorld& world, uint32_t type, sf::Packet& data) {
+        REQUIRE(type == 1);
+
+        float x;
+        data >> x;
+
+        Position* position = world.GetComponentPtr<Position>(id);
+        REQUIRE(position);
+        position->Members._Position.X = x;
+
+        randomNumbers.push_back(world.GetRandom().GetNumber());
+    };
+
+    auto recorder = std::make_shared<WorldRecorder>();
+
+    StandardWorld client(nullptr);
+    REQUIRE(client.Init(WorldNetworkSettings::GetSettingsForClient(), nullptr));
+    client.SetRecorder(recorder);
+
+    const int mainSeed = Random::Get()->GetSeed();
+    const int mainIndex = Random::Get()->GetIndex();
+
+    CHECK(client.HandleEntityPacket(creation) == id);
+    client.Tick(1);
+
+    sf::Packet command;
+    command << 5.f;
+    client.RecordCommand(1, command);
+    handler(client, 1, command);
+
+    client.Tick(2);
+    client.SetRecorder(nullptr);
+
+    // Only the world's own generator is used and reseeded
+    CHECK(Random::Get()->GetSeed() == mainSeed);
+    CHECK(Random::Get()->GetIndex() == mainIndex);
+
+    CHECK(recorder->GetEntryCount() == 4);
+
+    WorldReplay replay;
+    REQUIRE(replay.LoadFromMemory(recorder->GetData()));
+
+    const auto& entries = replay.GetEntries();
+    REQUIRE(entries.size() == 4);
+    CHECK(entries[0].Type == WORLD_RECORDING_ENTRY::Packet);
+    CHECK(entries[1].Type == WORLD_RECORDING_ENTRY::Tick);
+    CHECK(entries[1].TickNumber == 1);
+    CHECK(entries[2].Type == WORLD_RECORDING_ENTRY::Command);
+    CHECK(entries[3].TickNumber == 2);
+
+    CHECK(replay.GetWorldType() == client.GetType());
+    CHECK(!replay.GetRecordedSettings().IsAuthoritative);
+
+    StandardWorld replayed(nullptr);
+    REQUIRE(replayed.Init(replay.GetRecordedSettings(), nullptr));
+
+    WorldReplayResult result;
+    replay.Run(replayed, handler, result);
+
+    CHECK(result.TickCount == 2);
+
+    Position* recorded = client.GetComponentPtr<Position>(id);
+    Position* position = replayed.GetComponentPtr<Position>(id);
+    REQUIRE(recorded);
+    REQUIRE(position);
+    CHECK(position->Members._Position == recorded->Members._Position);
+
+    // The same random numbers are drawn after each tick
+    REQUIRE(randomNumbers.size() == 2);
+    CHECK(randomNumbers[0] == randomNumbers[1]);
+
+    const auto tickZone = std::find_if(result.Zones.begin(), result.Zones.end(),
+        [](const WorldReplayZoneTiming& zone) { return zone.Name == "GameWorld::Tick"; });
+
+    REQUIRE(tickZone != result.Zones.end());
+    CHECK(tickZone->Count == 2);
+
+    SECTION("Truncated recordings are rejected")
+    {
+        const auto& data = recorder->GetData();
+
+        sf::Packet truncated;
+        truncated.append(data.getData(), data.getDataSize() - 1);
+
+        CHECK(!replay.LoadFromMemory(truncated));
+    }
+
+    replayed.Release();
+    client.Release();
+    server.Release();
+}
@@ -4,6 +4,8 @@
 
 #include "catch.hpp"
 
+#include <cctype>
+
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
@@ -314,6 +316,22 @@ TEST_CASE("StringIterator get functions", "[string][objectfile]")
         }
     }
 
+    SECTION("Non-ASCII stop flag stops at underscores")
+    {
+        itr.ReInit("abc_def ghi");
+
+        auto results =
+            itr.GetNextCharacterSequence<std::string>(UNNORMALCHARACTER_TYPE_NON_ASCII);
+
+        REQUIRE(results != nullptr);
+        CHECK(*results == "abc");
+
+        results = itr.GetNextCharacterSequence<std::string>(UNNORMALCHARACTER_TYPE_NON_ASCII);
+
+        REQUIRE(results != nullptr);
+        CHECK(*results == "def");
+    }
+
     SECTION("Getting decimal separator numbers")
     {
         itr.ReInit("aib val: = 243.12al toi() a 2456,12.5");
@@ -809,3 +827,220 @@ TEST_CASE("StringIterator new line handling", "[string]")
         CHECK(*result == "true");
     }
 }
+
+//! Forces StringIterator to handle every character one by one
+template<class DataIteratorType>
+class NoByteScanningDataIterator : public DataIteratorType {
+public:
+    NoByteScanningDataIterator(const std::string& str) : DataIteratorType(str) {}
+
+    bool GetRemainingBytes(const char*& current, const char*& end) override
+    {
+        return false;
+    }
+};
+
+//! Runs the same kind of calls that ObjectFileProcessor does and records the results
+std::vector<std::string> ParseWithIterator(StringIterator& itr)
+{
+    std::vector<std::string> results;
+
+    const auto record = [&](const std::unique_ptr<std::string>& value) {
+        results.push_back((value ? "'" + *value + "'" : std::string("null")) + " at " +
+                          std::to_string(itr.GetPosition()) + " line " +
+                          std::to_string(itr.GetCurrentLine()));
+    };
+
+    // Every call should move forward so this is just a safety limit //
+    for(size_t i = 0; i <= itr.GetLastValidCharIndex() && !itr.IsOutOfBounds(); ++i) {
+
+        itr.SkipWhiteSpace(SPECIAL_ITERATOR_FILEHANDLING);
+
+        switch(i % 5) {
+        case 0:
+            record(itr.GetNextCharacterSequence<std::string>(
+                UNNORMALCHARACTER_TYPE_LOWCODES | UNNORMALCHARACTER_TYPE_CONTROLCHARACTERS,
+                SPECIAL_ITERATOR_FILEHANDLING));
+            break;
+        case 1:
+            record(itr.GetUntilNextCharacterOrAll<std::string>(
+                ';', SPECIAL_ITERATOR_FILEHANDLING));
+            break;
+        case 2:
+            record(itr.GetStringInQuotes<std::string>(QUOTETYPE_BOTH));
+            break;
+        case 3:
+            record(itr.GetUntilLineEnd<std::string>());
+            break;
+        case 4:
+            record(itr.GetUntilNextCharacterOrNothing<std::string>('{'));
+            break;
+        }
+    }
+
+    return results;
+}
+
+constexpr auto ByteScanningTestStr =
+    "FileType: \"test\";\r\n"
+    "// A comment with \"quotes\" and 'more' and \\ in it\n"
+    "Value = \"escaped \\\" quote and \\\\ slash\";\n"
+    "/* multi\r\n   line * / comment */ Other: 'single \"inner\" quotes';\n"
+    "\v\f  \t Unicode = \"\xc3\xa4\xc3\xb6 \xe2\x80\xa8 separated\";\n"
+    "o Type \"Name\" {\n"
+    "    l values {\n"
+    "        number = -12.5e3;\n"
+    "        path = some/path*with/stars;\n"
+    "    }\n"
+    "}\n"
+    "last line without ending";
+
+TEST_CASE("StringIterator byte scanning matches character iteration", "[string][objectfile]")
+{
+    StringIterator scanned(std::make_unique<UTF8DataIterator>(ByteScanningTestStr));
+    StringIterator plain(
+        std::make_unique<NoByteScanningDataIterator<UTF8DataIterator>>(ByteScanningTestStr));
+
+    CHECK(ParseWithIterator(scanned) == ParseWithIterator(plain));
+
+    SECTION("std::string source")
+    {
+        const std::string text = ByteScanningTestStr;
+        StringIterator narrow(text);
+        StringIterator plain2(
+            std::make_unique<NoByteScanningDataIterator<StringClassDataIterator<std::string>>>(
+                text));
+
+        CHECK(ParseWithIterator(narrow) == ParseWithIterator(plain2));
+    }
+
+    SECTION("Long runs")
+    {
+        std::string text;
+
+        for(int i = 0; i < 20; ++i) {
+            text += std::string(i * 7, ' ') + "name_" + std::string(i * 5, 'x') + " = \"" +
+                    std::string(i * 11, 'y') + "\";" + (i % 2 ? "\r\n" : "\n") +
+                    "// " + std::string(i * 13, 'z') + "\n";
+        }
+
+        StringIterator longscanned(std::make_unique<UTF8DataIterator>(text));
+        StringIterator longplain(
+            std::make_unique<NoByteScanningDataIterator<UTF8DataIterator>>(text));
+
+        CHECK(ParseWithIterator(longscanned) == ParseWithIterator(longplain));
+    }
+}
+
+TEST_CASE("ByteScanning matches plain loops", "[string]")
+{
+    INFO("Implementation: " << ByteScanning::GetImplementationName());
+
+    std::string data;
+
+    // Every byte value in a few different orders so that all vector lanes see them
+    for(int round = 0; round < 5; ++round) {
+        for(int i = 0; i < 256; ++i)
+            data.push_back(static_cast<char>((i * (round * 2 + 1) + round * 37) & 0xFF));
+    }
+
+    const char* begin = data.data();
+    const char* end = data.data() + data.size();
+
+    const auto isspecial = [](unsigned char c, int stop) {
+        return c >= 0x80 || (c >= 0x0A && c <= 0x0D) || c == '\\' || c == '"' || c == '\'' ||
+               c == '/' || c == '*' || c == stop;
+    };
+
+    for(size_t offset = 0; offset < data.size(); offset += 13) {
+
+        const char* start = begin + offset;
+
+        const char* expected = start;
+        while(expected < end && !isspecial(*expected, 'a'))
+            ++expected;
+
+        CHECK(ByteScanning::FindSpecialCharacter(start, end, 'a') == expected);
+
+        expected = start;
+        while(expected < end && static_cast<unsigned char>(*expected) < 0x80)
+            ++expected;
+
+        CHECK(ByteScanning::FindNonASCII(start, end) == expected);
+
+        expected = start;
+        while(expected < end && (std::isalnum(static_cast<unsigned char>(*expected)) ||
+                                    *expected == '_') &&
+              static_cast<unsigned char>(*expected) < 0x80)
+            ++expected;
+
+        CHECK(ByteScanning::SkipAlphanumeric(start, end) == expected);
+
+        size_t lines = 0;
+
+        for(const char* current = start; current < end; ++current) {
+            if(StringOperations::IsLineTerminator(*current) &&
+                !(*current == '\r' && current + 1 < end && *(current + 1) == '\n'))
+                ++lines;
+        }
+
+        CHECK(ByteScanning::CountLineChanges(start, end, end) == lines);
+    }
+
+    SECTION("Skipping characters")
+    {
+        const std::string whitespace = std::string(40, ' ') + "\t\r\n  \n" +
+                                       std::string(30, '-') + "   \n" + std::string(50, ' ');
+
+        const char* wsbegin = whitespace.data();
+        const char* wsend = wsbegin + whitespace.size();
+
+        CHECK(ByteScanning::SkipCharacters(wsbegin, wsend, ' ', false, false) == wsbegin + 40);
+        CHECK(ByteScanning::SkipCharacters(wsbegin, wsend, -1, true, false) == wsbegin + 46);
+        CHECK(ByteScanning::SkipCharacters(wsbegin, wsend, -1, true, true) == wsbegin + 41);
+        CHECK(ByteScanning::SkipCharacters(wsbegin + 46, wsend, '-', true, false) == wsend);
+        CHECK(ByteScanning::SkipCharacters(wsbegin + 46, wsend, '-', false, false) ==
+              wsbegin + 76);
+        CHECK(ByteScanning::SkipCharacters(wsbegin + 76, wsend, -1, true, true) ==
+              wsbegin + 79);
+        CHECK(ByteScanning::SkipCharacters(wsbegin + 80, wsend, -1, true, true) == wsend);
+    }
+}
+
+TEST_CASE("StringIterator parse throughput", "[.benchmark][string][objectfile]")
+{
+    std::string text;
+
+    for(int i = 0; i < 2000; ++i)
+        text += ByteScanningTestStr;
+
+    const auto megabytes = text.size() / (1024.0 * 1024.0);
+    INFO("Data size: " << megabytes << " MiB, scanning: "
+                       << ByteScanning::GetImplementationName());
+
+    size_t scannedcount = 0;
+    size_t plaincount = 0;
+    size_t narrowcount = 0;
+
+    BENCHMARK("UTF8 data with byte scanning")
+    {
+        StringIterator itr(std::make_unique<UTF8PointerDataIterator>(text));
+        scannedcount = ParseWithIterator(itr).size();
+    }
+
+    BENCHMARK("UTF8 data one character at a time")
+    {
+        StringIterator itr(
+            std::make_unique<NoByteScanningDataIterator<UTF8DataIterator>>(text));
+        plaincount = ParseWithIterator(itr).size();
+    }
+
+    BENCHMARK("std::string data with byte scanning")
+    {
+        StringIterator itr(&text);
+        narrowcount = ParseWithIterator(itr).size();
+    }
+
+    CHECK(scannedcount == plaincount);
+    CHECK(scannedcount == narrowcount);
+}
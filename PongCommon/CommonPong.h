@@ -19,7 +19,7 @@
 #include "PlayerSlot.h"
 #include "PongPackets.h"
 #include "Script/ScriptExecutor.h"
-#include "Statistics/TimingMonitor.h"
+#include "Statistics/Profiler.h"
 #include "Threading/QueuedTask.h"
 #include "Threading/ThreadingManager.h"
 #include "Window.h"
@@ -133,6 +133,28 @@ int VerifyRunResult(GameWorld@ world){
     return value;
 }
 
+int VerifyRunResultWithView(GameWorld@ world){
+
+    auto holder = world.GetScriptComponentHolder("CoolTimer");
+
+    if(holder.GetCount() != 3)
+        return -1;
+
+    int value = 0;
+
+    for(uint i = 0; i < holder.GetCount(); ++i){
+
+        CoolTimer@ timer = cast<CoolTimer>(holder.GetAt(i));
+
+        if(holder.Find(holder.GetEntityAt(i)) !is timer)
+            return -2;
+
+        value += timer.TimeValue;
+    }
+
+    return value;
+}
+
 array<ObjectID>@ BeforeRemoveIndex;
 
 bool RemoveSomeComponents(GameWorld@ world){